@@ -0,0 +1,396 @@
+// Tokenizer and parser throughput on generated sources:
+//
+//     bench_frontend [--seed N] [--repeat N] [--text] [--json] [size...]
+//
+// Sizes take a K, M or G suffix (default: 1K 100K 1M 10M). For each size it
+// generates a source dense in classes, functions, nested expressions, long
+// string literals and comments (mostly comments and strings with --text),
+// then reports tokenizer MB/s and tokens/s (serially and on every core),
+// parser nodes/s, the heap used by the tokens and by the ProgramNode, how long
+// freeing the ProgramNode takes and the size of the same tree as a FlatAst. It
+// also parses the source a second time pulling the tokens on demand, and
+// reports the MB/s of tokenizing and parsing together that way and its peak
+// heap. The same seed always generates the same source, so runs are
+// comparable across builds. Throughput that drops as the size grows points at
+// quadratic behaviour.
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "../src/parser/flat_ast.h"
+#include "../src/parser/parser.h"
+#include "../src/parser/tokenizer.h"
+
+// Live and peak heap bytes, counted by replacing the global operator new. The
+// size is kept in front of each block so delete can subtract it again
+static size_t liveBytes = 0;
+static size_t peakBytes = 0;
+static constexpr size_t header = alignof(std::max_align_t);
+
+void *operator new(std::size_t size)
+{
+    char *block = static_cast<char *>(std::malloc(size + header));
+    if (!block)
+    {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<size_t *>(block) = size;
+    liveBytes += size;
+    peakBytes = std::max(peakBytes, liveBytes);
+    return block + header;
+}
+
+void operator delete(void *memory) noexcept
+{
+    if (memory)
+    {
+        char *block = static_cast<char *>(memory) - header;
+        liveBytes -= *reinterpret_cast<size_t *>(block);
+        std::free(block);
+    }
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    operator delete(memory);
+}
+
+// Generates valid edu source of roughly the requested size
+class SourceGenerator
+{
+public:
+    SourceGenerator(unsigned seed, bool text) : random(seed), text(text) {}
+
+    std::string generate(size_t size)
+    {
+        std::string source;
+        source.reserve(size + 4096);
+        declarations = 0;
+        while (source.size() < size)
+        {
+            if (text)
+            {
+                // Three comments to every function, whose strings run long
+                pick(4) ? comment(source) : function(source);
+                continue;
+            }
+            switch (pick(4))
+            {
+            case 0:
+                comment(source);
+                break;
+            case 1:
+                klass(source);
+                break;
+            default:
+                function(source);
+                break;
+            }
+        }
+        return source;
+    }
+
+    // Top level declarations generated by the last generate()
+    size_t declarations = 0;
+
+private:
+    std::mt19937 random;
+    bool text;
+    int nextId = 0;
+
+    int pick(int count) { return std::uniform_int_distribution<int>(0, count - 1)(random); }
+
+    void comment(std::string &out)
+    {
+        if (pick(2))
+        {
+            out += "// Generated comment " + std::to_string(nextId++) + ": " + words(text ? 40 + pick(80) : 8 + pick(16)) + "\n";
+        }
+        else
+        {
+            out += "/* Block comment\n   " + words(10 + pick(20)) + "\n   " + words(10) + " */\n";
+        }
+    }
+
+    std::string words(int count)
+    {
+        static const char *vocabulary[] = {"alpha", "beta", "gamma", "delta", "value", "result",
+                                           "index", "total", "shape", "token", "parser", "node"};
+        std::string text;
+        for (int i = 0; i < count; i++)
+        {
+            text += (i ? " " : "");
+            text += vocabulary[pick(12)];
+        }
+        return text;
+    }
+
+    // Nested arithmetic over the given variables
+    std::string expression(const std::vector<std::string> &variables, int depth)
+    {
+        if (depth == 0 || pick(4) == 0)
+        {
+            return pick(3) ? variables[pick(static_cast<int>(variables.size()))] : std::to_string(pick(1000));
+        }
+        static const char *operators[] = {"+", "-", "*", "+", "-"};
+        std::string left = expression(variables, depth - 1);
+        std::string right = expression(variables, depth - 1);
+        return "(" + left + " " + operators[pick(5)] + " " + right + ")";
+    }
+
+    void body(std::string &out, std::vector<std::string> variables, const std::string &indent)
+    {
+        int statements = 2 + pick(5);
+        for (int i = 0; i < statements; i++)
+        {
+            std::string name = "v" + std::to_string(i);
+            switch (pick(5))
+            {
+            case 0:
+                out += indent + "string s" + std::to_string(i) + " = \"" + words(text ? 40 + pick(160) : 10 + pick(40)) + "\";\n";
+                break;
+            case 1:
+                out += indent + "if (" + expression(variables, 2) + " > " + std::to_string(pick(100)) + ") {\n";
+                out += indent + "    " + variables[0] + " = " + expression(variables, 3) + ";\n";
+                out += indent + "}\n";
+                break;
+            case 2:
+                out += indent + "for (int i = 0; i < " + std::to_string(pick(50)) + "; i = i + 1) {\n";
+                out += indent + "    " + variables[0] + " = " + variables[0] + " + i;\n";
+                out += indent + "}\n";
+                break;
+            default:
+                out += indent + "int " + name + " = " + expression(variables, 4) + ";\n";
+                variables.push_back(name);
+                break;
+            }
+        }
+        out += indent + "return " + expression(variables, 3) + ";\n";
+    }
+
+    void function(std::string &out)
+    {
+        out += "int function f" + std::to_string(nextId++) + "(int a, int b) {\n";
+        body(out, {"a", "b"}, "    ");
+        out += "}\n\n";
+        declarations++;
+    }
+
+    void klass(std::string &out)
+    {
+        out += "class C" + std::to_string(nextId++) + " {\n";
+        int fields = 1 + pick(4);
+        std::vector<std::string> variables = {"a"};
+        for (int i = 0; i < fields; i++)
+        {
+            out += "    int field" + std::to_string(i) + ";\n";
+            variables.push_back("field" + std::to_string(i));
+        }
+        int methods = 1 + pick(3);
+        for (int i = 0; i < methods; i++)
+        {
+            out += "    int function method" + std::to_string(i) + "(int a) {\n";
+            body(out, variables, "        ");
+            out += "    }\n";
+        }
+        out += "}\n\n";
+        declarations++;
+    }
+};
+
+static size_t parseSize(const char *text)
+{
+    char *suffix = nullptr;
+    double size = std::strtod(text, &suffix);
+    switch (*suffix)
+    {
+    case 'k':
+    case 'K':
+        size *= 1024;
+        break;
+    case 'm':
+    case 'M':
+        size *= 1024 * 1024;
+        break;
+    case 'g':
+    case 'G':
+        size *= 1024 * 1024 * 1024;
+        break;
+    }
+    return static_cast<size_t>(size);
+}
+
+struct Result
+{
+    size_t sourceBytes = 0;
+    size_t tokens = 0;
+    size_t nodes = 0;
+    double tokenizeSeconds = 1e30;
+    double parallelSeconds = 1e30;
+    double parseSeconds = 1e30;
+    size_t tokenBytes = 0;
+    size_t astBytes = 0;
+    size_t peakParseBytes = 0;
+    double freeSeconds = 1e30;
+    size_t flatBytes = 0;
+    double streamSeconds = 1e30;
+    size_t peakStreamBytes = 0;
+    bool complete = true;
+};
+
+static double seconds(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+static Result measure(const std::string &source, size_t declarations, int repeat)
+{
+    Result result;
+    result.sourceBytes = source.size();
+    // Best of repeat runs, the least disturbed by the rest of the machine
+    for (int run = 0; run < repeat; run++)
+    {
+        size_t before = liveBytes;
+        auto start = std::chrono::steady_clock::now();
+        // Tokens point into the tokenizer, which has to outlive the parse
+        Tokenizer tokenizer(source);
+        std::vector<Token> tokens = tokenizer.tokenize();
+        result.tokenizeSeconds = std::min(result.tokenizeSeconds, seconds(start));
+        result.tokens = tokens.size();
+        result.tokenBytes = liveBytes - before;
+
+        {
+            start = std::chrono::steady_clock::now();
+            Tokenizer parallel(source);
+            std::vector<Token> parallelTokens = parallel.tokenizeParallel();
+            result.parallelSeconds = std::min(result.parallelSeconds, seconds(start));
+            result.complete = parallelTokens.size() == tokens.size();
+        }
+
+        before = liveBytes;
+        peakBytes = liveBytes;
+        size_t nodesBefore = ASTNode::created();
+        start = std::chrono::steady_clock::now();
+        Parser parser(tokens);
+        std::unique_ptr<ProgramNode> program = parser.parse();
+        result.parseSeconds = std::min(result.parseSeconds, seconds(start));
+        result.nodes = ASTNode::created() - nodesBefore;
+        result.astBytes = liveBytes - before;
+        result.peakParseBytes = peakBytes - before;
+        result.complete = result.complete && program && program->children.size() == declarations;
+        result.flatBytes = FlatAst::flatten(*program).bytes();
+        start = std::chrono::steady_clock::now();
+        program.reset();
+        result.freeSeconds = std::min(result.freeSeconds, seconds(start));
+
+        // The source copy the tokenizer owns doesn't count
+        SourceBuffer buffer(source);
+        before = liveBytes;
+        peakBytes = liveBytes;
+        start = std::chrono::steady_clock::now();
+        Tokenizer streamed(std::move(buffer));
+        Parser streamingParser(streamed);
+        program = streamingParser.parse();
+        result.streamSeconds = std::min(result.streamSeconds, seconds(start));
+        result.peakStreamBytes = peakBytes - before;
+        result.complete = result.complete && program && program->children.size() == declarations;
+    }
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned seed = 1;
+    int repeat = 3;
+    bool json = false;
+    bool text = false;
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            seed = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            repeat = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--text") == 0)
+        {
+            text = true;
+        }
+        else if (strcmp(argv[i], "--json") == 0)
+        {
+            json = true;
+        }
+        else if (parseSize(argv[i]) > 0)
+        {
+            sizes.push_back(parseSize(argv[i]));
+        }
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--seed N] [--repeat N] [--text] [--json] [size...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (sizes.empty())
+    {
+        sizes = {1024, 100 * 1024, 1024 * 1024, 10 * 1024 * 1024};
+    }
+
+    if (json)
+    {
+        std::printf("{\"seed\": %u, \"text\": %s, \"results\": [", seed, text ? "true" : "false");
+    }
+    else
+    {
+        std::printf("%12s %10s %10s %12s %12s %12s %10s %10s %10s %10s %10s %12s %10s\n", "source B", "tok MB/s",
+                    "par MB/s", "tokens/s", "nodes/s", "nodes", "tokens MB", "AST MB", "peak MB", "free ms", "flat MB", "stream MB/s",
+                    "stream MB");
+    }
+
+    bool allComplete = true;
+    for (size_t i = 0; i < sizes.size(); i++)
+    {
+        SourceGenerator generator(seed, text);
+        std::string source = generator.generate(sizes[i]);
+        Result r = measure(source, generator.declarations, repeat);
+        allComplete = allComplete && r.complete;
+
+        double megabytes = r.sourceBytes / (1024.0 * 1024.0);
+        if (json)
+        {
+            std::printf("%s\n  {\"source_bytes\": %zu, \"tokens\": %zu, \"nodes\": %zu, "
+                        "\"tokenize_s\": %.6f, \"parse_s\": %.6f, \"tokenize_mb_per_s\": %.2f, "
+                        "\"parallel_tokenize_mb_per_s\": %.2f, "
+                        "\"tokens_per_s\": %.0f, \"nodes_per_s\": %.0f, \"token_bytes\": %zu, "
+                        "\"ast_bytes\": %zu, \"peak_parse_bytes\": %zu, \"free_s\": %.6f, \"flat_bytes\": %zu, \"stream_mb_per_s\": %.2f, "
+                        "\"peak_stream_bytes\": %zu, \"complete\": %s}",
+                        i ? "," : "", r.sourceBytes, r.tokens, r.nodes, r.tokenizeSeconds, r.parseSeconds,
+                        megabytes / r.tokenizeSeconds, megabytes / r.parallelSeconds, r.tokens / r.tokenizeSeconds,
+                        r.nodes / r.parseSeconds, r.tokenBytes, r.astBytes, r.peakParseBytes, r.freeSeconds, r.flatBytes, megabytes / r.streamSeconds, r.peakStreamBytes,
+                        r.complete ? "true" : "false");
+        }
+        else
+        {
+            std::printf("%12zu %10.2f %10.2f %12.0f %12.0f %12zu %10.2f %10.2f %10.2f %10.2f %10.2f %12.2f %10.2f%s\n",
+                        r.sourceBytes, megabytes / r.tokenizeSeconds, megabytes / r.parallelSeconds,
+                        r.tokens / r.tokenizeSeconds, r.nodes / r.parseSeconds,
+                        r.nodes, r.tokenBytes / 1048576.0, r.astBytes / 1048576.0, r.peakParseBytes / 1048576.0, r.freeSeconds * 1000,
+                        r.flatBytes / 1048576.0,
+                        megabytes / r.streamSeconds, r.peakStreamBytes / 1048576.0,
+                        r.complete ? "" : "  (parse incomplete)");
+        }
+    }
+    if (json)
+    {
+        std::printf("\n]}\n");
+    }
+    return allComplete ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+// Runs a command and writes its wall time, peak RSS and exit status to a file,
+// for bench/run.py:
+//
+//     bench_measure <result file> <command> [arguments...]
+//
+// The peak RSS a process reports includes the memory of the process it was
+// forked from, so measuring straight from Python would add the size of the
+// Python interpreter to every run. This launcher is small enough not to.
+#include <chrono>
+#include <cstdio>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "Usage: %s <result file> <command> [arguments...]\n", argv[0]);
+        return 2;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    pid_t child = fork();
+    if (child < 0)
+    {
+        std::perror("fork");
+        return 2;
+    }
+    if (child == 0)
+    {
+        execvp(argv[2], argv + 2);
+        std::perror(argv[2]);
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage = {};
+    // wait4 includes the children the command waited for, e.g. the C++
+    // compiler and the compiled program for edu --compile
+    if (wait4(child, &status, 0, &usage) < 0)
+    {
+        std::perror("wait4");
+        return 2;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    long rss = usage.ru_maxrss;
+#ifdef __APPLE__
+    rss /= 1024; // Bytes there, KiB on Linux
+#endif
+    int exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+
+    FILE *result = std::fopen(argv[1], "w");
+    if (!result)
+    {
+        std::perror(argv[1]);
+        return 2;
+    }
+    std::fprintf(result, "%.6f %ld %d\n", elapsed.count(), rss, exitCode);
+    std::fclose(result);
+    return exitCode;
+}
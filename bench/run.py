@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Runs the edu workloads in bench/ and writes the results as JSON.
+
+Every workload (a .edu file with a main function) runs --runs times in each
+mode: on the interpreter (bytecode VM plus AST walker), on the interpreter
+without its JIT (--no-jit), on the AST walker only (--ast), on closures
+compiled from the AST (--closures), transpiled to C++ and compiled (--compile,
+includes the C++ compile time) and transpiled only (--transpile). For each it
+reports the median and 95th percentile wall time and the peak RSS of the
+process tree. Interpreter modes also report heap allocations per edu call from
+one --alloc-stats run.
+
+    python3 bench/run.py --edu build/edu --output build/bench.json
+    python3 bench/run.py --modes interpret,ast --runs 10 primes recursion
+"""
+
+import argparse
+import json
+import math
+import os
+import platform
+import re
+import signal
+import statistics
+import subprocess
+import sys
+import tempfile
+
+BENCH_DIR = os.path.dirname(os.path.abspath(__file__))
+
+MODES = {
+    "interpret": [],
+    "no-jit": ["--no-jit"],
+    "ast": ["--ast"],
+    "closures": ["--closures"],
+    "compile": ["--compile"],
+    "transpile": ["--transpile"],
+}
+
+ALLOC_STATS = re.compile(r"allocations per call: ([0-9.]+)")
+
+
+def find_workloads(names):
+    workloads = []
+    for file in sorted(os.listdir(BENCH_DIR)):
+        name, ext = os.path.splitext(file)
+        if ext != ".edu" or (names and name not in names):
+            continue
+        with open(os.path.join(BENCH_DIR, file)) as source:
+            # Modules such as benchUtils.edu are only imported
+            if "function main(" in source.read():
+                workloads.append(name)
+    missing = set(names) - set(workloads)
+    if missing:
+        sys.exit("Unknown workloads: " + ", ".join(sorted(missing)))
+    return workloads
+
+
+def run_once(measure, command, timeout):
+    """Runs command in bench/ so imports resolve against it. Returns
+    (seconds, peak RSS in KiB, exit status, stdout, stderr)."""
+    with tempfile.TemporaryFile() as out, tempfile.TemporaryFile() as err, \
+            tempfile.NamedTemporaryFile("r") as result:
+        process = subprocess.Popen([measure, result.name] + command, cwd=BENCH_DIR,
+                                   stdout=out, stderr=err, start_new_session=True)
+        try:
+            process.wait(timeout)
+        except subprocess.TimeoutExpired:
+            os.killpg(process.pid, signal.SIGKILL)
+            process.wait()
+            return timeout, 0, None, "", "timed out"
+
+        out.seek(0)
+        err.seek(0)
+        fields = result.read().split()
+        if len(fields) != 3:
+            return 0, 0, process.returncode, "", err.read().decode(errors="replace")
+        elapsed, rss, status = float(fields[0]), int(fields[1]), int(fields[2])
+        return elapsed, rss, status, out.read().decode(errors="replace"), err.read().decode(errors="replace")
+
+
+def percentile(samples, fraction):
+    # Nearest rank, so the result is always one of the measured times
+    ordered = sorted(samples)
+    return ordered[max(0, math.ceil(fraction * len(ordered)) - 1)]
+
+
+def bench(measure, edu, workload, mode, runs, timeout, expected):
+    """Returns the result entry and the output of the last run"""
+    command = [edu] + MODES[mode] + [workload + ".edu"]
+    result = {"workload": workload, "mode": mode}
+    times = []
+    peak_rss = 0
+    output = None
+    for _ in range(runs):
+        elapsed, rss, status, output, errors = run_once(measure, command, timeout)
+        if status != 0:
+            # The first error, e.g. what the C++ compiler choked on
+            lines = [line for line in errors.splitlines() if "error" in line.lower()] or errors.strip().splitlines()
+            result["error"] = lines[0] if lines else "exit status %s" % status
+            return result, None
+        times.append(elapsed)
+        peak_rss = max(peak_rss, rss)
+
+    result["runs"] = runs
+    result["median_s"] = round(statistics.median(times), 6)
+    result["p95_s"] = round(percentile(times, 0.95), 6)
+    result["max_rss_kb"] = peak_rss
+
+    # Transpiling prints C++ rather than the program's output, and --compile
+    # announces itself before the program's output
+    if mode != "transpile" and expected is not None:
+        result["output_matches"] = output.endswith(expected)
+
+    if mode in ("interpret", "no-jit", "ast", "closures"):
+        _, _, status, _, errors = run_once(measure, [edu, "--alloc-stats"] + MODES[mode] + [workload + ".edu"], timeout)
+        match = ALLOC_STATS.search(errors)
+        if status == 0 and match:
+            result["allocs_per_call"] = float(match.group(1))
+    return result, output
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run the edu benchmark workloads")
+    parser.add_argument("workloads", nargs="*", help="workload names, e.g. primes (default: all)")
+    parser.add_argument("--edu", default="build/edu", help="edu binary to benchmark")
+    parser.add_argument("--measure", default="build/bench_measure",
+                        help="launcher built from bench/measure.cpp")
+    parser.add_argument("--runs", type=int, default=5, help="runs per workload and mode")
+    parser.add_argument("--modes", default="interpret,no-jit,ast,closures,compile,transpile",
+                        help="comma separated subset of " + ",".join(MODES))
+    parser.add_argument("--timeout", type=float, default=120, help="seconds before a run is killed")
+    parser.add_argument("--output", default="build/bench.json", help="JSON file to write")
+    args = parser.parse_args()
+
+    modes = args.modes.split(",")
+    unknown = [mode for mode in modes if mode not in MODES]
+    if unknown:
+        sys.exit("Unknown modes: " + ", ".join(unknown))
+    edu = os.path.abspath(args.edu)
+    measure = os.path.abspath(args.measure)
+    for path in (edu, measure):
+        if not os.path.isfile(path):
+            sys.exit("No " + path + ", build it with scons first")
+
+    results = []
+    print("%-10s %-10s %10s %10s %10s %12s" % ("workload", "mode", "median s", "p95 s", "RSS KiB", "allocs/call"))
+    for workload in find_workloads(args.workloads):
+        # The interpreter's output is what the other modes are checked against
+        expected = None
+        for mode in modes:
+            result, output = bench(measure, edu, workload, mode, args.runs, args.timeout, expected)
+            if mode == "interpret":
+                expected = output
+            results.append(result)
+
+            if "error" in result:
+                print("%-10s %-10s failed: %s" % (workload, mode, result["error"]))
+                continue
+            mismatch = "  output differs" if result.get("output_matches") is False else ""
+            allocs = result.get("allocs_per_call")
+            print("%-10s %-10s %10.4f %10.4f %10d %12s%s" % (
+                workload, mode, result["median_s"], result["p95_s"], result["max_rss_kb"],
+                "-" if allocs is None else "%.3f" % allocs, mismatch))
+
+    report = {
+        "edu": args.edu,
+        "runs": args.runs,
+        "machine": platform.machine(),
+        "system": platform.system(),
+        "results": results,
+    }
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, "w") as file:
+        json.dump(report, file, indent=2)
+        file.write("\n")
+    print("Wrote " + args.output)
+
+
+if __name__ == "__main__":
+    main()
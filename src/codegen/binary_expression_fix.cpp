@@ -6,12 +6,12 @@ std::string BinaryExpressionFix::fixOrExpression(OrExpressionNode *node)
     std::stringstream output;
 
     // Special case for isPrime function
-    if (auto *leftBinaryExpr = dynamic_cast<BinaryExpressionNode *>(node->left.get()))
+    if (auto *leftBinaryExpr = nodeCast<BinaryExpressionNode>(node->left.get()))
     {
         if (leftBinaryExpr->op == "%")
         {
             // Generate the variable (num)
-            if (auto *varExpr = dynamic_cast<VariableExpressionNode *>(leftBinaryExpr->left.get()))
+            if (auto *varExpr = nodeCast<VariableExpressionNode>(leftBinaryExpr->left.get()))
             {
                 output << varExpr->name;
             }
@@ -20,7 +20,7 @@ std::string BinaryExpressionFix::fixOrExpression(OrExpressionNode *node)
             output << " % ";
 
             // Generate the right operand (2)
-            if (auto *intLiteral = dynamic_cast<IntegerLiteralNode *>(leftBinaryExpr->right.get()))
+            if (auto *intLiteral = nodeCast<IntegerLiteralNode>(leftBinaryExpr->right.get()))
             {
                 output << intLiteral->value;
             }
@@ -34,12 +34,12 @@ std::string BinaryExpressionFix::fixOrExpression(OrExpressionNode *node)
     output << " || ";
 
     // Special case for isPrime function
-    if (auto *rightBinaryExpr = dynamic_cast<BinaryExpressionNode *>(node->right.get()))
+    if (auto *rightBinaryExpr = nodeCast<BinaryExpressionNode>(node->right.get()))
     {
         if (rightBinaryExpr->op == "%")
         {
             // Generate the variable (num)
-            if (auto *varExpr = dynamic_cast<VariableExpressionNode *>(rightBinaryExpr->left.get()))
+            if (auto *varExpr = nodeCast<VariableExpressionNode>(rightBinaryExpr->left.get()))
             {
                 output << varExpr->name;
             }
@@ -48,7 +48,7 @@ std::string BinaryExpressionFix::fixOrExpression(OrExpressionNode *node)
             output << " % ";
 
             // Generate the right operand (3)
-            if (auto *intLiteral = dynamic_cast<IntegerLiteralNode *>(rightBinaryExpr->right.get()))
+            if (auto *intLiteral = nodeCast<IntegerLiteralNode>(rightBinaryExpr->right.get()))
             {
                 output << intLiteral->value;
             }
@@ -66,14 +66,14 @@ std::string BinaryExpressionFix::fixIfCondition(IfStatementNode *node)
     std::stringstream output;
 
     // Special case for y == 0 in MathUtils::divide
-    if (auto *comparisonNode = dynamic_cast<ComparisonExpressionNode *>(node->condition.get()))
+    if (auto *comparisonNode = nodeCast<ComparisonExpressionNode>(node->condition.get()))
     {
-        if (auto *leftVarExpr = dynamic_cast<VariableExpressionNode *>(comparisonNode->left.get()))
+        if (auto *leftVarExpr = nodeCast<VariableExpressionNode>(comparisonNode->left.get()))
         {
             if (leftVarExpr->name == "y" && comparisonNode->op == "==")
             {
                 output << leftVarExpr->name << " == ";
-                if (auto *rightIntLiteral = dynamic_cast<IntegerLiteralNode *>(comparisonNode->right.get()))
+                if (auto *rightIntLiteral = nodeCast<IntegerLiteralNode>(comparisonNode->right.get()))
                 {
                     output << rightIntLiteral->value;
                 }
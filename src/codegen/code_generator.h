@@ -93,6 +93,7 @@ private:
     bool hasMainFunction = false;
     std::set<std::string> declaredVariables; // Track declared variables
     std::map<std::string, std::string> functionReturnTypes;
+    int switchCounter = 0; // Names the locals of lowered switches apart
 
     bool isBooleanReturningFunction(const std::string &functionName)
     {
@@ -108,76 +109,13 @@ private:
         }
     }
 
-    // Add this method to your CodeGenerator class
-    void generateOrExpressionDirect(OrExpressionNode *node)
-    {
-        if (!node)
-            return;
-
-        // Handle left side
-        if (auto *leftEq = dynamic_cast<EqualityExpressionNode *>(node->left.get()))
-        {
-            // Check if left side of equality is a binary expression (like num % 2)
-            if (auto *leftBinary = dynamic_cast<BinaryExpressionNode *>(leftEq->left.get()))
-            {
-                // Generate the binary expression (num % 2)
-                generateExpressionHelper(leftBinary->left.get());  // num
-                output << " " << leftBinary->op << " ";            // %
-                generateExpressionHelper(leftBinary->right.get()); // 2
-
-                // Add the equality operator and right side
-                output << " " << leftEq->op << " ";            // ==
-                generateExpressionHelper(leftEq->right.get()); // 0
-            }
-            else
-            {
-                // Handle other equality expressions normally
-                generateEqualityExpression(leftEq);
-            }
-        }
-        else
-        {
-            // Handle non-equality expressions
-            generateExpressionHelper(node->left.get());
-        }
-
-        // Output the OR operator
-        output << " || ";
-
-        // Handle right side
-        if (auto *rightEq = dynamic_cast<EqualityExpressionNode *>(node->right.get()))
-        {
-            // Check if left side of equality is a binary expression (like num % 3)
-            if (auto *rightBinary = dynamic_cast<BinaryExpressionNode *>(rightEq->left.get()))
-            {
-                // Generate the binary expression (num % 3)
-                generateExpressionHelper(rightBinary->left.get());  // num
-                output << " " << rightBinary->op << " ";            // %
-                generateExpressionHelper(rightBinary->right.get()); // 3
-
-                // Add the equality operator and right side
-                output << " " << rightEq->op << " ";            // ==
-                generateExpressionHelper(rightEq->right.get()); // 0
-            }
-            else
-            {
-                // Handle other equality expressions normally
-                generateEqualityExpression(rightEq);
-            }
-        }
-        else
-        {
-            // Handle non-equality expressions
-            generateExpressionHelper(node->right.get());
-        }
-    }
     std::string fixStringConcatenation(const std::string &code)
     {
         std::string result = code;
 
         // Only fix string concatenation in print statements
-        std::regex pattern(R"((".*?") \+ ([^<]+) << std::endl)");
-        result = std::regex_replace(result, pattern, "$1 << $2 << std::endl");
+        std::regex pattern(R"((".*?") \+ ([^<]+) << '\\n')");
+        result = std::regex_replace(result, pattern, "$1 << $2 << '\\n'");
 
         return result;
     }
@@ -194,7 +132,7 @@ private:
         // First pass: declare global variables
         for (const auto &child : node->children)
         {
-            if (auto *varDeclNode = dynamic_cast<VariableDeclarationNode *>(child.get()))
+            if (auto *varDeclNode = nodeCast<VariableDeclarationNode>(child.get()))
             {
                 generateVariableDeclaration(varDeclNode);
                 output << "\n";
@@ -204,31 +142,27 @@ private:
         // Second pass: generate classes, functions, etc.
         for (const auto &child : node->children)
         {
-            if (auto *classNode = dynamic_cast<ClassNode *>(child.get()))
-            {
-                generateClass(classNode);
-            }
-            else if (auto *functionNode = dynamic_cast<FunctionNode *>(child.get()))
-            {
-                generateFunction(functionNode);
-            }
-            else if (auto *interfaceNode = dynamic_cast<InterfaceNode *>(child.get()))
-            {
-                generateInterface(interfaceNode);
-            }
-            else if (auto *exportNode = dynamic_cast<ExportNode *>(child.get()))
-            {
-                // Handle export node
-            }
-            else if (auto *importNode = dynamic_cast<ImportNode *>(child.get()))
+            if (!child)
             {
-                // Handle import node
+                continue;
             }
-            else if (auto *templateNode = dynamic_cast<TemplateNode *>(child.get()))
+            switch (child->kind())
             {
-                // Handle template node
+            case NodeKind::Class:
+                generateClass(static_cast<ClassNode *>(child.get()));
+                break;
+            case NodeKind::Function:
+            case NodeKind::AsyncFunction:
+                generateFunction(static_cast<FunctionNode *>(child.get()));
+                break;
+            case NodeKind::Interface:
+                generateInterface(static_cast<InterfaceNode *>(child.get()));
+                break;
+            default:
+                // Exports, imports and templates aren't generated, and
+                // variable declarations were handled above
+                break;
             }
-            // Skip variable declarations as they're already handled
         }
 
         // Add main function if not already defined
@@ -241,84 +175,72 @@ private:
         }
     }
 
-    void generateExpressionHelper(ExpressionNode *expr)
+    // Generates any expression; every operand goes through here
+    void generateExpression(ExpressionNode *expr)
     {
         if (!expr)
             return;
 
-        if (auto *varExpr = dynamic_cast<VariableExpressionNode *>(expr))
-        {
-            generateVariableExpression(varExpr);
-        }
-        else if (auto *callExpr = dynamic_cast<CallExpressionNode *>(expr))
-        {
-            generateCallExpression(callExpr);
-        }
-        else if (auto *memberAccessExpr = dynamic_cast<MemberAccessExpressionNode *>(expr))
-        {
-            generateMemberAccessExpression(memberAccessExpr);
-        }
-        else if (auto *intLiteral = dynamic_cast<IntegerLiteralNode *>(expr))
-        {
-            generateIntegerLiteral(intLiteral);
-        }
-        else if (auto *floatLiteral = dynamic_cast<FloatingPointLiteralNode *>(expr))
-        {
-            generateFloatingPointLiteral(floatLiteral);
-        }
-        else if (auto *stringLiteral = dynamic_cast<StringLiteralNode *>(expr))
-        {
-            generateStringLiteral(stringLiteral);
-        }
-        else if (auto *boolLiteral = dynamic_cast<BooleanLiteralNode *>(expr))
-        {
-            generateBooleanLiteral(boolLiteral);
-        }
-        else if (auto *charLiteral = dynamic_cast<CharLiteralNode *>(expr))
-        {
-            generateCharLiteral(charLiteral);
-        }
-        else if (auto *addExpr = dynamic_cast<AdditionExpressionNode *>(expr))
-        {
-            generateAdditionExpression(addExpr);
-        }
-        else if (auto *subExpr = dynamic_cast<SubtractionExpressionNode *>(expr))
-        {
-            generateSubtractionExpression(subExpr);
-        }
-        else if (auto *mulExpr = dynamic_cast<MultiplicationExpressionNode *>(expr))
-        {
-            generateMultiplicationExpression(mulExpr);
-        }
-        else if (auto *divExpr = dynamic_cast<DivisionExpressionNode *>(expr))
-        {
-            generateDivisionExpression(divExpr);
-        }
-        else if (auto *compExpr = dynamic_cast<ComparisonExpressionNode *>(expr))
-        {
-            generateComparisonExpression(compExpr);
-        }
-        else if (auto *eqExpr = dynamic_cast<EqualityExpressionNode *>(expr))
-        {
-            generateEqualityExpression(eqExpr);
-        }
-        else if (auto *orExpr = dynamic_cast<OrExpressionNode *>(expr))
-        {
-            generateOrExpression(orExpr);
-        }
-        else if (auto *andExpr = dynamic_cast<AndExpressionNode *>(expr))
-        {
-            generateAndExpression(andExpr);
-        }
-        else if (auto *binaryExpr = dynamic_cast<BinaryExpressionNode *>(expr))
-        {
-            generateBinaryExpression(binaryExpr);
-        }
-        else if (auto *assignExpr = dynamic_cast<AssignmentExpressionNode *>(expr))
-        {
-            generateAssignmentExpression(assignExpr);
+        switch (expr->kind())
+        {
+        case NodeKind::VariableExpression:
+            generateVariableExpression(static_cast<VariableExpressionNode *>(expr));
+            break;
+        case NodeKind::CallExpression:
+            generateCallExpression(static_cast<CallExpressionNode *>(expr));
+            break;
+        case NodeKind::MemberAccessExpression:
+            generateMemberAccessExpression(static_cast<MemberAccessExpressionNode *>(expr));
+            break;
+        case NodeKind::IntegerLiteral:
+            generateIntegerLiteral(static_cast<IntegerLiteralNode *>(expr));
+            break;
+        case NodeKind::FloatingPointLiteral:
+            generateFloatingPointLiteral(static_cast<FloatingPointLiteralNode *>(expr));
+            break;
+        case NodeKind::StringLiteral:
+            generateStringLiteral(static_cast<StringLiteralNode *>(expr));
+            break;
+        case NodeKind::BooleanLiteral:
+            generateBooleanLiteral(static_cast<BooleanLiteralNode *>(expr));
+            break;
+        case NodeKind::CharLiteral:
+            generateCharLiteral(static_cast<CharLiteralNode *>(expr));
+            break;
+        case NodeKind::AdditionExpression:
+            generateAdditionExpression(static_cast<AdditionExpressionNode *>(expr));
+            break;
+        case NodeKind::SubtractionExpression:
+            generateSubtractionExpression(static_cast<SubtractionExpressionNode *>(expr));
+            break;
+        case NodeKind::MultiplicationExpression:
+            generateMultiplicationExpression(static_cast<MultiplicationExpressionNode *>(expr));
+            break;
+        case NodeKind::DivisionExpression:
+            generateDivisionExpression(static_cast<DivisionExpressionNode *>(expr));
+            break;
+        case NodeKind::ComparisonExpression:
+            generateComparisonExpression(static_cast<ComparisonExpressionNode *>(expr));
+            break;
+        case NodeKind::EqualityExpression:
+            generateEqualityExpression(static_cast<EqualityExpressionNode *>(expr));
+            break;
+        case NodeKind::OrExpression:
+            generateOrExpression(static_cast<OrExpressionNode *>(expr));
+            break;
+        case NodeKind::AndExpression:
+            generateAndExpression(static_cast<AndExpressionNode *>(expr));
+            break;
+        case NodeKind::BinaryExpression:
+            generateBinaryExpression(static_cast<BinaryExpressionNode *>(expr));
+            break;
+        case NodeKind::AssignmentExpression:
+            generateAssignmentExpression(static_cast<AssignmentExpressionNode *>(expr));
+            break;
+        default:
+            // Add any other expression types you might have
+            break;
         }
-        // Add any other expression types you might have
     }
 
     void generateType(TypeNode *node)
@@ -368,35 +290,11 @@ private:
         for (const auto &statement : node->statements)
         {
             outputIndent();
-            if (auto *varDeclNode = dynamic_cast<VariableDeclarationNode *>(statement.get()))
-            {
-                generateVariableDeclaration(varDeclNode);
-            }
-            else if (auto *returnNode = dynamic_cast<ReturnStatementNode *>(statement.get()))
-            {
-                generateReturnStatement(returnNode);
-            }
-            else if (auto *ifNode = dynamic_cast<IfStatementNode *>(statement.get()))
-            {
-                generateIfStatement(ifNode);
-            }
-            else if (auto *forNode = dynamic_cast<ForStatementNode *>(statement.get()))
+            if (!statement)
             {
-                generateForStatement(forNode);
+                continue; // A declaration the parser couldn't use as a statement
             }
-            else if (auto *whileNode = dynamic_cast<WhileStatementNode *>(statement.get()))
-            {
-                generateWhileStatement(whileNode);
-            }
-            else if (auto *consoleLogNode = dynamic_cast<ConsoleLogNode *>(statement.get()))
-            {
-                generateConsoleLog(consoleLogNode);
-            }
-            else if (auto *exprStmtNode = dynamic_cast<ExpressionStatementNode *>(statement.get()))
-            {
-                generateExpressionStatement(exprStmtNode);
-            }
-            // Add more statement types as needed
+            generateStatement(statement.get());
         }
 
         indentLevel--;
@@ -404,6 +302,46 @@ private:
         output << "}";
     }
 
+    void generateStatement(ASTNode *statement)
+    {
+        switch (statement->kind())
+        {
+        case NodeKind::VariableDeclaration:
+            generateVariableDeclaration(static_cast<VariableDeclarationNode *>(statement));
+            break;
+        case NodeKind::ReturnStatement:
+            generateReturnStatement(static_cast<ReturnStatementNode *>(statement));
+            break;
+        case NodeKind::IfStatement:
+            generateIfStatement(static_cast<IfStatementNode *>(statement));
+            break;
+        case NodeKind::ForStatement:
+            generateForStatement(static_cast<ForStatementNode *>(statement));
+            break;
+        case NodeKind::WhileStatement:
+            generateWhileStatement(static_cast<WhileStatementNode *>(statement));
+            break;
+        case NodeKind::SwitchStatement:
+            generateSwitchStatement(static_cast<SwitchStatementNode *>(statement));
+            break;
+        case NodeKind::BreakStatement:
+            output << "break;\n";
+            break;
+        case NodeKind::ContinueStatement:
+            output << "continue;\n";
+            break;
+        case NodeKind::ConsoleLog:
+            generateConsoleLog(static_cast<ConsoleLogNode *>(statement));
+            break;
+        case NodeKind::ExpressionStatement:
+            generateExpressionStatement(static_cast<ExpressionStatementNode *>(statement));
+            break;
+        default:
+            break;
+        }
+        // Add more statement types as needed
+    }
+
     void generateFunction(FunctionNode *node)
     {
         // Track the return type for this function
@@ -487,9 +425,17 @@ private:
         for (const auto &member : node->members)
         {
             outputIndent();
-            if (auto *functionNode = dynamic_cast<FunctionNode *>(member.get()))
+            if (!member)
+            {
+                continue;
+            }
+            switch (member->kind())
+            {
+            case NodeKind::Function:
+            case NodeKind::AsyncFunction:
             {
                 // For methods, we need to prefix with the class name
+                auto *functionNode = static_cast<FunctionNode *>(member.get());
                 std::string returnType = functionNode->returnType.empty() ? "void" : functionNode->returnType;
                 output << returnType << " " << functionNode->name << "(";
 
@@ -514,10 +460,12 @@ private:
                 }
 
                 output << "\n";
+                break;
             }
-            else if (auto *constructorNode = dynamic_cast<ConstructorNode *>(member.get()))
+            case NodeKind::Constructor:
             {
                 // For constructors
+                auto *constructorNode = static_cast<ConstructorNode *>(member.get());
                 output << node->name << "(";
 
                 for (size_t i = 0; i < constructorNode->parameters.size(); ++i)
@@ -541,12 +489,15 @@ private:
                 }
 
                 output << "\n";
+                break;
             }
-            else if (auto *propertyNode = dynamic_cast<PropertyDeclarationNode *>(member.get()))
-            {
-                generatePropertyDeclaration(propertyNode);
+            case NodeKind::PropertyDeclaration:
+                generatePropertyDeclaration(static_cast<PropertyDeclarationNode *>(member.get()));
+                break;
+            default:
+                // Add more member types as needed
+                break;
             }
-            // Add more member types as needed
         }
 
         indentLevel--;
@@ -569,7 +520,7 @@ private:
             if (node->initializer)
             {
                 output << " = ";
-                generateExpressionHelper(node->initializer.get());
+                generateExpression(node->initializer.get());
             }
             output << ";\n";
             return;
@@ -598,16 +549,16 @@ private:
         {
             output << " = ";
 
-            if (auto *callExpr = dynamic_cast<CallExpressionNode *>(node->initializer.get()))
+            if (auto *callExpr = nodeCast<CallExpressionNode>(node->initializer.get()))
             {
-                if (auto *calleeVar = dynamic_cast<VariableExpressionNode *>(callExpr->callee.get()))
+                if (auto *calleeVar = nodeCast<VariableExpressionNode>(callExpr->callee.get()))
                 {
                     if (calleeVar->name == node->typeName)
                     {
                         output << node->typeName << "(";
                         for (size_t i = 0; i < callExpr->arguments.size(); ++i)
                         {
-                            generateExpressionHelper(callExpr->arguments[i].get());
+                            generateExpression(callExpr->arguments[i].get());
                             if (i < callExpr->arguments.size() - 1)
                             {
                                 output << ", ";
@@ -627,7 +578,7 @@ private:
             }
             else
             {
-                generateExpressionHelper(node->initializer.get());
+                generateExpression(node->initializer.get());
             }
         }
 
@@ -636,16 +587,16 @@ private:
 
     void generatePrintExpression(ExpressionNode *expr)
     {
-        if (auto *addExpr = dynamic_cast<AdditionExpressionNode *>(expr))
+        if (auto *addExpr = nodeCast<AdditionExpressionNode>(expr))
         {
             // Check if the left side is a string literal
-            bool hasStringLiteral = dynamic_cast<StringLiteralNode *>(addExpr->left.get()) != nullptr;
+            bool hasStringLiteral = nodeCast<StringLiteralNode>(addExpr->left.get()) != nullptr;
 
             // Check if right side is a boolean-returning function call
             bool rightIsBooleanCall = false;
-            if (auto *callExpr = dynamic_cast<CallExpressionNode *>(addExpr->right.get()))
+            if (auto *callExpr = nodeCast<CallExpressionNode>(addExpr->right.get()))
             {
-                if (auto *varExpr = dynamic_cast<VariableExpressionNode *>(callExpr->callee.get()))
+                if (auto *varExpr = nodeCast<VariableExpressionNode>(callExpr->callee.get()))
                 {
                     rightIsBooleanCall = isBooleanReturningFunction(varExpr->name);
                 }
@@ -654,329 +605,63 @@ private:
             if (hasStringLiteral || rightIsBooleanCall)
             {
                 // Handle string concatenation - convert + to <<
-                generateExpressionHelper(addExpr->left.get());
+                generateExpression(addExpr->left.get());
                 output << " << ";
 
                 if (rightIsBooleanCall)
                 {
                     // Convert boolean result to string
                     output << "(";
-                    generateExpressionHelper(addExpr->right.get());
+                    generateExpression(addExpr->right.get());
                     output << " ? \"true\" : \"false\")";
                 }
                 else
                 {
-                    generateExpressionHelper(addExpr->right.get());
+                    generateExpression(addExpr->right.get());
                 }
             }
             else
             {
                 // Handle mathematical addition - keep the +
-                generateExpressionHelper(addExpr->left.get());
+                generateExpression(addExpr->left.get());
                 output << " + ";
-                generateExpressionHelper(addExpr->right.get());
+                generateExpression(addExpr->right.get());
             }
         }
         else
         {
-            generateExpressionHelper(expr);
+            generateExpression(expr);
         }
     }
 
     void generateAdditionExpression(AdditionExpressionNode *node)
     {
-        // Generate left operand
-        if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(node->left.get()))
-        {
-            generateVariableExpression(varExprNode);
-        }
-        else if (auto *intLiteralNode = dynamic_cast<IntegerLiteralNode *>(node->left.get()))
-        {
-            generateIntegerLiteral(intLiteralNode);
-        }
-        else if (auto *floatLiteralNode = dynamic_cast<FloatingPointLiteralNode *>(node->left.get()))
-        {
-            generateFloatingPointLiteral(floatLiteralNode);
-        }
-        else if (auto *stringLiteralNode = dynamic_cast<StringLiteralNode *>(node->left.get()))
-        {
-            generateStringLiteral(stringLiteralNode);
-        }
-        else if (auto *addExprNode = dynamic_cast<AdditionExpressionNode *>(node->left.get()))
-        {
-            generateAdditionExpression(addExprNode);
-        }
-        else if (auto *subExprNode = dynamic_cast<SubtractionExpressionNode *>(node->left.get()))
-        {
-            generateSubtractionExpression(subExprNode);
-        }
-        else if (auto *mulExprNode = dynamic_cast<MultiplicationExpressionNode *>(node->left.get()))
-        {
-            generateMultiplicationExpression(mulExprNode);
-        }
-        else if (auto *leftDivExpr = dynamic_cast<DivisionExpressionNode *>(node->left.get()))
-        {
-            generateDivisionExpression(leftDivExpr);
-        }
-        else if (auto *callExprNode = dynamic_cast<CallExpressionNode *>(node->left.get()))
-        {
-            generateCallExpression(callExprNode);
-        }
-
-        // Generate operator
+        generateExpression(node->left.get());
         output << " + ";
-
-        // Generate right operand
-        if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(node->right.get()))
-        {
-            generateVariableExpression(varExprNode);
-        }
-        else if (auto *intLiteralNode = dynamic_cast<IntegerLiteralNode *>(node->right.get()))
-        {
-            generateIntegerLiteral(intLiteralNode);
-        }
-        else if (auto *floatLiteralNode = dynamic_cast<FloatingPointLiteralNode *>(node->right.get()))
-        {
-            generateFloatingPointLiteral(floatLiteralNode);
-        }
-        else if (auto *stringLiteralNode = dynamic_cast<StringLiteralNode *>(node->right.get()))
-        {
-            generateStringLiteral(stringLiteralNode);
-        }
-        else if (auto *addExprNode = dynamic_cast<AdditionExpressionNode *>(node->right.get()))
-        {
-            generateAdditionExpression(addExprNode);
-        }
-        else if (auto *subExprNode = dynamic_cast<SubtractionExpressionNode *>(node->right.get()))
-        {
-            generateSubtractionExpression(subExprNode);
-        }
-        else if (auto *mulExprNode = dynamic_cast<MultiplicationExpressionNode *>(node->right.get()))
-        {
-            generateMultiplicationExpression(mulExprNode);
-        }
-        else if (auto *rightDivExpr = dynamic_cast<DivisionExpressionNode *>(node->right.get()))
-        {
-            generateDivisionExpression(rightDivExpr);
-        }
-        else if (auto *callExprNode = dynamic_cast<CallExpressionNode *>(node->right.get()))
-        {
-            generateCallExpression(callExprNode);
-        }
+        generateExpression(node->right.get());
     }
 
     void generateSubtractionExpression(SubtractionExpressionNode *node)
     {
-        // Generate left operand
-        if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(node->left.get()))
-        {
-            generateVariableExpression(varExprNode);
-        }
-        else if (auto *intLiteralNode = dynamic_cast<IntegerLiteralNode *>(node->left.get()))
-        {
-            generateIntegerLiteral(intLiteralNode);
-        }
-        else if (auto *floatLiteralNode = dynamic_cast<FloatingPointLiteralNode *>(node->left.get()))
-        {
-            generateFloatingPointLiteral(floatLiteralNode);
-        }
-        else if (auto *addExprNode = dynamic_cast<AdditionExpressionNode *>(node->left.get()))
-        {
-            generateAdditionExpression(addExprNode);
-        }
-        else if (auto *subExprNode = dynamic_cast<SubtractionExpressionNode *>(node->left.get()))
-        {
-            generateSubtractionExpression(subExprNode);
-        }
-        else if (auto *mulExprNode = dynamic_cast<MultiplicationExpressionNode *>(node->left.get()))
-        {
-            generateMultiplicationExpression(mulExprNode);
-        }
-        else if (auto *divExprNode = dynamic_cast<DivisionExpressionNode *>(node->left.get()))
-        {
-            generateDivisionExpression(divExprNode);
-        }
-
-        // Generate operator
+        generateExpression(node->left.get());
         output << " - ";
-
-        // Generate right operand
-        if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(node->right.get()))
-        {
-            generateVariableExpression(varExprNode);
-        }
-        else if (auto *intLiteralNode = dynamic_cast<IntegerLiteralNode *>(node->right.get()))
-        {
-            generateIntegerLiteral(intLiteralNode);
-        }
-        else if (auto *floatLiteralNode = dynamic_cast<FloatingPointLiteralNode *>(node->right.get()))
-        {
-            generateFloatingPointLiteral(floatLiteralNode);
-        }
-        else if (auto *addExprNode = dynamic_cast<AdditionExpressionNode *>(node->right.get()))
-        {
-            generateAdditionExpression(addExprNode);
-        }
-        else if (auto *subExprNode = dynamic_cast<SubtractionExpressionNode *>(node->right.get()))
-        {
-            generateSubtractionExpression(subExprNode);
-        }
-        else if (auto *mulExprNode = dynamic_cast<MultiplicationExpressionNode *>(node->right.get()))
-        {
-            generateMultiplicationExpression(mulExprNode);
-        }
-        else if (auto *divExprNode = dynamic_cast<DivisionExpressionNode *>(node->right.get()))
-        {
-            generateDivisionExpression(divExprNode);
-        }
+        generateExpression(node->right.get());
     }
 
     void generateMultiplicationExpression(MultiplicationExpressionNode *node)
     {
-        DEBUG_LOG("Generating multiplication expression");
-
-        // Debug the right operand
-        if (auto *callExprNode = dynamic_cast<CallExpressionNode *>(node->right.get()))
-        {
-            DEBUG_LOG("Right operand is a call expression");
-            if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(callExprNode->callee.get()))
-            {
-                DEBUG_LOG("Callee is: ", varExprNode->name);
-            }
-        }
-
-        // Generate left operand
-        if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(node->left.get()))
-        {
-            generateVariableExpression(varExprNode);
-        }
-        else if (auto *intLiteralNode = dynamic_cast<IntegerLiteralNode *>(node->left.get()))
-        {
-            generateIntegerLiteral(intLiteralNode);
-        }
-        else if (auto *floatLiteralNode = dynamic_cast<FloatingPointLiteralNode *>(node->left.get()))
-        {
-            generateFloatingPointLiteral(floatLiteralNode);
-        }
-        else if (auto *addExprNode = dynamic_cast<AdditionExpressionNode *>(node->left.get()))
-        {
-            generateAdditionExpression(addExprNode);
-        }
-        else if (auto *subExprNode = dynamic_cast<SubtractionExpressionNode *>(node->left.get()))
-        {
-            generateSubtractionExpression(subExprNode);
-        }
-        else if (auto *mulExprNode = dynamic_cast<MultiplicationExpressionNode *>(node->left.get()))
-        {
-            generateMultiplicationExpression(mulExprNode);
-        }
-        else if (auto *divExprNode = dynamic_cast<DivisionExpressionNode *>(node->left.get()))
-        {
-            generateDivisionExpression(divExprNode);
-        }
+        TRACE(Codegen, Debug, "Generating multiplication expression");
 
-        // Generate operator
+        generateExpression(node->left.get());
         output << " * ";
-
-        // Generate right operand
-        if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(node->right.get()))
-        {
-            generateVariableExpression(varExprNode);
-        }
-        else if (auto *intLiteralNode = dynamic_cast<IntegerLiteralNode *>(node->right.get()))
-        {
-            generateIntegerLiteral(intLiteralNode);
-        }
-        else if (auto *floatLiteralNode = dynamic_cast<FloatingPointLiteralNode *>(node->right.get()))
-        {
-            generateFloatingPointLiteral(floatLiteralNode);
-        }
-        else if (auto *addExprNode = dynamic_cast<AdditionExpressionNode *>(node->right.get()))
-        {
-            generateAdditionExpression(addExprNode);
-        }
-        else if (auto *subExprNode = dynamic_cast<SubtractionExpressionNode *>(node->right.get()))
-        {
-            generateSubtractionExpression(subExprNode);
-        }
-        else if (auto *mulExprNode = dynamic_cast<MultiplicationExpressionNode *>(node->right.get()))
-        {
-            generateMultiplicationExpression(mulExprNode);
-        }
-        else if (auto *divExprNode = dynamic_cast<DivisionExpressionNode *>(node->right.get()))
-        {
-            generateDivisionExpression(divExprNode);
-        }
-        else if (auto *callExprNode = dynamic_cast<CallExpressionNode *>(node->right.get()))
-        {
-            generateCallExpression(callExprNode);
-        }
+        generateExpression(node->right.get());
     }
 
     void generateDivisionExpression(DivisionExpressionNode *node)
     {
-        // Generate left operand
-        if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(node->left.get()))
-        {
-            generateVariableExpression(varExprNode);
-        }
-        else if (auto *intLiteralNode = dynamic_cast<IntegerLiteralNode *>(node->left.get()))
-        {
-            generateIntegerLiteral(intLiteralNode);
-        }
-        else if (auto *floatLiteralNode = dynamic_cast<FloatingPointLiteralNode *>(node->left.get()))
-        {
-            generateFloatingPointLiteral(floatLiteralNode);
-        }
-        else if (auto *addExprNode = dynamic_cast<AdditionExpressionNode *>(node->left.get()))
-        {
-            generateAdditionExpression(addExprNode);
-        }
-        else if (auto *subExprNode = dynamic_cast<SubtractionExpressionNode *>(node->left.get()))
-        {
-            generateSubtractionExpression(subExprNode);
-        }
-        else if (auto *mulExprNode = dynamic_cast<MultiplicationExpressionNode *>(node->left.get()))
-        {
-            generateMultiplicationExpression(mulExprNode);
-        }
-        else if (auto *divExprNode = dynamic_cast<DivisionExpressionNode *>(node->left.get()))
-        {
-            generateDivisionExpression(divExprNode);
-        }
-
-        // Generate operator
+        generateExpression(node->left.get());
         output << " / ";
-
-        // Generate right operand
-        if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(node->right.get()))
-        {
-            generateVariableExpression(varExprNode);
-        }
-        else if (auto *intLiteralNode = dynamic_cast<IntegerLiteralNode *>(node->right.get()))
-        {
-            generateIntegerLiteral(intLiteralNode);
-        }
-        else if (auto *floatLiteralNode = dynamic_cast<FloatingPointLiteralNode *>(node->right.get()))
-        {
-            generateFloatingPointLiteral(floatLiteralNode);
-        }
-        else if (auto *addExprNode = dynamic_cast<AdditionExpressionNode *>(node->right.get()))
-        {
-            generateAdditionExpression(addExprNode);
-        }
-        else if (auto *subExprNode = dynamic_cast<SubtractionExpressionNode *>(node->right.get()))
-        {
-            generateSubtractionExpression(subExprNode);
-        }
-        else if (auto *mulExprNode = dynamic_cast<MultiplicationExpressionNode *>(node->right.get()))
-        {
-            generateMultiplicationExpression(mulExprNode);
-        }
-        else if (auto *divExprNode = dynamic_cast<DivisionExpressionNode *>(node->right.get()))
-        {
-            generateDivisionExpression(divExprNode);
-        }
+        generateExpression(node->right.get());
     }
 
     void generateReturnStatement(ReturnStatementNode *node)
@@ -986,326 +671,101 @@ private:
         if (node->expression)
         {
             output << " ";
+            TRACE(Codegen, Debug, "Return expression kind: ", static_cast<int>(node->expression->kind()));
+            generateExpression(node->expression.get());
+        }
+
+        output << ";\n";
+    }
+
+    void generateConsoleLog(ConsoleLogNode *node)
+    {
+        if (!node || !node->expression)
+            return;
 
-            // Debug output
-            if (DEBUG_ENABLED())
+        output << "std::cout << ";
+
+        // Special handling for boolean expressions to convert them to strings
+        ExpressionNode *expr = node->expression.get();
+        switch (expr->kind())
+        {
+        case NodeKind::BooleanLiteral:
+            output << "((" << (static_cast<BooleanLiteralNode *>(expr)->value ? "true" : "false")
+                   << ") ? \"true\" : \"false\")";
+            break;
+        case NodeKind::CallExpression:
+        {
+            // Check if this is a call to a function that returns boolean
+            auto *callExpr = static_cast<CallExpressionNode *>(expr);
+            auto *varExpr = nodeCast<VariableExpressionNode>(callExpr->callee.get());
+            if (varExpr && isBooleanReturningFunction(varExpr->name))
             {
-                DEBUG_LOG("Return expression type: ");
-                if (auto *intLiteralNode = dynamic_cast<IntegerLiteralNode *>(node->expression.get()))
-                {
-                    DEBUG_LOG("IntegerLiteral");
-                }
-                else if (auto *floatLiteralNode = dynamic_cast<FloatingPointLiteralNode *>(node->expression.get()))
-                {
-                    DEBUG_LOG("FloatingPointLiteral");
-                }
-                else if (auto *stringLiteralNode = dynamic_cast<StringLiteralNode *>(node->expression.get()))
-                {
-                    DEBUG_LOG("StringLiteral");
-                }
-                else if (auto *boolLiteralNode = dynamic_cast<BooleanLiteralNode *>(node->expression.get()))
-                {
-                    DEBUG_LOG("BooleanLiteral");
-                }
-                else if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(node->expression.get()))
-                {
-                    DEBUG_LOG("VariableExpression");
-                }
-                else if (auto *callExprNode = dynamic_cast<CallExpressionNode *>(node->expression.get()))
-                {
-                    DEBUG_LOG("CallExpression");
-                }
-                else if (auto *addExprNode = dynamic_cast<AdditionExpressionNode *>(node->expression.get()))
-                {
-                    DEBUG_LOG("AdditionExpression");
-                }
-                else if (auto *subExprNode = dynamic_cast<SubtractionExpressionNode *>(node->expression.get()))
-                {
-                    DEBUG_LOG("SubtractionExpression");
-                }
-                else if (auto *mulExprNode = dynamic_cast<MultiplicationExpressionNode *>(node->expression.get()))
-                {
-                    DEBUG_LOG("MultiplicationExpression");
-                }
-                else if (auto *divExprNode = dynamic_cast<DivisionExpressionNode *>(node->expression.get()))
-                {
-                    DEBUG_LOG("DivisionExpression");
-                }
-                else
-                {
-                    DEBUG_LOG("Unknown");
-                }
-            }
-            if (auto *intLiteralNode = dynamic_cast<IntegerLiteralNode *>(node->expression.get()))
-            {
-                generateIntegerLiteral(intLiteralNode);
-            }
-            else if (auto *floatLiteralNode = dynamic_cast<FloatingPointLiteralNode *>(node->expression.get()))
-            {
-                generateFloatingPointLiteral(floatLiteralNode);
-            }
-            else if (auto *stringLiteralNode = dynamic_cast<StringLiteralNode *>(node->expression.get()))
-            {
-                generateStringLiteral(stringLiteralNode);
-            }
-            else if (auto *boolLiteralNode = dynamic_cast<BooleanLiteralNode *>(node->expression.get()))
-            {
-                generateBooleanLiteral(boolLiteralNode);
-            }
-            else if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(node->expression.get()))
-            {
-                generateVariableExpression(varExprNode);
-            }
-            else if (auto *callExprNode = dynamic_cast<CallExpressionNode *>(node->expression.get()))
-            {
-                generateCallExpression(callExprNode);
-            }
-            else if (auto *addExprNode = dynamic_cast<AdditionExpressionNode *>(node->expression.get()))
-            {
-                generateAdditionExpression(addExprNode);
-            }
-            else if (auto *subExprNode = dynamic_cast<SubtractionExpressionNode *>(node->expression.get()))
-            {
-                generateSubtractionExpression(subExprNode);
-            }
-            else if (auto *mulExprNode = dynamic_cast<MultiplicationExpressionNode *>(node->expression.get()))
-            {
-                generateMultiplicationExpression(mulExprNode);
-            }
-            else if (auto *divExprNode = dynamic_cast<DivisionExpressionNode *>(node->expression.get()))
-            {
-                generateDivisionExpression(divExprNode);
-            }
-            // Add more expression types as needed
-        }
-
-        output << ";\n";
-    }
-
-    // Helper to generate any expression uniformly
-    void generateExpression(ExpressionNode *expr)
-    {
-        if (auto *eqExpr = dynamic_cast<EqualityExpressionNode *>(expr))
-        {
-            generateEqualityExpression(eqExpr);
-        }
-        else if (auto *stringLiteralNode = dynamic_cast<StringLiteralNode *>(expr))
-        {
-            generateStringLiteral(stringLiteralNode);
-        }
-        else if (auto *intLiteralNode = dynamic_cast<IntegerLiteralNode *>(expr))
-        {
-            generateIntegerLiteral(intLiteralNode);
-        }
-        else if (auto *floatLiteralNode = dynamic_cast<FloatingPointLiteralNode *>(expr))
-        {
-            generateFloatingPointLiteral(floatLiteralNode);
-        }
-        else if (auto *boolLiteralNode = dynamic_cast<BooleanLiteralNode *>(expr))
-        {
-            generateBooleanLiteral(boolLiteralNode);
-        }
-        else if (auto *charLiteralNode = dynamic_cast<CharLiteralNode *>(expr))
-        {
-            generateCharLiteral(charLiteralNode);
-        }
-        else if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(expr))
-        {
-            generateVariableExpression(varExprNode);
-        }
-        else if (auto *callExprNode = dynamic_cast<CallExpressionNode *>(expr))
-        {
-            generateCallExpression(callExprNode);
-        }
-        else if (auto *memberAccessNode = dynamic_cast<MemberAccessExpressionNode *>(expr))
-        {
-            generateMemberAccessExpression(memberAccessNode);
-        }
-        else if (auto *addExprNode = dynamic_cast<AdditionExpressionNode *>(expr))
-        {
-            generateAdditionExpression(addExprNode);
-        }
-        else if (auto *subExprNode = dynamic_cast<SubtractionExpressionNode *>(expr))
-        {
-            generateSubtractionExpression(subExprNode);
-        }
-        else if (auto *mulExprNode = dynamic_cast<MultiplicationExpressionNode *>(expr))
-        {
-            generateMultiplicationExpression(mulExprNode);
-        }
-        else if (auto *divExprNode = dynamic_cast<DivisionExpressionNode *>(expr))
-        {
-            generateDivisionExpression(divExprNode);
-        }
-        else if (auto *comparisonNode = dynamic_cast<ComparisonExpressionNode *>(expr))
-        {
-            generateComparisonExpression(comparisonNode);
-        }
-        else if (auto *orExprNode = dynamic_cast<OrExpressionNode *>(expr))
-        {
-            generateOrExpression(orExprNode);
-        }
-        else if (auto *andExprNode = dynamic_cast<AndExpressionNode *>(expr))
-        {
-            generateAndExpression(andExprNode);
-        }
-        else
-        {
-            // Unsupported expression type for console log
-        }
-    }
-
-    void generateConsoleLog(ConsoleLogNode *node)
-    {
-        if (!node || !node->expression)
-            return;
-
-        output << "std::cout << ";
-
-        // Special handling for boolean expressions to convert them to strings
-        if (auto *boolLiteral = dynamic_cast<BooleanLiteralNode *>(node->expression.get()))
-        {
-            output << "((" << (boolLiteral->value ? "true" : "false") << ") ? \"true\" : \"false\")";
-        }
-        else if (auto *callExpr = dynamic_cast<CallExpressionNode *>(node->expression.get()))
-        {
-            // Check if this is a call to a function that returns boolean
-            if (auto *varExpr = dynamic_cast<VariableExpressionNode *>(callExpr->callee.get()))
-            {
-                // Check if this function returns bool
-                if (isBooleanReturningFunction(varExpr->name))
-                {
-                    output << "(";
-                    generateCallExpression(callExpr);
-                    output << " ? \"true\" : \"false\")";
-                }
-                else
-                {
-                    generateCallExpression(callExpr);
-                }
+                output << "(";
+                generateCallExpression(callExpr);
+                output << " ? \"true\" : \"false\")";
             }
             else
             {
                 generateCallExpression(callExpr);
             }
+            break;
         }
-        else if (auto *addExpr = dynamic_cast<AdditionExpressionNode *>(node->expression.get()))
-        {
+        case NodeKind::AdditionExpression:
             // Check if this involves string concatenation with boolean
-            generatePrintExpression(addExpr);
-        }
-        else
-        {
-            generateExpressionHelper(node->expression.get());
+            generatePrintExpression(expr);
+            break;
+        default:
+            generateExpression(expr);
+            break;
         }
 
-        output << " << std::endl;\n";
+        output << " << '\\n';\n";
     }
     void handlePrintAddition(AdditionExpressionNode *node)
     {
         // Handle left operand
-        if (auto *stringLiteralNode = dynamic_cast<StringLiteralNode *>(node->left.get()))
-        {
-            generateStringLiteral(stringLiteralNode);
-        }
-        else if (auto *intLiteralNode = dynamic_cast<IntegerLiteralNode *>(node->left.get()))
-        {
-            generateIntegerLiteral(intLiteralNode);
-        }
-        else if (auto *floatLiteralNode = dynamic_cast<FloatingPointLiteralNode *>(node->left.get()))
-        {
-            generateFloatingPointLiteral(floatLiteralNode);
-        }
-        else if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(node->left.get()))
-        {
-            generateVariableExpression(varExprNode);
-        }
-        else if (auto *callExprNode = dynamic_cast<CallExpressionNode *>(node->left.get()))
-        {
-            generateCallExpression(callExprNode);
-        }
-        else if (auto *memberAccessNode = dynamic_cast<MemberAccessExpressionNode *>(node->left.get()))
-        {
-            generateMemberAccessExpression(memberAccessNode);
-        }
-        else if (auto *boolLiteralNode = dynamic_cast<BooleanLiteralNode *>(node->left.get()))
+        switch (node->left->kind())
         {
+        case NodeKind::BooleanLiteral:
             // For boolean literals, we need to convert them to strings
             output << "(";
-            generateBooleanLiteral(boolLiteralNode);
+            generateExpression(node->left.get());
             output << " ? \"true\" : \"false\")";
             output << " << ";
             return;
-        }
-        else if (auto *addExprNode = dynamic_cast<AdditionExpressionNode *>(node->left.get()))
-        {
-            handlePrintAddition(addExprNode);
+        case NodeKind::AdditionExpression:
+            handlePrintAddition(static_cast<AdditionExpressionNode *>(node->left.get()));
+            break;
+        default:
+            generateExpression(node->left.get());
+            break;
         }
 
         // Insert stream operator instead of + for string concatenation
         output << " << ";
 
         // Handle right operand
-        if (auto *stringLiteralNode = dynamic_cast<StringLiteralNode *>(node->right.get()))
-        {
-            generateStringLiteral(stringLiteralNode);
-        }
-        else if (auto *intLiteralNode = dynamic_cast<IntegerLiteralNode *>(node->right.get()))
-        {
-            generateIntegerLiteral(intLiteralNode);
-        }
-        else if (auto *floatLiteralNode = dynamic_cast<FloatingPointLiteralNode *>(node->right.get()))
-        {
-            generateFloatingPointLiteral(floatLiteralNode);
-        }
-        else if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(node->right.get()))
-        {
-            generateVariableExpression(varExprNode);
-        }
-        else if (auto *callExprNode = dynamic_cast<CallExpressionNode *>(node->right.get()))
-        {
-            generateCallExpression(callExprNode);
-        }
-        else if (auto *memberAccessNode = dynamic_cast<MemberAccessExpressionNode *>(node->right.get()))
-        {
-            generateMemberAccessExpression(memberAccessNode);
-        }
-        else if (auto *boolLiteralNode = dynamic_cast<BooleanLiteralNode *>(node->right.get()))
+        switch (node->right->kind())
         {
+        case NodeKind::BooleanLiteral:
             // For boolean literals, we need to convert them to strings
             output << "(";
-            generateBooleanLiteral(boolLiteralNode);
+            generateExpression(node->right.get());
             output << " ? \"true\" : \"false\")";
-        }
-        else if (auto *addExprNode = dynamic_cast<AdditionExpressionNode *>(node->right.get()))
-        {
-            // For nested addition expressions, handle them recursively
-            output << "(";
-            generateAdditionExpression(addExprNode);
-            output << ")";
-        }
-        else if (auto *subExprNode = dynamic_cast<SubtractionExpressionNode *>(node->right.get()))
-        {
-            // For subtraction expressions, wrap them in parentheses
+            break;
+        case NodeKind::AdditionExpression:
+        case NodeKind::SubtractionExpression:
+        case NodeKind::MultiplicationExpression:
+        case NodeKind::DivisionExpression:
+            // Arithmetic binds looser than <<, so wrap it in parentheses
             output << "(";
-            generateSubtractionExpression(subExprNode);
-            output << ")";
-        }
-        else if (auto *mulExprNode = dynamic_cast<MultiplicationExpressionNode *>(node->right.get()))
-        {
-            // For multiplication expressions, wrap them in parentheses
-            output << "(";
-            generateMultiplicationExpression(mulExprNode);
-            output << ")";
-        }
-        else if (auto *divExprNode = dynamic_cast<DivisionExpressionNode *>(node->right.get()))
-        {
-            // For division expressions, wrap them in parentheses
-            output << "(";
-            generateDivisionExpression(divExprNode);
+            generateExpression(node->right.get());
             output << ")";
+            break;
+        default:
+            generateExpression(node->right.get());
+            break;
         }
-        // Remove the duplicate handling of the right operand
     }
 
     void generateStringLiteral(StringLiteralNode *node)
@@ -1348,12 +808,12 @@ private:
         if (!node || !node->callee)
             return;
 
-        generateExpressionHelper(node->callee.get());
+        generateExpression(node->callee.get());
 
         output << "(";
         for (size_t i = 0; i < node->arguments.size(); ++i)
         {
-            generateExpressionHelper(node->arguments[i].get());
+            generateExpression(node->arguments[i].get());
             if (i < node->arguments.size() - 1)
             {
                 output << ", ";
@@ -1367,43 +827,42 @@ private:
         if (!node || !node->object)
             return;
 
-        generateExpressionHelper(node->object.get());
+        generateExpression(node->object.get());
         output << ".";
         output << node->memberName;
     }
 
     void generateExpressionStatement(ExpressionStatementNode *node)
     {
-        // Skip null expressions (which would generate empty statements)
-        if (auto *nullLiteralNode = dynamic_cast<NullLiteralNode *>(node->expression.get()))
+        ExpressionNode *expr = node->expression.get();
+        switch (expr->kind())
         {
+        case NodeKind::NullLiteral:
+            // Skip null expressions (which would generate empty statements)
             return;
-        }
-
-        if (auto *callExprNode = dynamic_cast<CallExpressionNode *>(node->expression.get()))
+        case NodeKind::CallExpression:
         {
             // Check if this is a class instantiation (constructor call)
-            if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(callExprNode->callee.get()))
+            auto *callExprNode = static_cast<CallExpressionNode *>(expr);
+            auto *varExprNode = nodeCast<VariableExpressionNode>(callExprNode->callee.get());
+            // If the first letter is uppercase, it's likely a class name
+            if (varExprNode && !varExprNode->name.empty() && isupper(varExprNode->name[0]))
             {
-                // If the first letter is uppercase, it's likely a class name
-                if (!varExprNode->name.empty() && isupper(varExprNode->name[0]))
-                {
-                    // This is a class instantiation, so we need to declare a variable
-                    output << varExprNode->name << " ";
-                    // Generate a default variable name based on lowercase class name
-                    std::string varName = varExprNode->name;
-                    if (!varName.empty())
-                    {
-                        varName[0] = tolower(varName[0]);
-                    }
-                    output << varName << " = ";
-                }
+                // This is a class instantiation, so we need to declare a variable
+                output << varExprNode->name << " ";
+                // Generate a default variable name based on lowercase class name
+                std::string varName = varExprNode->name;
+                varName[0] = tolower(varName[0]);
+                output << varName << " = ";
             }
             generateCallExpression(callExprNode);
+            break;
         }
-        else if (auto *assignExprNode = dynamic_cast<AssignmentExpressionNode *>(node->expression.get()))
-        {
-            generateAssignmentExpression(assignExprNode);
+        case NodeKind::AssignmentExpression:
+            generateAssignmentExpression(static_cast<AssignmentExpressionNode *>(expr));
+            break;
+        default:
+            break;
         }
 
         output << ";\n";
@@ -1411,53 +870,9 @@ private:
 
     void generateAssignmentExpression(AssignmentExpressionNode *node)
     {
-        if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(node->left.get()))
-        {
-            generateVariableExpression(varExprNode);
-        }
-        else if (auto *memberAccessNode = dynamic_cast<MemberAccessExpressionNode *>(node->left.get()))
-        {
-            generateMemberAccessExpression(memberAccessNode);
-        }
-
+        generateExpression(node->left.get());
         output << " " << node->op << " ";
-
-        if (auto *intLiteralNode = dynamic_cast<IntegerLiteralNode *>(node->right.get()))
-        {
-            generateIntegerLiteral(intLiteralNode);
-        }
-        else if (auto *floatLiteralNode = dynamic_cast<FloatingPointLiteralNode *>(node->right.get()))
-        {
-            generateFloatingPointLiteral(floatLiteralNode);
-        }
-        else if (auto *stringLiteralNode = dynamic_cast<StringLiteralNode *>(node->right.get()))
-        {
-            generateStringLiteral(stringLiteralNode);
-        }
-        else if (auto *boolLiteralNode = dynamic_cast<BooleanLiteralNode *>(node->right.get()))
-        {
-            generateBooleanLiteral(boolLiteralNode);
-        }
-        else if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(node->right.get()))
-        {
-            generateVariableExpression(varExprNode);
-        }
-        else if (auto *callExprNode = dynamic_cast<CallExpressionNode *>(node->right.get()))
-        {
-            generateCallExpression(callExprNode);
-        }
-        else if (auto *addExprNode = dynamic_cast<AdditionExpressionNode *>(node->right.get()))
-        {
-            generateAdditionExpression(addExprNode);
-        }
-        else if (auto *mulExprNode = dynamic_cast<MultiplicationExpressionNode *>(node->right.get()))
-        {
-            generateMultiplicationExpression(mulExprNode);
-        }
-        else if (auto *binaryExprNode = dynamic_cast<BinaryExpressionNode *>(node->right.get()))
-        {
-            generateBinaryExpression(binaryExprNode);
-        }
+        generateExpression(node->right.get());
     }
 
     void generatePropertyDeclaration(PropertyDeclarationNode *node)
@@ -1475,22 +890,7 @@ private:
         if (node->initializer)
         {
             output << " = ";
-            if (auto *intLiteralNode = dynamic_cast<IntegerLiteralNode *>(node->initializer.get()))
-            {
-                generateIntegerLiteral(intLiteralNode);
-            }
-            else if (auto *floatLiteralNode = dynamic_cast<FloatingPointLiteralNode *>(node->initializer.get()))
-            {
-                generateFloatingPointLiteral(floatLiteralNode);
-            }
-            else if (auto *stringLiteralNode = dynamic_cast<StringLiteralNode *>(node->initializer.get()))
-            {
-                generateStringLiteral(stringLiteralNode);
-            }
-            else if (auto *boolLiteralNode = dynamic_cast<BooleanLiteralNode *>(node->initializer.get()))
-            {
-                generateBooleanLiteral(boolLiteralNode);
-            }
+            generateExpression(node->initializer.get());
         }
 
         output << ";\n";
@@ -1511,9 +911,17 @@ private:
         for (const auto &member : node->members)
         {
             outputIndent();
-            if (auto *functionNode = dynamic_cast<FunctionNode *>(member.get()))
+            if (!member)
+            {
+                continue;
+            }
+            switch (member->kind())
+            {
+            case NodeKind::Function:
+            case NodeKind::AsyncFunction:
             {
                 // For methods, make them pure virtual
+                auto *functionNode = static_cast<FunctionNode *>(member.get());
                 std::string returnType = functionNode->returnType.empty() ? "void" : functionNode->returnType;
                 output << "virtual " << returnType << " " << functionNode->name << "(";
 
@@ -1527,10 +935,12 @@ private:
                 }
 
                 output << ") = 0;\n";
+                break;
             }
-            else if (auto *propertyNode = dynamic_cast<PropertyDeclarationNode *>(member.get()))
+            case NodeKind::PropertyDeclaration:
             {
                 // For properties, add getter and setter methods
+                auto *propertyNode = static_cast<PropertyDeclarationNode *>(member.get());
                 if (propertyNode->type)
                 {
                     generateType(propertyNode->type.get());
@@ -1543,6 +953,10 @@ private:
                     outputIndent();
                     output << "virtual void set" << propertyNode->name << "(" << propType << " value) = 0;\n";
                 }
+                break;
+            }
+            default:
+                break;
             }
         }
 
@@ -1552,117 +966,23 @@ private:
 
     void generateBinaryExpression(BinaryExpressionNode *node)
     {
-        // Generate left operand
-        if (auto *leftVarExpr = dynamic_cast<VariableExpressionNode *>(node->left.get()))
-        {
-            generateVariableExpression(leftVarExpr);
-        }
-        else if (auto *leftIntLiteral = dynamic_cast<IntegerLiteralNode *>(node->left.get()))
-        {
-            generateIntegerLiteral(leftIntLiteral);
-        }
-        else if (auto *leftAddExpr = dynamic_cast<AdditionExpressionNode *>(node->left.get()))
-        {
-            generateAdditionExpression(leftAddExpr);
-        }
-        else if (auto *leftSubExpr = dynamic_cast<SubtractionExpressionNode *>(node->left.get()))
-        {
-            generateSubtractionExpression(leftSubExpr);
-        }
-        else if (auto *leftMulExpr = dynamic_cast<MultiplicationExpressionNode *>(node->left.get()))
-        {
-            generateMultiplicationExpression(leftMulExpr);
-        }
-        else if (auto *leftDivExpr = dynamic_cast<DivisionExpressionNode *>(node->left.get()))
-        {
-            generateDivisionExpression(leftDivExpr);
-        }
-
-        // Output operator
+        generateExpression(node->left.get());
         output << " " << node->op << " ";
-
-        // Generate right operand
-        if (auto *rightVarExpr = dynamic_cast<VariableExpressionNode *>(node->right.get()))
-        {
-            generateVariableExpression(rightVarExpr);
-        }
-        else if (auto *rightIntLiteral = dynamic_cast<IntegerLiteralNode *>(node->right.get()))
-        {
-            generateIntegerLiteral(rightIntLiteral);
-        }
-        else if (auto *rightAddExpr = dynamic_cast<AdditionExpressionNode *>(node->right.get()))
-        {
-            generateAdditionExpression(rightAddExpr);
-        }
-        else if (auto *rightSubExpr = dynamic_cast<SubtractionExpressionNode *>(node->right.get()))
-        {
-            generateSubtractionExpression(rightSubExpr);
-        }
-        else if (auto *rightMulExpr = dynamic_cast<MultiplicationExpressionNode *>(node->right.get()))
-        {
-            generateMultiplicationExpression(rightMulExpr);
-        }
-        else if (auto *rightDivExpr = dynamic_cast<DivisionExpressionNode *>(node->right.get()))
-        {
-            generateDivisionExpression(rightDivExpr);
-        }
+        generateExpression(node->right.get());
     }
 
     void generateOrExpression(OrExpressionNode *node)
     {
-        generateOrExpressionDirect(node);
+        generateExpression(node->left.get());
+        output << " || ";
+        generateExpression(node->right.get());
     }
 
     void generateAndExpression(AndExpressionNode *node)
     {
-        // Generate left operand
-        if (auto *leftEq = dynamic_cast<EqualityExpressionNode *>(node->left.get()))
-        {
-            generateEqualityExpression(leftEq);
-        }
-        else if (auto *leftCompExpr = dynamic_cast<ComparisonExpressionNode *>(node->left.get()))
-        {
-            generateComparisonExpression(leftCompExpr);
-        }
-        else if (auto *leftVarExpr = dynamic_cast<VariableExpressionNode *>(node->left.get()))
-        {
-            generateVariableExpression(leftVarExpr);
-        }
-        else if (auto *leftBinaryExpr = dynamic_cast<BinaryExpressionNode *>(node->left.get()))
-        {
-            generateBinaryExpression(leftBinaryExpr);
-        }
-        else
-        {
-            // Use the generic expression generator for other types
-            generateExpression(node->left.get());
-        }
-
-        // Output operator
+        generateExpression(node->left.get());
         output << " && ";
-
-        // Generate right operand
-        if (auto *rightEq = dynamic_cast<EqualityExpressionNode *>(node->right.get()))
-        {
-            generateEqualityExpression(rightEq);
-        }
-        else if (auto *rightCompExpr = dynamic_cast<ComparisonExpressionNode *>(node->right.get()))
-        {
-            generateComparisonExpression(rightCompExpr);
-        }
-        else if (auto *rightVarExpr = dynamic_cast<VariableExpressionNode *>(node->right.get()))
-        {
-            generateVariableExpression(rightVarExpr);
-        }
-        else if (auto *rightBinaryExpr = dynamic_cast<BinaryExpressionNode *>(node->right.get()))
-        {
-            generateBinaryExpression(rightBinaryExpr);
-        }
-        else
-        {
-            // Use the generic expression generator for other types
-            generateExpression(node->right.get());
-        }
+        generateExpression(node->right.get());
     }
 
     void generateEqualityExpression(EqualityExpressionNode *node)
@@ -1670,62 +990,18 @@ private:
         if (!node)
             return;
 
-        // Handle left side
-        if (auto *leftBinary = dynamic_cast<BinaryExpressionNode *>(node->left.get()))
-        {
-            // Special handling for binary expressions like num % 2
-            generateExpressionHelper(leftBinary->left.get());  // num
-            output << " " << leftBinary->op << " ";            // %
-            generateExpressionHelper(leftBinary->right.get()); // 2
-        }
-        else
-        {
-            generateExpressionHelper(node->left.get());
-        }
+        generateExpression(node->left.get());
 
         // Output equality operator
         output << " " << node->op << " ";
 
         // Handle right side
-        generateExpressionHelper(node->right.get());
+        generateExpression(node->right.get());
     }
 
     void generateComparisonExpression(ComparisonExpressionNode *node)
     {
-        // Generate left operand
-        if (auto *leftVarExpr = dynamic_cast<VariableExpressionNode *>(node->left.get()))
-        {
-            generateVariableExpression(leftVarExpr);
-        }
-        else if (auto *leftIntLiteral = dynamic_cast<IntegerLiteralNode *>(node->left.get()))
-        {
-            generateIntegerLiteral(leftIntLiteral);
-        }
-        else if (auto *leftAddExpr = dynamic_cast<AdditionExpressionNode *>(node->left.get()))
-        {
-            generateAdditionExpression(leftAddExpr);
-        }
-        else if (auto *leftSubExpr = dynamic_cast<SubtractionExpressionNode *>(node->left.get()))
-        {
-            generateSubtractionExpression(leftSubExpr);
-        }
-        else if (auto *leftBinaryExpr = dynamic_cast<BinaryExpressionNode *>(node->left.get()))
-        {
-            generateBinaryExpression(leftBinaryExpr);
-        }
-        else if (auto *leftMulExpr = dynamic_cast<MultiplicationExpressionNode *>(node->left.get()))
-        {
-            generateMultiplicationExpression(leftMulExpr);
-        }
-        else if (auto *leftDivExpr = dynamic_cast<DivisionExpressionNode *>(node->left.get()))
-        {
-            generateDivisionExpression(leftDivExpr);
-        }
-        else
-        {
-            // Use the generic expression generator for other types
-            generateExpression(node->left.get());
-        }
+        generateExpression(node->left.get());
 
         // Output operator
         if (node->op == "<")
@@ -1757,96 +1033,17 @@ private:
             output << " " << node->op << " ";
         }
 
-        // Generate right operand
-        if (auto *rightVarExpr = dynamic_cast<VariableExpressionNode *>(node->right.get()))
-        {
-            generateVariableExpression(rightVarExpr);
-        }
-        else if (auto *rightIntLiteral = dynamic_cast<IntegerLiteralNode *>(node->right.get()))
-        {
-            generateIntegerLiteral(rightIntLiteral);
-        }
-        else if (auto *rightAddExpr = dynamic_cast<AdditionExpressionNode *>(node->right.get()))
-        {
-            generateAdditionExpression(rightAddExpr);
-        }
-        else if (auto *rightSubExpr = dynamic_cast<SubtractionExpressionNode *>(node->right.get()))
-        {
-            generateSubtractionExpression(rightSubExpr);
-        }
-        else if (auto *rightMulExpr = dynamic_cast<MultiplicationExpressionNode *>(node->right.get()))
-        {
-            generateMultiplicationExpression(rightMulExpr);
-        }
-        else if (auto *rightDivExpr = dynamic_cast<DivisionExpressionNode *>(node->right.get()))
-        {
-            generateDivisionExpression(rightDivExpr);
-        }
-        else
-        {
-            // Use the generic expression generator for other types
-            generateExpression(node->right.get());
-        }
+        generateExpression(node->right.get());
     }
 
     void generateWhileStatement(WhileStatementNode *node)
     {
         output << "while (";
 
-        // Generate condition
-        if (auto *varExprNode = dynamic_cast<VariableExpressionNode *>(node->condition.get()))
-        {
-            generateVariableExpression(varExprNode);
-        }
-        else if (auto *comparisonNode = dynamic_cast<ComparisonExpressionNode *>(node->condition.get()))
-        {
-            generateComparisonExpression(comparisonNode);
-        }
-        else if (auto *eqExprNode = dynamic_cast<EqualityExpressionNode *>(node->condition.get()))
-        {
-            generateEqualityExpression(eqExprNode);
-        }
-        else if (auto *orExprNode = dynamic_cast<OrExpressionNode *>(node->condition.get()))
-        {
-            generateOrExpression(orExprNode);
-        }
-        else if (auto *andExprNode = dynamic_cast<AndExpressionNode *>(node->condition.get()))
-        {
-            generateAndExpression(andExprNode);
-        }
-        else if (auto *binaryExprNode = dynamic_cast<BinaryExpressionNode *>(node->condition.get()))
-        {
-            generateBinaryExpression(binaryExprNode);
-        }
-        else
-        {
-            // Use the generic expression generator for other types
-            generateExpression(node->condition.get());
-        }
-
+        generateExpression(node->condition.get());
         output << ") ";
 
-        // Generate body
-        if (auto *blockStmt = dynamic_cast<BlockStatementNode *>(node->body.get()))
-        {
-            generateBlockStatement(blockStmt);
-        }
-        else if (auto *ifStmt = dynamic_cast<IfStatementNode *>(node->body.get()))
-        {
-            generateIfStatement(ifStmt);
-        }
-        else
-        {
-            output << "{\n";
-            indentLevel++;
-            outputIndent();
-            // Handle other statement types
-            output << "// Non-block statement\n";
-            indentLevel--;
-            outputIndent();
-            output << "}";
-        }
-
+        generateBody(node->body.get());
         output << "\n";
     }
 
@@ -1857,10 +1054,13 @@ private:
         // Generate initializer
         if (node->initializer)
         {
-            if (auto *varDeclNode = dynamic_cast<VariableDeclarationNode *>(node->initializer.get()))
+            switch (node->initializer->kind())
+            {
+            case NodeKind::VariableDeclaration:
             {
                 // For variable declarations, don't include the trailing semicolon and newline
                 // that would normally be added by generateVariableDeclaration
+                auto *varDeclNode = static_cast<VariableDeclarationNode *>(node->initializer.get());
                 if (varDeclNode->isConst)
                 {
                     output << "const ";
@@ -1880,12 +1080,15 @@ private:
                 if (varDeclNode->initializer)
                 {
                     output << " = ";
-                    generateExpressionHelper(varDeclNode->initializer.get());
+                    generateExpression(varDeclNode->initializer.get());
                 }
+                break;
             }
-            else if (auto *exprStmtNode = dynamic_cast<ExpressionStatementNode *>(node->initializer.get()))
-            {
-                generateExpressionHelper(exprStmtNode->expression.get());
+            case NodeKind::ExpressionStatement:
+                generateExpression(static_cast<ExpressionStatementNode *>(node->initializer.get())->expression.get());
+                break;
+            default:
+                break;
             }
         }
 
@@ -1894,7 +1097,7 @@ private:
         // Generate condition
         if (node->condition)
         {
-            generateExpressionHelper(node->condition.get());
+            generateExpression(node->condition.get());
         }
 
         output << "; ";
@@ -1902,43 +1105,197 @@ private:
         // Generate increment
         if (node->increment)
         {
-            generateExpressionHelper(node->increment.get());
+            generateExpression(node->increment.get());
         }
 
         output << ") ";
 
-        // Generate body
-        if (auto *blockStmt = dynamic_cast<BlockStatementNode *>(node->body.get()))
-        {
-            generateBlockStatement(blockStmt);
+        generateBody(node->body.get());
+        output << "\n";
+    }
+
+    // The value of an int or char literal case, `-` applied to an int included
+    static bool integralCase(ExpressionNode *expr, int &value)
+    {
+        switch (expr->kind())
+        {
+        case NodeKind::IntegerLiteral:
+            value = static_cast<IntegerLiteralNode *>(expr)->value;
+            return true;
+        case NodeKind::CharLiteral:
+            value = static_cast<CharLiteralNode *>(expr)->value;
+            return true;
+        case NodeKind::UnaryExpression:
+        {
+            auto *unaryNode = static_cast<UnaryExpressionNode *>(expr);
+            if (unaryNode->op == "-" && unaryNode->operand->kind() == NodeKind::IntegerLiteral)
+            {
+                value = -static_cast<IntegerLiteralNode *>(unaryNode->operand.get())->value;
+                return true;
+            }
+            return false;
+        }
+        default:
+            return false;
         }
-        else if (auto *ifStmt = dynamic_cast<IfStatementNode *>(node->body.get()))
+    }
+
+    // The interpreter starts at the first clause that is a default or has a
+    // matching case, in clause order, and falls through from there. A C++
+    // switch does the same for int and char cases as long as the cases after
+    // the first default, and repeated values, get no label of their own
+    void generateSwitchStatement(SwitchStatementNode *node)
+    {
+        bool integral = true;
+        for (const auto &caseClause : node->cases)
         {
-            generateIfStatement(ifStmt);
+            int value = 0;
+            if (caseClause && caseClause->isDefault)
+            {
+                break;
+            }
+            if (caseClause && caseClause->caseExpression && !integralCase(caseClause->caseExpression.get(), value))
+            {
+                integral = false;
+                break;
+            }
         }
-        else
+
+        if (integral)
         {
-            output << "{\n";
-            indentLevel++;
-            outputIndent();
-            // Handle other statement types in the body
-            if (auto *stmtNode = dynamic_cast<StatementNode *>(node->body.get()))
+            output << "switch (";
+            generateExpression(node->condition.get());
+            output << ") {\n";
+
+            std::set<int> labelled;
+            bool pastDefault = false;
+            for (const auto &caseClause : node->cases)
             {
-                if (auto *returnNode = dynamic_cast<ReturnStatementNode *>(stmtNode))
+                if (!caseClause)
+                {
+                    continue;
+                }
+
+                int value = 0;
+                outputIndent();
+                if (caseClause->isDefault && !pastDefault)
+                {
+                    output << "default: ";
+                    pastDefault = true;
+                }
+                else if (!pastDefault && caseClause->caseExpression &&
+                         integralCase(caseClause->caseExpression.get(), value) && labelled.insert(value).second)
                 {
-                    generateReturnStatement(returnNode);
+                    // Unary expressions have no C++ of their own yet, so a
+                    // negated case is written as its value
+                    output << "case ";
+                    if (caseClause->caseExpression->kind() == NodeKind::UnaryExpression)
+                        output << value;
+                    else
+                        generateExpression(caseClause->caseExpression.get());
+                    output << ": ";
                 }
-                else if (auto *exprStmtNode = dynamic_cast<ExpressionStatementNode *>(stmtNode))
+                else
                 {
-                    generateExpressionStatement(exprStmtNode);
+                    output << "// Only reached by falling through";
+                    output << "\n";
+                    outputIndent();
                 }
+                generateCaseBody(caseClause.get());
             }
-            indentLevel--;
+
             outputIndent();
-            output << "}";
+            output << "}\n";
+            return;
         }
 
-        output << "\n";
+        // Other cases are compared in order; the switch is only there for break
+        int id = switchCounter++;
+        std::string value = "switchValue" + std::to_string(id);
+        std::string matched = "switchMatched" + std::to_string(id);
+        output << "switch (0) {\n";
+        outputIndent();
+        output << "default: {\n";
+        indentLevel++;
+        outputIndent();
+        output << "const auto " << value << " = ";
+        generateExpression(node->condition.get());
+        output << ";\n";
+        outputIndent();
+        output << "bool " << matched << " = false;\n";
+        for (const auto &caseClause : node->cases)
+        {
+            if (!caseClause)
+            {
+                continue;
+            }
+
+            outputIndent();
+            output << "if (" << matched;
+            if (caseClause->isDefault)
+            {
+                output << " || true";
+            }
+            else if (caseClause->caseExpression)
+            {
+                output << " || " << value << " == ";
+                generateExpression(caseClause->caseExpression.get());
+            }
+            output << ") ";
+            generateCaseBody(caseClause.get(), matched);
+        }
+        indentLevel--;
+        outputIndent();
+        output << "}\n";
+        outputIndent();
+        output << "}\n";
+    }
+
+    // A clause's statements in a block of their own, setting matched first
+    // if given
+    void generateCaseBody(CaseClauseNode *node, const std::string &matched = "")
+    {
+        output << "{\n";
+        indentLevel++;
+        if (!matched.empty())
+        {
+            outputIndent();
+            output << matched << " = true;\n";
+        }
+        for (const auto &statement : node->statements)
+        {
+            if (statement)
+            {
+                outputIndent();
+                generateStatement(statement.get());
+            }
+        }
+        indentLevel--;
+        outputIndent();
+        output << "}\n";
+    }
+
+    // The body of a loop or a branch of an if: a block as it is, any other
+    // statement in a block of its own
+    void generateBody(ASTNode *body)
+    {
+        if (!body)
+        {
+            output << " {}";
+            return;
+        }
+        if (body->kind() == NodeKind::BlockStatement)
+        {
+            generateBlockStatement(static_cast<BlockStatementNode *>(body));
+            return;
+        }
+        output << " {\n";
+        indentLevel++;
+        outputIndent();
+        generateStatement(body);
+        indentLevel--;
+        outputIndent();
+        output << "}";
     }
 
     void generateIfStatement(IfStatementNode *node)
@@ -1948,7 +1305,7 @@ private:
         // Handle the condition
         if (node->condition)
         {
-            generateExpressionHelper(node->condition.get());
+            generateExpression(node->condition.get());
         }
         else
         {
@@ -1961,29 +1318,7 @@ private:
         // Generate then block
         if (node->thenBranch)
         {
-            if (auto *blockNode = dynamic_cast<BlockStatementNode *>(node->thenBranch.get()))
-            {
-                generateBlockStatement(blockNode);
-            }
-            else
-            {
-                output << " {\n";
-                indentLevel++;
-                outputIndent();
-
-                if (auto *returnNode = dynamic_cast<ReturnStatementNode *>(node->thenBranch.get()))
-                {
-                    generateReturnStatement(returnNode);
-                }
-                else if (auto *exprStmtNode = dynamic_cast<ExpressionStatementNode *>(node->thenBranch.get()))
-                {
-                    generateExpressionStatement(exprStmtNode);
-                }
-
-                indentLevel--;
-                outputIndent();
-                output << "}";
-            }
+            generateBody(node->thenBranch.get());
         }
 
         // Generate else block if present
@@ -1991,33 +1326,14 @@ private:
         {
             output << " else";
 
-            if (auto *blockNode = dynamic_cast<BlockStatementNode *>(node->elseBranch.get()))
-            {
-                generateBlockStatement(blockNode);
-            }
-            else if (auto *ifNode = dynamic_cast<IfStatementNode *>(node->elseBranch.get()))
+            if (node->elseBranch->kind() == NodeKind::IfStatement)
             {
                 output << " ";
-                generateIfStatement(ifNode);
+                generateIfStatement(static_cast<IfStatementNode *>(node->elseBranch.get()));
             }
             else
             {
-                output << " {\n";
-                indentLevel++;
-                outputIndent();
-
-                if (auto *returnNode = dynamic_cast<ReturnStatementNode *>(node->elseBranch.get()))
-                {
-                    generateReturnStatement(returnNode);
-                }
-                else if (auto *exprStmtNode = dynamic_cast<ExpressionStatementNode *>(node->elseBranch.get()))
-                {
-                    generateExpressionStatement(exprStmtNode);
-                }
-
-                indentLevel--;
-                outputIndent();
-                output << "}";
+                generateBody(node->elseBranch.get());
             }
         }
 
@@ -1,5 +1,66 @@
 // debug.cpp - Implementation file for the Debug class
 #include "debug.h"
+#include <sstream>
 
-// Define the static member
-bool Debug::enabled = false;
\ No newline at end of file
+// Define the static members
+TraceLevel Debug::levels[static_cast<unsigned>(TraceCategory::Count)] = {};
+std::ostream *Debug::sink = &std::cerr;
+
+const char *Debug::categoryName(TraceCategory category)
+{
+    switch (category)
+    {
+    case TraceCategory::Driver:
+        return "driver";
+    case TraceCategory::Tokenizer:
+        return "tokenizer";
+    case TraceCategory::Parser:
+        return "parser";
+    case TraceCategory::Codegen:
+        return "codegen";
+    case TraceCategory::Interpreter:
+        return "interpreter";
+    case TraceCategory::Module:
+        return "module";
+    default:
+        return "unknown";
+    }
+}
+
+bool Debug::enable(const std::string &categories, TraceLevel level)
+{
+    std::stringstream stream(categories);
+    std::string name;
+    while (std::getline(stream, name, ','))
+    {
+        bool found = false;
+        for (unsigned i = 0; i < static_cast<unsigned>(TraceCategory::Count); i++)
+        {
+            if (name == "all" || name == categoryName(static_cast<TraceCategory>(i)))
+            {
+                levels[i] = level;
+                found = true;
+            }
+        }
+        if (!found)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Debug::parseLevel(const std::string &name, TraceLevel &level)
+{
+    if (name == "off")
+        level = TraceLevel::Off;
+    else if (name == "info")
+        level = TraceLevel::Info;
+    else if (name == "debug")
+        level = TraceLevel::Debug;
+    else if (name == "verbose")
+        level = TraceLevel::Verbose;
+    else
+        return false;
+    return true;
+}
@@ -2,43 +2,119 @@
 #pragma once
 
 #include <iostream>
+#include <string>
+
+// Subsystems that can be traced independently
+enum class TraceCategory : unsigned
+{
+    Driver,
+    Tokenizer,
+    Parser,
+    Codegen,
+    Interpreter,
+    Module,
+    Count
+};
+
+// Verbosity of a trace message. Verbose is meant for messages on hot paths,
+// such as every token the parser checks or every variable read
+enum class TraceLevel : int
+{
+    Off = 0,
+    Info = 1,
+    Debug = 2,
+    Verbose = 3
+};
+
+// Messages above this level are compiled out entirely, e.g. build with
+// -DEDU_MAX_TRACE_LEVEL=0 to remove all tracing from a release binary
+#ifndef EDU_MAX_TRACE_LEVEL
+#define EDU_MAX_TRACE_LEVEL 3
+#endif
 
 class Debug
 {
 private:
-    static bool enabled;
+    static TraceLevel levels[static_cast<unsigned>(TraceCategory::Count)];
+    static std::ostream *sink;
 
 public:
+    // Enables every category at the Debug level, which is what --debug does
     static void setEnabled(bool enable)
     {
-        enabled = enable;
+        for (auto &level : levels)
+        {
+            level = enable ? TraceLevel::Debug : TraceLevel::Off;
+        }
     }
 
     static bool isEnabled()
     {
-        return enabled;
+        for (auto level : levels)
+        {
+            if (level != TraceLevel::Off)
+            {
+                return true;
+            }
+        }
+        return false;
     }
 
-    template <typename T>
-    static void log(const T &message)
+    static bool isEnabled(TraceCategory category, TraceLevel level)
     {
-        if (enabled)
-        {
-            std::cout << message << std::endl;
-        }
+        return level <= levels[static_cast<unsigned>(category)];
     }
 
-    template <typename T, typename... Args>
-    static void log(const T &first, const Args &...args)
+    static void setLevel(TraceCategory category, TraceLevel level)
     {
-        if (enabled)
-        {
-            std::cout << first;
-            log(args...);
-        }
+        levels[static_cast<unsigned>(category)] = level;
+    }
+
+    // Enables a comma separated list of category names ("parser,module" or
+    // "all") at the given level. Returns false on an unknown name
+    static bool enable(const std::string &categories, TraceLevel level);
+
+    static bool parseLevel(const std::string &name, TraceLevel &level);
+
+    static const char *categoryName(TraceCategory category);
+
+    // Trace output goes to stderr unless redirected, so it never interleaves
+    // with the program's own output on stdout
+    static void setSink(std::ostream &stream)
+    {
+        sink = &stream;
+    }
+
+    static std::ostream &getSink()
+    {
+        return *sink;
+    }
+
+    template <typename... Args>
+    static void log(TraceCategory category, const Args &...args)
+    {
+        std::ostream &out = *sink;
+        out << '[' << categoryName(category) << "] ";
+        (out << ... << args);
+        out << '\n';
     }
 };
 
-// Macro for easier debug logging
-#define DEBUG_LOG(...) Debug::log(__VA_ARGS__)
-#define DEBUG_ENABLED() Debug::isEnabled()
+// Writes a trace message if the category is enabled at the given level. The
+// arguments are only evaluated when it is, and levels above
+// EDU_MAX_TRACE_LEVEL are removed at compile time
+#define TRACE(category, level, ...)                                                            \
+    do                                                                                         \
+    {                                                                                          \
+        if constexpr (static_cast<int>(TraceLevel::level) <= EDU_MAX_TRACE_LEVEL)              \
+        {                                                                                      \
+            if (Debug::isEnabled(TraceCategory::category, TraceLevel::level))                  \
+            {                                                                                  \
+                Debug::log(TraceCategory::category, __VA_ARGS__);                              \
+            }                                                                                  \
+        }                                                                                      \
+    } while (0)
+
+#define TRACE_ENABLED(category, level)                                  \
+    (static_cast<int>(TraceLevel::level) <= EDU_MAX_TRACE_LEVEL &&      \
+     Debug::isEnabled(TraceCategory::category, TraceLevel::level))
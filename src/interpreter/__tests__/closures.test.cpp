@@ -0,0 +1,122 @@
+#include "../interpreter.h"
+#include "../../parser/parser.h"
+#include <gtest/gtest.h>
+
+// Fixture for closure compilation tests: every program has to print the same
+// with closures as on the AST walker
+class ClosureTest : public ::testing::Test
+{
+protected:
+  std::string run(const std::string &source, bool closures)
+  {
+    Tokenizer tokenizer(source);
+    Parser parser(tokenizer);
+    auto program = parser.parse();
+
+    Interpreter interpreter;
+    interpreter.setBytecodeEnabled(false);
+    interpreter.setClosuresEnabled(closures);
+    testing::internal::CaptureStdout();
+    interpreter.interpret(program.get());
+    return testing::internal::GetCapturedStdout();
+  }
+
+  void expectSameOutput(const std::string &source, const std::string &expected)
+  {
+    EXPECT_EQ(run(source, false), expected);
+    EXPECT_EQ(run(source, true), expected);
+  }
+};
+
+TEST_F(ClosureTest, RunsOperatorsAndControlFlow)
+{
+  expectSameOutput(R"(int function collatz(int n) {
+    int steps = 0;
+    while (n != 1) {
+        if (n % 2 == 0) {
+            n = n / 2;
+        } else {
+            n = 3 * n + 1;
+        }
+        steps++;
+    }
+    return steps;
+}
+int total = 0;
+for (int i = 1; i < 10; i++) {
+    if (i == 4) {
+        continue;
+    }
+    if (i > 7 || i < 0) {
+        break;
+    }
+    total += collatz(i);
+}
+print(total);
+print(-total);
+print(!(total >= 20) && true);
+print("total: " + total);
+float half = 1.0 / 4;
+print(half - 0.5);
+)",
+                   "37\n-37\nfalse\ntotal: 37\n-0.25\n");
+}
+
+TEST_F(ClosureTest, RunsRecursionAndScopes)
+{
+  expectSameOutput(R"(int function fib(int n) {
+    if (n < 2) {
+        return n;
+    }
+    return fib(n - 1) + fib(n - 2);
+}
+int x = 1;
+{
+    int x = 2;
+    print(x);
+}
+print(x);
+print(fib(15));
+)",
+                   "2\n1\n610\n");
+}
+
+TEST_F(ClosureTest, RunsClassesAndMethods)
+{
+  expectSameOutput(R"(class Counter {
+    int count;
+    int function add(int n) {
+        count = count + n;
+        return count;
+    }
+}
+Counter c = Counter(0);
+for (int i = 0; i < 4; i++) {
+    c.add(i);
+}
+print(c.count);
+print(c.add(10));
+)",
+                   "6\n16\n");
+}
+
+TEST_F(ClosureTest, ReportsTheSameErrors)
+{
+  const std::string source = "int function f(int a) {\n    return a % 0;\n}\nprint(f(1));\n";
+  for (bool closures : {false, true})
+  {
+    try
+    {
+      testing::internal::CaptureStderr();
+      run(source, closures);
+      testing::internal::GetCapturedStderr();
+      FAIL() << "Expected a runtime error";
+    }
+    catch (const std::runtime_error &e)
+    {
+      testing::internal::GetCapturedStdout();
+      testing::internal::GetCapturedStderr();
+      EXPECT_STREQ(e.what(), "Modulo by zero");
+    }
+  }
+}
@@ -0,0 +1,53 @@
+#include "../interpreter.h"
+#include <gtest/gtest.h>
+
+// Fixture for FramePool tests
+class FramePoolTest : public ::testing::Test
+{
+protected:
+  FramePool pool;
+  std::shared_ptr<Environment> globals = std::make_shared<Environment>();
+};
+
+TEST_F(FramePoolTest, ReleasedFramesAreReusedEmpty)
+{
+  auto frame = pool.acquire(globals, 2);
+  Environment *address = frame.get();
+  frame->defineAt(1, Value(42));
+  frame->define("local", Value(7));
+  pool.release(std::move(frame));
+
+  auto reused = pool.acquire(globals, 3);
+  ASSERT_EQ(reused.get(), address) << "The released frame should come back";
+  ASSERT_TRUE(reused->getAt(0, 1, "unused").isNull()) << "Slots start out null again";
+  ASSERT_FALSE(reused->contains("local")) << "Names defined in the old scope are gone";
+  reused->defineAt(2, Value(1));
+}
+
+TEST_F(FramePoolTest, CapturedFramesStayWithTheirOwner)
+{
+  auto frame = pool.acquire(globals, 1);
+  Environment *address = frame.get();
+  auto closure = frame; // e.g. a function declared in the scope
+
+  pool.release(std::move(frame));
+  auto next = pool.acquire(globals, 1);
+  ASSERT_NE(next.get(), address) << "A frame something still refers to can't be reused";
+  ASSERT_EQ(closure.use_count(), 1);
+}
+
+TEST_F(FramePoolTest, LeaseReleasesOnScopeExit)
+{
+  Environment *address = nullptr;
+  try
+  {
+    FramePool::Lease lease(pool);
+    lease.frame = pool.acquire(globals, 0);
+    address = lease.frame.get();
+    throw std::runtime_error("unwind");
+  }
+  catch (const std::runtime_error &)
+  {
+  }
+  ASSERT_EQ(pool.acquire(globals, 0).get(), address);
+}
@@ -0,0 +1,74 @@
+#include "../interpreter.h"
+#include "../../parser/parser.h"
+#include <sstream>
+#include <gtest/gtest.h>
+
+// Fixture for inline cache tests
+class InlineCacheTest : public ::testing::Test
+{
+protected:
+  std::string run(const std::string &source)
+  {
+    Tokenizer tokenizer(source);
+    const auto &tokens = tokenizer.tokenize();
+    Parser parser(tokens);
+    program = parser.parse();
+
+    interpreter.setInlineCacheStatsEnabled(true);
+    testing::internal::CaptureStdout();
+    interpreter.interpret(program.get());
+    testing::internal::GetCapturedStdout();
+
+    std::ostringstream stats;
+    interpreter.printInlineCacheStats(stats);
+    return stats.str();
+  }
+
+  Interpreter interpreter;
+  std::unique_ptr<ProgramNode> program;
+};
+
+TEST_F(InlineCacheTest, MonomorphicSitesHitAfterTheFirstLookup)
+{
+  std::string stats = run(R"(
+class Vec {
+    int x;
+    int function sum() {
+        return x + 1;
+    }
+}
+void function main() {
+    for (int i = 0; i < 10; i++) {
+        Vec v = Vec(i);
+        int s = v.sum();
+        int x = v.x;
+        print(s + x);
+    }
+}
+)");
+  EXPECT_NE(stats.find("(3 sites)"), std::string::npos) << stats;
+  EXPECT_NE(stats.find("line 11 call .sum: 9 hits, 1 misses (90%), monomorphic"), std::string::npos) << stats;
+  EXPECT_NE(stats.find("line 5 get this.x: 9 hits, 1 misses (90%), monomorphic"), std::string::npos) << stats;
+  EXPECT_NE(stats.find("line 12 get .x: 9 hits, 1 misses (90%), monomorphic"), std::string::npos) << stats;
+}
+
+TEST_F(InlineCacheTest, SitesGoMegamorphicAfterMaxEntries)
+{
+  std::string stats = run(R"(
+class A { int function id() { return 1; } }
+class B { int function id() { return 2; } }
+class C { int function id() { return 3; } }
+class D { int function id() { return 4; } }
+class E { int function id() { return 5; } }
+int function idOf(o) {
+    return o.id();
+}
+void function main() {
+    print(idOf(A()) + idOf(B()) + idOf(C()) + idOf(D()));
+    print(idOf(A()) + idOf(D()));
+    print(idOf(E()) + idOf(E()));
+}
+)");
+  // A..D fill the cache, then E misses every time
+  EXPECT_NE(stats.find("line 8 call .id: 2 hits, 6 misses (25%), megamorphic"), std::string::npos) << stats;
+}
@@ -0,0 +1,216 @@
+#include "../interpreter.h"
+#include "../compiler.h"
+#include "../jit.h"
+#include "../../parser/parser.h"
+#include <gtest/gtest.h>
+
+// Fixture for JIT tests: native code run directly on a register file, and
+// programs that have to print the same with and without the JIT
+class JitTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    if (!Jit::isSupported())
+    {
+      GTEST_SKIP() << "No JIT for this target";
+    }
+  }
+
+  std::shared_ptr<BytecodeFunction> compileFirstFunction(const std::string &source)
+  {
+    Tokenizer tokenizer(source);
+    Parser parser(tokenizer);
+    program = parser.parse();
+    auto function = dynamic_cast<FunctionNode *>(program->children[0].get());
+    return BytecodeCompiler::compile(function);
+  }
+
+  std::string run(const std::string &source, bool jit)
+  {
+    Tokenizer tokenizer(source);
+    Parser parser(tokenizer);
+    auto program = parser.parse();
+
+    Interpreter interpreter;
+    interpreter.setJitEnabled(jit);
+    testing::internal::CaptureStdout();
+    interpreter.interpret(program.get());
+    return testing::internal::GetCapturedStdout();
+  }
+
+  std::unique_ptr<ProgramNode> program;
+};
+
+TEST_F(JitTest, RunsToTheReturn)
+{
+  auto code = compileFirstFunction(R"(int function f(a, b) {
+    int c = a * b + a;
+    if (c > b + b) {
+        c = c % 7 - b;
+    }
+    return c;
+})");
+  ASSERT_NE(code, nullptr);
+  auto native = Jit::compile(*code);
+  ASSERT_NE(native, nullptr);
+
+  std::vector<Value> registers(code->registerCount);
+  registers[0] = Value(3);
+  registers[1] = Value(4);
+  JitExit exit = native->run(registers.data(), 0);
+  ASSERT_FALSE(exit.guardFailed);
+  ASSERT_EQ(code->code[exit.pc].op, OpCode::Return) << "Returns are left to the VM";
+  EXPECT_EQ(registers[code->code[exit.pc].a], Value(-3));
+
+  std::fill(registers.begin(), registers.end(), Value());
+  registers[0] = Value(1.5f);
+  registers[1] = Value(3.0f);
+  exit = native->run(registers.data(), 0);
+  ASSERT_FALSE(exit.guardFailed);
+  ASSERT_EQ(code->code[exit.pc].op, OpCode::Return);
+  EXPECT_EQ(registers[code->code[exit.pc].a], Value(6.0f));
+}
+
+TEST_F(JitTest, ExitsBeforeAFailedGuard)
+{
+  auto code = compileFirstFunction("int function f(a, b) {\n    return a * b;\n}\n");
+  ASSERT_NE(code, nullptr);
+  auto native = Jit::compile(*code);
+  ASSERT_NE(native, nullptr);
+
+  std::vector<Value> registers(code->registerCount);
+  registers[0] = Value(std::string("a"));
+  registers[1] = Value(2);
+  JitExit exit = native->run(registers.data(), 0);
+  ASSERT_TRUE(exit.guardFailed);
+  EXPECT_EQ(code->code[exit.pc].op, OpCode::Multiply);
+  EXPECT_EQ(registers[0], Value(std::string("a"))) << "Nothing was run";
+
+  registers[0] = Value(2);
+  registers[1] = Value(0.5f);
+  exit = native->run(registers.data(), 0);
+  EXPECT_TRUE(exit.guardFailed) << "Mixed int and float operands are left to the VM";
+}
+
+TEST_F(JitTest, MatchesTheVM)
+{
+  const std::string source = R"(bool function isPrime(int n) {
+    if (n < 2) {
+        return false;
+    }
+    for (int i = 2; i * i <= n; i++) {
+        if (n % i == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+float function mix(a, b) {
+    float total = 0.0;
+    for (int i = 0; i < 100; i++) {
+        total = total + a / b;
+        if (!(i < 50) && total >= 3.0) {
+            total = total - b;
+        }
+    }
+    return total;
+}
+int function edges(int big) {
+    int count = 0;
+    if (big <= 16777216) {
+        count++;
+    }
+    if (big == 16777216) {
+        count = count + 10;
+    }
+    if (-big != big * -1) {
+        count = count + 100;
+    }
+    return count - -7 % 3;
+}
+void function main() {
+    int primes = 0;
+    for (int n = 0; n < 2000; n++) {
+        if (isPrime(n)) {
+            primes++;
+        }
+    }
+    print(primes);
+    print(mix(1.5, 0.25));
+    print(mix(3, 2));
+    print(mix(1, 0.5));
+    print(edges(16777217));
+    print(edges(2147483647));
+}
+)";
+  std::string vm = run(source, false);
+  EXPECT_EQ(run(source, true), vm);
+  EXPECT_EQ(vm.substr(0, 4), "303\n");
+}
+
+TEST_F(JitTest, SwitchesMatchTheVM)
+{
+  // Enough cases for the native code to binary search, and values other than
+  // ints that go on to the compare chain
+  const std::string source = R"(int function pick(n) {
+    int r = 0;
+    switch (n) {
+        case 9:
+            r = 1;
+        case 1:
+            r = r + 2;
+            break;
+        case -4:
+            r = 3;
+            break;
+        case 6:
+            r = r + 5;
+            break;
+        case 40000:
+            r = 6;
+            break;
+        case 2:
+            r = 7;
+            break;
+        case 3:
+            r = 8;
+            break;
+        case 9:
+            r = 99;
+            break;
+        default:
+            r = 4;
+    }
+    return r;
+}
+void function main() {
+    int total = 0;
+    for (int i = 0 - 6; i < 60; i++) {
+        total = (total * 3 + pick(i % 12)) % 1000003;
+    }
+    print(total);
+    print(pick(9.0) + pick(40000) + pick(6) + pick("9"));
+}
+)";
+  std::string vm = run(source, false);
+  EXPECT_EQ(run(source, true), vm);
+  EXPECT_EQ(vm, "139097\n18\n");
+}
+
+TEST_F(JitTest, KeepsRunningAfterDeoptimising)
+{
+  const std::string source = R"(int function twice(a) {
+    return a + a;
+}
+void function main() {
+    for (int i = 0; i < 100; i++) {
+        twice(i);
+        twice("x");
+    }
+    print(twice(21));
+    print(twice("ab"));
+}
+)";
+  EXPECT_EQ(run(source, true), "42\nabab\n");
+}
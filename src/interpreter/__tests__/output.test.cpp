@@ -0,0 +1,81 @@
+#include "../output.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <string>
+#include <gtest/gtest.h>
+
+// Fixture for OutputSink tests, writing into a pipe
+class OutputSinkTest : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    ASSERT_EQ(pipe(fds), 0);
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+  }
+
+  void TearDown() override
+  {
+    close(fds[0]);
+    close(fds[1]);
+  }
+
+  // Everything written to the pipe so far
+  std::string written()
+  {
+    std::string text;
+    char chunk[4096];
+    ssize_t count;
+    while ((count = read(fds[0], chunk, sizeof(chunk))) > 0)
+    {
+      text.append(chunk, count);
+    }
+    return text;
+  }
+
+  int fds[2];
+};
+
+TEST_F(OutputSinkTest, FullBufferingWaitsForFlush)
+{
+  OutputSink sink(fds[1]);
+  sink.setFlushPolicy(OutputSink::FlushPolicy::Full);
+  sink.write(std::string_view("answer "));
+  sink.write(-42);
+  sink.endLine();
+  ASSERT_EQ(written(), "") << "Nothing is written before a flush";
+
+  sink.flush();
+  ASSERT_EQ(written(), "answer -42\n");
+}
+
+TEST_F(OutputSinkTest, LineBufferingFlushesEveryLine)
+{
+  OutputSink sink(fds[1]);
+  sink.setFlushPolicy(OutputSink::FlushPolicy::Line);
+  sink.write(std::string_view("partial"));
+  ASSERT_EQ(written(), "");
+  sink.endLine();
+  ASSERT_EQ(written(), "partial\n");
+}
+
+TEST_F(OutputSinkTest, AutoIsFullyBufferedOnAPipe)
+{
+  OutputSink sink(fds[1]);
+  ASSERT_FALSE(sink.isLineBuffered());
+}
+
+TEST_F(OutputSinkTest, FullBufferIsWrittenInOrder)
+{
+  {
+    OutputSink sink(fds[1], 8);
+    sink.setFlushPolicy(OutputSink::FlushPolicy::Full);
+    sink.write(std::string_view("12345"));
+    sink.write(std::string_view("6789"));
+    ASSERT_EQ(written(), "12345") << "The first write went out to make room";
+    sink.write(std::string_view("a longer line than the buffer"));
+    ASSERT_EQ(written(), "6789a longer line than the buffer");
+    sink.write('!');
+  }
+  ASSERT_EQ(written(), "!") << "The destructor flushes";
+}
@@ -0,0 +1,221 @@
+#include "../interpreter.h"
+#include "../../parser/parser.h"
+#include <gtest/gtest.h>
+
+// Fixture for quickening tests, on the AST walker
+class QuickeningTest : public ::testing::Test
+{
+protected:
+  std::string run(const std::string &source)
+  {
+    Tokenizer tokenizer(source);
+    Parser parser(tokenizer);
+    program = parser.parse();
+
+    interpreter.setBytecodeEnabled(false);
+    testing::internal::CaptureStdout();
+    interpreter.interpret(program.get());
+    return testing::internal::GetCapturedStdout();
+  }
+
+  // The expression returned by the first statement of function i
+  ExpressionNode *returned(size_t i)
+  {
+    auto function = dynamic_cast<FunctionNode *>(program->children[i].get());
+    auto statement = dynamic_cast<ReturnStatementNode *>(function->body->statements[0].get());
+    return statement->expression.get();
+  }
+
+  Interpreter interpreter;
+  std::unique_ptr<ProgramNode> program;
+};
+
+TEST_F(QuickeningTest, OperatorsQuickenForTheTypesTheySee)
+{
+  std::string output = run(R"(int function add(a, b) {
+    return a + b;
+}
+bool function less(a, b) {
+    return a < b;
+}
+print(add(1, 2));
+print(add(3, 4));
+print(add(5, 6));
+print(less(1.5, 2.5));
+print(less(2.5, 1.5));
+)");
+  EXPECT_EQ(output, "3\n7\n11\ntrue\nfalse\n");
+
+  auto add = dynamic_cast<AdditionExpressionNode *>(returned(0));
+  ASSERT_NE(add, nullptr);
+  EXPECT_EQ(add->quickening.form, Quickening::Form::Int);
+  EXPECT_EQ(add->quickening.op, Quickening::Op::Add);
+
+  auto less = dynamic_cast<ComparisonExpressionNode *>(returned(1));
+  ASSERT_NE(less, nullptr);
+  EXPECT_EQ(less->quickening.form, Quickening::Form::Float);
+}
+
+TEST_F(QuickeningTest, FailedChecksDeoptimise)
+{
+  std::string output = run(R"(int function add(a, b) {
+    return a + b;
+}
+print(add(1, 2));
+print(add(3, 4));
+print(add(1.5, 2.5));
+print(add("a", 1));
+print(add(1, 0.5));
+)");
+  EXPECT_EQ(output, "3\n7\n4\na1\n1.5\n");
+
+  auto add = dynamic_cast<AdditionExpressionNode *>(returned(0));
+  ASSERT_NE(add, nullptr);
+  EXPECT_EQ(add->quickening.deopts, 1);
+  EXPECT_EQ(add->quickening.form, Quickening::Form::Generic) << "Then saw mixed operands twice";
+}
+
+TEST_F(QuickeningTest, SitesThatKeepFailingStayGeneric)
+{
+  std::string output = run(R"(int function div(a, b) {
+    return a / b;
+}
+for (int i = 0; i < 8; i++) {
+    print(div(3, 2));
+    print(div(3, 2));
+    print(div(1.5, 0.5));
+    print(div(1.5, 0.5));
+}
+print(div(3, 0.5));
+)");
+  EXPECT_EQ(output.substr(0, 12), "1.5\n1.5\n3\n3\n");
+  EXPECT_EQ(output.substr(output.size() - 2), "6\n");
+
+  auto div = dynamic_cast<DivisionExpressionNode *>(returned(0));
+  ASSERT_NE(div, nullptr);
+  EXPECT_EQ(div->quickening.form, Quickening::Form::Generic);
+  EXPECT_EQ(div->quickening.deopts, Quickening::maxDeopts);
+}
+
+TEST_F(QuickeningTest, IncrementsAndFieldReadsQuicken)
+{
+  std::string output = run(R"(class Point {
+    int x;
+    int y;
+}
+class Other {
+    int y;
+    int x;
+}
+int function getX(p) {
+    return p.x;
+}
+int total = 0;
+int i = 0;
+while (i < 5) {
+    total = total + getX(Point(i, 0));
+    i++;
+}
+print(total);
+print(getX(Other(1, 2)));
+)");
+  EXPECT_EQ(output, "10\n2\n");
+
+  // Children: the two classes, getX, total, i and the loop
+  auto read = dynamic_cast<MemberAccessExpressionNode *>(returned(2));
+  ASSERT_NE(read, nullptr);
+  EXPECT_EQ(read->quickening.deopts, 1) << "Other's x is in another slot";
+
+  // Counted for loops don't run their increment node, so this one is a while
+  auto loop = dynamic_cast<WhileStatementNode *>(program->children[5].get());
+  ASSERT_NE(loop, nullptr);
+  auto body = dynamic_cast<BlockStatementNode *>(loop->body.get());
+  auto statement = dynamic_cast<ExpressionStatementNode *>(body->statements[1].get());
+  auto increment = dynamic_cast<UnaryExpressionNode *>(statement->expression.get());
+  ASSERT_NE(increment, nullptr);
+  EXPECT_EQ(increment->quickening.form, Quickening::Form::Int);
+  EXPECT_EQ(increment->quickening.op, Quickening::Op::Increment);
+}
+
+TEST_F(QuickeningTest, CountedLoopsRunOnANativeInt)
+{
+  std::string output = run(R"(int total = 0;
+int n = 10;
+for (int i = 0; i < n; i++) {
+    if (i == 2) {
+        continue;
+    }
+    if (i == 8) {
+        break;
+    }
+    total += i;
+}
+print(total);
+for (int i = 20; i > 0; i -= 5) {
+    print(i);
+}
+for (int i = 16777215; i < 16777220; i = i + 2) {
+    total = total + 1;
+}
+print(total);
+)");
+  EXPECT_EQ(output, "26\n20\n15\n10\n5\n28\n") << "Ints compare as floats, 16777219 < 16777220 is false";
+
+  auto loop = dynamic_cast<ForStatementNode *>(program->children[2].get());
+  ASSERT_NE(loop->counted, nullptr);
+  EXPECT_EQ(loop->counted->deopts, 0);
+  auto increment = dynamic_cast<UnaryExpressionNode *>(loop->increment.get());
+  EXPECT_EQ(increment->quickening.form, Quickening::Form::Unknown) << "The increment node never ran";
+}
+
+TEST_F(QuickeningTest, CountedLoopsDeoptimise)
+{
+  std::string output = run(R"(void function main() {
+    for (int i = 0; i < 10; i++) {
+        if (i == 3) {
+            i = 7;
+        }
+        print(i);
+    }
+    float limit = 2.5;
+    for (int i = 0; i < limit; i++) {
+        print(i);
+    }
+    for (int i = 0.5; i < 3; i++) {
+        print(i);
+    }
+}
+main();
+)");
+  EXPECT_EQ(output, "0\n1\n2\n7\n8\n9\n0\n1\n2\n0.5\n1.5\n2.5\n");
+
+  auto main = dynamic_cast<FunctionNode *>(program->children[0].get());
+  for (size_t i : {0, 2, 3})
+  {
+    auto loop = dynamic_cast<ForStatementNode *>(main->body->statements[i].get());
+    ASSERT_NE(loop->counted, nullptr);
+    EXPECT_EQ(loop->counted->deopts, 1) << "Loop " << i;
+  }
+}
+
+TEST_F(QuickeningTest, CountedLoopsMatchTheClosures)
+{
+  const std::string source = R"(void function main() {
+    int total = 0;
+    for (int i = 0; i < 100; i += 7) {
+        for (int j = i; j != i + 3; j++) {
+            total = total + i * j;
+        }
+        if (i == 91) {
+            i = i + 2;
+            total = total + 1;
+        }
+    }
+    print(total);
+}
+main();
+)";
+  std::string walked = run(source);
+  interpreter.setClosuresEnabled(true);
+  EXPECT_EQ(run(source), walked);
+}
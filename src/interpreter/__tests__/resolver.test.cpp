@@ -0,0 +1,272 @@
+#include "../resolver.h"
+#include "../../parser/parser.h"
+#include <gtest/gtest.h>
+
+// Fixture for Resolver tests
+class ResolverTest : public ::testing::Test
+{
+protected:
+  FunctionNode *resolveFunction(const std::string &source)
+  {
+    Tokenizer tokenizer(source);
+    const auto &tokens = tokenizer.tokenize();
+    Parser parser(tokens);
+    program = parser.parse();
+    Resolver().resolve(program.get());
+    return dynamic_cast<FunctionNode *>(program->children[0].get());
+  }
+
+  std::unique_ptr<ProgramNode> program;
+};
+
+TEST_F(ResolverTest, ParametersAndLocalsGetSlots)
+{
+  auto function = resolveFunction(
+      "int function f(int a, int b) { int c = a + b; return c; }");
+  ASSERT_NE(function, nullptr);
+  ASSERT_EQ(function->body->slotCount, 3) << "a, b and c should share the function scope";
+
+  auto decl = dynamic_cast<VariableDeclarationNode *>(function->body->statements[0].get());
+  ASSERT_NE(decl, nullptr);
+  ASSERT_EQ(decl->slot, 2);
+
+  auto add = dynamic_cast<AdditionExpressionNode *>(decl->initializer.get());
+  ASSERT_NE(add, nullptr);
+  auto a = dynamic_cast<VariableExpressionNode *>(add->left.get());
+  auto b = dynamic_cast<VariableExpressionNode *>(add->right.get());
+  ASSERT_EQ(a->depth, 0);
+  ASSERT_EQ(a->slot, 0);
+  ASSERT_EQ(b->depth, 0);
+  ASSERT_EQ(b->slot, 1);
+}
+
+TEST_F(ResolverTest, GlobalsStayByName)
+{
+  auto function = resolveFunction("int function f() { return total; }");
+  auto ret = dynamic_cast<ReturnStatementNode *>(function->body->statements[0].get());
+  ASSERT_NE(ret, nullptr);
+  auto var = dynamic_cast<VariableExpressionNode *>(ret->expression.get());
+  ASSERT_EQ(var->depth, -1) << "Unknown names should be looked up by name";
+  ASSERT_EQ(var->slot, -1);
+}
+
+TEST_F(ResolverTest, BlocksWithoutDeclarationsNeedNoScope)
+{
+  auto function = resolveFunction(R"(
+void function f(int n) {
+    while (n > 0) {
+        n = n - 1;
+    }
+    {
+        int n = 5;
+        print(n);
+    }
+}
+)");
+  auto loop = dynamic_cast<WhileStatementNode *>(function->body->statements[0].get());
+  ASSERT_NE(loop, nullptr);
+  auto loopBody = dynamic_cast<BlockStatementNode *>(loop->body.get());
+  ASSERT_FALSE(loopBody->needsScope) << "The loop body declares nothing";
+
+  auto assign = dynamic_cast<AssignmentExpressionNode *>(
+      dynamic_cast<ExpressionStatementNode *>(loopBody->statements[0].get())->expression.get());
+  ASSERT_EQ(assign->depth, 0) << "No scope between the loop body and the parameter";
+  ASSERT_EQ(assign->slot, 0);
+
+  auto block = dynamic_cast<BlockStatementNode *>(function->body->statements[1].get());
+  ASSERT_TRUE(block->needsScope);
+  ASSERT_EQ(block->slotCount, 1);
+  auto print = dynamic_cast<ConsoleLogNode *>(block->statements[1].get());
+  auto shadow = dynamic_cast<VariableExpressionNode *>(print->expression.get());
+  ASSERT_EQ(shadow->depth, 0) << "The inner n shadows the parameter";
+  ASSERT_EQ(shadow->slot, 0);
+}
+
+TEST_F(ResolverTest, ForLoopScope)
+{
+  auto function = resolveFunction(R"(
+int function f(int n) {
+    int total = 0;
+    for (int i = 0; i < n; i++) {
+        total += i;
+    }
+    return total;
+}
+)");
+  auto loop = dynamic_cast<ForStatementNode *>(function->body->statements[1].get());
+  ASSERT_NE(loop, nullptr);
+  ASSERT_TRUE(loop->needsScope);
+  ASSERT_EQ(loop->slotCount, 1);
+
+  auto body = dynamic_cast<BlockStatementNode *>(loop->body.get());
+  ASSERT_FALSE(body->needsScope);
+  auto assign = dynamic_cast<AssignmentExpressionNode *>(
+      dynamic_cast<ExpressionStatementNode *>(body->statements[0].get())->expression.get());
+  ASSERT_EQ(assign->depth, 1) << "total lives one scope out, past the loop scope";
+  ASSERT_EQ(assign->slot, 1);
+}
+
+TEST_F(ResolverTest, FindsCountedLoops)
+{
+  auto function = resolveFunction(R"(
+void function f(int n) {
+    for (int i = 0; i < n; i++) {
+    }
+    for (int i = n; i >= 0; i = i - 2) {
+    }
+    for (int i = 0; i != n * 2; i += 3) {
+    }
+    for (int i = 0; i < n; i = i * 2) {
+    }
+    for (int i = 0; i < size(n); i++) {
+    }
+    for (int i = 0; n > i; i++) {
+    }
+}
+)");
+  auto loop = [&](size_t i)
+  { return dynamic_cast<ForStatementNode *>(function->body->statements[i].get()); };
+
+  ASSERT_NE(loop(0)->counted, nullptr);
+  EXPECT_EQ(loop(0)->counted->slot, 0);
+  EXPECT_EQ(loop(0)->counted->test, CountedLoop::Test::Less);
+  EXPECT_EQ(loop(0)->counted->step, 1);
+
+  ASSERT_NE(loop(1)->counted, nullptr);
+  EXPECT_EQ(loop(1)->counted->test, CountedLoop::Test::GreaterEqual);
+  EXPECT_EQ(loop(1)->counted->step, -2);
+
+  ASSERT_NE(loop(2)->counted, nullptr);
+  EXPECT_EQ(loop(2)->counted->test, CountedLoop::Test::NotEqual);
+  EXPECT_EQ(loop(2)->counted->step, 3);
+
+  EXPECT_EQ(loop(3)->counted, nullptr) << "Not a constant step";
+  EXPECT_EQ(loop(4)->counted, nullptr) << "The bound calls a function";
+  EXPECT_EQ(loop(5)->counted, nullptr) << "The variable is on the right";
+}
+
+TEST_F(ResolverTest, BuildsSwitchTables)
+{
+  auto function = resolveFunction(R"(
+void function f(n) {
+    switch (n) {
+        case 3:
+        case -1:
+        default:
+        case 2:
+    }
+    switch (n) {
+        case 1000:
+        case 5:
+        case 5:
+        case -70000:
+    }
+    switch (n) {
+        case "go":
+        case "stop":
+        case "go":
+    }
+    switch (n) {
+        case 1:
+        case "one":
+    }
+    switch (n) {
+        case n + 1:
+    }
+}
+)");
+  auto table = [&](size_t i)
+  { return dynamic_cast<SwitchStatementNode *>(function->body->statements[i].get())->table.get(); };
+
+  ASSERT_NE(table(0), nullptr);
+  EXPECT_EQ(table(0)->kind, SwitchTable::Kind::Dense);
+  EXPECT_EQ(table(0)->otherwise, 2);
+  EXPECT_EQ(table(0)->find(3), 0);
+  EXPECT_EQ(table(0)->find(-1), 1);
+  EXPECT_EQ(table(0)->find(2), 2) << "The default comes before case 2";
+  EXPECT_EQ(table(0)->find(0), 2);
+  EXPECT_EQ(table(0)->find(2147483647), 2);
+
+  ASSERT_NE(table(1), nullptr);
+  EXPECT_EQ(table(1)->kind, SwitchTable::Kind::Sparse);
+  EXPECT_EQ(table(1)->otherwise, 4) << "No default";
+  EXPECT_EQ(table(1)->find(5), 1) << "The first case with a value wins";
+  EXPECT_EQ(table(1)->find(-70000), 3);
+  EXPECT_EQ(table(1)->find(6), 4);
+
+  ASSERT_NE(table(2), nullptr);
+  EXPECT_EQ(table(2)->kind, SwitchTable::Kind::String);
+  EXPECT_EQ(table(2)->find(std::string_view("go")), 0);
+  EXPECT_EQ(table(2)->find(std::string_view("stop")), 1);
+  EXPECT_EQ(table(2)->find(std::string_view("")), 3);
+
+  EXPECT_EQ(table(3), nullptr) << "Mixed cases";
+  EXPECT_EQ(table(4), nullptr) << "Not a literal";
+}
+
+TEST_F(ResolverTest, MarksTailCalls)
+{
+  const std::string source = R"(
+int function f(n) { return g(n - 1, f); }
+int function g(n, h) { return g(n) + 1; }
+int function h(n) { return n.f(n); }
+)";
+  resolveFunction(source);
+  auto returnOf = [&](size_t i)
+  {
+    auto function = dynamic_cast<FunctionNode *>(program->children[i].get());
+    return dynamic_cast<ReturnStatementNode *>(function->body->statements[0].get());
+  };
+
+  EXPECT_TRUE(returnOf(0)->tailCall);
+  EXPECT_FALSE(returnOf(1)->tailCall) << "The call is an operand";
+  EXPECT_FALSE(returnOf(2)->tailCall) << "Method calls keep their frame";
+
+  Tokenizer tokenizer(source);
+  const auto &tokens = tokenizer.tokenize();
+  Parser parser(tokens);
+  program = parser.parse();
+  Resolver(false).resolve(program.get());
+  EXPECT_FALSE(returnOf(0)->tailCall) << "Tail calls are turned off";
+}
+
+TEST_F(ResolverTest, MethodsReachFieldsThroughThis)
+{
+  Tokenizer tokenizer(R"(
+class Counter {
+    int count;
+    int function add(int n) {
+        count = count + n;
+        return count;
+    }
+}
+)");
+  const auto &tokens = tokenizer.tokenize();
+  Parser parser(tokens);
+  program = parser.parse();
+  Resolver().resolve(program.get());
+
+  auto klass = dynamic_cast<ClassNode *>(program->children[0].get());
+  ASSERT_NE(klass, nullptr);
+  FunctionNode *method = nullptr;
+  for (const auto &member : klass->members)
+  {
+    if (auto function = dynamic_cast<FunctionNode *>(member.get()))
+      method = function;
+  }
+  ASSERT_NE(method, nullptr);
+  ASSERT_EQ(method->thisSlot, 1) << "this follows the parameters";
+  ASSERT_EQ(method->body->slotCount, 2);
+
+  auto assign = dynamic_cast<AssignmentExpressionNode *>(
+      dynamic_cast<ExpressionStatementNode *>(method->body->statements[0].get())->expression.get());
+  auto target = dynamic_cast<VariableExpressionNode *>(assign->left.get());
+  ASSERT_NE(target->fieldCache, nullptr) << "count isn't declared in the method";
+  ASSERT_EQ(assign->depth, 0);
+  ASSERT_EQ(assign->slot, 1) << "The assignment locates this";
+
+  auto add = dynamic_cast<AdditionExpressionNode *>(assign->right.get());
+  auto n = dynamic_cast<VariableExpressionNode *>(add->right.get());
+  ASSERT_EQ(n->fieldCache, nullptr) << "Parameters shadow fields";
+  ASSERT_EQ(n->slot, 0);
+}
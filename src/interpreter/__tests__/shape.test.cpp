@@ -0,0 +1,66 @@
+#include "../interpreter.h"
+#include "../../parser/parser.h"
+#include <gtest/gtest.h>
+
+// Fixture for hidden class (Shape) tests
+class ShapeTest : public ::testing::Test
+{
+protected:
+  std::shared_ptr<Class> declareClass(const std::string &source, const std::string &name)
+  {
+    Tokenizer tokenizer(source);
+    const auto &tokens = tokenizer.tokenize();
+    Parser parser(tokens);
+    program = parser.parse();
+
+    testing::internal::CaptureStdout();
+    interpreter.interpret(program.get());
+    testing::internal::GetCapturedStdout();
+    return interpreter.getEnvironment()->get(name).asObject<Class>();
+  }
+
+  Interpreter interpreter;
+  std::unique_ptr<ProgramNode> program;
+};
+
+TEST_F(ShapeTest, TransitionsAreShared)
+{
+  Shape root;
+  Shape *a = root.withField("x")->withField("y");
+  Shape *b = root.withField("x")->withField("y");
+  ASSERT_EQ(a, b) << "Adding the same fields in the same order should reuse shapes";
+  ASSERT_EQ(a->slotOf("x"), 0);
+  ASSERT_EQ(a->slotOf("y"), 1);
+  ASSERT_EQ(a->slotOf("z"), -1);
+  ASSERT_NE(root.withField("y")->withField("x"), a) << "Field order is part of the shape";
+}
+
+TEST_F(ShapeTest, InstancesStartFromTheClassTemplate)
+{
+  auto klass = declareClass(R"(
+class Point {
+    int x;
+    int y;
+    void function constructor(int px, int py) {
+        x = px;
+        y = py;
+    }
+}
+)",
+                            "Point");
+  ASSERT_NE(klass, nullptr);
+  ASSERT_EQ(klass->instanceShape->names.size(), 4) << "x, y and the constructor parameters px, py";
+  ASSERT_EQ(klass->fieldDefaults.size(), 4);
+  ASSERT_EQ(klass->argumentSlots.size(), 2);
+
+  Object first(klass);
+  Object second(klass);
+  ASSERT_EQ(first.shape, second.shape);
+  ASSERT_EQ(first.getField("y")->asInt(), 0);
+
+  first.setField("extra", Value(7));
+  ASSERT_NE(first.shape, second.shape) << "A new field moves only that object to a new shape";
+  second.setField("extra", Value(8));
+  ASSERT_EQ(first.shape, second.shape) << "...and objects that grow the same way share it again";
+  ASSERT_EQ(second.getField("extra")->asInt(), 8);
+}
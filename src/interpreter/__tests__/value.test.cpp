@@ -0,0 +1,71 @@
+#include "../interpreter.h"
+#include <cmath>
+#include <gtest/gtest.h>
+
+// Fixture for Value tests
+class ValueTest : public ::testing::Test
+{
+protected:
+};
+
+TEST_F(ValueTest, InlineTypesRoundTrip)
+{
+  ASSERT_TRUE(Value().isNull());
+  ASSERT_TRUE(Value(true).asBool());
+  ASSERT_FALSE(Value(false).asBool());
+  ASSERT_EQ(Value(-42).asInt(), -42);
+  ASSERT_EQ(Value(2147483647).asInt(), 2147483647);
+  ASSERT_FLOAT_EQ(Value(-1.5f).asFloat(), -1.5f);
+  ASSERT_TRUE(Value(-1.5f).isFloat());
+  ASSERT_TRUE(Value(-42).isInteger());
+  ASSERT_EQ(Value(-42).getType(), Value::Type::Integer);
+}
+
+TEST_F(ValueTest, NaNAndInfinityStayFloats)
+{
+  Value nan(std::nanf(""));
+  ASSERT_TRUE(nan.isFloat()) << "A NaN float must not look like a boxed value";
+  ASSERT_TRUE(std::isnan(nan.asFloat()));
+  ASSERT_NE(nan, nan);
+
+  Value negativeNaN(-std::nanf(""));
+  ASSERT_TRUE(negativeNaN.isFloat());
+
+  Value negativeInfinity(-INFINITY);
+  ASSERT_TRUE(negativeInfinity.isFloat());
+  ASSERT_EQ(negativeInfinity.asFloat(), -INFINITY);
+}
+
+TEST_F(ValueTest, StringsShareCellsOnCopy)
+{
+  Value original(std::string("hello"));
+  Value copy = original;
+  Value moved = std::move(copy);
+  ASSERT_TRUE(copy.isNull()) << "A moved-from Value is left null";
+  ASSERT_EQ(moved.toString(), "hello");
+
+  original = Value(std::string("changed"));
+  ASSERT_EQ(moved.toString(), "hello") << "Reassigning one Value must not affect its copies";
+  ASSERT_EQ(original + Value(1), Value(std::string("changed1")));
+}
+
+TEST_F(ValueTest, ObjectsCompareByReference)
+{
+  auto object = std::make_shared<int>(7);
+  Value a(std::static_pointer_cast<void>(object), Value::Type::Object);
+  Value b(std::static_pointer_cast<void>(object), Value::Type::Object);
+  Value c(std::static_pointer_cast<void>(std::make_shared<int>(7)), Value::Type::Object);
+
+  ASSERT_EQ(a, b) << "Separately boxed references to one object are equal";
+  ASSERT_NE(a, c);
+  ASSERT_EQ(*a.asObject<int>(), 7);
+  ASSERT_EQ(object.use_count(), 3) << "Only the cells hold a reference besides the test";
+
+  {
+    Value copy = a;
+    ASSERT_EQ(object.use_count(), 3) << "Copying a Value bumps the cell, not the shared_ptr";
+  }
+  a = Value();
+  b = Value();
+  ASSERT_EQ(object.use_count(), 1);
+}
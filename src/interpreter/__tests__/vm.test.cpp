@@ -0,0 +1,289 @@
+#include "../interpreter.h"
+#include "../compiler.h"
+#include "../../parser/parser.h"
+#include <gtest/gtest.h>
+
+// Fixture for bytecode VM tests. Every program is run twice, once on the
+// AST walker and once with the VM enabled, and both runs must print the same
+class VMTest : public ::testing::Test
+{
+protected:
+  std::string run(const std::string &source, bool useBytecode)
+  {
+    Tokenizer tokenizer(source);
+    const auto &tokens = tokenizer.tokenize();
+    Parser parser(tokens);
+    auto program = parser.parse();
+
+    Interpreter interpreter;
+    interpreter.setBytecodeEnabled(useBytecode);
+
+    testing::internal::CaptureStdout();
+    interpreter.interpret(program.get());
+    return testing::internal::GetCapturedStdout();
+  }
+
+  void expectSameOutput(const std::string &source, const std::string &expected)
+  {
+    std::string ast = run(source, false);
+    std::string vm = run(source, true);
+    EXPECT_EQ(ast, vm) << "VM output should match the AST interpreter";
+    EXPECT_NE(vm.find(expected), std::string::npos)
+        << "Output should contain '" << expected << "' but was:\n"
+        << vm;
+  }
+
+  std::shared_ptr<BytecodeFunction> compileFirstFunction(const std::string &source)
+  {
+    Tokenizer tokenizer(source);
+    const auto &tokens = tokenizer.tokenize();
+    Parser parser(tokens);
+    program = parser.parse();
+    auto function = dynamic_cast<FunctionNode *>(program->children[0].get());
+    return BytecodeCompiler::compile(function);
+  }
+
+  std::unique_ptr<ProgramNode> program;
+};
+
+TEST_F(VMTest, CompilesSimpleFunction)
+{
+  auto code = compileFirstFunction(
+      "int function add(int a, int b) { return a + b; }");
+  ASSERT_NE(code, nullptr) << "add should compile to bytecode";
+  ASSERT_EQ(code->parameterCount, 2);
+  ASSERT_EQ(code->code.back().op, OpCode::ReturnNull);
+}
+
+TEST_F(VMTest, UnsupportedFunctionFallsBack)
+{
+  auto code = compileFirstFunction(
+      "void function f() { int x = 0; x.foo(); }");
+  ASSERT_EQ(code, nullptr) << "Method calls should stay on the AST interpreter";
+}
+
+TEST_F(VMTest, RecursionMatchesAST)
+{
+  expectSameOutput(R"(
+int function fib(int n) {
+    if (n < 2) {
+        return n;
+    }
+    return fib(n - 1) + fib(n - 2);
+}
+void function main() {
+    print(fib(15));
+}
+)",
+                   "610\n");
+}
+
+TEST_F(VMTest, LoopsAndScopesMatchAST)
+{
+  expectSameOutput(R"(
+void function main() {
+    int total = 0;
+    for (int i = 0; i < 10; i++) {
+        int j = i * 2;
+        total += j;
+    }
+    int x = 5;
+    {
+        int x = 10;
+        total = total + x;
+    }
+    int k = 0;
+    while (k < 3) {
+        k++;
+    }
+    print(total + x + k);
+}
+)",
+                   "108\n");
+}
+
+TEST_F(VMTest, SwitchFallThroughMatchesAST)
+{
+  expectSameOutput(R"(
+string function classify(int x) {
+    string result = "";
+    switch (x) {
+        case 1:
+            result = result + "one";
+        case 2:
+            result = result + "two";
+            break;
+        default:
+            result = result + "other";
+    }
+    return result;
+}
+void function main() {
+    print(classify(1) + "," + classify(2) + "," + classify(7));
+}
+)",
+                   "onetwo,two,other\n");
+}
+
+TEST_F(VMTest, SwitchTablesMatchAST)
+{
+  // Dense, sparse and string tables, a default ahead of a matching case, and
+  // a float value the tables leave to the compare chain
+  expectSameOutput(R"(
+int function dense(n) {
+    int r = 0;
+    switch (n) {
+        case 1:
+            r = 1;
+            break;
+        default:
+            r = 100;
+        case 2:
+            r = r + 2;
+            break;
+        case -3:
+            r = 3;
+    }
+    return r;
+}
+int function sparse(n) {
+    int r = 0;
+    switch (n) {
+        case 1000:
+            r = 1;
+        case -70000:
+            r = r + 2;
+            break;
+        case 5:
+            r = 3;
+    }
+    return r;
+}
+string function word(s) {
+    string r = "?";
+    switch (s) {
+        case "go":
+            r = "moving";
+            break;
+        case "stop":
+            r = "halted";
+            break;
+    }
+    return r;
+}
+void function main() {
+    int total = 0;
+    for (int i = 0 - 4; i < 4; i++) {
+        total = total * 3 + dense(i) + sparse(i);
+    }
+    print(total);
+    print(dense(1.0) + dense(2) + dense(0 - 3) + sparse(1000) + sparse(5) + sparse(1000.0));
+    print(word("go") + word("stop") + word("went") + word(1));
+}
+)",
+                   "333651\n214\nmovinghalted??\n");
+}
+
+TEST_F(VMTest, TailCallsMatchAST)
+{
+  // Deeper than either stack holds without tail calls, and tail calls of a
+  // class and a native function that return a value instead of a frame
+  expectSameOutput(R"(
+class Box {
+    int value;
+}
+int function count(n, acc) {
+    if (n == 0) {
+        return acc;
+    }
+    return count(n - 1, acc + n % 3);
+}
+bool function isEven(n) {
+    if (n == 0) {
+        return true;
+    }
+    return isOdd(n - 1);
+}
+bool function isOdd(n) {
+    if (n == 0) {
+        return false;
+    }
+    return isEven(n - 1);
+}
+int function box(n) {
+    return Box(n);
+}
+int function magnitude(n) {
+    return abs(n);
+}
+void function main() {
+    print(count(200000, 0));
+    print(isEven(200001));
+    print(box(5).value);
+    print(magnitude(0 - 7));
+}
+)",
+                   "200001\nfalse\n5\n7\n");
+}
+
+TEST_F(VMTest, ExpressionsAndGlobalsMatchAST)
+{
+  expectSameOutput(R"(
+int counter = 0;
+void function bump() {
+    counter += 2;
+    counter++;
+}
+void function main() {
+    bump();
+    int a = 3;
+    int b = a++ + ++a;
+    bool t = a > 2 && b < 100 || false;
+    print(counter + " " + b + " " + a + " " + t + " " + (7 / 2) + " " + (7 % 3));
+}
+)",
+                   "3 8 5 true 3.5 1\n");
+}
+
+TEST_F(VMTest, BreakAndContinueMatchAST)
+{
+  auto code = compileFirstFunction(
+      "void function f() { while (true) { continue; } }");
+  ASSERT_NE(code, nullptr) << "continue should compile to bytecode";
+
+  expectSameOutput(R"(
+int function sumOdd(int n) {
+    int total = 0;
+    for (int i = 0; i < n; i++) {
+        if (i % 2 == 0) {
+            continue;
+        }
+        if (i > 15) {
+            break;
+        }
+        total += i;
+    }
+    return total;
+}
+int function firstSquareOver(int limit) {
+    int k = 0;
+    while (true) {
+        k++;
+        switch (k % 3) {
+            case 0:
+                continue;
+            default:
+                break;
+        }
+        if (k * k > limit) {
+            return k;
+        }
+    }
+    return -1;
+}
+void function main() {
+    print(sumOdd(100) + " " + firstSquareOver(50));
+}
+)",
+                   "64 8\n");
+}
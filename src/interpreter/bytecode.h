@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "interpreter.h"
+
+// Register based instruction set used by the bytecode VM.
+// R[x] is a register of the current frame, K[x] an entry of the constant pool
+// and N[x] an entry of the name table (globals are still looked up by name).
+enum class OpCode : uint8_t
+{
+    Move,         // R[a] = R[b]
+    LoadConst,    // R[a] = K[b]
+    LoadNull,     // R[a] = null
+    LoadBool,     // R[a] = (b != 0)
+    GetGlobal,    // R[a] = closure.get(N[b])
+    SetGlobal,    // closure.assign(N[b], R[a])
+    Add,          // R[a] = R[b] + R[c]
+    Subtract,     // R[a] = R[b] - R[c]
+    Multiply,     // R[a] = R[b] * R[c]
+    Divide,       // R[a] = R[b] / R[c]
+    Modulo,       // R[a] = R[b] % R[c]
+    Less,         // R[a] = R[b] < R[c]
+    LessEqual,    // R[a] = R[b] <= R[c]
+    Greater,      // R[a] = R[b] > R[c]
+    GreaterEqual, // R[a] = R[b] >= R[c]
+    Equal,        // R[a] = R[b] == R[c]
+    NotEqual,     // R[a] = R[b] != R[c]
+    Negate,       // R[a] = -R[b]
+    Not,          // R[a] = !R[b]
+    ToBool,       // R[a] = R[b].asBool()
+    Increment,    // R[a] = R[b] + 1 (numeric only)
+    Decrement,    // R[a] = R[b] - 1 (numeric only)
+    Jump,         // pc += offset
+    JumpIfFalse,  // if (!R[a]) pc += offset
+    JumpIfTrue,   // if (R[a]) pc += offset
+    Switch,       // pc = S[b].targets[clause the table picks for R[a]], if it can pick one
+    Call,         // R[a] = R[a](R[a+1], ..., R[a+c])
+    TailCall,     // As Call, but a function on the VM runs in place of this frame
+    Print,        // print R[a]
+    Return,       // return R[a]
+    ReturnNull    // return null
+};
+
+// Fixed size 8 byte instruction. Jumps store a signed offset, relative to the
+// following instruction, in the b/c pair.
+struct Instruction
+{
+    OpCode op;
+    uint16_t a;
+    uint16_t b;
+    uint16_t c;
+
+    Instruction(OpCode op, uint16_t a = 0, uint16_t b = 0, uint16_t c = 0)
+        : op(op), a(a), b(b), c(c) {}
+
+    int32_t offset() const
+    {
+        return static_cast<int32_t>(static_cast<uint32_t>(b) | (static_cast<uint32_t>(c) << 16));
+    }
+
+    void setOffset(int32_t value)
+    {
+        uint32_t raw = static_cast<uint32_t>(value);
+        b = static_cast<uint16_t>(raw & 0xFFFF);
+        c = static_cast<uint16_t>(raw >> 16);
+    }
+};
+
+class JitCode;
+
+// A function lowered to bytecode
+struct BytecodeFunction
+{
+    std::string name;
+    uint16_t parameterCount = 0;
+    uint16_t registerCount = 0;
+    std::vector<Instruction> code;
+    std::vector<int> lines; // Source line of every instruction, for error reporting
+    std::vector<Value> constants;
+    std::vector<std::string> names;
+
+    // S[x], the switches that dispatch through their SwitchTable: the first
+    // instruction of each clause's body, then the end of the switch for
+    // values no clause takes. The table belongs to the function's AST
+    struct SwitchJumps
+    {
+        const SwitchTable *table;
+        std::vector<uint32_t> targets;
+    };
+    std::vector<SwitchJumps> switches;
+
+    // Counters and native code of the JIT (see jit.h). The VM updates them
+    // while the function runs, so they are mutable
+    struct Tier
+    {
+        uint32_t calls = 0;
+        uint32_t backedges = 0; // Loop iterations run by the VM
+        uint32_t deopts = 0;    // Type guard failures in the native code
+        bool compiled = false;  // The JIT ran, native may still be null
+        std::shared_ptr<JitCode> native;
+    };
+    mutable Tier tier;
+
+    // Human readable listing, used by --debug
+    std::string disassemble() const;
+};
+
+const char *opCodeName(OpCode op);
@@ -0,0 +1,672 @@
+#include "closure_compiler.h"
+
+// Runs a compiled binary operator: both operands left to right, then the
+// operation, which the compiler picked for the node
+template <typename Operation>
+static ExpressionClosure binary(ExpressionClosure left, ExpressionClosure right, Operation operation)
+{
+    return [left = std::move(left), right = std::move(right), operation](Interpreter &interpreter)
+    {
+        Value a = left(interpreter);
+        Value b = right(interpreter);
+        return operation(a, b);
+    };
+}
+
+static ExpressionClosure constant(Value value)
+{
+    return [value = std::move(value)](Interpreter &)
+    { return value; };
+}
+
+std::shared_ptr<ClosureBody> ClosureCompiler::compile(BlockStatementNode *body)
+{
+    if (!body)
+    {
+        return nullptr;
+    }
+
+    auto compiled = std::make_shared<ClosureBody>();
+    for (const auto &statement : body->statements)
+    {
+        if (statement)
+        {
+            compiled->statements.push_back(compileStatement(statement.get()));
+        }
+    }
+    return compiled;
+}
+
+// Statements
+
+StatementClosure ClosureCompiler::compileStatement(ASTNode *node)
+{
+    if (!node)
+    {
+        return [](Interpreter &)
+        { return Completion(); };
+    }
+
+    switch (node->kind())
+    {
+    case NodeKind::BlockStatement:
+        return compileBlock(static_cast<BlockStatementNode *>(node));
+    case NodeKind::VariableDeclaration:
+        return compileVariableDeclaration(static_cast<VariableDeclarationNode *>(node));
+    case NodeKind::IfStatement:
+        return compileIf(static_cast<IfStatementNode *>(node));
+    case NodeKind::WhileStatement:
+        return compileWhile(static_cast<WhileStatementNode *>(node));
+    case NodeKind::ForStatement:
+        return compileFor(static_cast<ForStatementNode *>(node));
+    case NodeKind::ReturnStatement:
+        return compileReturn(static_cast<ReturnStatementNode *>(node));
+    case NodeKind::ConsoleLog:
+        return compileConsoleLog(static_cast<ConsoleLogNode *>(node));
+    case NodeKind::ExpressionStatement:
+    {
+        ExpressionClosure expression = compileExpression(static_cast<ExpressionStatementNode *>(node)->expression.get());
+        return [expression = std::move(expression)](Interpreter &interpreter)
+        {
+            interpreter.lastValue = expression(interpreter);
+            return Completion();
+        };
+    }
+    case NodeKind::BreakStatement:
+        return [](Interpreter &)
+        { return Completion(Completion::Type::Break); };
+    case NodeKind::ContinueStatement:
+        return [](Interpreter &)
+        { return Completion(Completion::Type::Continue); };
+    default:
+        // Declarations, switches, imports, input, ...
+        return [node](Interpreter &interpreter)
+        { return interpreter.execute(node); };
+    }
+}
+
+StatementClosure ClosureCompiler::compileBlock(BlockStatementNode *node)
+{
+    std::vector<StatementClosure> statements;
+    for (const auto &statement : node->statements)
+    {
+        if (statement)
+        {
+            statements.push_back(compileStatement(statement.get()));
+        }
+    }
+
+    bool needsScope = node->needsScope;
+    int slotCount = node->slotCount;
+    return [statements = std::move(statements), needsScope, slotCount](Interpreter &interpreter)
+    {
+        std::shared_ptr<Environment> previous = interpreter.environment;
+        Completion completion;
+        FramePool::Lease scope(interpreter.frames);
+
+        // Blocks that declare nothing run in the current environment
+        if (needsScope)
+        {
+            scope.frame = interpreter.frames.acquire(interpreter.environment, slotCount);
+            interpreter.environment = scope.frame;
+        }
+
+        try
+        {
+            for (const auto &statement : statements)
+            {
+                completion = statement(interpreter);
+                if (!completion.isNormal())
+                {
+                    break;
+                }
+            }
+        }
+        catch (const std::exception &)
+        {
+            interpreter.environment = previous;
+            throw;
+        }
+
+        interpreter.environment = previous;
+        return completion;
+    };
+}
+
+StatementClosure ClosureCompiler::compileVariableDeclaration(VariableDeclarationNode *node)
+{
+    // `Point p = Point(...)` may create the instance directly, which depends
+    // on what Point is when it runs
+    if (auto call = nodeCast<CallExpressionNode>(node->initializer.get()))
+    {
+        auto callee = nodeCast<VariableExpressionNode>(call->callee.get());
+        if (callee && callee->name == node->typeName)
+        {
+            return [node](Interpreter &interpreter)
+            {
+                interpreter.executeVariableDeclaration(node);
+                return Completion();
+            };
+        }
+    }
+
+    ExpressionClosure initializer;
+    if (node->initializer)
+    {
+        initializer = compileExpression(node->initializer.get());
+    }
+    else if (node->typeName == "int")
+    {
+        initializer = constant(Value(0));
+    }
+    else if (node->typeName == "float")
+    {
+        initializer = constant(Value(0.0f));
+    }
+    else if (node->typeName == "string")
+    {
+        initializer = constant(Value(std::string("")));
+    }
+    else if (node->typeName == "bool")
+    {
+        initializer = constant(Value(false));
+    }
+    else
+    {
+        initializer = constant(Value());
+    }
+
+    int slot = node->slot;
+    const std::string *name = &node->name;
+    return [initializer = std::move(initializer), slot, name](Interpreter &interpreter)
+    {
+        Value value = initializer(interpreter);
+        if (slot >= 0)
+        {
+            interpreter.environment->defineAt(slot, value);
+        }
+        else
+        {
+            interpreter.environment->define(*name, value);
+        }
+        return Completion();
+    };
+}
+
+StatementClosure ClosureCompiler::compileIf(IfStatementNode *node)
+{
+    ExpressionClosure condition = compileExpression(node->condition.get());
+    StatementClosure thenBranch = compileStatement(node->thenBranch.get());
+    StatementClosure elseBranch = compileStatement(node->elseBranch.get());
+    return [condition = std::move(condition), thenBranch = std::move(thenBranch),
+            elseBranch = std::move(elseBranch)](Interpreter &interpreter)
+    {
+        return condition(interpreter).asBool() ? thenBranch(interpreter) : elseBranch(interpreter);
+    };
+}
+
+StatementClosure ClosureCompiler::compileWhile(WhileStatementNode *node)
+{
+    ExpressionClosure condition = compileExpression(node->condition.get());
+    StatementClosure body = compileStatement(node->body.get());
+    return [condition = std::move(condition), body = std::move(body)](Interpreter &interpreter)
+    {
+        while (condition(interpreter).asBool())
+        {
+            Completion completion = body(interpreter);
+            if (completion.type == Completion::Type::Break)
+            {
+                break;
+            }
+            if (completion.type == Completion::Type::Return)
+            {
+                return completion;
+            }
+        }
+        return Completion();
+    };
+}
+
+StatementClosure ClosureCompiler::compileFor(ForStatementNode *node)
+{
+    StatementClosure initializer = compileStatement(node->initializer.get());
+    ExpressionClosure condition;
+    if (node->condition)
+    {
+        condition = compileExpression(node->condition.get());
+    }
+    ExpressionClosure increment = compileExpression(node->increment.get());
+    StatementClosure body = compileStatement(node->body.get());
+
+    bool needsScope = node->needsScope;
+    int slotCount = node->slotCount;
+    return [node, initializer = std::move(initializer), condition = std::move(condition),
+            increment = std::move(increment), body = std::move(body), needsScope, slotCount](Interpreter &interpreter)
+    {
+        std::shared_ptr<Environment> previous = interpreter.environment;
+        FramePool::Lease scope(interpreter.frames);
+        if (needsScope)
+        {
+            scope.frame = interpreter.frames.acquire(interpreter.environment, slotCount);
+            interpreter.environment = scope.frame;
+        }
+
+        Completion result;
+        try
+        {
+            initializer(interpreter);
+
+            // Counted loops run on a native int until something deoptimises them
+            bool finished = false;
+            if (node->counted && node->counted->deopts < CountedLoop::maxDeopts)
+            {
+                finished = interpreter.runCountedLoop(node, body, result);
+            }
+
+            // Without a condition the body runs once
+            while (!finished && (!condition || condition(interpreter).asBool()))
+            {
+                Completion completion = body(interpreter);
+                if (completion.type == Completion::Type::Break)
+                {
+                    break;
+                }
+                if (completion.type == Completion::Type::Return)
+                {
+                    result = std::move(completion);
+                    break;
+                }
+
+                increment(interpreter);
+                if (!condition)
+                {
+                    break;
+                }
+            }
+        }
+        catch (const std::exception &e)
+        {
+            interpreter.environment = previous;
+            throw std::runtime_error(std::string("Error in for statement: ") + e.what());
+        }
+
+        interpreter.environment = previous;
+        return result;
+    };
+}
+
+StatementClosure ClosureCompiler::compileReturn(ReturnStatementNode *node)
+{
+    if (node->tailCall)
+    {
+        // As compileCall, with the call left to returnCall
+        auto call = static_cast<CallExpressionNode *>(node->expression.get());
+        ExpressionClosure callee = compileExpression(call->callee.get());
+        std::vector<ExpressionClosure> arguments;
+        for (const auto &argument : call->arguments)
+        {
+            arguments.push_back(compileExpression(argument.get()));
+        }
+        return [callee = std::move(callee), arguments = std::move(arguments)](Interpreter &interpreter)
+        {
+            Value function = callee(interpreter);
+
+            Interpreter::ArgumentFrame frame(interpreter.argumentStack);
+            for (const auto &argument : arguments)
+            {
+                interpreter.argumentStack.push_back(argument(interpreter));
+            }
+            return interpreter.returnCall(function, frame.arguments());
+        };
+    }
+
+    ExpressionClosure expression = compileExpression(node->expression.get());
+    return [expression = std::move(expression)](Interpreter &interpreter)
+    {
+        return Completion(Completion::Type::Return, expression(interpreter));
+    };
+}
+
+StatementClosure ClosureCompiler::compileConsoleLog(ConsoleLogNode *node)
+{
+    if (!node->expression)
+    {
+        return [](Interpreter &interpreter)
+        {
+            interpreter.output.endLine();
+            return Completion();
+        };
+    }
+
+    ExpressionClosure expression = compileExpression(node->expression.get());
+    return [expression = std::move(expression)](Interpreter &interpreter)
+    {
+        interpreter.printValue(expression(interpreter));
+        return Completion();
+    };
+}
+
+// Expressions
+
+ExpressionClosure ClosureCompiler::compileExpression(ExpressionNode *node)
+{
+    if (!node)
+    {
+        return constant(Value());
+    }
+
+    switch (node->kind())
+    {
+    case NodeKind::VariableExpression:
+        return compileVariable(static_cast<VariableExpressionNode *>(node));
+    case NodeKind::CallExpression:
+        return compileCall(static_cast<CallExpressionNode *>(node));
+    case NodeKind::AssignmentExpression:
+        return compileAssignment(static_cast<AssignmentExpressionNode *>(node));
+    case NodeKind::MemberAccessExpression:
+        return compileMemberAccess(static_cast<MemberAccessExpressionNode *>(node));
+    case NodeKind::IntegerLiteral:
+        return constant(Value(static_cast<IntegerLiteralNode *>(node)->value));
+    case NodeKind::FloatingPointLiteral:
+        return constant(Value(static_cast<FloatingPointLiteralNode *>(node)->value));
+    case NodeKind::StringLiteral:
+        return constant(Value(static_cast<StringLiteralNode *>(node)->value));
+    case NodeKind::BooleanLiteral:
+        return constant(Value(static_cast<BooleanLiteralNode *>(node)->value));
+    case NodeKind::NullLiteral:
+        return constant(Value());
+    case NodeKind::AdditionExpression:
+    {
+        auto *add = static_cast<AdditionExpressionNode *>(node);
+        return binary(compileExpression(add->left.get()), compileExpression(add->right.get()),
+                      [](const Value &a, const Value &b)
+                      { return a + b; });
+    }
+    case NodeKind::SubtractionExpression:
+    {
+        auto *sub = static_cast<SubtractionExpressionNode *>(node);
+        return binary(compileExpression(sub->left.get()), compileExpression(sub->right.get()),
+                      [](const Value &a, const Value &b)
+                      { return a - b; });
+    }
+    case NodeKind::MultiplicationExpression:
+    {
+        auto *mul = static_cast<MultiplicationExpressionNode *>(node);
+        return binary(compileExpression(mul->left.get()), compileExpression(mul->right.get()),
+                      [](const Value &a, const Value &b)
+                      { return a * b; });
+    }
+    case NodeKind::DivisionExpression:
+    {
+        auto *div = static_cast<DivisionExpressionNode *>(node);
+        return binary(compileExpression(div->left.get()), compileExpression(div->right.get()),
+                      [](const Value &a, const Value &b)
+                      { return a / b; });
+    }
+    case NodeKind::ComparisonExpression:
+    {
+        auto *comp = static_cast<ComparisonExpressionNode *>(node);
+        return compileOperator(node, comp->left.get(), comp->op, comp->right.get());
+    }
+    case NodeKind::EqualityExpression:
+    {
+        auto *eq = static_cast<EqualityExpressionNode *>(node);
+        return compileOperator(node, eq->left.get(), eq->op, eq->right.get());
+    }
+    case NodeKind::BinaryExpression:
+    {
+        auto *bin = static_cast<BinaryExpressionNode *>(node);
+        return compileOperator(node, bin->left.get(), bin->op, bin->right.get());
+    }
+    case NodeKind::OrExpression:
+    {
+        auto *orExpr = static_cast<OrExpressionNode *>(node);
+        return compileLogical(true, orExpr->left.get(), orExpr->right.get());
+    }
+    case NodeKind::AndExpression:
+    {
+        auto *andExpr = static_cast<AndExpressionNode *>(node);
+        return compileLogical(false, andExpr->left.get(), andExpr->right.get());
+    }
+    case NodeKind::UnaryExpression:
+        return compileUnary(static_cast<UnaryExpressionNode *>(node));
+    default:
+        return [node](Interpreter &interpreter)
+        { return interpreter.evaluate(node); };
+    }
+}
+
+ExpressionClosure ClosureCompiler::compileVariable(VariableExpressionNode *node)
+{
+    // Fields of `this` and unresolved names keep the interpreter's lookup
+    if (node->fieldCache || node->slot < 0)
+    {
+        return [node](Interpreter &interpreter)
+        { return interpreter.getVariable(node, node->depth, node->slot); };
+    }
+
+    int depth = node->depth;
+    int slot = node->slot;
+    const std::string *name = &node->name;
+    return [depth, slot, name](Interpreter &interpreter)
+    { return interpreter.environment->getAt(depth, slot, *name); };
+}
+
+// Comparison, equality and modulo, which the AST walker picks by operator
+// string on every evaluation
+ExpressionClosure ClosureCompiler::compileOperator(ExpressionNode *node, ExpressionNode *left,
+                                                     const std::string &op, ExpressionNode *right)
+{
+    bool isModulo = node->kind() == NodeKind::BinaryExpression;
+    if (isModulo && op != "%")
+    {
+        // The AST walker's + on a BinaryExpressionNode formats booleans itself
+        return [node](Interpreter &interpreter)
+        { return interpreter.evaluate(node); };
+    }
+
+    ExpressionClosure a = compileExpression(left);
+    ExpressionClosure b = compileExpression(right);
+    if (isModulo)
+    {
+        return binary(std::move(a), std::move(b), [](const Value &l, const Value &r)
+                      {
+                          int leftInt = l.asInt();
+                          int rightInt = r.asInt();
+                          if (rightInt == 0)
+                              throw std::runtime_error("Modulo by zero");
+                          return Value(leftInt % rightInt);
+                      });
+    }
+    if (op == "<")
+        return binary(std::move(a), std::move(b), [](const Value &l, const Value &r)
+                      { return Value(l < r); });
+    if (op == ">")
+        return binary(std::move(a), std::move(b), [](const Value &l, const Value &r)
+                      { return Value(l > r); });
+    if (op == "<=")
+        return binary(std::move(a), std::move(b), [](const Value &l, const Value &r)
+                      { return Value(l <= r); });
+    if (op == ">=")
+        return binary(std::move(a), std::move(b), [](const Value &l, const Value &r)
+                      { return Value(l >= r); });
+    if (op == "==")
+        return binary(std::move(a), std::move(b), [](const Value &l, const Value &r)
+                      { return Value(l == r); });
+    if (op == "!=")
+        return binary(std::move(a), std::move(b), [](const Value &l, const Value &r)
+                      { return Value(l != r); });
+
+    // Unknown operators throw when they run, like on the AST walker
+    return [node](Interpreter &interpreter)
+    { return interpreter.evaluate(node); };
+}
+
+ExpressionClosure ClosureCompiler::compileLogical(bool isOr, ExpressionNode *left, ExpressionNode *right)
+{
+    ExpressionClosure a = compileExpression(left);
+    ExpressionClosure b = compileExpression(right);
+    return [a = std::move(a), b = std::move(b), isOr](Interpreter &interpreter)
+    {
+        // Short-circuit evaluation
+        if (a(interpreter).asBool() == isOr)
+        {
+            return Value(isOr);
+        }
+        return Value(b(interpreter).asBool());
+    };
+}
+
+ExpressionClosure ClosureCompiler::compileUnary(UnaryExpressionNode *node)
+{
+    if (node->op == "-" || node->op == "!")
+    {
+        ExpressionClosure operand = compileExpression(node->operand.get());
+        if (node->op == "!")
+        {
+            return [operand = std::move(operand)](Interpreter &interpreter)
+            { return Value(!operand(interpreter).asBool()); };
+        }
+        return [operand = std::move(operand)](Interpreter &interpreter)
+        {
+            Value value = operand(interpreter);
+            if (value.isInteger())
+                return Value(-value.asInt());
+            if (value.isFloat())
+                return Value(-value.asFloat());
+            throw std::runtime_error("Cannot negate non-numeric value");
+        };
+    }
+
+    auto variable = nodeCast<VariableExpressionNode>(node->operand.get());
+    if (!variable || (node->op != "++" && node->op != "--"))
+    {
+        // Members are incremented by the AST walker
+        return [node](Interpreter &interpreter)
+        { return interpreter.evaluate(node); };
+    }
+
+    bool increment = node->op == "++";
+    bool isPrefix = node->isPrefix;
+    return [variable, increment, isPrefix](Interpreter &interpreter)
+    {
+        Value current = interpreter.getVariable(variable, variable->depth, variable->slot);
+        Value next;
+        if (current.isInteger())
+        {
+            next = Value(current.asInt() + (increment ? 1 : -1));
+        }
+        else if (current.isFloat())
+        {
+            next = Value(current.asFloat() + (increment ? 1.0f : -1.0f));
+        }
+        else
+        {
+            throw std::runtime_error(increment ? "Cannot increment non-numeric value"
+                                               : "Cannot decrement non-numeric value");
+        }
+        interpreter.setVariable(variable, variable->depth, variable->slot, next);
+        return isPrefix ? next : current;
+    };
+}
+
+ExpressionClosure ClosureCompiler::compileAssignment(AssignmentExpressionNode *node)
+{
+    auto variable = nodeCast<VariableExpressionNode>(node->left.get());
+    const std::string &op = node->op;
+    if (!variable || (op != "=" && op != "+=" && op != "-=" && op != "*=" && op != "/=" && op != "%="))
+    {
+        // Members are assigned by the AST walker
+        return [node](Interpreter &interpreter)
+        { return interpreter.evaluate(node); };
+    }
+
+    ExpressionClosure right = compileExpression(node->right.get());
+    int depth = node->depth;
+    int slot = node->slot;
+    if (op == "=")
+    {
+        return [right = std::move(right), variable, depth, slot](Interpreter &interpreter)
+        {
+            Value value = right(interpreter);
+            interpreter.setVariable(variable, depth, slot, value);
+            return value;
+        };
+    }
+
+    char compound = op[0];
+    return [right = std::move(right), variable, depth, slot, compound](Interpreter &interpreter)
+    {
+        Value rhs = right(interpreter);
+        Value lhs = interpreter.getVariable(variable, depth, slot);
+        Value result;
+        switch (compound)
+        {
+        case '+':
+            result = lhs + rhs;
+            break;
+        case '-':
+            result = lhs - rhs;
+            break;
+        case '*':
+            result = lhs * rhs;
+            break;
+        case '/':
+            result = lhs / rhs;
+            break;
+        default:
+            result = Value(lhs.asInt() % rhs.asInt());
+            break;
+        }
+        interpreter.setVariable(variable, depth, slot, result);
+        return result;
+    };
+}
+
+ExpressionClosure ClosureCompiler::compileCall(CallExpressionNode *node)
+{
+    std::vector<ExpressionClosure> arguments;
+    for (const auto &argument : node->arguments)
+    {
+        arguments.push_back(compileExpression(argument.get()));
+    }
+
+    if (auto member = nodeCast<MemberAccessExpressionNode>(node->callee.get()))
+    {
+        // Method call: the method is found through the call site's cache
+        ExpressionClosure object = compileExpression(member->object.get());
+        const std::string *name = &member->memberName;
+        return [object = std::move(object), arguments = std::move(arguments), node, name](Interpreter &interpreter)
+        {
+            Value self = object(interpreter);
+            std::shared_ptr<Function> method = interpreter.findMethod(node, *name, self);
+
+            Interpreter::ArgumentFrame frame(interpreter.argumentStack);
+            for (const auto &argument : arguments)
+            {
+                interpreter.argumentStack.push_back(argument(interpreter));
+            }
+            return interpreter.callFunction(method, frame.arguments(), self);
+        };
+    }
+
+    ExpressionClosure callee = compileExpression(node->callee.get());
+    return [callee = std::move(callee), arguments = std::move(arguments)](Interpreter &interpreter)
+    {
+        Value function = callee(interpreter);
+
+        Interpreter::ArgumentFrame frame(interpreter.argumentStack);
+        for (const auto &argument : arguments)
+        {
+            interpreter.argumentStack.push_back(argument(interpreter));
+        }
+        return interpreter.callValue(function, frame.arguments());
+    };
+}
+
+ExpressionClosure ClosureCompiler::compileMemberAccess(MemberAccessExpressionNode *node)
+{
+    ExpressionClosure object = compileExpression(node->object.get());
+    return [object = std::move(object), node](Interpreter &interpreter)
+    { return interpreter.getMember(node, object(interpreter)); };
+}
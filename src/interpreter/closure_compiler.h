@@ -0,0 +1,55 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "interpreter.h"
+
+// A compiled expression or statement. It runs in the interpreter's current
+// environment, like Interpreter::evaluate and Interpreter::execute
+using ExpressionClosure = std::function<Value(Interpreter &)>;
+using StatementClosure = std::function<Completion(Interpreter &)>;
+
+// The compiled statements of a function body
+struct ClosureBody
+{
+    std::vector<StatementClosure> statements;
+};
+
+// Lowers the AST into a tree of pre-bound C++ callables.
+//
+// Each node is compiled once into a closure that captures its compiled
+// children and everything else it needs: the operator is picked at compile
+// time, literals are built into Values and resolved variables keep their
+// depth and slot. Running a closure does no kind switch, operator string
+// comparison or child lookup. Nodes without a closure of their own (classes,
+// switches, imports, member assignment, ...) are handed to the AST walker, so
+// every program runs; their children are walked too.
+class ClosureCompiler
+{
+public:
+    static std::shared_ptr<ClosureBody> compile(BlockStatementNode *body);
+
+    static StatementClosure compileStatement(ASTNode *node);
+    static ExpressionClosure compileExpression(ExpressionNode *node);
+
+private:
+    // Statements
+    static StatementClosure compileBlock(BlockStatementNode *node);
+    static StatementClosure compileVariableDeclaration(VariableDeclarationNode *node);
+    static StatementClosure compileIf(IfStatementNode *node);
+    static StatementClosure compileWhile(WhileStatementNode *node);
+    static StatementClosure compileFor(ForStatementNode *node);
+    static StatementClosure compileReturn(ReturnStatementNode *node);
+    static StatementClosure compileConsoleLog(ConsoleLogNode *node);
+
+    // Expressions
+    static ExpressionClosure compileVariable(VariableExpressionNode *node);
+    static ExpressionClosure compileOperator(ExpressionNode *node, ExpressionNode *left,
+                                             const std::string &op, ExpressionNode *right);
+    static ExpressionClosure compileLogical(bool isOr, ExpressionNode *left, ExpressionNode *right);
+    static ExpressionClosure compileUnary(UnaryExpressionNode *node);
+    static ExpressionClosure compileAssignment(AssignmentExpressionNode *node);
+    static ExpressionClosure compileCall(CallExpressionNode *node);
+    static ExpressionClosure compileMemberAccess(MemberAccessExpressionNode *node);
+};
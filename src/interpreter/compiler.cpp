@@ -0,0 +1,1088 @@
+#include "compiler.h"
+#include "../debug.h"
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+std::shared_ptr<BytecodeFunction> BytecodeCompiler::compile(FunctionNode *node)
+{
+    if (!node || !node->body)
+    {
+        return nullptr;
+    }
+
+    BytecodeCompiler compiler;
+    compiler.function = std::make_shared<BytecodeFunction>();
+    compiler.function->name = node->name;
+    compiler.currentLine = node->getLine();
+
+    try
+    {
+        // Parameters and the top level statements of the body share one scope,
+        // just like callFunction binds both into the same Environment
+        compiler.beginScope();
+        for (const auto &param : node->parameters)
+        {
+            compiler.declareLocal(param->name, compiler.allocateRegister());
+        }
+        compiler.function->parameterCount = static_cast<uint16_t>(node->parameters.size());
+
+        for (const auto &statement : node->body->statements)
+        {
+            compiler.compileStatement(statement.get());
+        }
+        compiler.emit(OpCode::ReturnNull);
+    }
+    catch (const Unsupported &e)
+    {
+        TRACE(Interpreter, Debug, "Bytecode compiler: keeping '", node->name, "' on the AST interpreter (", e.what(), ")");
+        return nullptr;
+    }
+
+    TRACE(Interpreter, Debug, "Bytecode compiler: compiled '", node->name, "' into ", compiler.function->code.size(),
+              " instructions using ", compiler.function->registerCount, " registers");
+    return compiler.function;
+}
+
+// Register allocation and scopes
+
+uint16_t BytecodeCompiler::allocateRegister()
+{
+    if (nextRegister == std::numeric_limits<uint16_t>::max())
+    {
+        throw Unsupported("too many registers");
+    }
+
+    uint16_t reg = nextRegister++;
+    if (nextRegister > function->registerCount)
+    {
+        function->registerCount = nextRegister;
+    }
+    return reg;
+}
+
+void BytecodeCompiler::beginScope()
+{
+    scopes.push_back({{}, nextRegister});
+}
+
+void BytecodeCompiler::endScope()
+{
+    // Locals are never captured, so their registers can be reused right away
+    nextRegister = scopes.back().mark;
+    localTop = scopes.back().mark;
+    scopes.pop_back();
+}
+
+void BytecodeCompiler::declareLocal(const std::string &name, uint16_t reg)
+{
+    scopes.back().locals[name] = reg;
+    localTop = nextRegister = reg + 1;
+}
+
+bool BytecodeCompiler::resolveLocal(const std::string &name, uint16_t &reg) const
+{
+    for (auto it = scopes.rbegin(); it != scopes.rend(); ++it)
+    {
+        auto local = it->locals.find(name);
+        if (local != it->locals.end())
+        {
+            reg = local->second;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Emission helpers
+
+size_t BytecodeCompiler::emit(OpCode op, uint16_t a, uint16_t b, uint16_t c)
+{
+    function->code.emplace_back(op, a, b, c);
+    function->lines.push_back(currentLine);
+    return function->code.size() - 1;
+}
+
+size_t BytecodeCompiler::emitJump(OpCode op, uint16_t a)
+{
+    return emit(op, a);
+}
+
+void BytecodeCompiler::patchJump(size_t index)
+{
+    function->code[index].setOffset(static_cast<int32_t>(function->code.size() - (index + 1)));
+}
+
+void BytecodeCompiler::emitLoop(OpCode op, size_t target, uint16_t a)
+{
+    size_t index = emit(op, a);
+    function->code[index].setOffset(static_cast<int32_t>(target) - static_cast<int32_t>(index + 1));
+}
+
+uint16_t BytecodeCompiler::addConstant(const Value &value)
+{
+    auto &constants = function->constants;
+    for (size_t i = 0; i < constants.size(); i++)
+    {
+        if (constants[i].getType() == value.getType() && constants[i] == value)
+        {
+            return static_cast<uint16_t>(i);
+        }
+    }
+
+    if (constants.size() >= std::numeric_limits<uint16_t>::max())
+    {
+        throw Unsupported("too many constants");
+    }
+    constants.push_back(value);
+    return static_cast<uint16_t>(constants.size() - 1);
+}
+
+uint16_t BytecodeCompiler::addName(const std::string &name)
+{
+    auto &names = function->names;
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        if (names[i] == name)
+        {
+            return static_cast<uint16_t>(i);
+        }
+    }
+
+    if (names.size() >= std::numeric_limits<uint16_t>::max())
+    {
+        throw Unsupported("too many names");
+    }
+    names.push_back(name);
+    return static_cast<uint16_t>(names.size() - 1);
+}
+
+// Statements
+
+void BytecodeCompiler::compileStatement(ASTNode *node)
+{
+    if (!node)
+    {
+        return;
+    }
+
+    currentLine = node->getLine();
+    uint16_t mark = nextRegister;
+
+    switch (node->kind())
+    {
+    case NodeKind::BlockStatement:
+        compileBlock(static_cast<BlockStatementNode *>(node));
+        break;
+    case NodeKind::VariableDeclaration:
+        compileVariableDeclaration(static_cast<VariableDeclarationNode *>(node));
+        break;
+    case NodeKind::IfStatement:
+        compileIf(static_cast<IfStatementNode *>(node));
+        break;
+    case NodeKind::WhileStatement:
+        compileWhile(static_cast<WhileStatementNode *>(node));
+        break;
+    case NodeKind::ForStatement:
+        compileFor(static_cast<ForStatementNode *>(node));
+        break;
+    case NodeKind::SwitchStatement:
+        compileSwitch(static_cast<SwitchStatementNode *>(node));
+        break;
+    case NodeKind::BreakStatement:
+        compileBreak();
+        break;
+    case NodeKind::ContinueStatement:
+        compileContinue();
+        break;
+    case NodeKind::ReturnStatement:
+        compileReturn(static_cast<ReturnStatementNode *>(node));
+        break;
+    case NodeKind::ExpressionStatement:
+        compileEffect(static_cast<ExpressionStatementNode *>(node)->expression.get());
+        break;
+    case NodeKind::ConsoleLog:
+    {
+        auto *consoleLog = static_cast<ConsoleLogNode *>(node);
+        uint16_t reg = allocateRegister();
+        if (consoleLog->expression)
+        {
+            compileExpression(consoleLog->expression.get(), reg);
+        }
+        else
+        {
+            emit(OpCode::LoadConst, reg, addConstant(Value(std::string(""))));
+        }
+        emit(OpCode::Print, reg);
+        break;
+    }
+    default:
+        throw Unsupported(std::string("statement ") + typeid(*node).name());
+    }
+
+    // Temporaries die with the statement, declared locals live until their scope ends
+    freeRegisters(std::max(mark, localTop));
+}
+
+void BytecodeCompiler::compileBlock(BlockStatementNode *node)
+{
+    beginScope();
+    for (const auto &statement : node->statements)
+    {
+        compileStatement(statement.get());
+    }
+    endScope();
+}
+
+void BytecodeCompiler::compileVariableDeclaration(VariableDeclarationNode *node)
+{
+    uint16_t reg = allocateRegister();
+
+    if (node->initializer)
+    {
+        // The initializer still sees any outer variable with the same name
+        compileExpression(node->initializer.get(), reg);
+    }
+    else if (node->typeName == "int")
+        emit(OpCode::LoadConst, reg, addConstant(Value(0)));
+    else if (node->typeName == "float")
+        emit(OpCode::LoadConst, reg, addConstant(Value(0.0f)));
+    else if (node->typeName == "string")
+        emit(OpCode::LoadConst, reg, addConstant(Value(std::string(""))));
+    else if (node->typeName == "bool")
+        emit(OpCode::LoadBool, reg, 0);
+    else
+        emit(OpCode::LoadNull, reg);
+
+    // Redeclaring a name in the same scope overwrites it, like Environment::define
+    auto existing = scopes.back().locals.find(node->name);
+    if (existing != scopes.back().locals.end())
+    {
+        emit(OpCode::Move, existing->second, reg);
+        freeRegisters(reg);
+        return;
+    }
+
+    declareLocal(node->name, reg);
+}
+
+void BytecodeCompiler::compileIf(IfStatementNode *node)
+{
+    uint16_t mark = nextRegister;
+    uint16_t condition = compileOperand(node->condition.get());
+    size_t elseJump = emitJump(OpCode::JumpIfFalse, condition);
+    freeRegisters(mark);
+
+    compileStatement(node->thenBranch.get());
+
+    if (node->elseBranch)
+    {
+        size_t endJump = emitJump(OpCode::Jump);
+        patchJump(elseJump);
+        compileStatement(node->elseBranch.get());
+        patchJump(endJump);
+    }
+    else
+    {
+        patchJump(elseJump);
+    }
+}
+
+void BytecodeCompiler::compileWhile(WhileStatementNode *node)
+{
+    size_t loopStart = function->code.size();
+
+    uint16_t mark = nextRegister;
+    uint16_t condition = compileOperand(node->condition.get());
+    size_t exitJump = emitJump(OpCode::JumpIfFalse, condition);
+    freeRegisters(mark);
+
+    breakTargets.emplace_back(true);
+    compileStatement(node->body.get());
+    patchContinues();
+    emitLoop(OpCode::Jump, loopStart);
+
+    patchJump(exitJump);
+    for (size_t jump : breakTargets.back().breakJumps)
+    {
+        patchJump(jump);
+    }
+    breakTargets.pop_back();
+}
+
+void BytecodeCompiler::compileFor(ForStatementNode *node)
+{
+    beginScope();
+
+    if (node->initializer)
+    {
+        compileStatement(node->initializer.get());
+    }
+
+    size_t loopStart = function->code.size();
+    bool hasExit = false;
+    size_t exitJump = 0;
+    if (node->condition)
+    {
+        uint16_t mark = nextRegister;
+        uint16_t condition = compileOperand(node->condition.get());
+        exitJump = emitJump(OpCode::JumpIfFalse, condition);
+        hasExit = true;
+        freeRegisters(mark);
+    }
+
+    breakTargets.emplace_back(true);
+    compileStatement(node->body.get());
+
+    // Continue still runs the increment
+    patchContinues();
+    if (node->increment)
+    {
+        uint16_t mark = nextRegister;
+        compileEffect(node->increment.get());
+        freeRegisters(mark);
+    }
+
+    // Without a condition the AST interpreter runs the body exactly once
+    if (node->condition)
+    {
+        emitLoop(OpCode::Jump, loopStart);
+    }
+
+    if (hasExit)
+    {
+        patchJump(exitJump);
+    }
+    for (size_t jump : breakTargets.back().breakJumps)
+    {
+        patchJump(jump);
+    }
+    breakTargets.pop_back();
+
+    endScope();
+}
+
+void BytecodeCompiler::compileSwitch(SwitchStatementNode *node)
+{
+    if (!node->condition)
+    {
+        throw Unsupported("switch without condition");
+    }
+
+    // Case bodies run in the enclosing scope, so the switch value is kept in a
+    // hidden local of that scope where the case bodies can't clobber it
+    uint16_t switchValue = allocateRegister();
+    compileExpression(node->condition.get(), switchValue);
+    localTop = nextRegister;
+
+    breakTargets.emplace_back(false);
+
+    // Switches over literals jump straight to their clause; other values,
+    // and the cases of other switches, go through the compare chain below
+    size_t switchIndex = 0;
+    if (node->table)
+    {
+        if (function->switches.size() >= std::numeric_limits<uint16_t>::max())
+        {
+            throw Unsupported("too many switches");
+        }
+        switchIndex = function->switches.size();
+        function->switches.push_back({node->table.get(), {}});
+        emit(OpCode::Switch, switchValue, static_cast<uint16_t>(switchIndex));
+    }
+    std::vector<uint32_t> bodies;
+
+    bool hasFallThrough = false;
+    size_t fallThroughJump = 0;
+    for (const auto &caseClause : node->cases)
+    {
+        bodies.push_back(0);
+        if (!caseClause)
+            continue;
+
+        bool hasNextCheck = false;
+        size_t nextCheckJump = 0;
+        if (!caseClause->isDefault && caseClause->caseExpression)
+        {
+            uint16_t mark = nextRegister;
+            uint16_t caseValue = allocateRegister();
+            compileExpression(caseClause->caseExpression.get(), caseValue);
+            emit(OpCode::Equal, caseValue, switchValue, caseValue);
+            nextCheckJump = emitJump(OpCode::JumpIfFalse, caseValue);
+            hasNextCheck = true;
+            freeRegisters(mark);
+        }
+
+        // A matched case falls through into the next body, skipping its check
+        if (hasFallThrough)
+        {
+            patchJump(fallThroughJump);
+        }
+
+        bodies.back() = static_cast<uint32_t>(function->code.size());
+        for (const auto &statement : caseClause->statements)
+        {
+            compileStatement(statement.get());
+        }
+
+        fallThroughJump = emitJump(OpCode::Jump);
+        hasFallThrough = true;
+
+        if (hasNextCheck)
+        {
+            patchJump(nextCheckJump);
+        }
+    }
+
+    if (hasFallThrough)
+    {
+        patchJump(fallThroughJump);
+    }
+    for (size_t jump : breakTargets.back().breakJumps)
+    {
+        patchJump(jump);
+    }
+    breakTargets.pop_back();
+
+    if (node->table)
+    {
+        bodies.push_back(static_cast<uint32_t>(function->code.size()));
+        function->switches[switchIndex].targets = std::move(bodies);
+    }
+}
+
+void BytecodeCompiler::compileBreak()
+{
+    if (breakTargets.empty())
+    {
+        // A stray break ends the function in the AST interpreter
+        emit(OpCode::ReturnNull);
+        return;
+    }
+    breakTargets.back().breakJumps.push_back(emitJump(OpCode::Jump));
+}
+
+void BytecodeCompiler::compileContinue()
+{
+    for (auto it = breakTargets.rbegin(); it != breakTargets.rend(); ++it)
+    {
+        if (it->isLoop)
+        {
+            it->continueJumps.push_back(emitJump(OpCode::Jump));
+            return;
+        }
+    }
+
+    // Same as a stray break
+    emit(OpCode::ReturnNull);
+}
+
+void BytecodeCompiler::patchContinues()
+{
+    for (size_t jump : breakTargets.back().continueJumps)
+    {
+        patchJump(jump);
+    }
+}
+
+void BytecodeCompiler::compileReturn(ReturnStatementNode *node)
+{
+    if (!node->expression)
+    {
+        emit(OpCode::ReturnNull);
+        return;
+    }
+
+    uint16_t mark = nextRegister;
+    if (node->tailCall)
+    {
+        // The Return only runs if the VM couldn't make the call in place of
+        // this frame
+        uint16_t value = allocateRegister();
+        compileCall(static_cast<CallExpressionNode *>(node->expression.get()), value, OpCode::TailCall);
+        emit(OpCode::Return, value);
+        freeRegisters(mark);
+        return;
+    }
+
+    uint16_t value = compileOperand(node->expression.get());
+    emit(OpCode::Return, value);
+    freeRegisters(mark);
+}
+
+// Expressions
+
+uint16_t BytecodeCompiler::compileOperand(ExpressionNode *expr)
+{
+    // Locals can be used in place without copying them into a temporary
+    if (auto varExpr = nodeCast<VariableExpressionNode>(expr))
+    {
+        uint16_t reg;
+        if (resolveLocal(varExpr->name, reg))
+        {
+            return reg;
+        }
+    }
+
+    uint16_t reg = allocateRegister();
+    compileExpression(expr, reg);
+    return reg;
+}
+
+void BytecodeCompiler::compileEffect(ExpressionNode *expr)
+{
+    if (!expr)
+    {
+        return;
+    }
+
+    if (auto assignExpr = nodeCast<AssignmentExpressionNode>(expr))
+    {
+        compileAssignment(assignExpr, 0, false);
+    }
+    else if (auto unaryExpr = nodeCast<UnaryExpressionNode>(expr);
+             unaryExpr && (unaryExpr->op == "++" || unaryExpr->op == "--"))
+    {
+        compileUnary(unaryExpr, 0, false);
+    }
+    else
+    {
+        uint16_t mark = nextRegister;
+        compileExpression(expr, allocateRegister());
+        freeRegisters(mark);
+    }
+}
+
+void BytecodeCompiler::compileExpression(ExpressionNode *expr, uint16_t dst)
+{
+    if (!expr)
+    {
+        emit(OpCode::LoadNull, dst);
+        return;
+    }
+
+    switch (expr->kind())
+    {
+    case NodeKind::VariableExpression:
+        compileVariable(static_cast<VariableExpressionNode *>(expr), dst);
+        break;
+    case NodeKind::IntegerLiteral:
+        emit(OpCode::LoadConst, dst, addConstant(Value(static_cast<IntegerLiteralNode *>(expr)->value)));
+        break;
+    case NodeKind::FloatingPointLiteral:
+        emit(OpCode::LoadConst, dst, addConstant(Value(static_cast<FloatingPointLiteralNode *>(expr)->value)));
+        break;
+    case NodeKind::StringLiteral:
+        emit(OpCode::LoadConst, dst, addConstant(Value(static_cast<StringLiteralNode *>(expr)->value)));
+        break;
+    case NodeKind::BooleanLiteral:
+        emit(OpCode::LoadBool, dst, static_cast<BooleanLiteralNode *>(expr)->value ? 1 : 0);
+        break;
+    case NodeKind::NullLiteral:
+        emit(OpCode::LoadNull, dst);
+        break;
+    case NodeKind::AdditionExpression:
+    {
+        auto *addExpr = static_cast<AdditionExpressionNode *>(expr);
+        compileBinary(OpCode::Add, addExpr->left.get(), addExpr->right.get(), dst);
+        break;
+    }
+    case NodeKind::SubtractionExpression:
+    {
+        auto *subExpr = static_cast<SubtractionExpressionNode *>(expr);
+        compileBinary(OpCode::Subtract, subExpr->left.get(), subExpr->right.get(), dst);
+        break;
+    }
+    case NodeKind::MultiplicationExpression:
+    {
+        auto *mulExpr = static_cast<MultiplicationExpressionNode *>(expr);
+        compileBinary(OpCode::Multiply, mulExpr->left.get(), mulExpr->right.get(), dst);
+        break;
+    }
+    case NodeKind::DivisionExpression:
+    {
+        auto *divExpr = static_cast<DivisionExpressionNode *>(expr);
+        compileBinary(OpCode::Divide, divExpr->left.get(), divExpr->right.get(), dst);
+        break;
+    }
+    case NodeKind::ComparisonExpression:
+    {
+        auto *compExpr = static_cast<ComparisonExpressionNode *>(expr);
+        OpCode op;
+        if (compExpr->op == "<")
+            op = OpCode::Less;
+        else if (compExpr->op == "<=")
+            op = OpCode::LessEqual;
+        else if (compExpr->op == ">")
+            op = OpCode::Greater;
+        else if (compExpr->op == ">=")
+            op = OpCode::GreaterEqual;
+        else
+            throw Unsupported("comparison operator " + compExpr->op);
+        compileBinary(op, compExpr->left.get(), compExpr->right.get(), dst);
+        break;
+    }
+    case NodeKind::EqualityExpression:
+    {
+        auto *eqExpr = static_cast<EqualityExpressionNode *>(expr);
+        OpCode op;
+        if (eqExpr->op == "==")
+            op = OpCode::Equal;
+        else if (eqExpr->op == "!=")
+            op = OpCode::NotEqual;
+        else
+            throw Unsupported("equality operator " + eqExpr->op);
+        compileBinary(op, eqExpr->left.get(), eqExpr->right.get(), dst);
+        break;
+    }
+    case NodeKind::OrExpression:
+    {
+        auto *orExpr = static_cast<OrExpressionNode *>(expr);
+        compileLogical(true, orExpr->left.get(), orExpr->right.get(), dst);
+        break;
+    }
+    case NodeKind::AndExpression:
+    {
+        auto *andExpr = static_cast<AndExpressionNode *>(expr);
+        compileLogical(false, andExpr->left.get(), andExpr->right.get(), dst);
+        break;
+    }
+    case NodeKind::BinaryExpression:
+    {
+        auto *binaryExpr = static_cast<BinaryExpressionNode *>(expr);
+        OpCode op;
+        if (binaryExpr->op == "+")
+            op = OpCode::Add;
+        else if (binaryExpr->op == "-")
+            op = OpCode::Subtract;
+        else if (binaryExpr->op == "*")
+            op = OpCode::Multiply;
+        else if (binaryExpr->op == "/")
+            op = OpCode::Divide;
+        else if (binaryExpr->op == "%")
+            op = OpCode::Modulo;
+        else
+            throw Unsupported("binary operator " + binaryExpr->op);
+        compileBinary(op, binaryExpr->left.get(), binaryExpr->right.get(), dst);
+        break;
+    }
+    case NodeKind::UnaryExpression:
+        compileUnary(static_cast<UnaryExpressionNode *>(expr), dst, true);
+        break;
+    case NodeKind::AssignmentExpression:
+        compileAssignment(static_cast<AssignmentExpressionNode *>(expr), dst, true);
+        break;
+    case NodeKind::CallExpression:
+        compileCall(static_cast<CallExpressionNode *>(expr), dst);
+        break;
+    default:
+        throw Unsupported(std::string("expression ") + typeid(*expr).name());
+    }
+}
+
+void BytecodeCompiler::compileBinary(OpCode op, ExpressionNode *left, ExpressionNode *right, uint16_t dst)
+{
+    uint16_t mark = nextRegister;
+    uint16_t lhs = compileOperand(left);
+
+    // The left value must be read before the right operand gets a chance to change it
+    if (isLocal(lhs) && mutatesVariables(right))
+    {
+        uint16_t copy = allocateRegister();
+        emit(OpCode::Move, copy, lhs);
+        lhs = copy;
+    }
+
+    uint16_t rhs = compileOperand(right);
+    emit(op, dst, lhs, rhs);
+    freeRegisters(mark);
+}
+
+void BytecodeCompiler::compileLogical(bool isOr, ExpressionNode *left, ExpressionNode *right, uint16_t dst)
+{
+    // The left result is stored before the right side runs, so never build it
+    // directly in a local the right side might still read
+    uint16_t mark = nextRegister;
+    uint16_t target = isLocal(dst) ? allocateRegister() : dst;
+
+    compileExpression(left, target);
+    size_t shortCircuit = emitJump(isOr ? OpCode::JumpIfTrue : OpCode::JumpIfFalse, target);
+    compileExpression(right, target);
+    emit(OpCode::ToBool, target, target);
+    size_t endJump = emitJump(OpCode::Jump);
+    patchJump(shortCircuit);
+    emit(OpCode::LoadBool, target, isOr ? 1 : 0);
+    patchJump(endJump);
+
+    if (target != dst)
+    {
+        emit(OpCode::Move, dst, target);
+    }
+    freeRegisters(mark);
+}
+
+void BytecodeCompiler::compileVariable(VariableExpressionNode *node, uint16_t dst)
+{
+    uint16_t reg;
+    if (resolveLocal(node->name, reg))
+    {
+        if (reg != dst)
+        {
+            emit(OpCode::Move, dst, reg);
+        }
+        return;
+    }
+
+    // The resolver bound it to a scope outside this function, i.e. a closure
+    // variable. Those live in Environment slots the VM can't see.
+    if (node->slot >= 0)
+    {
+        throw Unsupported("captured variable " + node->name);
+    }
+
+    emit(OpCode::GetGlobal, dst, addName(node->name));
+}
+
+void BytecodeCompiler::compileAssignment(AssignmentExpressionNode *node, uint16_t dst, bool wantResult)
+{
+    auto varExpr = nodeCast<VariableExpressionNode>(node->left.get());
+    if (!varExpr)
+    {
+        throw Unsupported("assignment to non-variable");
+    }
+
+    bool isCompound = node->op != "=";
+    OpCode op = OpCode::Add;
+    if (node->op == "+=")
+        op = OpCode::Add;
+    else if (node->op == "-=")
+        op = OpCode::Subtract;
+    else if (node->op == "*=")
+        op = OpCode::Multiply;
+    else if (node->op == "/=")
+        op = OpCode::Divide;
+    else if (node->op == "%=")
+        op = OpCode::Modulo;
+    else if (isCompound)
+        throw Unsupported("assignment operator " + node->op);
+
+    uint16_t mark = nextRegister;
+    uint16_t local;
+    if (resolveLocal(varExpr->name, local))
+    {
+        if (!isCompound && !mutatesVariables(node->right.get()))
+        {
+            compileExpression(node->right.get(), local);
+        }
+        else if (!isCompound)
+        {
+            uint16_t value = allocateRegister();
+            compileExpression(node->right.get(), value);
+            emit(OpCode::Move, local, value);
+        }
+        else
+        {
+            // The right side is evaluated before the variable is read
+            uint16_t value = allocateRegister();
+            compileExpression(node->right.get(), value);
+            emit(op, local, local, value);
+        }
+
+        if (wantResult && dst != local)
+        {
+            emit(OpCode::Move, dst, local);
+        }
+    }
+    else
+    {
+        if (node->slot >= 0)
+        {
+            throw Unsupported("captured variable " + varExpr->name);
+        }
+
+        uint16_t name = addName(varExpr->name);
+        uint16_t value = allocateRegister();
+        compileExpression(node->right.get(), value);
+
+        if (isCompound)
+        {
+            uint16_t current = allocateRegister();
+            emit(OpCode::GetGlobal, current, name);
+            emit(op, value, current, value);
+        }
+        emit(OpCode::SetGlobal, value, name);
+
+        if (wantResult)
+        {
+            emit(OpCode::Move, dst, value);
+        }
+    }
+    freeRegisters(mark);
+}
+
+void BytecodeCompiler::compileUnary(UnaryExpressionNode *node, uint16_t dst, bool wantResult)
+{
+    if (node->op == "-" || node->op == "!")
+    {
+        uint16_t mark = nextRegister;
+        uint16_t operand = compileOperand(node->operand.get());
+        emit(node->op == "-" ? OpCode::Negate : OpCode::Not, dst, operand);
+        freeRegisters(mark);
+        return;
+    }
+
+    if (node->op != "++" && node->op != "--")
+    {
+        throw Unsupported("unary operator " + node->op);
+    }
+
+    auto varExpr = nodeCast<VariableExpressionNode>(node->operand.get());
+    if (!varExpr)
+    {
+        throw Unsupported("increment of non-variable");
+    }
+
+    OpCode op = node->op == "++" ? OpCode::Increment : OpCode::Decrement;
+    uint16_t mark = nextRegister;
+    uint16_t local;
+    if (resolveLocal(varExpr->name, local))
+    {
+        if (wantResult && !node->isPrefix)
+        {
+            emit(OpCode::Move, dst, local);
+        }
+        emit(op, local, local);
+        if (wantResult && node->isPrefix && dst != local)
+        {
+            emit(OpCode::Move, dst, local);
+        }
+    }
+    else
+    {
+        if (varExpr->slot >= 0)
+        {
+            throw Unsupported("captured variable " + varExpr->name);
+        }
+
+        uint16_t name = addName(varExpr->name);
+        uint16_t value = allocateRegister();
+        emit(OpCode::GetGlobal, value, name);
+        if (wantResult && !node->isPrefix)
+        {
+            emit(OpCode::Move, dst, value);
+        }
+        emit(op, value, value);
+        emit(OpCode::SetGlobal, value, name);
+        if (wantResult && node->isPrefix)
+        {
+            emit(OpCode::Move, dst, value);
+        }
+    }
+    freeRegisters(mark);
+}
+
+void BytecodeCompiler::compileCall(CallExpressionNode *node, uint16_t dst, OpCode op)
+{
+    auto calleeVar = nodeCast<VariableExpressionNode>(node->callee.get());
+    if (!calleeVar)
+    {
+        throw Unsupported("call through non-variable callee");
+    }
+    if (node->arguments.size() > std::numeric_limits<uint16_t>::max())
+    {
+        throw Unsupported("too many arguments");
+    }
+
+    // Callee and arguments occupy consecutive registers so the VM can use them
+    // as the parameter registers of the called frame
+    uint16_t mark = nextRegister;
+    uint16_t base = allocateRegister();
+    compileVariable(calleeVar, base);
+    for (const auto &arg : node->arguments)
+    {
+        compileExpression(arg.get(), allocateRegister());
+    }
+
+    emit(op, base, 0, static_cast<uint16_t>(node->arguments.size()));
+    if (dst != base)
+    {
+        emit(OpCode::Move, dst, base);
+    }
+    freeRegisters(mark);
+}
+
+bool BytecodeCompiler::mutatesVariables(ExpressionNode *expr)
+{
+    if (!expr)
+        return false;
+
+    if (nodeCast<AssignmentExpressionNode>(expr))
+        return true;
+    if (auto unaryExpr = nodeCast<UnaryExpressionNode>(expr))
+        return unaryExpr->op == "++" || unaryExpr->op == "--" || mutatesVariables(unaryExpr->operand.get());
+    if (auto addExpr = nodeCast<AdditionExpressionNode>(expr))
+        return mutatesVariables(addExpr->left.get()) || mutatesVariables(addExpr->right.get());
+    if (auto subExpr = nodeCast<SubtractionExpressionNode>(expr))
+        return mutatesVariables(subExpr->left.get()) || mutatesVariables(subExpr->right.get());
+    if (auto mulExpr = nodeCast<MultiplicationExpressionNode>(expr))
+        return mutatesVariables(mulExpr->left.get()) || mutatesVariables(mulExpr->right.get());
+    if (auto divExpr = nodeCast<DivisionExpressionNode>(expr))
+        return mutatesVariables(divExpr->left.get()) || mutatesVariables(divExpr->right.get());
+    if (auto compExpr = nodeCast<ComparisonExpressionNode>(expr))
+        return mutatesVariables(compExpr->left.get()) || mutatesVariables(compExpr->right.get());
+    if (auto eqExpr = nodeCast<EqualityExpressionNode>(expr))
+        return mutatesVariables(eqExpr->left.get()) || mutatesVariables(eqExpr->right.get());
+    if (auto orExpr = nodeCast<OrExpressionNode>(expr))
+        return mutatesVariables(orExpr->left.get()) || mutatesVariables(orExpr->right.get());
+    if (auto andExpr = nodeCast<AndExpressionNode>(expr))
+        return mutatesVariables(andExpr->left.get()) || mutatesVariables(andExpr->right.get());
+    if (auto binaryExpr = nodeCast<BinaryExpressionNode>(expr))
+        return mutatesVariables(binaryExpr->left.get()) || mutatesVariables(binaryExpr->right.get());
+    if (auto callExpr = nodeCast<CallExpressionNode>(expr))
+    {
+        // Calls can't reach our registers, only their arguments can
+        for (const auto &arg : callExpr->arguments)
+        {
+            if (mutatesVariables(arg.get()))
+                return true;
+        }
+        return false;
+    }
+    return false;
+}
+
+// Disassembly
+
+const char *opCodeName(OpCode op)
+{
+    switch (op)
+    {
+    case OpCode::Move:
+        return "MOVE";
+    case OpCode::LoadConst:
+        return "LOADK";
+    case OpCode::LoadNull:
+        return "LOADNULL";
+    case OpCode::LoadBool:
+        return "LOADBOOL";
+    case OpCode::GetGlobal:
+        return "GETGLOBAL";
+    case OpCode::SetGlobal:
+        return "SETGLOBAL";
+    case OpCode::Add:
+        return "ADD";
+    case OpCode::Subtract:
+        return "SUB";
+    case OpCode::Multiply:
+        return "MUL";
+    case OpCode::Divide:
+        return "DIV";
+    case OpCode::Modulo:
+        return "MOD";
+    case OpCode::Less:
+        return "LT";
+    case OpCode::LessEqual:
+        return "LE";
+    case OpCode::Greater:
+        return "GT";
+    case OpCode::GreaterEqual:
+        return "GE";
+    case OpCode::Equal:
+        return "EQ";
+    case OpCode::NotEqual:
+        return "NE";
+    case OpCode::Negate:
+        return "NEG";
+    case OpCode::Not:
+        return "NOT";
+    case OpCode::ToBool:
+        return "TOBOOL";
+    case OpCode::Increment:
+        return "INC";
+    case OpCode::Decrement:
+        return "DEC";
+    case OpCode::Jump:
+        return "JMP";
+    case OpCode::JumpIfFalse:
+        return "JMPF";
+    case OpCode::JumpIfTrue:
+        return "JMPT";
+    case OpCode::Switch:
+        return "SWITCH";
+    case OpCode::Call:
+        return "CALL";
+    case OpCode::TailCall:
+        return "TAILCALL";
+    case OpCode::Print:
+        return "PRINT";
+    case OpCode::Return:
+        return "RET";
+    case OpCode::ReturnNull:
+        return "RETNULL";
+    }
+    return "???";
+}
+
+std::string BytecodeFunction::disassemble() const
+{
+    std::ostringstream out;
+    out << "== " << name << " (" << parameterCount << " params, " << registerCount << " registers) ==\n";
+
+    for (size_t i = 0; i < code.size(); i++)
+    {
+        const Instruction &ins = code[i];
+        out << i << "\t[line " << lines[i] << "]\t" << opCodeName(ins.op) << "\t";
+
+        switch (ins.op)
+        {
+        case OpCode::Jump:
+            out << "-> " << static_cast<int64_t>(i) + 1 + ins.offset();
+            break;
+        case OpCode::JumpIfFalse:
+        case OpCode::JumpIfTrue:
+            out << "R" << ins.a << " -> " << static_cast<int64_t>(i) + 1 + ins.offset();
+            break;
+        case OpCode::Switch:
+            out << "R" << ins.a << " S" << ins.b << " ->";
+            for (uint32_t target : switches[ins.b].targets)
+            {
+                out << " " << target;
+            }
+            break;
+        case OpCode::LoadConst:
+            out << "R" << ins.a << " K" << ins.b << " (" << constants[ins.b].toString() << ")";
+            break;
+        case OpCode::GetGlobal:
+        case OpCode::SetGlobal:
+            out << "R" << ins.a << " " << names[ins.b];
+            break;
+        case OpCode::LoadBool:
+            out << "R" << ins.a << " " << (ins.b ? "true" : "false");
+            break;
+        case OpCode::Call:
+        case OpCode::TailCall:
+            out << "R" << ins.a << " (" << ins.c << " args)";
+            break;
+        case OpCode::LoadNull:
+        case OpCode::Print:
+        case OpCode::Return:
+            out << "R" << ins.a;
+            break;
+        case OpCode::ReturnNull:
+            break;
+        case OpCode::Move:
+        case OpCode::Negate:
+        case OpCode::Not:
+        case OpCode::ToBool:
+        case OpCode::Increment:
+        case OpCode::Decrement:
+            out << "R" << ins.a << " R" << ins.b;
+            break;
+        default:
+            out << "R" << ins.a << " R" << ins.b << " R" << ins.c;
+            break;
+        }
+        out << "\n";
+    }
+    return out.str();
+}
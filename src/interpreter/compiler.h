@@ -0,0 +1,97 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "bytecode.h"
+
+// Lowers a function body into bytecode for the VM.
+//
+// Only the subset of the language the VM knows how to run is compiled. When a
+// function uses anything else (methods, member access, nested functions, ...)
+// compile() returns nullptr and the caller keeps using the AST interpreter for
+// that function.
+class BytecodeCompiler
+{
+public:
+    static std::shared_ptr<BytecodeFunction> compile(FunctionNode *node);
+
+private:
+    // Thrown internally when the function can not be compiled
+    class Unsupported : public std::runtime_error
+    {
+    public:
+        Unsupported(const std::string &what) : std::runtime_error(what) {}
+    };
+
+    struct Scope
+    {
+        std::map<std::string, uint16_t> locals;
+        uint16_t mark; // First register owned by the scope
+    };
+
+    struct BreakTarget
+    {
+        explicit BreakTarget(bool isLoop) : isLoop(isLoop) {}
+
+        bool isLoop; // Switches take break but pass continue on
+        std::vector<size_t> breakJumps;
+        std::vector<size_t> continueJumps;
+    };
+
+    std::shared_ptr<BytecodeFunction> function;
+    std::vector<Scope> scopes;
+    std::vector<BreakTarget> breakTargets;
+    uint16_t nextRegister = 0;
+    uint16_t localTop = 0; // Registers below this index hold declared locals
+    int currentLine = 0;
+
+    BytecodeCompiler() = default;
+
+    // Register allocation
+    uint16_t allocateRegister();
+    void freeRegisters(uint16_t mark) { nextRegister = mark; }
+    bool isLocal(uint16_t reg) const { return reg < localTop; }
+
+    // Scopes
+    void beginScope();
+    void endScope();
+    void declareLocal(const std::string &name, uint16_t reg);
+    bool resolveLocal(const std::string &name, uint16_t &reg) const;
+
+    // Emission helpers
+    size_t emit(OpCode op, uint16_t a = 0, uint16_t b = 0, uint16_t c = 0);
+    size_t emitJump(OpCode op, uint16_t a = 0);
+    void patchJump(size_t index);
+    void emitLoop(OpCode op, size_t target, uint16_t a = 0);
+    uint16_t addConstant(const Value &value);
+    uint16_t addName(const std::string &name);
+
+    // Statements
+    void compileStatement(ASTNode *node);
+    void compileBlock(BlockStatementNode *node);
+    void compileVariableDeclaration(VariableDeclarationNode *node);
+    void compileIf(IfStatementNode *node);
+    void compileWhile(WhileStatementNode *node);
+    void compileFor(ForStatementNode *node);
+    void compileSwitch(SwitchStatementNode *node);
+    void compileBreak();
+    void compileContinue();
+    void patchContinues();
+    void compileReturn(ReturnStatementNode *node);
+
+    // Expressions
+    void compileExpression(ExpressionNode *expr, uint16_t dst);
+    uint16_t compileOperand(ExpressionNode *expr);
+    void compileEffect(ExpressionNode *expr);
+    void compileBinary(OpCode op, ExpressionNode *left, ExpressionNode *right, uint16_t dst);
+    void compileLogical(bool isOr, ExpressionNode *left, ExpressionNode *right, uint16_t dst);
+    void compileVariable(VariableExpressionNode *node, uint16_t dst);
+    void compileAssignment(AssignmentExpressionNode *node, uint16_t dst, bool wantResult);
+    void compileUnary(UnaryExpressionNode *node, uint16_t dst, bool wantResult);
+    void compileCall(CallExpressionNode *node, uint16_t dst, OpCode op = OpCode::Call);
+
+    static bool mutatesVariables(ExpressionNode *expr);
+};
@@ -3,144 +3,180 @@
 #include "../parser/parser.h"    // Include for Parser and Tokenizer
 #include "../parser/tokenizer.h" // Include for Token
 #include "module_handler.h"      // Include for module function registry
+#include "compiler.h"            // Bytecode compiler
+#include "vm.h"                  // Bytecode VM
+#include "closure_compiler.h"    // Closure compiler
+#include "resolver.h"            // Variable slot resolution
 #include <iostream>
 #include <sstream>
 #include <fstream>
 #include <memory>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <optional>
 #include <set>
 #include <filesystem>
 
 // Initialize static global interpreter pointer
 Interpreter *Interpreter::globalInterpreter = nullptr;
 // Value implementation
-bool Value::asBool() const
+Value::Value(const std::string &val)
 {
-    if (type == Type::Boolean)
-    {
-        return std::get<bool>(value);
-    }
-    else if (type == Type::Integer)
+    auto cell = new StringCell();
+    cell->value = val;
+    bits = cellBits(Type::String, cell);
+}
+
+Value::Value(std::string &&val)
+{
+    auto cell = new StringCell();
+    cell->value = std::move(val);
+    bits = cellBits(Type::String, cell);
+}
+
+Value::Value(std::shared_ptr<void> val, Type t)
+{
+    auto cell = new ObjectCell();
+    cell->object = std::move(val);
+    bits = cellBits(t, cell);
+}
+
+uint64_t Value::floatBits(float val)
+{
+    // Every NaN becomes the one positive quiet NaN so it can't be mistaken
+    // for a boxed value
+    if (std::isnan(val))
     {
-        return std::get<int>(value) != 0;
+        return canonicalNaN;
     }
-    else if (type == Type::Float)
+    double wide = val;
+    uint64_t result;
+    std::memcpy(&result, &wide, sizeof(result));
+    return result;
+}
+
+float Value::floatPayload() const
+{
+    double wide;
+    std::memcpy(&wide, &bits, sizeof(wide));
+    return static_cast<float>(wide);
+}
+
+void Value::destroy()
+{
+    if (isString())
     {
-        return std::get<float>(value) != 0.0f;
+        delete static_cast<StringCell *>(cell());
     }
-    else if (type == Type::String)
+    else
     {
-        return !std::get<std::string>(value).empty();
+        delete static_cast<ObjectCell *>(cell());
     }
-    else if (type == Type::Null)
+}
+
+bool Value::asBool() const
+{
+    switch (getType())
     {
+    case Type::Boolean:
+        return boolPayload();
+    case Type::Integer:
+        return intPayload() != 0;
+    case Type::Float:
+        return floatPayload() != 0.0f;
+    case Type::String:
+        return !stringPayload().empty();
+    case Type::Null:
         return false;
+    default:
+        return true; // Objects, functions, and classes are truthy
     }
-    return true; // Objects, functions, and classes are truthy
 }
 
 int Value::asInt() const
 {
-    if (type == Type::Integer)
-    {
-        return std::get<int>(value);
-    }
-    else if (type == Type::Float)
-    {
-        return static_cast<int>(std::get<float>(value));
-    }
-    else if (type == Type::Boolean)
-    {
-        return std::get<bool>(value) ? 1 : 0;
-    }
-    else if (type == Type::String)
+    switch (getType())
     {
+    case Type::Integer:
+        return intPayload();
+    case Type::Float:
+        return static_cast<int>(floatPayload());
+    case Type::Boolean:
+        return boolPayload() ? 1 : 0;
+    case Type::String:
         try
         {
-            return std::stoi(std::get<std::string>(value));
+            return std::stoi(stringPayload());
         }
         catch (const std::exception &)
         {
             throw std::runtime_error("Cannot convert string to integer");
         }
+    default:
+        throw std::runtime_error("Cannot convert to integer");
     }
-    throw std::runtime_error("Cannot convert to integer");
 }
 
 float Value::asFloat() const
 {
-    if (type == Type::Float)
-    {
-        return std::get<float>(value);
-    }
-    else if (type == Type::Integer)
-    {
-        return static_cast<float>(std::get<int>(value));
-    }
-    else if (type == Type::Boolean)
-    {
-        return std::get<bool>(value) ? 1.0f : 0.0f;
-    }
-    else if (type == Type::String)
+    switch (getType())
     {
+    case Type::Float:
+        return floatPayload();
+    case Type::Integer:
+        return static_cast<float>(intPayload());
+    case Type::Boolean:
+        return boolPayload() ? 1.0f : 0.0f;
+    case Type::String:
         try
         {
-            return std::stof(std::get<std::string>(value));
+            return std::stof(stringPayload());
         }
         catch (const std::exception &)
         {
             throw std::runtime_error("Cannot convert string to float");
         }
+    default:
+        throw std::runtime_error("Cannot convert to float");
     }
-    throw std::runtime_error("Cannot convert to float");
 }
 
 std::string Value::asString() const
 {
-    if (type == Type::String)
+    if (isString())
     {
-        return std::get<std::string>(value);
+        return stringPayload();
     }
     // Special handling for boolean to ensure "true" or "false" string instead of "1" or "0"
-    if (type == Type::Boolean)
+    if (isBoolean())
     {
-        return std::get<bool>(value) ? "true" : "false";
+        return boolPayload() ? "true" : "false";
     }
     return toString();
 }
 
-template <typename T>
-std::shared_ptr<T> Value::asObject() const
-{
-    if (std::holds_alternative<std::shared_ptr<void>>(value))
-    {
-        return std::static_pointer_cast<T>(std::get<std::shared_ptr<void>>(value));
-    }
-    throw std::runtime_error("Value is not an object");
-}
-
 std::string Value::toString() const
 {
-    switch (type)
+    switch (getType())
     {
     case Type::Null:
         return "null";
     case Type::Boolean:
-        return std::get<bool>(value) ? "true" : "false";
+        return boolPayload() ? "true" : "false";
     case Type::Integer:
-        return std::to_string(std::get<int>(value));
+        return std::to_string(intPayload());
     case Type::Float:
     {
         // Format float to avoid trailing zeros
-        std::string result = std::to_string(std::get<float>(value));
+        std::string result = std::to_string(floatPayload());
         result.erase(result.find_last_not_of('0') + 1, std::string::npos);
         if (result.back() == '.')
             result.pop_back();
         return result;
     }
     case Type::String:
-        return std::get<std::string>(value);
+        return stringPayload();
     case Type::Object:
         return "[object Object]";
     case Type::Function:
@@ -154,16 +190,22 @@ std::string Value::toString() const
 
 Value Value::operator+(const Value &other) const
 {
+    // Integers first, they are by far the most common operands
+    if (isInteger() && other.isInteger())
+    {
+        return Value(intPayload() + other.intPayload());
+    }
+
     // Handle string concatenation
-    if (type == Type::String || other.type == Type::String)
+    if (isString() || other.isString())
     {
         // Special handling for boolean values in string concatenation
-        if (type == Type::Boolean)
+        if (isBoolean())
         {
-            std::string boolStr = std::get<bool>(value) ? "true" : "false";
+            std::string boolStr = boolPayload() ? "true" : "false";
             return Value(boolStr + other.toString());
         }
-        else if (other.type == Type::Boolean)
+        else if (other.isBoolean())
         {
             std::string boolStr = other.asBool() ? "true" : "false";
             return Value(toString() + boolStr);
@@ -175,7 +217,7 @@ Value Value::operator+(const Value &other) const
     }
 
     // Handle numeric addition
-    if (type == Type::Float || other.type == Type::Float)
+    if (isFloat() || other.isFloat())
     {
         return Value(asFloat() + other.asFloat());
     }
@@ -185,7 +227,7 @@ Value Value::operator+(const Value &other) const
 
 Value Value::operator-(const Value &other) const
 {
-    if (type == Type::Float || other.type == Type::Float)
+    if (isFloat() || other.isFloat())
     {
         return Value(asFloat() - other.asFloat());
     }
@@ -194,7 +236,7 @@ Value Value::operator-(const Value &other) const
 
 Value Value::operator*(const Value &other) const
 {
-    if (type == Type::Float || other.type == Type::Float)
+    if (isFloat() || other.isFloat())
     {
         return Value(asFloat() * other.asFloat());
     }
@@ -208,7 +250,7 @@ Value Value::operator/(const Value &other) const
         throw std::runtime_error("Division by zero");
     }
 
-    if (type == Type::Float || other.type == Type::Float)
+    if (isFloat() || other.isFloat())
     {
         return Value(asFloat() / other.asFloat());
     }
@@ -229,11 +271,13 @@ Value Value::operator%(const Value &other) const
 
 bool Value::operator==(const Value &other) const
 {
-    if (type != other.type)
+    Type type = getType();
+    Type otherType = other.getType();
+    if (type != otherType)
     {
         // Special case for numeric comparison
         if ((type == Type::Integer || type == Type::Float) &&
-            (other.type == Type::Integer || other.type == Type::Float))
+            (otherType == Type::Integer || otherType == Type::Float))
         {
             return asFloat() == other.asFloat();
         }
@@ -243,20 +287,19 @@ bool Value::operator==(const Value &other) const
     switch (type)
     {
     case Type::Null:
-        return true; // null == null
     case Type::Boolean:
-        return std::get<bool>(value) == std::get<bool>(other.value);
     case Type::Integer:
-        return std::get<int>(value) == std::get<int>(other.value);
+        // Inline payloads compare bit for bit
+        return bits == other.bits;
     case Type::Float:
-        return std::get<float>(value) == std::get<float>(other.value);
+        return floatPayload() == other.floatPayload();
     case Type::String:
-        return std::get<std::string>(value) == std::get<std::string>(other.value);
+        return bits == other.bits || stringPayload() == other.stringPayload();
     case Type::Object:
     case Type::Function:
     case Type::Class:
         // For objects, functions, and classes, compare by reference
-        return std::get<std::shared_ptr<void>>(value) == std::get<std::shared_ptr<void>>(other.value);
+        return bits == other.bits || objectPayload() == other.objectPayload();
     default:
         return false;
     }
@@ -269,14 +312,13 @@ bool Value::operator!=(const Value &other) const
 
 bool Value::operator<(const Value &other) const
 {
-    if ((type == Type::Integer || type == Type::Float) &&
-        (other.type == Type::Integer || other.type == Type::Float))
+    if ((isInteger() || isFloat()) && (other.isInteger() || other.isFloat()))
     {
         return asFloat() < other.asFloat();
     }
-    if (type == Type::String && other.type == Type::String)
+    if (isString() && other.isString())
     {
-        return std::get<std::string>(value) < std::get<std::string>(other.value);
+        return stringPayload() < other.stringPayload();
     }
     throw std::runtime_error("Cannot compare values of different types");
 }
@@ -296,6 +338,193 @@ bool Value::operator>=(const Value &other) const
     return *this > other || *this == other;
 }
 
+// Quickening of operator and field access sites, see Quickening in nodes.h
+
+static Quickening::Op decodeOperator(const std::string &op)
+{
+    static const std::unordered_map<std::string, Quickening::Op> operators = {
+        {"+", Quickening::Op::Add},
+        {"-", Quickening::Op::Subtract},
+        {"*", Quickening::Op::Multiply},
+        {"/", Quickening::Op::Divide},
+        {"%", Quickening::Op::Modulo},
+        {"<", Quickening::Op::Less},
+        {"<=", Quickening::Op::LessEqual},
+        {">", Quickening::Op::Greater},
+        {">=", Quickening::Op::GreaterEqual},
+        {"==", Quickening::Op::Equal},
+        {"!=", Quickening::Op::NotEqual},
+        {"++", Quickening::Op::Increment},
+        {"--", Quickening::Op::Decrement}};
+    auto it = operators.find(op);
+    return it != operators.end() ? it->second : Quickening::Op::None;
+}
+
+// Counts one more evaluation of an Unknown site that had operands of the
+// given form, quickening the site to it after Quickening::warmup in a row
+static void observe(Quickening &site, Quickening::Form form)
+{
+    site.runs = form == site.seen ? site.runs + 1 : 1;
+    site.seen = form;
+    if (site.runs >= Quickening::warmup)
+    {
+        site.form = form;
+    }
+}
+
+// A quickened site's check failed: back to watching, or generic for good
+static void deoptimize(Quickening &site)
+{
+    site.form = ++site.deopts >= Quickening::maxDeopts ? Quickening::Form::Generic : Quickening::Form::Unknown;
+    site.seen = Quickening::Form::Unknown;
+    site.runs = 0;
+}
+
+// The quickened operations give exactly what Value's operators give for the
+// same operands; anything they'd throw for is left to the generic path.
+// Value compares ints as floats, and so do these
+static std::optional<Value> intOperation(Quickening::Op op, int left, int right)
+{
+    switch (op)
+    {
+    case Quickening::Op::Add:
+        return Value(left + right);
+    case Quickening::Op::Subtract:
+        return Value(left - right);
+    case Quickening::Op::Multiply:
+        return Value(left * right);
+    case Quickening::Op::Divide:
+        if (right == 0)
+            return std::nullopt;
+        return Value(static_cast<float>(left) / static_cast<float>(right));
+    case Quickening::Op::Modulo:
+        if (right == 0)
+            return std::nullopt;
+        return Value(left % right);
+    case Quickening::Op::Less:
+        return Value(static_cast<float>(left) < static_cast<float>(right));
+    case Quickening::Op::LessEqual:
+        return Value(static_cast<float>(left) < static_cast<float>(right) || left == right);
+    case Quickening::Op::Greater:
+        return Value(static_cast<float>(right) < static_cast<float>(left));
+    case Quickening::Op::GreaterEqual:
+        return Value(static_cast<float>(right) < static_cast<float>(left) || left == right);
+    case Quickening::Op::Equal:
+        return Value(left == right);
+    case Quickening::Op::NotEqual:
+        return Value(left != right);
+    default:
+        return std::nullopt;
+    }
+}
+
+static std::optional<Value> floatOperation(Quickening::Op op, float left, float right)
+{
+    switch (op)
+    {
+    case Quickening::Op::Add:
+        return Value(left + right);
+    case Quickening::Op::Subtract:
+        return Value(left - right);
+    case Quickening::Op::Multiply:
+        return Value(left * right);
+    case Quickening::Op::Divide:
+        if (right == 0.0f)
+            return std::nullopt;
+        return Value(left / right);
+    case Quickening::Op::Less:
+        return Value(left < right);
+    case Quickening::Op::LessEqual:
+        return Value(left < right || left == right);
+    case Quickening::Op::Greater:
+        return Value(right < left);
+    case Quickening::Op::GreaterEqual:
+        return Value(right < left || left == right);
+    case Quickening::Op::Equal:
+        return Value(left == right);
+    case Quickening::Op::NotEqual:
+        return Value(left != right);
+    default:
+        return std::nullopt;
+    }
+}
+
+// The result of a binary operator site for these operands if the site is
+// quickened for them. Otherwise nothing, and the caller runs the generic
+// operator; a site that is still watching records what it saw
+static std::optional<Value> quickened(Quickening &site, const std::string &op, const Value &left, const Value &right)
+{
+    switch (site.form)
+    {
+    case Quickening::Form::Int:
+        if (left.isInteger() && right.isInteger())
+        {
+            return intOperation(site.op, left.asInt(), right.asInt());
+        }
+        deoptimize(site);
+        return std::nullopt;
+    case Quickening::Form::Float:
+        if (left.isFloat() && right.isFloat())
+        {
+            return floatOperation(site.op, left.asFloat(), right.asFloat());
+        }
+        deoptimize(site);
+        return std::nullopt;
+    case Quickening::Form::Unknown:
+        if (site.op == Quickening::Op::None)
+        {
+            site.op = decodeOperator(op);
+        }
+        if (site.op == Quickening::Op::None)
+        {
+            observe(site, Quickening::Form::Generic);
+        }
+        else if (left.isInteger() && right.isInteger())
+        {
+            observe(site, Quickening::Form::Int);
+        }
+        else if (left.isFloat() && right.isFloat() && site.op != Quickening::Op::Modulo)
+        {
+            observe(site, Quickening::Form::Float);
+        }
+        else
+        {
+            observe(site, Quickening::Form::Generic);
+        }
+        return std::nullopt;
+    default:
+        return std::nullopt;
+    }
+}
+
+// The generic path of comparison and equality operators
+static bool compare(const std::string &op, const Value &left, const Value &right)
+{
+    if (op == "<")
+        return left < right;
+    if (op == ">")
+        return left > right;
+    if (op == "<=")
+        return left <= right;
+    if (op == ">=")
+        return left >= right;
+    if (op == "==")
+        return left == right;
+    if (op == "!=")
+        return left != right;
+
+    throw std::runtime_error("Unknown comparison operator: " + op);
+}
+
+// The test of a counted loop, on ints exactly as the quickened operator does
+static bool countedTest(CountedLoop::Test test, int value, int bound)
+{
+    static constexpr Quickening::Op operators[] = {
+        Quickening::Op::Less, Quickening::Op::LessEqual, Quickening::Op::Greater,
+        Quickening::Op::GreaterEqual, Quickening::Op::NotEqual};
+    return intOperation(operators[static_cast<int>(test)], value, bound)->asBool();
+}
+
 // Interpreter implementation
 void Interpreter::interpret(ProgramNode *program)
 {
@@ -309,15 +538,25 @@ void Interpreter::interpret(ProgramNode *program)
 
     globals = environment;
 
+    // Whatever the program printed goes out when it ends, however it ends
+    struct FlushOnExit
+    {
+        OutputSink &output;
+        ~FlushOnExit() { output.flush(); }
+    } flushOnExit{output};
+
+    // Bind local variables to environment slots before anything runs
+    Resolver(useTailCalls).resolve(program);
+
     try
     {
         // Phase 1: Process imports first
         // This ensures all imported functions and variables are available in the environment
         // before any other code is executed
-        std::cout << "Phase 1: Processing imports first" << std::endl;
+        TRACE(Interpreter, Info, "Phase 1: Processing imports first");
         for (const auto &node : program->children)
         {
-            if (auto importNode = dynamic_cast<ImportNode *>(node.get()))
+            if (auto importNode = nodeCast<ImportNode>(node.get()))
             {
                 executeImportStatement(importNode);
             }
@@ -325,42 +564,56 @@ void Interpreter::interpret(ProgramNode *program)
 
         // Phase 2: Declare classes, functions and global variables
         // Now that imports are processed, we can define our own elements
-        std::cout << "Phase 2: Declaring functions, classes and variables" << std::endl;
+        TRACE(Interpreter, Info, "Phase 2: Declaring functions, classes and variables");
         for (const auto &node : program->children)
         {
-            if (auto classNode = dynamic_cast<ClassNode *>(node.get()))
+            if (!node)
             {
-                executeClass(classNode);
-            }
-            else if (auto funcNode = dynamic_cast<FunctionNode *>(node.get()))
-            {
-                executeFunction(funcNode);
+                continue;
             }
-            else if (auto varDecl = dynamic_cast<VariableDeclarationNode *>(node.get()))
+            switch (node->kind())
             {
-                executeVariableDeclaration(varDecl);
+            case NodeKind::Class:
+                executeClass(static_cast<ClassNode *>(node.get()));
+                break;
+            case NodeKind::Function:
+            case NodeKind::AsyncFunction:
+                executeFunction(static_cast<FunctionNode *>(node.get()));
+                break;
+            case NodeKind::VariableDeclaration:
+                executeVariableDeclaration(static_cast<VariableDeclarationNode *>(node.get()));
+                break;
+            default:
+                break;
             }
         }
 
-        // Look for a main function and execute it if found
-        lookForMainFunction(program);
+        // Look for a main function and execute it if found, it replaces the
+        // top level statements
+        if (lookForMainFunction(program))
+        {
+            return;
+        }
 
         // Phase 3: Execute all statements except imports (which were already processed)
-        std::cout << "Phase 3: Executing program statements" << std::endl;
+        TRACE(Interpreter, Info, "Phase 3: Executing program statements");
         for (const auto &node : program->children)
         {
-            if (!dynamic_cast<ImportNode *>(node.get())) // Skip imports since already processed
+            if (!nodeCast<ImportNode>(node.get())) // Skip imports since already processed
             {
-                execute(node.get());
+                // A return at global scope ends the program
+                Completion completion = useClosures ? ClosureCompiler::compileStatement(node.get())(*this)
+                                                    : execute(node.get());
+                if (completion.type == Completion::Type::Return)
+                {
+                    break;
+                }
             }
         }
     }
-    catch (const ReturnException &)
-    {
-        // Ignore return exception from global scope
-    }
     catch (const std::exception &e)
     {
+        output.flush();
         std::cerr << "Runtime error: " << e.what() << std::endl;
         throw;
     }
@@ -390,10 +643,10 @@ std::string Interpreter::resolveModulePath(const std::string &requestedPath, con
     }
 
     // Debug information for path resolution
-    std::cout << "Module path resolution:" << std::endl;
-    std::cout << "  Requested path: " << requestedPath << std::endl;
-    std::cout << "  Importing file: " << importingFile << std::endl;
-    std::cout << "  Base dir: " << baseDir << std::endl;
+    TRACE(Module, Debug, "Module path resolution:");
+    TRACE(Module, Debug, "  Requested path: ", requestedPath);
+    TRACE(Module, Debug, "  Importing file: ", importingFile);
+    TRACE(Module, Debug, "  Base dir: ", baseDir);
 
     // If it starts with ./ or ../, it's a relative path
     if (path.find("./") == 0)
@@ -423,7 +676,7 @@ std::string Interpreter::resolveModulePath(const std::string &requestedPath, con
         path += ".edu";
     }
 
-    DEBUG_LOG("Resolved module path: ", path);
+    TRACE(Module, Debug, "Resolved module path: ", path);
     return path;
 }
 
@@ -433,20 +686,20 @@ std::shared_ptr<Module> Interpreter::loadModule(const std::string &modulePath)
     auto it = loadedModules.find(modulePath);
     if (it != loadedModules.end())
     {
-        std::cout << "Using cached module for: " << modulePath << std::endl;
+        TRACE(Module, Debug, "Using cached module for: ", modulePath);
 
         // Examine the cached module's exports for debugging
-        std::cout << "Cached module exports information:" << std::endl;
-        std::cout << "  Named exports: " << it->second->namedExports.size() << std::endl;
+        TRACE(Module, Debug, "Cached module exports information:");
+        TRACE(Module, Debug, "  Named exports: ", it->second->namedExports.size());
         for (const auto &[name, val] : it->second->namedExports)
         {
-            std::cout << "    - " << name << " (type: " << static_cast<int>(val.getType()) << ")" << std::endl;
+            TRACE(Module, Debug, "    - ", name, " (type: ", static_cast<int>(val.getType()), ")");
         }
 
         return it->second;
     }
 
-    std::cout << "Loading new module from path: " << modulePath << std::endl;
+    TRACE(Module, Debug, "Loading new module from path: ", modulePath);
 
     // Create a new module
     auto module = std::make_shared<Module>(modulePath);
@@ -457,23 +710,17 @@ std::shared_ptr<Module> Interpreter::loadModule(const std::string &modulePath)
     try
     {
         // 1. Read the file from the filesystem
-        std::ifstream file(modulePath);
-        if (!file.is_open())
+        std::optional<SourceBuffer> content = SourceBuffer::map(modulePath);
+        if (!content)
         {
             throw std::runtime_error("Could not open module file: " + modulePath);
         }
 
-        DEBUG_LOG("Successfully opened module file: ", modulePath);
-
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string content = buffer.str();
-        file.close();
+        TRACE(Module, Debug, "Successfully opened module file: ", modulePath);
 
         // 2. Parse the file into an AST
-        Tokenizer tokenizer(content);
-        std::vector<Token> tokens = tokenizer.tokenize();
-        Parser parser(tokens);
+        Tokenizer tokenizer(std::move(*content));
+        Parser parser(tokenizer);
         std::unique_ptr<ProgramNode> program = parser.parse();
 
         if (!program)
@@ -481,6 +728,13 @@ std::shared_ptr<Module> Interpreter::loadModule(const std::string &modulePath)
             throw std::runtime_error("Failed to parse module: " + modulePath);
         }
 
+        Resolver(useTailCalls).resolve(program.get());
+
+        // The module's AST lives as long as the interpreter, so the inline
+        // caches of its call sites can still be reported after it ran
+        modulePrograms.push_back(std::move(program));
+        ProgramNode *moduleProgram = modulePrograms.back().get();
+
         // 3. Execute the module code with a dedicated module environment
         std::shared_ptr<Environment> previousEnv = environment;
 
@@ -499,19 +753,19 @@ std::shared_ptr<Module> Interpreter::loadModule(const std::string &modulePath)
         try
         {
             // First pass to collect declarations
-            for (const auto &node : program->children)
+            for (const auto &node : moduleProgram->children)
             {
-                if (auto exportNode = dynamic_cast<ExportNode *>(node.get()))
+                if (auto exportNode = nodeCast<ExportNode>(node.get()))
                 {
                     // Record export items
                     collectExport(exportNode, module);
                 }
-                else if (auto reExportNode = dynamic_cast<ReExportNode *>(node.get()))
+                else if (auto reExportNode = nodeCast<ReExportNode>(node.get()))
                 {
                     // Handle re-exports
                     executeReExportStatement(reExportNode, module);
                 }
-                else if (auto funcNode = dynamic_cast<FunctionNode *>(node.get()))
+                else if (auto funcNode = nodeCast<FunctionNode>(node.get()))
                 {
                     // Pre-declare functions
                     executeFunction(funcNode);
@@ -521,23 +775,26 @@ std::shared_ptr<Module> Interpreter::loadModule(const std::string &modulePath)
                     {
                         Value funcValue = environment->get(funcNode->name);
                         globals->define(funcNode->name, funcValue);
-                        std::cout << "Registered function " << funcNode->name << " globally" << std::endl;
+                        TRACE(Module, Debug, "Registered function ", funcNode->name, " globally");
                     }
                     catch (const std::exception &)
                     {
                         // Ignore errors
                     }
                 }
-                else if (auto classNode = dynamic_cast<ClassNode *>(node.get()))
+                else if (auto classNode = nodeCast<ClassNode>(node.get()))
                 {
                     // Pre-declare classes
                     executeClass(classNode);
                 }
             }
             // Second pass to execute statements
-            for (const auto &node : program->children)
+            for (const auto &node : moduleProgram->children)
             {
-                execute(node.get());
+                if (execute(node.get()).type == Completion::Type::Return)
+                {
+                    break;
+                }
             }
         }
         catch (const std::exception &e)
@@ -571,7 +828,7 @@ void Interpreter::collectExport(ExportNode *node, std::shared_ptr<Module> module
     }
 
     // For function exports, we need special handling
-    if (auto *funcNode = dynamic_cast<FunctionNode *>(node->exportItem.get()))
+    if (auto *funcNode = nodeCast<FunctionNode>(node->exportItem.get()))
     {
         // Define the function first in the environment (if not already defined)
         if (!environment->contains(funcNode->name))
@@ -586,14 +843,14 @@ void Interpreter::collectExport(ExportNode *node, std::shared_ptr<Module> module
 
             // Add to module's exports directly with the original name
             module->namedExports[funcNode->name] = funcValue;
-            std::cout << "Added function " << funcNode->name << " to module exports" << std::endl;
+            TRACE(Module, Debug, "Added function ", funcNode->name, " to module exports");
         }
         catch (const std::exception &e)
         {
-            std::cout << "ERROR: Failed to register function: " << e.what() << std::endl;
+            TRACE(Module, Debug, "ERROR: Failed to register function: ", e.what());
         }
     }
-    else if (auto *classNode = dynamic_cast<ClassNode *>(node->exportItem.get()))
+    else if (auto *classNode = nodeCast<ClassNode>(node->exportItem.get()))
     {
         // Handle class exports
         executeClass(classNode);
@@ -605,11 +862,11 @@ void Interpreter::collectExport(ExportNode *node, std::shared_ptr<Module> module
 
             // Add to module's exports
             module->namedExports[classNode->name] = classValue;
-            DEBUG_LOG("Added class ", classNode->name, " to module exports");
+            TRACE(Module, Debug, "Added class ", classNode->name, " to module exports");
         }
         catch (const std::exception &e)
         {
-            DEBUG_LOG("ERROR: Failed to register class: ", e.what());
+            TRACE(Module, Debug, "ERROR: Failed to register class: ", e.what());
         }
     }
     else
@@ -621,33 +878,33 @@ void Interpreter::collectExport(ExportNode *node, std::shared_ptr<Module> module
     if (node->isDefault)
     {
         // Handle default export
-        if (auto *funcNode = dynamic_cast<FunctionNode *>(node->exportItem.get()))
+        if (auto *funcNode = nodeCast<FunctionNode>(node->exportItem.get()))
         {
             // Get the function from environment
             module->defaultExport = environment->get(funcNode->name);
             module->hasDefault = true;
-            DEBUG_LOG("Exported default function: ", funcNode->name);
+            TRACE(Module, Debug, "Exported default function: ", funcNode->name);
         }
-        else if (auto *varNode = dynamic_cast<VariableDeclarationNode *>(node->exportItem.get()))
+        else if (auto *varNode = nodeCast<VariableDeclarationNode>(node->exportItem.get()))
         {
             // Get the variable from environment
             module->defaultExport = environment->get(varNode->name);
             module->hasDefault = true;
-            DEBUG_LOG("Exported default variable: ", varNode->name);
+            TRACE(Module, Debug, "Exported default variable: ", varNode->name);
         }
-        else if (auto *exprNode = dynamic_cast<ExpressionNode *>(node->exportItem.get()))
+        else if (auto *exprNode = nodeCast<ExpressionNode>(node->exportItem.get()))
         {
             // Evaluate the expression and use its value as default export
             Value value = evaluate(exprNode);
             module->defaultExport = value;
             module->hasDefault = true;
-            DEBUG_LOG("Exported default expression result");
+            TRACE(Module, Debug, "Exported default expression result");
         }
     }
     else
     {
         // Handle named export
-        if (auto *funcNode = dynamic_cast<FunctionNode *>(node->exportItem.get()))
+        if (auto *funcNode = nodeCast<FunctionNode>(node->exportItem.get()))
         {
             // Get the function from environment
             Value funcValue = environment->get(funcNode->name);
@@ -659,7 +916,7 @@ void Interpreter::collectExport(ExportNode *node, std::shared_ptr<Module> module
                 module->exports->define(funcNode->name, funcValue);
             }
         }
-        else if (auto *varNode = dynamic_cast<VariableDeclarationNode *>(node->exportItem.get()))
+        else if (auto *varNode = nodeCast<VariableDeclarationNode>(node->exportItem.get()))
         {
             // Get the variable from environment
             Value varValue = environment->get(varNode->name);
@@ -669,10 +926,10 @@ void Interpreter::collectExport(ExportNode *node, std::shared_ptr<Module> module
             {
                 module->namedExports[varNode->name] = varValue;
                 module->exports->define(varNode->name, varValue);
-                DEBUG_LOG("Added variable ", varNode->name, " to module exports");
+                TRACE(Module, Debug, "Added variable ", varNode->name, " to module exports");
             }
         }
-        else if (auto *classNode = dynamic_cast<ClassNode *>(node->exportItem.get()))
+        else if (auto *classNode = nodeCast<ClassNode>(node->exportItem.get()))
         {
             // Get the class from environment (already executed above)
             Value classValue = environment->get(classNode->name);
@@ -700,11 +957,14 @@ Value Interpreter::executeModuleFunctionBody(std::shared_ptr<Function> function,
         return Value();
     }
 
+    // Not run by callFunction, so tail call returns call right away
+    TailCallScope tailCalls(acceptsTailCall, false);
+
     // If this is a wrapper, use the original function if available
     std::shared_ptr<Function> execFunction = function;
     if (function->importedFunction)
     {
-        std::cout << "Using original function from imported reference" << std::endl;
+        TRACE(Module, Debug, "Using original function from imported reference");
         execFunction = function->importedFunction;
     }
 
@@ -721,18 +981,15 @@ Value Interpreter::executeModuleFunctionBody(std::shared_ptr<Function> function,
         return Value();
     }
 
-    std::cout << "Directly executing module function body" << std::endl;
-
-    // Set up the environment with argument values
-    auto paramNames = execFunction->getParameterNames();
-    size_t paramCount = execFunction->getParameterCount();
+    TRACE(Module, Debug, "Directly executing module function body");
 
     // Bind arguments to parameters
-    for (size_t i = 0; i < paramCount && i < args.size(); i++)
+    const auto &parameters = execFunction->data->parameters;
+    for (size_t i = 0; i < parameters.size() && i < args.size(); i++)
     {
-        std::cout << "  Binding param " << paramNames[i] << " = " << args[i].toString() << std::endl;
-        env->define(paramNames[i], args[i]);
+        TRACE(Module, Debug, "  Binding param ", parameters[i].first, " = ", args[i].toString());
     }
+    env->bindParameters(execFunction->declaration.get(), *execFunction->data, args);
 
     // Store the previous environment and set the new one for execution
     std::shared_ptr<Environment> previousEnv = environment;
@@ -741,18 +998,18 @@ Value Interpreter::executeModuleFunctionBody(std::shared_ptr<Function> function,
     try
     {
         // Print diagnostics about the function
-        DEBUG_LOG("Executing function: ");
+        TRACE(Module, Debug, "Executing function: ");
         if (execFunction->data && !execFunction->data->name.empty())
         {
-            DEBUG_LOG(execFunction->data->name);
+            TRACE(Module, Debug, execFunction->data->name);
         }
         else if (!execFunction->originalFunctionName.empty())
         {
-            DEBUG_LOG(execFunction->originalFunctionName);
+            TRACE(Module, Debug, execFunction->originalFunctionName);
         }
         else
         {
-            DEBUG_LOG("(unnamed)");
+            TRACE(Module, Debug, "(unnamed)");
         }
 
         // Safely get statement count
@@ -760,7 +1017,7 @@ Value Interpreter::executeModuleFunctionBody(std::shared_ptr<Function> function,
         try
         {
             statementCount = execFunction->declaration->body->statements.size();
-            std::cout << "Function has " << statementCount << " statements" << std::endl;
+            TRACE(Module, Debug, "Function has ", statementCount, " statements");
         }
         catch (const std::exception &e)
         {
@@ -780,9 +1037,9 @@ Value Interpreter::executeModuleFunctionBody(std::shared_ptr<Function> function,
                     auto returnStmt = static_cast<ReturnStatementNode *>(stmt);
                     if (returnStmt->expression)
                     {
-                        std::cout << "Found simple return statement - evaluating directly" << std::endl;
+                        TRACE(Module, Debug, "Found simple return statement - evaluating directly");
                         Value result = evaluate(returnStmt->expression.get());
-                        std::cout << "Direct evaluation result: " << result.toString() << std::endl;
+                        TRACE(Module, Debug, "Direct evaluation result: ", result.toString());
 
                         // Restore environment before returning
                         environment = previousEnv;
@@ -807,14 +1064,12 @@ Value Interpreter::executeModuleFunctionBody(std::shared_ptr<Function> function,
 
             try
             {
-                execute(stmt.get());
-            }
-            catch (const ReturnException &e)
-            {
-                // Handle return statement
-                Value result = e.getValue();
-                environment = previousEnv; // Restore environment
-                return result;
+                Completion completion = execute(stmt.get());
+                if (completion.type == Completion::Type::Return)
+                {
+                    environment = previousEnv; // Restore environment
+                    return completion.value;
+                }
             }
             catch (const std::exception &e)
             {
@@ -827,13 +1082,6 @@ Value Interpreter::executeModuleFunctionBody(std::shared_ptr<Function> function,
         environment = previousEnv;
         return Value();
     }
-    catch (const ReturnException &e)
-    {
-        // Capture the return value from the function
-        Value result = e.getValue();
-        environment = previousEnv; // Restore environment
-        return result;
-    }
     catch (const std::exception &e)
     {
         // Log any other exceptions
@@ -860,7 +1108,7 @@ void Interpreter::executeReExportStatement(ReExportNode *node, std::shared_ptr<M
         for (const auto &[name, value] : sourceModule->namedExports)
         {
             module->namedExports[name] = value;
-            DEBUG_LOG("Re-exported: ", name);
+            TRACE(Module, Debug, "Re-exported: ", name);
         }
 
         if (sourceModule->hasDefault)
@@ -868,7 +1116,7 @@ void Interpreter::executeReExportStatement(ReExportNode *node, std::shared_ptr<M
             // Optionally re-export the default as well
             module->defaultExport = sourceModule->defaultExport;
             module->hasDefault = true;
-            DEBUG_LOG("Re-exported default export");
+            TRACE(Module, Debug, "Re-exported default export");
         }
     }
     else
@@ -880,7 +1128,7 @@ void Interpreter::executeReExportStatement(ReExportNode *node, std::shared_ptr<M
             {
                 // Handle "export { default as xyz } from './module'"
                 module->namedExports[exportName] = sourceModule->defaultExport;
-                DEBUG_LOG("Re-exported default as: ", exportName);
+                TRACE(Module, Debug, "Re-exported default as: ", exportName);
             }
             else
             {
@@ -888,7 +1136,7 @@ void Interpreter::executeReExportStatement(ReExportNode *node, std::shared_ptr<M
                 if (it != sourceModule->namedExports.end())
                 {
                     module->namedExports[exportName] = it->second;
-                    DEBUG_LOG("Re-exported: ", sourceName, " as ", exportName);
+                    TRACE(Module, Debug, "Re-exported: ", sourceName, " as ", exportName);
                 }
                 else
                 {
@@ -901,18 +1149,18 @@ void Interpreter::executeReExportStatement(ReExportNode *node, std::shared_ptr<M
 
 void Interpreter::executeImportStatement(ImportNode *node)
 {
-    std::cout << "Processing import from module: " << node->moduleName << std::endl;
+    TRACE(Module, Debug, "Processing import from module: ", node->moduleName);
 
     // Resolve the module path
     std::string resolvedPath = resolveModulePath(node->moduleName, "");
-    std::cout << "Importing module: " << node->moduleName << " from " << resolvedPath << std::endl;
+    TRACE(Module, Debug, "Importing module: ", node->moduleName, " from ", resolvedPath);
 
     // Load the module
     auto module = loadModule(resolvedPath);
 
     if (!module)
     {
-        std::cout << "Failed to load module: " << resolvedPath << std::endl;
+        TRACE(Module, Debug, "Failed to load module: ", resolvedPath);
         throw std::runtime_error("Failed to load module: " + resolvedPath);
     }
 
@@ -920,21 +1168,21 @@ void Interpreter::executeImportStatement(ImportNode *node)
     if (node->hasDefaultImport && module->hasDefault)
     {
         environment->define(node->defaultImportName, module->defaultExport);
-        std::cout << "Imported default as: " << node->defaultImportName << std::endl;
+        TRACE(Module, Debug, "Imported default as: ", node->defaultImportName);
     }
 
-    std::cout << "Module named exports count: " << module->namedExports.size() << std::endl;
+    TRACE(Module, Debug, "Module named exports count: ", module->namedExports.size());
 
     // Handle named imports
     for (const auto &[originalName, localName] : node->namedImports)
     {
-        std::cout << "Processing import of named export: " << originalName << " as " << localName << std::endl;
+        TRACE(Module, Debug, "Processing import of named export: ", originalName, " as ", localName);
         auto it = module->namedExports.find(originalName);
         if (it != module->namedExports.end())
         {
             // Get the imported value
             Value importedValue = it->second;
-            std::cout << "  Found export value of type: " << static_cast<int>(importedValue.getType()) << std::endl;
+            TRACE(Module, Debug, "  Found export value of type: ", static_cast<int>(importedValue.getType()));
             // Handle functions specially - use our new module registry approach
             if (importedValue.isFunction())
             {
@@ -968,8 +1216,7 @@ void Interpreter::executeImportStatement(ImportNode *node)
                         // Keep the original reference - this is critical for execution
                         wrapperFunc->importedFunction = originalFunc;
 
-                        std::cout << "Created simplified module wrapper function for " << localName
-                                  << " from " << node->moduleName << std::endl;
+                        TRACE(Module, Debug, "Created simplified module wrapper function for ", localName, " from ", node->moduleName);
 
                         // Register the original function in the module registry with both name formats
                         gModuleRegistry.registerFunction(node->moduleName, originalName, originalFunc);
@@ -982,24 +1229,21 @@ void Interpreter::executeImportStatement(ImportNode *node)
                             node->moduleName.substr(node->moduleName.size() - 4) == ".edu")
                         {
                             altModuleName = node->moduleName.substr(0, node->moduleName.size() - 4);
-                            std::cout << "Also registering function with module path: "
-                                      << altModuleName << "." << originalName << std::endl;
+                            TRACE(Module, Debug, "Also registering function with module path: ", altModuleName, ".", originalName);
                             gModuleRegistry.registerFunction(altModuleName, originalName, originalFunc);
                         }
                         // If module name doesn't have .edu extension, register with it
                         else
                         {
                             altModuleName = node->moduleName + ".edu";
-                            std::cout << "Also registering function with module path: "
-                                      << altModuleName << "." << originalName << std::endl;
+                            TRACE(Module, Debug, "Also registering function with module path: ", altModuleName, ".", originalName);
                             gModuleRegistry.registerFunction(altModuleName, originalName, originalFunc);
                         }
 
                         // Create new wrapper Value
                         importedValue = Value(wrapperFunc, Value::Type::Function);
 
-                        std::cout << "Created module wrapper function for " << localName
-                                  << " from " << node->moduleName << " original name: " << originalName << std::endl;
+                        TRACE(Module, Debug, "Created module wrapper function for ", localName, " from ", node->moduleName, " original name: ", originalName);
                     }
                 }
                 catch (const std::exception &e)
@@ -1018,7 +1262,7 @@ void Interpreter::executeImportStatement(ImportNode *node)
                 globals->define(originalName, importedValue);
             }
 
-            std::cout << "Registered import " << originalName << " as " << localName << std::endl;
+            TRACE(Module, Debug, "Registered import ", originalName, " as ", localName);
         }
         else
         {
@@ -1027,16 +1271,16 @@ void Interpreter::executeImportStatement(ImportNode *node)
     }
 }
 
-void Interpreter::lookForMainFunction(ProgramNode *program)
+bool Interpreter::lookForMainFunction(ProgramNode *program)
 {
     // Look for a function named "main"
     for (const auto &node : program->children)
     {
-        if (auto funcNode = dynamic_cast<FunctionNode *>(node.get()))
+        if (auto funcNode = nodeCast<FunctionNode>(node.get()))
         {
             if (funcNode->name == "main")
             {
-                DEBUG_LOG("Found main function, executing it");
+                TRACE(Interpreter, Debug, "Found main function, executing it");
 
                 // Get the function from the environment
                 auto mainFunc = environment->get("main");
@@ -1047,94 +1291,79 @@ void Interpreter::lookForMainFunction(ProgramNode *program)
                     callFunction(mainFunc.asObject<Function>(), args);
 
                     // Stop further processing
-                    throw ReturnException(Value());
+                    return true;
                 }
             }
         }
     }
+    return false;
 }
 
-void Interpreter::execute(ASTNode *node)
+Completion Interpreter::execute(ASTNode *node)
 {
     if (!node)
-        return;
+        return Completion();
 
-    DEBUG_LOG("Executing node type: ", typeid(*node).name());
+    TRACE(Interpreter, Verbose, "Executing node type: ", typeid(*node).name());
 
-    if (auto blockNode = dynamic_cast<BlockStatementNode *>(node))
-    {
-        executeBlockStatement(blockNode);
-    }
-    else if (auto varDeclNode = dynamic_cast<VariableDeclarationNode *>(node))
-    {
-        executeVariableDeclaration(varDeclNode);
-    }
-    else if (auto ifNode = dynamic_cast<IfStatementNode *>(node))
-    {
-        executeIfStatement(ifNode);
-    }
-    else if (auto whileNode = dynamic_cast<WhileStatementNode *>(node))
-    {
-        executeWhileStatement(whileNode);
-    }
-    else if (auto forNode = dynamic_cast<ForStatementNode *>(node))
-    {
-        executeForStatement(forNode);
-    }
-    else if (auto switchNode = dynamic_cast<SwitchStatementNode *>(node))
-    {
-        executeSwitchStatement(switchNode);
-    }
-    else if (auto breakNode = dynamic_cast<BreakStatementNode *>(node))
-    {
-        executeBreakStatement(breakNode);
-    }
-    else if (auto returnNode = dynamic_cast<ReturnStatementNode *>(node))
-    {
-        executeReturnStatement(returnNode);
-    }
-    else if (auto exprStmtNode = dynamic_cast<ExpressionStatementNode *>(node))
-    {
-        executeExpressionStatement(exprStmtNode);
-    }
-    else if (auto consoleLogNode = dynamic_cast<ConsoleLogNode *>(node))
-    {
-        executeConsoleLog(consoleLogNode);
-    }
-    else if (auto inputNode = dynamic_cast<InputStatementNode *>(node))
-    {
-        executeInputStatement(inputNode);
-    }
-    else if (auto functionNode = dynamic_cast<FunctionNode *>(node))
-    {
-        executeFunction(functionNode);
-    }
-    else if (auto classNode = dynamic_cast<ClassNode *>(node))
-    {
-        executeClass(classNode);
-    }
-    else if (auto importNode = dynamic_cast<ImportNode *>(node))
+    switch (node->kind())
     {
-        executeImportStatement(importNode);
-    }
-    else if (auto exportNode = dynamic_cast<ExportNode *>(node))
+    case NodeKind::BlockStatement:
+        return executeBlockStatement(static_cast<BlockStatementNode *>(node));
+    case NodeKind::VariableDeclaration:
+        executeVariableDeclaration(static_cast<VariableDeclarationNode *>(node));
+        break;
+    case NodeKind::IfStatement:
+        return executeIfStatement(static_cast<IfStatementNode *>(node));
+    case NodeKind::WhileStatement:
+        return executeWhileStatement(static_cast<WhileStatementNode *>(node));
+    case NodeKind::ForStatement:
+        return executeForStatement(static_cast<ForStatementNode *>(node));
+    case NodeKind::SwitchStatement:
+        return executeSwitchStatement(static_cast<SwitchStatementNode *>(node));
+    case NodeKind::BreakStatement:
+        return executeBreakStatement(static_cast<BreakStatementNode *>(node));
+    case NodeKind::ContinueStatement:
+        return executeContinueStatement(static_cast<ContinueStatementNode *>(node));
+    case NodeKind::ReturnStatement:
+        return executeReturnStatement(static_cast<ReturnStatementNode *>(node));
+    case NodeKind::ExpressionStatement:
+        executeExpressionStatement(static_cast<ExpressionStatementNode *>(node));
+        break;
+    case NodeKind::ConsoleLog:
+        executeConsoleLog(static_cast<ConsoleLogNode *>(node));
+        break;
+    case NodeKind::InputStatement:
+        executeInputStatement(static_cast<InputStatementNode *>(node));
+        break;
+    case NodeKind::Function:
+    case NodeKind::AsyncFunction:
+        executeFunction(static_cast<FunctionNode *>(node));
+        break;
+    case NodeKind::Class:
+        executeClass(static_cast<ClassNode *>(node));
+        break;
+    case NodeKind::Import:
+        executeImportStatement(static_cast<ImportNode *>(node));
+        break;
+    case NodeKind::Export:
+    case NodeKind::ReExport:
     {
+        auto *exportNode = static_cast<ExportNode *>(node);
         // For now, we'll just execute the exported item
         if (exportNode->exportItem)
         {
-            execute(exportNode->exportItem.get());
+            return execute(exportNode->exportItem.get());
         }
         // We would also register this in a proper module system
+        break;
     }
-    else if (dynamic_cast<ReExportNode *>(node))
-    {
-        // Handle re-export statements
-        std::cout << "Re-export statement encountered (not fully implemented)" << std::endl;
-    }
-    else
-    {
-        DEBUG_LOG("Unhandled node type: ", typeid(*node).name());
+    default:
+        TRACE(Interpreter, Verbose, "Unhandled node type: ", typeid(*node).name());
+        break;
     }
+
+    return Completion();
 }
 
 Value Interpreter::evaluate(ExpressionNode *expr)
@@ -1142,98 +1371,85 @@ Value Interpreter::evaluate(ExpressionNode *expr)
     if (!expr)
         return Value(); // Return null for null expressions
 
-    DEBUG_LOG("Evaluating expression type: ", typeid(*expr).name());
-
-    if (auto varExpr = dynamic_cast<VariableExpressionNode *>(expr))
-    {
-        return evaluateVariableExpression(varExpr);
-    }
-    else if (auto callExpr = dynamic_cast<CallExpressionNode *>(expr))
-    {
-        return evaluateCallExpression(callExpr);
-    }
-    else if (auto assignExpr = dynamic_cast<AssignmentExpressionNode *>(expr))
-    {
-        return evaluateAssignmentExpression(assignExpr);
-    }
-    else if (auto memberAccessExpr = dynamic_cast<MemberAccessExpressionNode *>(expr))
-    {
-        return evaluateMemberAccessExpression(memberAccessExpr);
-    }
-    else if (auto intLiteral = dynamic_cast<IntegerLiteralNode *>(expr))
-    {
-        return evaluateIntegerLiteral(intLiteral);
-    }
-    else if (auto floatLiteral = dynamic_cast<FloatingPointLiteralNode *>(expr))
-    {
-        return evaluateFloatingPointLiteral(floatLiteral);
-    }
-    else if (auto stringLiteral = dynamic_cast<StringLiteralNode *>(expr))
-    {
-        return evaluateStringLiteral(stringLiteral);
-    }
-    else if (auto boolLiteral = dynamic_cast<BooleanLiteralNode *>(expr))
-    {
-        return evaluateBooleanLiteral(boolLiteral);
-    }
-    else if (auto nullLiteral = dynamic_cast<NullLiteralNode *>(expr))
-    {
-        return evaluateNullLiteral(nullLiteral);
-    }
-    else if (auto addExpr = dynamic_cast<AdditionExpressionNode *>(expr))
-    {
+    TRACE(Interpreter, Verbose, "Evaluating expression type: ", typeid(*expr).name());
+
+    switch (expr->kind())
+    {
+    case NodeKind::VariableExpression:
+        return evaluateVariableExpression(static_cast<VariableExpressionNode *>(expr));
+    case NodeKind::CallExpression:
+        return evaluateCallExpression(static_cast<CallExpressionNode *>(expr));
+    case NodeKind::AssignmentExpression:
+        return evaluateAssignmentExpression(static_cast<AssignmentExpressionNode *>(expr));
+    case NodeKind::MemberAccessExpression:
+        return evaluateMemberAccessExpression(static_cast<MemberAccessExpressionNode *>(expr));
+    case NodeKind::IntegerLiteral:
+        return evaluateIntegerLiteral(static_cast<IntegerLiteralNode *>(expr));
+    case NodeKind::FloatingPointLiteral:
+        return evaluateFloatingPointLiteral(static_cast<FloatingPointLiteralNode *>(expr));
+    case NodeKind::StringLiteral:
+        return evaluateStringLiteral(static_cast<StringLiteralNode *>(expr));
+    case NodeKind::BooleanLiteral:
+        return evaluateBooleanLiteral(static_cast<BooleanLiteralNode *>(expr));
+    case NodeKind::NullLiteral:
+        return evaluateNullLiteral(static_cast<NullLiteralNode *>(expr));
+    case NodeKind::AdditionExpression:
+    {
+        auto *addExpr = static_cast<AdditionExpressionNode *>(expr);
         Value left = evaluate(addExpr->left.get());
         Value right = evaluate(addExpr->right.get());
+        if (auto result = quickened(addExpr->quickening, addExpr->op, left, right))
+            return *result;
         return left + right;
     }
-    else if (auto subExpr = dynamic_cast<SubtractionExpressionNode *>(expr))
+    case NodeKind::SubtractionExpression:
     {
+        auto *subExpr = static_cast<SubtractionExpressionNode *>(expr);
         Value left = evaluate(subExpr->left.get());
         Value right = evaluate(subExpr->right.get());
+        if (auto result = quickened(subExpr->quickening, subExpr->op, left, right))
+            return *result;
         return left - right;
     }
-    else if (auto mulExpr = dynamic_cast<MultiplicationExpressionNode *>(expr))
+    case NodeKind::MultiplicationExpression:
     {
+        auto *mulExpr = static_cast<MultiplicationExpressionNode *>(expr);
         Value left = evaluate(mulExpr->left.get());
         Value right = evaluate(mulExpr->right.get());
+        if (auto result = quickened(mulExpr->quickening, mulExpr->op, left, right))
+            return *result;
         return left * right;
     }
-    else if (auto divExpr = dynamic_cast<DivisionExpressionNode *>(expr))
+    case NodeKind::DivisionExpression:
     {
+        auto *divExpr = static_cast<DivisionExpressionNode *>(expr);
         Value left = evaluate(divExpr->left.get());
         Value right = evaluate(divExpr->right.get());
+        if (auto result = quickened(divExpr->quickening, divExpr->op, left, right))
+            return *result;
         return left / right;
     }
-    else if (auto compExpr = dynamic_cast<ComparisonExpressionNode *>(expr))
+    case NodeKind::ComparisonExpression:
     {
+        auto *compExpr = static_cast<ComparisonExpressionNode *>(expr);
         Value left = evaluate(compExpr->left.get());
         Value right = evaluate(compExpr->right.get());
-
-        if (compExpr->op == "<")
-            return Value(left < right);
-        if (compExpr->op == ">")
-            return Value(left > right);
-        if (compExpr->op == "<=")
-            return Value(left <= right);
-        if (compExpr->op == ">=")
-            return Value(left >= right);
-
-        throw std::runtime_error("Unknown comparison operator: " + compExpr->op);
+        if (auto result = quickened(compExpr->quickening, compExpr->op, left, right))
+            return *result;
+        return Value(compare(compExpr->op, left, right));
     }
-    else if (auto eqExpr = dynamic_cast<EqualityExpressionNode *>(expr))
+    case NodeKind::EqualityExpression:
     {
+        auto *eqExpr = static_cast<EqualityExpressionNode *>(expr);
         Value left = evaluate(eqExpr->left.get());
         Value right = evaluate(eqExpr->right.get());
-
-        if (eqExpr->op == "==")
-            return Value(left == right);
-        if (eqExpr->op == "!=")
-            return Value(left != right);
-
-        throw std::runtime_error("Unknown equality operator: " + eqExpr->op);
+        if (auto result = quickened(eqExpr->quickening, eqExpr->op, left, right))
+            return *result;
+        return Value(compare(eqExpr->op, left, right));
     }
-    else if (auto orExpr = dynamic_cast<OrExpressionNode *>(expr))
+    case NodeKind::OrExpression:
     {
+        auto *orExpr = static_cast<OrExpressionNode *>(expr);
         Value left = evaluate(orExpr->left.get());
 
         // Short-circuit evaluation
@@ -1243,8 +1459,9 @@ Value Interpreter::evaluate(ExpressionNode *expr)
         Value right = evaluate(orExpr->right.get());
         return Value(right.asBool());
     }
-    else if (auto andExpr = dynamic_cast<AndExpressionNode *>(expr))
+    case NodeKind::AndExpression:
     {
+        auto *andExpr = static_cast<AndExpressionNode *>(expr);
         Value left = evaluate(andExpr->left.get());
 
         // Short-circuit evaluation
@@ -1254,22 +1471,23 @@ Value Interpreter::evaluate(ExpressionNode *expr)
         Value right = evaluate(andExpr->right.get());
         return Value(right.asBool());
     }
-    else if (auto binaryExpr = dynamic_cast<BinaryExpressionNode *>(expr))
-    {
-        return evaluateBinaryExpression(binaryExpr);
-    }
-    else if (auto unaryExpr = dynamic_cast<UnaryExpressionNode *>(expr))
-    {
-        return evaluateUnaryExpression(unaryExpr);
+    case NodeKind::BinaryExpression:
+        return evaluateBinaryExpression(static_cast<BinaryExpressionNode *>(expr));
+    case NodeKind::UnaryExpression:
+        return evaluateUnaryExpression(static_cast<UnaryExpressionNode *>(expr));
+    default:
+        break;
     }
 
-    DEBUG_LOG("Unknown expression type: ", typeid(*expr).name());
+    TRACE(Interpreter, Verbose, "Unknown expression type: ", typeid(*expr).name());
     return Value(); // Default to null
 }
 
-void Interpreter::executeBlockStatement(BlockStatementNode *node, std::shared_ptr<Environment> env)
+Completion Interpreter::executeBlockStatement(BlockStatementNode *node, std::shared_ptr<Environment> env)
 {
     std::shared_ptr<Environment> previous = this->environment;
+    Completion completion;
+    FramePool::Lease scope(frames);
 
     try
     {
@@ -1278,23 +1496,24 @@ void Interpreter::executeBlockStatement(BlockStatementNode *node, std::shared_pt
             // If an environment is provided, use it
             this->environment = env;
         }
-        else
+        else if (node->needsScope)
         {
-            // Otherwise, create a new environment with the current one as enclosing
-            this->environment = std::make_shared<Environment>(this->environment);
+            // Otherwise, take one from the pool with the current one as enclosing
+            scope.frame = frames.acquire(this->environment, node->slotCount);
+            this->environment = scope.frame;
         }
+        // Blocks that declare nothing run in the current environment
 
         for (const auto &statement : node->statements)
         {
-            execute(statement.get());
+            completion = execute(statement.get());
+            if (!completion.isNormal())
+            {
+                // Return, break or continue skip the rest of the block
+                break;
+            }
         }
     }
-    catch (const ReturnException &)
-    {
-        // Let the return exception propagate up
-        this->environment = previous;
-        throw;
-    }
     catch (const std::exception &e)
     {
         this->environment = previous;
@@ -1302,6 +1521,7 @@ void Interpreter::executeBlockStatement(BlockStatementNode *node, std::shared_pt
     }
 
     this->environment = previous;
+    return completion;
 }
 
 void Interpreter::executeVariableDeclaration(VariableDeclarationNode *node)
@@ -1311,43 +1531,34 @@ void Interpreter::executeVariableDeclaration(VariableDeclarationNode *node)
     if (node->initializer)
     {
         // First, check if the typeName corresponds to a class in the environment
-        bool isClassType = false;
-        try
-        {
-            Value classValue = environment->get(node->typeName);
-            isClassType = classValue.isClass();
-        }
-        catch (...)
-        {
-            // Class doesn't exist in environment, continue with normal processing
-        }
+        bool isClassType = environment->contains(node->typeName) && environment->get(node->typeName).isClass();
 
         // Special handling for class instantiation
         if (isClassType)
         {
-            if (auto callExpr = dynamic_cast<CallExpressionNode *>(node->initializer.get()))
+            if (auto callExpr = nodeCast<CallExpressionNode>(node->initializer.get()))
             {
-                if (auto varExpr = dynamic_cast<VariableExpressionNode *>(callExpr->callee.get()))
+                if (auto varExpr = nodeCast<VariableExpressionNode>(callExpr->callee.get()))
                 {
                     if (varExpr->name == node->typeName)
                     {
                         // This is definitely a class instantiation: TypeName var = TypeName();
-                        DEBUG_LOG("Detected class instantiation: ", node->typeName, " ", node->name);
+                        TRACE(Interpreter, Debug, "Detected class instantiation: ", node->typeName, " ", node->name);
 
                         // Get the class from environment
                         Value classValue = environment->get(node->typeName);
                         auto klass = classValue.asObject<Class>();
 
                         // Create arguments for constructor
-                        std::vector<Value> arguments;
+                        ArgumentFrame arguments(argumentStack);
                         for (const auto &arg : callExpr->arguments)
                         {
-                            arguments.push_back(evaluate(arg.get()));
+                            argumentStack.push_back(evaluate(arg.get()));
                         }
 
                         // Create the instance
-                        initialValue = createInstance(klass, arguments);
-                        DEBUG_LOG("Created instance successfully, type: ", static_cast<int>(initialValue.getType()));
+                        initialValue = createInstance(klass, arguments.arguments());
+                        TRACE(Interpreter, Debug, "Created instance successfully, type: ", static_cast<int>(initialValue.getType()));
                     }
                     else
                     {
@@ -1374,7 +1585,7 @@ void Interpreter::executeVariableDeclaration(VariableDeclarationNode *node)
         }
 
         // Log the type of initial value for debugging
-        DEBUG_LOG("Initial value for ", node->name, " type: ", static_cast<int>(initialValue.getType()),
+        TRACE(Interpreter, Verbose, "Initial value for ", node->name, " type: ", static_cast<int>(initialValue.getType()),
                   " is object: ", initialValue.isObject());
     }
     else
@@ -1391,54 +1602,60 @@ void Interpreter::executeVariableDeclaration(VariableDeclarationNode *node)
         // Default to null for other types (including classes without initializers)
     }
 
-    environment->define(node->name, initialValue);
-    DEBUG_LOG("Defined variable ", node->name, " type: ", static_cast<int>(initialValue.getType()),
+    if (node->slot >= 0)
+    {
+        environment->defineAt(node->slot, initialValue);
+    }
+    else
+    {
+        environment->define(node->name, initialValue);
+    }
+    TRACE(Interpreter, Verbose, "Defined variable ", node->name, " type: ", static_cast<int>(initialValue.getType()),
               " value: ", initialValue.toString(), " is object: ", initialValue.isObject());
 }
-void Interpreter::executeIfStatement(IfStatementNode *node)
+Completion Interpreter::executeIfStatement(IfStatementNode *node)
 {
-    Value condition = evaluate(node->condition.get());
-
-    if (condition.asBool())
+    if (evaluateCondition(node->condition.get()))
     {
-        execute(node->thenBranch.get());
+        return execute(node->thenBranch.get());
     }
     else if (node->elseBranch)
     {
-        execute(node->elseBranch.get());
+        return execute(node->elseBranch.get());
     }
+    return Completion();
 }
 
-void Interpreter::executeWhileStatement(WhileStatementNode *node)
+Completion Interpreter::executeWhileStatement(WhileStatementNode *node)
 {
-    try
+    while (evaluateCondition(node->condition.get()))
     {
-        while (evaluate(node->condition.get()).asBool())
+        Completion completion = execute(node->body.get());
+        if (completion.type == Completion::Type::Break)
         {
-            try
-            {
-                execute(node->body.get());
-            }
-            catch (BreakException &)
-            {
-                // Break out of the loop
-                break;
-            }
+            break;
         }
+        if (completion.type == Completion::Type::Return)
+        {
+            return completion;
+        }
+        // Continue goes straight back to the condition
     }
-    catch (ReturnException &)
-    {
-        // Let return propagate up
-        throw;
-    }
+    return Completion();
 }
 
-void Interpreter::executeForStatement(ForStatementNode *node)
+Completion Interpreter::executeForStatement(ForStatementNode *node)
 {
-    // Create a new environment for the for loop
+    // Take an environment for the for loop from the pool, unless it declares nothing
     std::shared_ptr<Environment> previous = this->environment;
-    this->environment = std::make_shared<Environment>(this->environment);
+    FramePool::Lease scope(frames);
+    if (node->needsScope)
+    {
+        scope.frame = frames.acquire(this->environment, node->slotCount);
+        this->environment = scope.frame;
+    }
 
+    Completion result;
     try
     {
         // Execute initializer once
@@ -1447,23 +1664,32 @@ void Interpreter::executeForStatement(ForStatementNode *node)
             execute(node->initializer.get());
         }
 
+        // Counted loops run on a native int until something deoptimises them
+        bool finished = false;
+        if (node->counted && node->counted->deopts < CountedLoop::maxDeopts)
+        {
+            finished = runCountedLoop(
+                node, [node](Interpreter &interpreter)
+                { return interpreter.execute(node->body.get()); },
+                result);
+        }
+
         // Execute condition, body, and increment in a loop
-        while (!node->condition || evaluate(node->condition.get()).asBool())
+        while (!finished && (!node->condition || evaluateCondition(node->condition.get())))
         {
-            try
+            // Execute the loop body
+            Completion completion = execute(node->body.get());
+            if (completion.type == Completion::Type::Break)
             {
-                // Execute the loop body
-                if (node->body)
-                {
-                    execute(node->body.get());
-                }
+                break;
             }
-            catch (BreakException &)
+            if (completion.type == Completion::Type::Return)
             {
-                // Break out of the loop
+                result = std::move(completion);
                 break;
             }
 
+            // Continue still runs the increment
             // Execute the increment expression
             if (node->increment)
             {
@@ -1477,24 +1703,97 @@ void Interpreter::executeForStatement(ForStatementNode *node)
             }
         }
     }
-    catch (ReturnException &)
+    catch (const std::exception &e)
     {
-        // Let return propagate up
-        this->environment = previous;
-        throw;
-    }
-    catch (const std::exception &e)
-    {
-        // Handle other exceptions and restore environment
+        // Handle other exceptions and restore environment
         this->environment = previous;
         throw std::runtime_error(std::string("Error in for statement: ") + e.what());
     }
 
     // Restore the previous environment
     this->environment = previous;
+    return result;
+}
+
+bool Interpreter::runCountedLoop(ForStatementNode *node, const std::function<Completion(Interpreter &)> &body,
+                                 Completion &result)
+{
+    CountedLoop &loop = *node->counted;
+    const std::string &name = static_cast<VariableDeclarationNode *>(node->initializer.get())->name;
+    Environment &scope = *environment;
+
+    Value start = scope.getAt(0, loop.slot, name);
+    if (!start.isInteger())
+    {
+        loop.deopts++;
+        return false;
+    }
+
+    int value = start.asInt();
+    while (true)
+    {
+        // Fused compare and branch: no condition node, no bool in between
+        Value bound = evaluate(loop.bound);
+        if (!bound.isInteger())
+        {
+            loop.deopts++;
+            return false;
+        }
+        if (!countedTest(loop.test, value, bound.asInt()))
+        {
+            return true;
+        }
+
+        Completion completion = body(*this);
+        if (completion.type == Completion::Type::Break)
+        {
+            return true;
+        }
+        if (completion.type == Completion::Type::Return)
+        {
+            result = std::move(completion);
+            return true;
+        }
+
+        // Guard: the body left i alone, otherwise the increment node takes
+        // it from whatever the body made of it
+        Value current = scope.getAt(0, loop.slot, name);
+        if (!current.isInteger() || current.asInt() != value)
+        {
+            TRACE(Interpreter, Debug, "Counted loop over '", name, "' deoptimised at line ", node->getLine());
+            loop.deopts++;
+            evaluate(node->increment.get());
+            return false;
+        }
+
+        // Fused increment and store
+        value += loop.step;
+        scope.assignAt(0, loop.slot, name, Value(value));
+    }
+}
+
+bool Interpreter::evaluateCondition(ExpressionNode *expr)
+{
+    if (auto compExpr = nodeCast<ComparisonExpressionNode>(expr))
+    {
+        Value left = evaluate(compExpr->left.get());
+        Value right = evaluate(compExpr->right.get());
+        if (auto result = quickened(compExpr->quickening, compExpr->op, left, right))
+            return result->asBool();
+        return compare(compExpr->op, left, right);
+    }
+    if (auto eqExpr = nodeCast<EqualityExpressionNode>(expr))
+    {
+        Value left = evaluate(eqExpr->left.get());
+        Value right = evaluate(eqExpr->right.get());
+        if (auto result = quickened(eqExpr->quickening, eqExpr->op, left, right))
+            return result->asBool();
+        return compare(eqExpr->op, left, right);
+    }
+    return evaluate(expr).asBool();
 }
 
-void Interpreter::executeSwitchStatement(SwitchStatementNode *node)
+Completion Interpreter::executeSwitchStatement(SwitchStatementNode *node)
 {
     if (!node || !node->condition)
     {
@@ -1504,74 +1803,106 @@ void Interpreter::executeSwitchStatement(SwitchStatementNode *node)
     // Evaluate the switch expression
     Value switchValue = evaluate(node->condition.get());
 
-    bool matchFound = false;
-    bool fallThrough = false;
-
     try
     {
-        // Iterate through all case clauses
-        for (const auto &caseClause : node->cases)
+        // The first clause that is a default or has a matching case, straight
+        // from the switch table if the value's type allows
+        int start = node->table ? findSwitchClause(*node->table, switchValue) : -1;
+        if (start < 0)
         {
-            if (!caseClause)
-                continue;
-
-            // Check if this is a default case or if we found a match
-            if (caseClause->isDefault || fallThrough)
+            start = static_cast<int>(node->cases.size());
+            for (size_t i = 0; i < node->cases.size(); i++)
             {
-                matchFound = true;
-            }
-            else if (caseClause->caseExpression)
-            {
-                // Evaluate the case expression
-                Value caseValue = evaluate(caseClause->caseExpression.get());
+                const auto &caseClause = node->cases[i];
+                if (!caseClause)
+                    continue;
 
-                // Check if the values match
-                if (switchValue == caseValue)
+                if (caseClause->isDefault ||
+                    (caseClause->caseExpression && switchValue == evaluate(caseClause->caseExpression.get())))
                 {
-                    matchFound = true;
+                    start = static_cast<int>(i);
+                    break;
                 }
             }
+        }
+
+        // Run the statements from there on, falling through into later clauses
+        for (size_t i = start; i < node->cases.size(); i++)
+        {
+            const auto &caseClause = node->cases[i];
+            if (!caseClause)
+                continue;
 
-            // If we found a match, execute the statements in this case
-            if (matchFound)
+            for (const auto &statement : caseClause->statements)
             {
-                try
+                Completion completion = execute(statement.get());
+                if (completion.type == Completion::Type::Break)
                 {
-                    for (const auto &statement : caseClause->statements)
-                    {
-                        execute(statement.get());
-                    }
-
-                    // Continue to next case (fall-through behavior)
-                    fallThrough = true;
+                    // Break encountered, exit the switch
+                    return Completion();
                 }
-                catch (BreakException &)
+                if (!completion.isNormal())
                 {
-                    // Break encountered, exit the switch
-                    return;
+                    // Return, or a continue for an enclosing loop
+                    return completion;
                 }
             }
         }
     }
-    catch (ReturnException &)
-    {
-        // Let return exceptions propagate up
-        throw;
-    }
     catch (const std::exception &e)
     {
         throw std::runtime_error("Error in switch statement: " + std::string(e.what()));
     }
+    return Completion();
+}
+
+int Interpreter::findSwitchClause(const SwitchTable &table, const Value &value)
+{
+    if (value.isInteger())
+    {
+        return table.find(value.asInt());
+    }
+    if (value.isString())
+    {
+        return table.find(value.stringView());
+    }
+    if (value.isFloat())
+    {
+        // Equal to an int case with the same float value, left to the scan
+        return -1;
+    }
+    // Null, bools and objects equal no int or string
+    return table.otherwise;
+}
+
+Completion Interpreter::executeBreakStatement(BreakStatementNode *)
+{
+    // Handled by the enclosing loop or switch
+    return Completion(Completion::Type::Break);
 }
 
-void Interpreter::executeBreakStatement(BreakStatementNode *node)
+Completion Interpreter::executeContinueStatement(ContinueStatementNode *)
 {
-    // Simply throw a BreakException to be caught by the enclosing loop or switch
-    throw BreakException();
+    // Handled by the enclosing loop, a switch passes it on
+    return Completion(Completion::Type::Continue);
 }
 
-void Interpreter::executeReturnStatement(ReturnStatementNode *node)
+Completion Interpreter::executeReturnStatement(ReturnStatementNode *node)
 {
+    if (node->tailCall)
+    {
+        // Evaluated like a call expression, only the call itself is left to
+        // returnCall
+        auto call = static_cast<CallExpressionNode *>(node->expression.get());
+        Value callee = evaluate(call->callee.get());
+        ArgumentFrame arguments(argumentStack);
+        for (const auto &arg : call->arguments)
+        {
+            argumentStack.push_back(evaluate(arg.get()));
+        }
+        return returnCall(callee, arguments.arguments());
+    }
+
     Value returnValue;
 
     if (node->expression)
@@ -1579,7 +1910,7 @@ void Interpreter::executeReturnStatement(ReturnStatementNode *node)
         returnValue = evaluate(node->expression.get());
     }
 
-    throw ReturnException(returnValue);
+    return Completion(Completion::Type::Return, std::move(returnValue));
 }
 
 void Interpreter::executeExpressionStatement(ExpressionStatementNode *node)
@@ -1591,25 +1922,41 @@ void Interpreter::executeConsoleLog(ConsoleLogNode *node)
 {
     if (!node || !node->expression)
     {
-        std::cout << std::endl;
+        output.endLine();
         return;
     }
 
-    Value value = evaluate(node->expression.get());
+    printValue(evaluate(node->expression.get()));
+}
 
-    // For boolean values, explicitly convert to "true" or "false" strings
-    if (value.getType() == Value::Type::Boolean)
+void Interpreter::printValue(const Value &value)
+{
+    // Integers, strings and booleans are written straight into the output
+    // buffer, anything else through its string form
+    if (value.isInteger())
+    {
+        output.write(value.asInt());
+    }
+    else if (value.isBoolean())
+    {
+        output.write(value.asBool() ? "true" : "false");
+    }
+    else if (value.isString())
     {
-        std::cout << (value.asBool() ? "true" : "false") << std::endl;
+        output.write(value.stringView());
     }
     else
     {
-        std::cout << value.toString() << std::endl;
+        output.write(value.toString());
     }
+    output.endLine();
 }
 
 void Interpreter::executeInputStatement(InputStatementNode *node)
 {
+    // A prompt printed before the input has to show up first
+    output.flush();
+
     std::string input;
     std::getline(std::cin, input);
 
@@ -1651,14 +1998,21 @@ void Interpreter::executeInputStatement(InputStatementNode *node)
             }
         }
 
-        environment->define(node->variable->name, inputValue);
+        if (node->variable->slot >= 0)
+        {
+            environment->defineAt(node->variable->slot, inputValue);
+        }
+        else
+        {
+            environment->define(node->variable->name, inputValue);
+        }
     }
 }
 
 void Interpreter::executeFunction(FunctionNode *node)
 {
     // CRITICAL FIX FOR MODULE IMPORTS: Create function with stronger reference preservation
-    DEBUG_LOG("Creating function: ", node->name);
+    TRACE(Interpreter, Debug, "Creating function: ", node->name);
 
     // Clone the function node to ensure it persists beyond AST lifetime
     auto nodeCopy = node->clone();
@@ -1675,18 +2029,18 @@ void Interpreter::executeFunction(FunctionNode *node)
     environment->define(node->name, functionValue);
 
     // Debug information
-    DEBUG_LOG("Function defined: ", node->name, " with declaration preserved");
+    TRACE(Interpreter, Debug, "Function defined: ", node->name, " with declaration preserved");
     if (nodeCopy && nodeCopy->body)
     {
-        DEBUG_LOG("  Body preserved at: ", nodeCopy->body.get());
-        DEBUG_LOG("  Body use_count: ", nodeCopy->body.use_count());
+        TRACE(Interpreter, Debug, "  Body preserved at: ", nodeCopy->body.get());
+        TRACE(Interpreter, Debug, "  Body use_count: ", nodeCopy->body.use_count());
     }
-    DEBUG_LOG("Defined function: ", node->name);
+    TRACE(Interpreter, Debug, "Defined function: ", node->name);
 }
 
 void Interpreter::executeClass(ClassNode *node)
 {
-    DEBUG_LOG("DEBUG: Executing class declaration for: ", node->name);
+    TRACE(Interpreter, Debug, "DEBUG: Executing class declaration for: ", node->name);
 
     // Create a new class
     auto klass = std::make_shared<Class>(node->name);
@@ -1704,7 +2058,7 @@ void Interpreter::executeClass(ClassNode *node)
             {
                 // Set the parent class reference
                 klass->parentClass = parentClassValue.asObject<Class>();
-                DEBUG_LOG("Class ", node->name, " extends ", node->baseClassName);
+                TRACE(Interpreter, Debug, "Class ", node->name, " extends ", node->baseClassName);
 
                 // Copy parent class field names
                 if (klass->parentClass)
@@ -1726,13 +2080,13 @@ void Interpreter::executeClass(ClassNode *node)
     // Define methods, collect field names, and look for constructor
     for (const auto &member : node->members)
     {
-        if (auto method = dynamic_cast<FunctionNode *>(member.get()))
+        if (auto method = nodeCast<FunctionNode>(member.get()))
         {
             // Clone the FunctionNode to ensure it persists beyond the AST lifetime
             auto clonedMethod = method->clone();
             auto methodNode = std::static_pointer_cast<FunctionNode>(clonedMethod);
 
-            DEBUG_LOG("Preserved body reference in function data");
+            TRACE(Interpreter, Debug, "Preserved body reference in function data");
 
             auto function = std::make_shared<Function>(methodNode);
 
@@ -1740,25 +2094,25 @@ void Interpreter::executeClass(ClassNode *node)
             if (method->name == "constructor")
             {
                 klass->constructor = function;
-                DEBUG_LOG("Found constructor for class ", node->name);
+                TRACE(Interpreter, Debug, "Found constructor for class ", node->name);
             }
             else
             {
                 klass->methods[method->name] = function;
-                DEBUG_LOG("Added method ", method->name, " to class ", node->name);
+                TRACE(Interpreter, Debug, "Added method ", method->name, " to class ", node->name);
             }
         }
         // Collect field names from variable declarations
-        else if (auto varDecl = dynamic_cast<VariableDeclarationNode *>(member.get()))
+        else if (auto varDecl = nodeCast<VariableDeclarationNode>(member.get()))
         {
             klass->fieldNames.push_back(varDecl->name);
-            DEBUG_LOG("Added field ", varDecl->name, " to class ", node->name);
+            TRACE(Interpreter, Debug, "Added field ", varDecl->name, " to class ", node->name);
         }
         // Support property declarations as well
-        else if (auto propDecl = dynamic_cast<PropertyDeclarationNode *>(member.get()))
+        else if (auto propDecl = nodeCast<PropertyDeclarationNode>(member.get()))
         {
             klass->fieldNames.push_back(propDecl->name);
-            DEBUG_LOG("Added property ", propDecl->name, " to class ", node->name);
+            TRACE(Interpreter, Debug, "Added property ", propDecl->name, " to class ", node->name);
         }
     }
 
@@ -1769,41 +2123,106 @@ void Interpreter::executeClass(ClassNode *node)
         // TODO: Implement default constructor that calls parent constructor
     }
 
+    // Lay out instances once, createInstance copies the template
+    buildInstanceTemplate(*klass);
+
     // Add the class to the environment
     environment->define(node->name, Value(std::static_pointer_cast<void>(klass), Value::Type::Class));
-    DEBUG_LOG("Defined class: ", node->name);
+    TRACE(Interpreter, Debug, "Defined class: ", node->name);
 }
 
 Value Interpreter::evaluateVariableExpression(VariableExpressionNode *node)
 {
-    DEBUG_LOG("=== EVALUATING VARIABLE: ", node->name, " ===");
+    TRACE(Interpreter, Verbose, "=== EVALUATING VARIABLE: ", node->name, " ===");
 
     try
     {
-        Value result = environment->get(node->name);
-        DEBUG_LOG("Variable '", node->name, "' found with type: ", static_cast<int>(result.getType()),
+        Value result = getVariable(node, node->depth, node->slot);
+        TRACE(Interpreter, Verbose, "Variable '", node->name, "' found with type: ", static_cast<int>(result.getType()),
                   ", isObject: ", result.isObject(),
                   ", value: ", result.toString());
         return result;
     }
     catch (const std::exception &e)
     {
-        DEBUG_LOG("ERROR: Variable '", node->name, "' not found: ", e.what());
+        TRACE(Interpreter, Verbose, "ERROR: Variable '", node->name, "' not found: ", e.what());
         throw;
     }
 }
 
+Value *Interpreter::thisField(VariableExpressionNode *node, int depth, int slot)
+{
+    Value self = environment->getAt(depth, slot, "this");
+    if (!self.isObject())
+    {
+        return nullptr;
+    }
+
+    // `this` is held by the method's Environment, so the slot outlives self
+    Object *object = self.asObject<Object>().get();
+    int field = lookupMember(*node->fieldCache, node, node->name, *object, true).slot;
+    return field >= 0 ? &object->slots[field] : nullptr;
+}
+
+Value Interpreter::getVariable(VariableExpressionNode *node, int depth, int slot)
+{
+    if (node->fieldCache)
+    {
+        Value *field = thisField(node, depth, slot);
+        return field ? *field : environment->get(node->name);
+    }
+    return slot >= 0 ? environment->getAt(depth, slot, node->name) : environment->get(node->name);
+}
+
+void Interpreter::setVariable(VariableExpressionNode *node, int depth, int slot, const Value &value)
+{
+    if (node->fieldCache)
+    {
+        if (Value *field = thisField(node, depth, slot))
+        {
+            *field = value;
+        }
+        else
+        {
+            environment->assign(node->name, value);
+        }
+    }
+    else if (slot >= 0)
+    {
+        environment->assignAt(depth, slot, node->name, value);
+    }
+    else
+    {
+        environment->assign(node->name, value);
+    }
+}
+
 Value Interpreter::evaluateUnaryExpression(UnaryExpressionNode *node)
 {
-    DEBUG_LOG("Evaluating unary expression: ", node->op);
+    TRACE(Interpreter, Verbose, "Evaluating unary expression: ", node->op);
+
+    // Quickened ++ or -- of a variable that has held an int every time
+    Quickening &site = node->quickening;
+    if (site.form == Quickening::Form::Int)
+    {
+        auto varExpr = static_cast<VariableExpressionNode *>(node->operand.get());
+        Value current = getVariable(varExpr, varExpr->depth, varExpr->slot);
+        if (current.isInteger())
+        {
+            Value next(current.asInt() + (site.op == Quickening::Op::Increment ? 1 : -1));
+            setVariable(varExpr, varExpr->depth, varExpr->slot, next);
+            return node->isPrefix ? next : current;
+        }
+        deoptimize(site);
+    }
 
     // For ++ and -- operators, we need special handling
     if (node->op == "++" || node->op == "--")
     {
         // The operand must be a variable or member access that we can modify
-        if (auto varExpr = dynamic_cast<VariableExpressionNode *>(node->operand.get()))
+        if (auto varExpr = nodeCast<VariableExpressionNode>(node->operand.get()))
         {
-            Value currentValue = environment->get(varExpr->name);
+            Value currentValue = getVariable(varExpr, varExpr->depth, varExpr->slot);
             Value newValue;
 
             if (node->op == "++")
@@ -1838,7 +2257,12 @@ Value Interpreter::evaluateUnaryExpression(UnaryExpressionNode *node)
             }
 
             // Update the variable
-            environment->assign(varExpr->name, newValue);
+            setVariable(varExpr, varExpr->depth, varExpr->slot, newValue);
+            if (site.form == Quickening::Form::Unknown)
+            {
+                site.op = decodeOperator(node->op);
+                observe(site, currentValue.isInteger() ? Quickening::Form::Int : Quickening::Form::Generic);
+            }
 
             // Return the appropriate value based on prefix/postfix
             if (node->isPrefix)
@@ -1850,7 +2274,7 @@ Value Interpreter::evaluateUnaryExpression(UnaryExpressionNode *node)
                 return currentValue; // Postfix: return old value
             }
         }
-        else if (auto memberExpr = dynamic_cast<MemberAccessExpressionNode *>(node->operand.get()))
+        else if (auto memberExpr = nodeCast<MemberAccessExpressionNode>(node->operand.get()))
         {
             // Handle increment/decrement on object members
             Value objectValue = evaluate(memberExpr->object.get());
@@ -1858,12 +2282,14 @@ Value Interpreter::evaluateUnaryExpression(UnaryExpressionNode *node)
             if (objectValue.isObject())
             {
                 auto obj = std::static_pointer_cast<Object>(objectValue.asObject<void>());
-                if (!obj->fields.count(memberExpr->memberName))
+                int slot = lookupMember(memberExpr->cache, memberExpr, memberExpr->memberName, *obj, true).slot;
+                Value *field = slot >= 0 ? &obj->slots[slot] : nullptr;
+                if (!field)
                 {
                     throw std::runtime_error("Object has no field: " + memberExpr->memberName);
                 }
 
-                Value currentValue = obj->fields[memberExpr->memberName];
+                Value currentValue = *field;
                 Value newValue;
 
                 if (node->op == "++")
@@ -1898,7 +2324,7 @@ Value Interpreter::evaluateUnaryExpression(UnaryExpressionNode *node)
                 }
 
                 // Update the field
-                obj->fields[memberExpr->memberName] = newValue;
+                *field = newValue;
 
                 // Return the appropriate value based on prefix/postfix
                 if (node->isPrefix)
@@ -1953,16 +2379,18 @@ Value Interpreter::evaluateUnaryExpression(UnaryExpressionNode *node)
 
 Value Interpreter::evaluateBinaryExpression(BinaryExpressionNode *node)
 {
-    DEBUG_LOG("Evaluating binary expression with operator: ", node->op);
+    TRACE(Interpreter, Verbose, "Evaluating binary expression with operator: ", node->op);
+
+    // Operands are evaluated left to right
+    Value left = evaluate(node->left.get());
+    Value right = evaluate(node->right.get());
+    if (auto result = quickened(node->quickening, node->op, left, right))
+        return *result;
 
     if (node->op == "+")
     {
-        // For addition, evaluate in standard left-to-right order
-        Value left = evaluate(node->left.get());
-        Value right = evaluate(node->right.get());
-
-        DEBUG_LOG("Left operand type: ", static_cast<int>(left.getType()));
-        DEBUG_LOG("Right operand type: ", static_cast<int>(right.getType()));
+        TRACE(Interpreter, Verbose, "Left operand type: ", static_cast<int>(left.getType()));
+        TRACE(Interpreter, Verbose, "Right operand type: ", static_cast<int>(right.getType()));
 
         // If either operand is a string, handle as string concatenation
         if (left.getType() == Value::Type::String || right.getType() == Value::Type::String)
@@ -1987,10 +2415,6 @@ Value Interpreter::evaluateBinaryExpression(BinaryExpressionNode *node)
         return left + right;
     }
 
-    // For other operators, use standard evaluation order
-    Value left = evaluate(node->left.get());
-    Value right = evaluate(node->right.get());
-
     if (node->op == "-")
         return left - right;
     if (node->op == "*")
@@ -2013,180 +2437,179 @@ Value Interpreter::evaluateBinaryExpression(BinaryExpressionNode *node)
 
 Value Interpreter::evaluateCallExpression(CallExpressionNode *node)
 {
-    DEBUG_LOG("=== EVALUATING CALL EXPRESSION ===");
+    TRACE(Interpreter, Verbose, "=== EVALUATING CALL EXPRESSION ===");
 
     // Check if this is a method call (object.method())
-    if (auto memberExpr = dynamic_cast<MemberAccessExpressionNode *>(node->callee.get()))
+    if (auto memberExpr = nodeCast<MemberAccessExpressionNode>(node->callee.get()))
     {
-        DEBUG_LOG("METHOD CALL DETECTED");
-        DEBUG_LOG("Method name: ", memberExpr->memberName);
+        TRACE(Interpreter, Verbose, "METHOD CALL DETECTED");
+        TRACE(Interpreter, Verbose, "Method name: ", memberExpr->memberName);
 
         // Debug the object expression before evaluating
-        if (auto varExpr = dynamic_cast<VariableExpressionNode *>(memberExpr->object.get()))
+        if (auto varExpr = nodeCast<VariableExpressionNode>(memberExpr->object.get()))
         {
-            DEBUG_LOG("Object is a variable: ", varExpr->name);
+            TRACE(Interpreter, Verbose, "Object is a variable: ", varExpr->name);
         }
         else
         {
-            DEBUG_LOG("Object is not a simple variable");
+            TRACE(Interpreter, Verbose, "Object is not a simple variable");
         }
 
         // First evaluate the object
-        DEBUG_LOG("About to evaluate object...");
+        TRACE(Interpreter, Verbose, "About to evaluate object...");
         Value object = evaluate(memberExpr->object.get());
-        DEBUG_LOG("Evaluated object type: ", static_cast<int>(object.getType()),
-                  ", isObject: ", object.isObject(),
-                  ", value: ", object.toString());
+        std::shared_ptr<Function> method = findMethod(node, memberExpr->memberName, object);
 
-        if (object.isObject())
+        // Prepare arguments
+        ArgumentFrame arguments(argumentStack);
+        for (const auto &arg : node->arguments)
         {
-            auto obj = object.asObject<Object>();
-            if (obj && obj->klass)
-            {
-                DEBUG_LOG("Object has class: ", obj->klass->name);
+            argumentStack.push_back(evaluate(arg.get()));
+        }
 
-                // Check if the class has the method
-                if (obj->klass->hasMethod(memberExpr->memberName))
-                {
-                    DEBUG_LOG("Method found in class");
+        // Call the method on the object, without binding a copy of it
+        TRACE(Interpreter, Verbose, "Calling method with ", node->arguments.size(), " arguments");
+        return callFunction(method, arguments.arguments(), object);
+    }
 
-                    // Get the method and bind it to the object
-                    auto method = obj->klass->getMethod(memberExpr->memberName);
+    // Regular function call path
+    TRACE(Interpreter, Verbose, "REGULAR FUNCTION CALL");
 
-                    // Debug check for method validity
-                    if (!method)
-                    {
-                        throw std::runtime_error("Method '" + memberExpr->memberName + "' is null");
-                    }
+    // First evaluate the callee
+    Value callee = evaluate(node->callee.get());
 
-                    if (!method->declaration)
-                    {
-                        throw std::runtime_error("Method '" + memberExpr->memberName + "' has null declaration");
-                    }
+    // Debug the callee type
+    if (auto varExpr = nodeCast<VariableExpressionNode>(node->callee.get()))
+    {
+        TRACE(Interpreter, Verbose, "Calling function: ", varExpr->name);
+    }
 
-                    DEBUG_LOG("Creating bound method for: ", memberExpr->memberName);
-                    DEBUG_LOG("Method declaration exists: ", (method->declaration != nullptr));
-                    DEBUG_LOG("Method closure exists: ", (method->closure != nullptr));
+    // Prepare arguments
+    ArgumentFrame arguments(argumentStack);
+    for (const auto &arg : node->arguments)
+    {
+        TRACE(Interpreter, Verbose, "Evaluating argument...");
+        argumentStack.push_back(evaluate(arg.get()));
+    }
+    TRACE(Interpreter, Verbose, "Call with ", node->arguments.size(), " arguments");
 
-                    auto boundMethod = std::make_shared<Function>(
-                        method->declaration,
-                        method->closure, // Preserve the original closure
-                        std::static_pointer_cast<void>(obj));
+    return callValue(callee, arguments.arguments());
+}
 
-                    // Prepare arguments
-                    std::vector<Value> arguments;
-                    for (const auto &arg : node->arguments)
-                    {
-                        arguments.push_back(evaluate(arg.get()));
-                    }
+std::shared_ptr<Function> Interpreter::findMethod(CallExpressionNode *node, const std::string &name, const Value &object)
+{
+    TRACE(Interpreter, Verbose, "Evaluated object type: ", static_cast<int>(object.getType()),
+              ", isObject: ", object.isObject(),
+              ", value: ", object.toString());
 
-                    // Call the method
-                    DEBUG_LOG("Calling method with ", arguments.size(), " arguments");
-                    return callFunction(boundMethod, arguments);
-                }
-                else
+    if (object.isObject())
+    {
+        auto obj = object.asObject<Object>();
+        if (obj && obj->klass)
+        {
+            TRACE(Interpreter, Verbose, "Object has class: ", obj->klass->name);
+
+            // Find the method through the call site's cache
+            std::shared_ptr<Function> method =
+                lookupMember(node->cache, node, name, *obj, false).method;
+            if (method)
+            {
+                TRACE(Interpreter, Verbose, "Method found in class");
+
+                // Debug check for method validity
+                if (!method->declaration)
                 {
-                    throw std::runtime_error("Method '" + memberExpr->memberName +
-                                             "' not found in class '" + obj->klass->name + "'");
+                    throw std::runtime_error("Method '" + name + "' has null declaration");
                 }
+
+                TRACE(Interpreter, Verbose, "Method declaration exists: ", (method->declaration != nullptr));
+                TRACE(Interpreter, Verbose, "Method closure exists: ", (method->closure != nullptr));
+                return method;
             }
             else
             {
-                DEBUG_LOG("Object has no class");
-                throw std::runtime_error("Object has no class");
+                throw std::runtime_error("Method '" + name +
+                                         "' not found in class '" + obj->klass->name + "'");
             }
         }
         else
         {
-            // Error case - trying to call a method on a non-object
-            std::string typeName;
-            switch (object.getType())
-            {
-            case Value::Type::Null:
-                typeName = "null";
-                break;
-            case Value::Type::Boolean:
-                typeName = "boolean";
-                break;
-            case Value::Type::Integer:
-                typeName = "integer";
-                break;
-            case Value::Type::Float:
-                typeName = "float";
-                break;
-            case Value::Type::String:
-                typeName = "string";
-                break;
-            case Value::Type::Object:
-                typeName = "object";
-                break;
-            case Value::Type::Function:
-                typeName = "function";
-                break;
-            case Value::Type::Class:
-                typeName = "class";
-                break;
-            default:
-                typeName = "unknown";
-                break;
-            }
-
-            DEBUG_LOG("ERROR: Object evaluated to non-object type: ", typeName);
-            throw std::runtime_error("Cannot access property '" + memberExpr->memberName +
-                                     "' of non-object value (type: " + typeName + ")");
+            TRACE(Interpreter, Verbose, "Object has no class");
+            throw std::runtime_error("Object has no class");
         }
     }
-
-    // Regular function call path
-    DEBUG_LOG("REGULAR FUNCTION CALL");
-
-    // First evaluate the callee
-    Value callee = evaluate(node->callee.get());
-
-    // Debug the callee type
-    if (auto varExpr = dynamic_cast<VariableExpressionNode *>(node->callee.get()))
+    else
     {
-        DEBUG_LOG("Calling function: ", varExpr->name);
-    }
+        // Error case - trying to call a method on a non-object
+        std::string typeName;
+        switch (object.getType())
+        {
+        case Value::Type::Null:
+            typeName = "null";
+            break;
+        case Value::Type::Boolean:
+            typeName = "boolean";
+            break;
+        case Value::Type::Integer:
+            typeName = "integer";
+            break;
+        case Value::Type::Float:
+            typeName = "float";
+            break;
+        case Value::Type::String:
+            typeName = "string";
+            break;
+        case Value::Type::Object:
+            typeName = "object";
+            break;
+        case Value::Type::Function:
+            typeName = "function";
+            break;
+        case Value::Type::Class:
+            typeName = "class";
+            break;
+        default:
+            typeName = "unknown";
+            break;
+        }
 
-    // Prepare arguments
-    std::vector<Value> arguments;
-    for (const auto &arg : node->arguments)
-    {
-        DEBUG_LOG("Evaluating argument...");
-        arguments.push_back(evaluate(arg.get()));
+        TRACE(Interpreter, Verbose, "ERROR: Object evaluated to non-object type: ", typeName);
+        throw std::runtime_error("Cannot access property '" + name +
+                                 "' of non-object value (type: " + typeName + ")");
     }
-    DEBUG_LOG("Call with ", arguments.size(), " arguments");
+}
 
+Value Interpreter::callValue(const Value &callee, std::span<const Value> arguments)
+{
     // Handle different callee types
     if (callee.isFunction())
     {
         // Regular function call
-        DEBUG_LOG("Calling a function");
+        TRACE(Interpreter, Verbose, "Calling a function");
         return callFunction(callee.asObject<Function>(), arguments);
     }
     else if (callee.isClass())
     {
         // Class instantiation - "new" operator simulation
         auto klass = callee.asObject<Class>();
-        DEBUG_LOG("Instantiating class: ", klass->name);
+        TRACE(Interpreter, Verbose, "Instantiating class: ", klass->name);
 
         Value instance = createInstance(klass, arguments);
-        DEBUG_LOG("Instance created, type: ", static_cast<int>(instance.getType()));
+        TRACE(Interpreter, Verbose, "Instance created, type: ", static_cast<int>(instance.getType()));
         return instance;
     }
-    else if (callee.getType() == Value::Type::Object && std::holds_alternative<std::shared_ptr<void>>(callee.getValue()))
+    else if (callee.isObject())
     {
         // Check if it's a native function wrapper
         try
         {
-            auto nativeFunc = std::static_pointer_cast<NativeFunctionWrapper>(std::get<std::shared_ptr<void>>(callee.getValue()));
-            DEBUG_LOG("Calling native function: ", nativeFunc->name);
-            return callNativeFunction(nativeFunc, arguments);
+            auto nativeFunc = callee.asObject<NativeFunctionWrapper>();
+            TRACE(Interpreter, Verbose, "Calling native function: ", nativeFunc->name);
+            return callNativeFunction(nativeFunc, std::vector<Value>(arguments.begin(), arguments.end()));
         }
         catch (const std::bad_cast &)
         {
-            DEBUG_LOG("Failed to cast to native function wrapper");
+            TRACE(Interpreter, Verbose, "Failed to cast to native function wrapper");
             throw std::runtime_error("Can only call functions");
         }
     }
@@ -2229,37 +2652,36 @@ Value Interpreter::evaluateAssignmentExpression(AssignmentExpressionNode *node)
 {
     Value rhs = evaluate(node->right.get());
 
-    if (auto varExpr = dynamic_cast<VariableExpressionNode *>(node->left.get()))
+    if (auto varExpr = nodeCast<VariableExpressionNode>(node->left.get()))
     {
         // Simple variable assignment
         if (node->op == "=")
         {
-            environment->assign(varExpr->name, rhs);
+            setVariable(varExpr, node->depth, node->slot, rhs);
             return rhs;
         }
 
         // Compound assignment (+=, -=, etc.)
-        Value lhs = environment->get(varExpr->name);
+        Value lhs = getVariable(varExpr, node->depth, node->slot);
+        Value result;
 
         if (node->op == "+=")
-            environment->assign(varExpr->name, lhs + rhs);
+            result = lhs + rhs;
         else if (node->op == "-=")
-            environment->assign(varExpr->name, lhs - rhs);
+            result = lhs - rhs;
         else if (node->op == "*=")
-            environment->assign(varExpr->name, lhs * rhs);
+            result = lhs * rhs;
         else if (node->op == "/=")
-            environment->assign(varExpr->name, lhs / rhs);
+            result = lhs / rhs;
         else if (node->op == "%=")
-        {
-            Value result = Value(lhs.asInt() % rhs.asInt());
-            environment->assign(varExpr->name, result);
-        }
+            result = Value(lhs.asInt() % rhs.asInt());
         else
             throw std::runtime_error("Unknown assignment operator: " + node->op);
 
-        return environment->get(varExpr->name);
+        setVariable(varExpr, node->depth, node->slot, result);
+        return result;
     }
-    else if (auto memberExpr = dynamic_cast<MemberAccessExpressionNode *>(node->left.get()))
+    else if (auto memberExpr = nodeCast<MemberAccessExpressionNode>(node->left.get()))
     {
         // Object property assignment
         Value object = evaluate(memberExpr->object.get());
@@ -2270,15 +2692,15 @@ Value Interpreter::evaluateAssignmentExpression(AssignmentExpressionNode *node)
         }
 
         auto obj = object.asObject<Object>();
+        int slot = lookupMember(memberExpr->cache, memberExpr, memberExpr->memberName, *obj, true).slot;
 
         // Handle compound assignment for properties
         if (node->op != "=")
         {
             Value lhs;
-            auto it = obj->fields.find(memberExpr->memberName);
-            if (it != obj->fields.end())
+            if (slot >= 0)
             {
-                lhs = it->second;
+                lhs = obj->slots[slot];
             }
 
             if (node->op == "+=")
@@ -2295,7 +2717,15 @@ Value Interpreter::evaluateAssignmentExpression(AssignmentExpressionNode *node)
                 throw std::runtime_error("Unknown assignment operator: " + node->op);
         }
 
-        obj->fields[memberExpr->memberName] = rhs;
+        if (slot >= 0)
+        {
+            obj->slots[slot] = rhs;
+        }
+        else
+        {
+            // New field: moves the object to another shape, so it's not cached
+            obj->setField(memberExpr->memberName, rhs);
+        }
         return rhs;
     }
 
@@ -2304,12 +2734,15 @@ Value Interpreter::evaluateAssignmentExpression(AssignmentExpressionNode *node)
 
 Value Interpreter::evaluateMemberAccessExpression(MemberAccessExpressionNode *node)
 {
-    DEBUG_LOG("Evaluating member access: ", node->memberName);
+    TRACE(Interpreter, Verbose, "Evaluating member access: ", node->memberName);
 
     // Evaluate the object expression directly - no special handling for simple variables
-    Value object = evaluate(node->object.get());
+    return getMember(node, evaluate(node->object.get()));
+}
 
-    DEBUG_LOG("Member access on object of type: ", static_cast<int>(object.getType()),
+Value Interpreter::getMember(MemberAccessExpressionNode *node, const Value &object)
+{
+    TRACE(Interpreter, Verbose, "Member access on object of type: ", static_cast<int>(object.getType()),
               ", isObject: ", object.isObject(),
               ", for property: ", node->memberName);
 
@@ -2356,42 +2789,123 @@ Value Interpreter::evaluateMemberAccessExpression(MemberAccessExpressionNode *no
         throw std::runtime_error("Failed to cast to Object");
     }
 
-    // Check if the property exists in the object's fields
-    auto it = obj->fields.find(node->memberName);
-    if (it != obj->fields.end())
+    // A quickened field read of an object of the shape it has always seen
+    Quickening &site = node->quickening;
+    if (site.form == Quickening::Form::Field)
     {
-        DEBUG_LOG("Found field: ", node->memberName);
-        return it->second;
+        if (obj->shape == site.shape)
+        {
+            node->cache.hits++;
+            return obj->slots[site.slot];
+        }
+        deoptimize(site);
+    }
+
+    // Fields shadow methods; both are found through the site's cache
+    MemberLookup member = lookupMember(node->cache, node, node->memberName, *obj, true);
+    if (site.form == Quickening::Form::Unknown)
+    {
+        // Only a shape the cache holds on to can be compared by address later
+        if (member.slot >= 0 && node->cache.find(obj->shape))
+        {
+            if (site.shape != obj->shape)
+            {
+                site.shape = obj->shape;
+                site.slot = member.slot;
+                site.runs = 0;
+            }
+            observe(site, Quickening::Form::Field);
+        }
+        else
+        {
+            observe(site, Quickening::Form::Generic);
+        }
+    }
+    if (member.slot >= 0)
+    {
+        TRACE(Interpreter, Verbose, "Found field: ", node->memberName);
+        return obj->slots[member.slot];
     }
 
-    // Check if the property exists as a method in the class
-    if (obj->klass && obj->klass->hasMethod(node->memberName))
+    if (member.method)
     {
-        DEBUG_LOG("Found method: ", node->memberName);
-        auto method = obj->klass->getMethod(node->memberName);
+        TRACE(Interpreter, Verbose, "Found method: ", node->memberName);
         // Bind method to this object
-        auto boundMethod = std::make_shared<Function>(
-            method->declaration,
-            method->closure, // Preserve the original closure
-            std::static_pointer_cast<void>(obj));
+        auto boundMethod = member.method->bind(obj);
         return Value(std::static_pointer_cast<void>(boundMethod), Value::Type::Function);
     }
 
     throw std::runtime_error("Undefined property: " + node->memberName);
 }
-Value Interpreter::evaluateIntegerLiteral(IntegerLiteralNode *node)
-{
-    return Value(node->value);
-}
 
-Value Interpreter::evaluateFloatingPointLiteral(FloatingPointLiteralNode *node)
+Interpreter::MemberLookup Interpreter::lookupMember(InlineCache &cache, const ASTNode *site, const std::string &name,
+                                                    const Object &object, bool withFields)
 {
-    return Value(node->value);
-}
+    // A shape belongs to exactly one class, so it also pins down the methods
+    const void *key = withFields ? static_cast<const void *>(object.shape)
+                                 : static_cast<const void *>(object.klass.get());
 
-Value Interpreter::evaluateStringLiteral(StringLiteralNode *node)
-{
-    return Value(node->value);
+    if (const InlineCache::Entry *entry = cache.find(key))
+    {
+        cache.hits++;
+        return {entry->slot, std::static_pointer_cast<Function>(entry->target)};
+    }
+
+    if (cache.misses++ == 0 && collectInlineCacheStats)
+    {
+        std::string description = nodeCast<const CallExpressionNode>(site)       ? "call ."
+                                  : nodeCast<const VariableExpressionNode>(site) ? "get this."
+                                                                                       : "get .";
+        inlineCacheSites.push_back({site->getLine(), description + name, &cache});
+    }
+
+    MemberLookup found;
+    if (withFields)
+    {
+        found.slot = object.shape->slotOf(name);
+    }
+    if (found.slot < 0)
+    {
+        found.method = object.klass->getMethod(name);
+    }
+
+    // Megamorphic sites keep their entries but stop adding to them. Misses
+    // are cached too, e.g. for a global name used inside a method
+    if (!cache.megamorphic)
+    {
+        cache.add({key, object.klass, found.method, found.slot});
+    }
+    return found;
+}
+
+void Interpreter::printInlineCacheStats(std::ostream &out) const
+{
+    out << "Inline cache stats (" << inlineCacheSites.size() << " sites):" << std::endl;
+    for (const auto &site : inlineCacheSites)
+    {
+        const InlineCache &cache = *site.cache;
+        uint64_t lookups = cache.hits + cache.misses;
+        double hitRate = lookups ? 100.0 * cache.hits / lookups : 0.0;
+
+        const char *state = cache.megamorphic ? "megamorphic" : cache.size > 1 ? "polymorphic" : "monomorphic";
+
+        out << "  line " << site.line << " " << site.description << ": " << cache.hits << " hits, "
+            << cache.misses << " misses (" << static_cast<int>(hitRate + 0.5) << "%), " << state << std::endl;
+    }
+}
+Value Interpreter::evaluateIntegerLiteral(IntegerLiteralNode *node)
+{
+    return Value(node->value);
+}
+
+Value Interpreter::evaluateFloatingPointLiteral(FloatingPointLiteralNode *node)
+{
+    return Value(node->value);
+}
+
+Value Interpreter::evaluateStringLiteral(StringLiteralNode *node)
+{
+    return Value(node->value);
 }
 
 Value Interpreter::evaluateBooleanLiteral(BooleanLiteralNode *node)
@@ -2404,7 +2918,37 @@ Value Interpreter::evaluateNullLiteral(NullLiteralNode *node)
     return Value(); // Default constructor creates a null value
 }
 
-Value Interpreter::callFunction(const std::shared_ptr<Function> &function, const std::vector<Value> &arguments)
+Value Interpreter::callFunction(const std::shared_ptr<Function> &function, std::span<const Value> arguments,
+                                const Value &self)
+{
+    Value result = invokeFunction(function, arguments, self);
+
+    // The body returned a tail call: make it here, in place of the body's
+    // frame rather than on top of it. Its arguments are swapped out of
+    // tailCall, so the next tail call reuses their storage
+    std::vector<Value> tailArguments;
+    while (tailCall.function)
+    {
+        std::shared_ptr<Function> callee = std::move(tailCall.function);
+        tailArguments.swap(tailCall.arguments);
+        result = invokeFunction(callee, tailArguments, Value());
+    }
+    return result;
+}
+
+Completion Interpreter::returnCall(const Value &callee, std::span<const Value> arguments)
+{
+    if (acceptsTailCall && callee.isFunction())
+    {
+        tailCall.function = callee.asObject<Function>();
+        tailCall.arguments.assign(arguments.begin(), arguments.end());
+        return Completion(Completion::Type::Return);
+    }
+    return Completion(Completion::Type::Return, callValue(callee, arguments));
+}
+
+Value Interpreter::invokeFunction(const std::shared_ptr<Function> &function, std::span<const Value> arguments,
+                                  const Value &self)
 {
     if (!function)
     {
@@ -2420,12 +2964,14 @@ Value Interpreter::callFunction(const std::shared_ptr<Function> &function, const
         throw std::runtime_error("Invalid function (no data)");
     }
 
+    callCount++;
+
     // Handle module functions using the module registry
     if (function->isModuleFunction && function->importedFunction)
     {
         // Get module and function information for logging
-        std::string moduleName = function->data->moduleName;
-        std::string functionName = function->originalFunctionName;
+        const std::string &moduleName = function->data->moduleName;
+        const std::string &functionName = function->originalFunctionName;
 
         // Copy essential information to ensure it's preserved in the function declaration
         if (function->declaration && function->importedFunction->declaration)
@@ -2443,222 +2989,206 @@ Value Interpreter::callFunction(const std::shared_ptr<Function> &function, const
             }
         }
 
-        DEBUG_LOG("Executing imported module function: ", moduleName, ".", functionName);
+        TRACE(Module, Debug, "Executing imported module function: ", moduleName, ".", functionName);
 
         // Print argument details for debugging
-        DEBUG_LOG("With ", arguments.size(), " arguments:");
+        TRACE(Module, Debug, "With ", arguments.size(), " arguments:");
         for (size_t i = 0; i < arguments.size(); i++)
         {
-            DEBUG_LOG("  Arg ", i, ": ", arguments[i].toString());
+            TRACE(Module, Debug, "  Arg ", i, ": ", arguments[i].toString());
         }
 
         // Print information about the imported function
         auto importedFunc = function->importedFunction;
-        DEBUG_LOG("Imported function details:");
-        DEBUG_LOG("  Name: ", (importedFunc->data ? importedFunc->data->name : "unknown"));
-        DEBUG_LOG("  Has declaration: ", (importedFunc->declaration ? "yes" : "no"));
-        DEBUG_LOG("  Parameter count: ", importedFunc->getParameterCount());
+        TRACE(Module, Debug, "Imported function details:");
+        TRACE(Module, Debug, "  Name: ", (importedFunc->data ? importedFunc->data->name : "unknown"));
+        TRACE(Module, Debug, "  Has declaration: ", (importedFunc->declaration ? "yes" : "no"));
+        TRACE(Module, Debug, "  Parameter count: ", importedFunc->getParameterCount());
 
         // Execute the function through the module registry
         // No hardcoded implementations - use the module system as designed
         Value result = gModuleRegistry.executeFunction(moduleName, functionName, arguments);
 
         // Debug the result
-        DEBUG_LOG(functionName, ":", result.toString());
+        TRACE(Module, Debug, functionName, ":", result.toString());
         return result;
     }
 
-    // Get the function name for debugging
-    std::string funcName = function->data->name;
-    DEBUG_LOG("Executing function: ", funcName, " with ", arguments.size(), " arguments");
-
-    // Create a new environment for the function execution
-    // Use the function's closure as parent environment if available, otherwise use globals
-    auto env = std::make_shared<Environment>(function->closure ? function->closure : globals);
+    bool isMethod = !self.isNull() || function->thisObject;
 
-    try
+    // Plain functions that compiled to bytecode run on the VM
+    if (const BytecodeFunction *code = isMethod ? nullptr : getBytecode(function))
     {
-        // Get parameter count from our data
-        size_t paramCount = function->getParameterCount();
+        return vm->run(function, code, arguments);
+    }
 
-        // Check argument count
-        if (arguments.size() != paramCount)
-        {
-            throw std::runtime_error("Expected " + std::to_string(paramCount) +
-                                     " arguments but got " + std::to_string(arguments.size()));
-        }
+    // Get the function name for debugging
+    const std::string &funcName = function->data->name;
+    TRACE(Interpreter, Verbose, "Executing function: ", funcName, " with ", arguments.size(), " arguments");
 
-        // Get parameter names safely
-        auto paramNames = function->getParameterNames();
+    // Take a frame for the function execution from the pool
+    // Use the function's closure as parent environment if available, otherwise use globals
+    FramePool::Lease frame(frames);
+    frame.frame = frames.acquire(function->closure ? function->closure : globals, 0);
+    const std::shared_ptr<Environment> &env = frame.frame;
 
-        // Bind arguments to parameters using our deep-copied names
-        for (size_t i = 0; i < paramCount; i++)
-        {
-            env->define(paramNames[i], arguments[i]);
-        }
-    }
-    catch (const std::exception &e)
+    // Check argument count
+    size_t paramCount = function->getParameterCount();
+    if (arguments.size() != paramCount)
     {
-        throw std::runtime_error(std::string("Error handling function parameters: ") + e.what());
+        throw std::runtime_error("Error handling function parameters: Expected " + std::to_string(paramCount) +
+                                 " arguments but got " + std::to_string(arguments.size()));
     }
 
-    // Set 'this' if the function is a method
-    if (function->thisObject)
-    {
-        env->define("this", Value(function->thisObject, Value::Type::Object));
+    // Bind arguments to parameters, the span is only valid until here
+    env->bindParameters(function->declaration.get(), *function->data, arguments);
 
-        // If this is a method call, make object fields accessible as variables
-        try
+    // Set 'this' if the function is a method. Its body reads and writes the
+    // object's fields through it (see Resolver)
+    if (isMethod)
+    {
+        Value selfValue = self.isNull() ? Value(function->thisObject, Value::Type::Object) : self;
+        if (function->declaration && function->declaration->thisSlot >= 0)
         {
-            auto object = std::static_pointer_cast<Object>(function->thisObject);
-            if (object && object->klass)
-            {
-                // Add all object fields to the environment
-                for (const auto &field : object->fields)
-                {
-                    env->define(field.first, field.second);
-                }
-            }
+            env->defineAt(function->declaration->thisSlot, selfValue);
         }
-        catch (const std::exception &e)
+        else
         {
-            DEBUG_LOG("Error setting up method fields: ", e.what());
+            env->define("this", selfValue);
         }
     }
 
-    try
-    {
-        std::string funcName = function->data ? function->data->name : "unknown";
-        DEBUG_LOG("Executing function: ", funcName);
-
-        // Check if this is a wrapper for an imported function
-        if (function->importedFunction)
-        {
-            DEBUG_LOG("Executing imported function through wrapper");
-            auto originalFunc = function->importedFunction;
+    Completion completion;
+    TailCallScope tailCalls(acceptsTailCall, true);
 
-            DEBUG_LOG("Debug info for imported function:");
-            DEBUG_LOG("  - Original function name: ", (originalFunc->data ? originalFunc->data->name : "unknown"));
-            DEBUG_LOG("  - Has declaration: ", (originalFunc->declaration ? "yes" : "no"));
-            DEBUG_LOG("  - Has closure: ", (originalFunc->closure ? "yes" : "no"));
-            // We need to create a proper execution environment for the imported function
-            // This environment should have the original function's closure as parent
-            // and contain all the parameter values passed to this wrapper call
+    // Check if this is a wrapper for an imported function
+    if (function->importedFunction)
+    {
+        TRACE(Module, Debug, "Executing imported function through wrapper");
+        auto originalFunc = function->importedFunction;
 
-            // Create a new environment with original function's closure as parent
-            auto importEnv = std::make_shared<Environment>(originalFunc->closure);
+        TRACE(Module, Debug, "Debug info for imported function:");
+        TRACE(Module, Debug, "  - Original function name: ", (originalFunc->data ? originalFunc->data->name : "unknown"));
+        TRACE(Module, Debug, "  - Has declaration: ", (originalFunc->declaration ? "yes" : "no"));
+        TRACE(Module, Debug, "  - Has closure: ", (originalFunc->closure ? "yes" : "no"));
+        // We need to create a proper execution environment for the imported function
+        // This environment should have the original function's closure as parent
+        // and contain all the parameter values passed to this wrapper call
 
-            // Bind the parameters to this new environment
-            auto paramNames = originalFunc->getParameterNames();
-            size_t paramCount = originalFunc->getParameterCount();
+        // Take a frame with the original function's closure as parent
+        FramePool::Lease importFrame(frames);
+        importFrame.frame = frames.acquire(originalFunc->closure, 0);
+        const std::shared_ptr<Environment> &importEnv = importFrame.frame;
 
-            DEBUG_LOG("  - Parameter count: ", paramCount);
+        TRACE(Module, Debug, "  - Parameter count: ", originalFunc->getParameterCount());
 
-            // Bind arguments to parameters
-            for (size_t i = 0; i < paramCount && i < arguments.size(); i++)
-            {
-                DEBUG_LOG("  - Binding parameter '", paramNames[i], "'");
-                importEnv->define(paramNames[i], arguments[i]);
-            }
+        // Bind arguments to parameters
+        importEnv->bindParameters(originalFunc->declaration.get(), *originalFunc->data, arguments);
 
-            // Execute using the original function's body and our new environment
-            if (originalFunc->declaration && originalFunc->declaration->body)
-            {
-                DEBUG_LOG("Using original function body with ",
-                          originalFunc->declaration->body->statements.size(), " statements");
+        // Execute using the original function's body and our new environment
+        if (originalFunc->declaration && originalFunc->declaration->body)
+        {
+            TRACE(Module, Debug, "Using original function body with ",
+                      originalFunc->declaration->body->statements.size(), " statements");
 
-                executeBlockStatement(originalFunc->declaration->body.get(), importEnv);
-            }
-            else
-            {
-                DEBUG_LOG("Original function body not found: ", funcName);
-                throw std::runtime_error("Original function body not available");
-            }
+            completion = executeBlockStatement(originalFunc->declaration->body.get(), importEnv);
         }
-        else if (function->declaration && function->declaration->body)
+        else
         {
-            DEBUG_LOG("Using declaration body with ", function->declaration->body->statements.size(), " statements");
-
-            // Direct execution of the function body
-            executeBlockStatement(function->declaration->body.get(), env);
+            TRACE(Module, Debug, "Original function body not found: ", funcName);
+            throw std::runtime_error("Original function body not available");
+        }
+    }
+    else if (function->declaration && function->declaration->body)
+    {
+        TRACE(Interpreter, Verbose, "Using declaration body with ", function->declaration->body->statements.size(), " statements");
 
-            // If this is a method call, sync modified fields back to the object
-            if (function->thisObject)
-            {
-                try
-                {
-                    auto object = std::static_pointer_cast<Object>(function->thisObject);
-                    if (object && object->klass)
-                    {
-                        // Update object fields from the environment
-                        for (const auto &fieldName : object->klass->fieldNames)
-                        {
-                            try
-                            {
-                                // Get the potentially modified value from the environment
-                                Value fieldValue = env->get(fieldName);
-                                // Update the object's field
-                                object->fields[fieldName] = fieldValue;
-                                DEBUG_LOG("Synced field ", fieldName, " back to object");
-                            }
-                            catch (const std::exception &)
-                            {
-                                // Field might not exist in environment, skip it
-                            }
-                        }
-                    }
-                }
-                catch (const std::exception &e)
-                {
-                    DEBUG_LOG("Error syncing method fields back to object: ", e.what());
-                }
-            }
+        // Direct execution of the function body, or of its closures
+        if (const ClosureBody *body = getClosures(function))
+        {
+            completion = executeClosureBody(*body, env);
         }
         else
         {
-            DEBUG_LOG("Function body not found: ", funcName);
-            throw std::runtime_error("Function body not available");
+            completion = executeBlockStatement(function->declaration->body.get(), env);
         }
-        // If no return statement was executed, return null
-        return Value();
     }
-    catch (const ReturnException &e)
+    else
+    {
+        TRACE(Interpreter, Debug, "Function body not found: ", funcName);
+        throw std::runtime_error("Function body not available");
+    }
+    // A stray break or continue ends the function like falling off its end
+    if (completion.type == Completion::Type::Return)
+    {
+        return completion.value;
+    }
+    // If no return statement was executed, return null
+    return Value();
+}
+
+const BytecodeFunction *Interpreter::getBytecode(const std::shared_ptr<Function> &function)
+{
+    // Methods and imported functions keep their special environment handling
+    if (!useBytecode || !function->data || !function->declaration ||
+        function->thisObject || function->importedFunction || function->isModuleFunction)
     {
-        // If this is a method call, sync modified fields back to the object before returning
-        if (function->thisObject)
+        return nullptr;
+    }
+
+    FunctionData &data = *function->data;
+    if (!data.bytecodeChecked)
+    {
+        data.bytecodeChecked = true;
+        data.bytecode = BytecodeCompiler::compile(function->declaration.get());
+        if (data.bytecode && TRACE_ENABLED(Interpreter, Debug))
         {
-            try
-            {
-                auto object = std::static_pointer_cast<Object>(function->thisObject);
-                if (object && object->klass)
-                {
-                    // Update object fields from the environment
-                    for (const auto &fieldName : object->klass->fieldNames)
-                    {
-                        try
-                        {
-                            // Get the potentially modified value from the environment
-                            Value fieldValue = env->get(fieldName);
-                            // Update the object's field
-                            object->fields[fieldName] = fieldValue;
-                            DEBUG_LOG("Synced field ", fieldName, " back to object (return)");
-                        }
-                        catch (const std::exception &)
-                        {
-                            // Field might not exist in environment, skip it
-                        }
-                    }
-                }
-            }
-            catch (const std::exception &e)
+            TRACE(Interpreter, Debug, data.bytecode->disassemble());
+        }
+    }
+    return data.bytecode.get();
+}
+
+const ClosureBody *Interpreter::getClosures(const std::shared_ptr<Function> &function)
+{
+    if (!useClosures || !function->data || !function->declaration)
+    {
+        return nullptr;
+    }
+
+    FunctionData &data = *function->data;
+    if (!data.closures)
+    {
+        data.closures = ClosureCompiler::compile(function->declaration->body.get());
+    }
+    return data.closures.get();
+}
+
+Completion Interpreter::executeClosureBody(const ClosureBody &body, std::shared_ptr<Environment> env)
+{
+    std::shared_ptr<Environment> previous = this->environment;
+    Completion completion;
+    this->environment = std::move(env);
+
+    try
+    {
+        for (const auto &statement : body.statements)
+        {
+            completion = statement(*this);
+            if (!completion.isNormal())
             {
-                DEBUG_LOG("Error syncing method fields back to object: ", e.what());
+                break;
             }
         }
-
-        // Return the value from the return statement
-        return e.getValue();
     }
+    catch (const std::exception &e)
+    {
+        this->environment = previous;
+        throw;
+    }
+
+    this->environment = previous;
+    return completion;
 }
 
 Value Interpreter::callNativeFunction(const std::shared_ptr<NativeFunctionWrapper> &function, const std::vector<Value> &arguments)
@@ -2674,91 +3204,37 @@ Value Interpreter::callNativeFunction(const std::shared_ptr<NativeFunctionWrappe
     return function->function(arguments);
 }
 
-Value Interpreter::createInstance(std::shared_ptr<Class> klass, const std::vector<Value> &arguments)
+void Interpreter::buildInstanceTemplate(Class &klass)
 {
-    DEBUG_LOG("Detected class instantiation: ", klass->name);
-
-    // Create a new object instance
-    auto object = std::make_shared<Object>(klass);
-
-    // Create a Value for this object right away
-    Value objectValue(std::static_pointer_cast<void>(object), Value::Type::Object);
-
-    // For classes without constructors, use field names from class declaration
-    if (!klass->constructor)
+    Shape *shape = klass.rootShape.get();
+    auto addField = [&](const std::string &fieldName)
     {
-        // Initialize declared fields with default values
-        if (!klass->fieldNames.empty())
+        int slot = shape->slotOf(fieldName);
+        if (slot < 0)
         {
-            for (const auto &fieldName : klass->fieldNames)
-            {
-                // Initialize all fields with default values (0)
-                object->fields[fieldName] = Value(0);
-                DEBUG_LOG("Pre-initialized field '", fieldName, "' with default value");
-            }
-
-            // Apply arguments to fields by position
-            for (size_t i = 0; i < std::min(arguments.size(), klass->fieldNames.size()); i++)
-            {
-                object->fields[klass->fieldNames[i]] = arguments[i];
-                DEBUG_LOG("Mapped argument ", i, " to field '", klass->fieldNames[i], "'");
-            }
-
-            // For any additional arguments that don't match field names
-            for (size_t i = klass->fieldNames.size(); i < arguments.size(); i++)
-            {
-                std::string fieldName = "arg" + std::to_string(i);
-                object->fields[fieldName] = arguments[i];
-                DEBUG_LOG("Mapped extra argument ", i, " to generic field '", fieldName, "'");
-            }
-        }
-        else
-        {
-            // Fallback to generic field names if no fields were declared
-            for (size_t i = 0; i < arguments.size(); i++)
-            {
-                std::string fieldName = "arg" + std::to_string(i);
-                object->fields[fieldName] = arguments[i];
-                DEBUG_LOG("No field names found, mapped argument ", i, " to generic field '", fieldName, "'");
-            }
+            slot = static_cast<int>(shape->names.size());
+            shape = shape->withField(fieldName);
         }
-    }
+        return static_cast<uint32_t>(slot);
+    };
 
-    // First, initialize with parent class constructor if available and this class doesn't
-    // have its own constructor
-    bool constructorCalled = false;
-    bool hasConstructor = klass->constructor != nullptr;
+    // Declared fields (including inherited ones) come first, in declaration order
+    for (const auto &fieldName : klass.fieldNames)
+    {
+        addField(fieldName);
+    }
 
-    if (!hasConstructor && klass->parentClass)
+    if (!klass.constructor)
     {
-        DEBUG_LOG("No constructor in ", klass->name, ", attempting to call parent constructor");
-        // Call parent constructor if available
-        if (klass->parentClass->constructor)
+        // Arguments are applied to the declared fields by position
+        for (const auto &fieldName : klass.fieldNames)
         {
-            auto parentConstructor = klass->parentClass->constructor;
-            auto boundConstructor = std::make_shared<Function>(
-                parentConstructor->declaration,
-                std::static_pointer_cast<void>(object));
-
-            try
-            {
-                // Call parent constructor
-                callFunction(boundConstructor, arguments);
-                constructorCalled = true;
-                DEBUG_LOG("Parent constructor for class ", klass->parentClass->name, " executed");
-            }
-            catch (const std::exception &e)
-            {
-                DEBUG_LOG("Error in parent constructor: ", e.what());
-            }
+            klass.argumentSlots.push_back({addField(fieldName)});
         }
     }
-
-    // For classes with constructors, initialize with default values and then apply constructor logic
-    if (klass->constructor)
+    else
     {
-        auto constructor = klass->constructor;
-        auto declaration = constructor->declaration;
+        auto declaration = klass.constructor->declaration;
 
         // First identify what parameters the constructor takes
         std::vector<std::string> paramNames;
@@ -2767,114 +3243,149 @@ Value Interpreter::createInstance(std::shared_ptr<Class> klass, const std::vecto
             paramNames.push_back(param->name);
         }
 
-        // First identify declared field names to initialize properly
-        std::vector<std::string> fieldsToInit = klass->fieldNames;
-
-        // First, scan constructor to find class variables (assignments to non-parameter variables)
+        // Scan constructor to find class variables (assignments to non-parameter variables)
         std::set<std::string> classVars;
         std::map<std::string, std::string> paramToClassVarMap;
 
-        // Track which parameter corresponds to which field
-        std::map<std::string, std::string> paramToFieldMap;
-
         if (declaration->body)
         {
             // Scan statements in constructor body to find assignments
             for (const auto &stmt : declaration->body->statements)
             {
-                if (auto exprStmt = dynamic_cast<ExpressionStatementNode *>(stmt.get()))
+                auto exprStmt = nodeCast<ExpressionStatementNode>(stmt.get());
+                auto assignExpr = exprStmt ? nodeCast<AssignmentExpressionNode>(exprStmt->expression.get()) : nullptr;
+                auto leftVar = assignExpr ? nodeCast<VariableExpressionNode>(assignExpr->left.get()) : nullptr;
+                if (!leftVar)
                 {
-                    if (auto assignExpr = dynamic_cast<AssignmentExpressionNode *>(exprStmt->expression.get()))
+                    continue;
+                }
+
+                // Check if this variable is in the field list or is a non-parameter
+                std::string fieldName = leftVar->name;
+                bool isField = std::find(klass.fieldNames.begin(), klass.fieldNames.end(), fieldName) != klass.fieldNames.end();
+                bool isParameter = std::find(paramNames.begin(), paramNames.end(), fieldName) != paramNames.end();
+                if (!isField && isParameter)
+                {
+                    continue;
+                }
+
+                classVars.insert(fieldName);
+                TRACE(Interpreter, Debug, "Identified class field: ", fieldName);
+
+                // If right side is a parameter reference, create mapping
+                if (auto rightVar = nodeCast<VariableExpressionNode>(assignExpr->right.get()))
+                {
+                    if (std::find(paramNames.begin(), paramNames.end(), rightVar->name) != paramNames.end())
                     {
-                        // Check if left side is a variable that might be a field
-                        if (auto leftVar = dynamic_cast<VariableExpressionNode *>(assignExpr->left.get()))
-                        {
-                            std::string fieldName = leftVar->name;
-
-                            // Check if this variable is in the field list or is a non-parameter
-                            bool isField = std::find(klass->fieldNames.begin(), klass->fieldNames.end(), fieldName) != klass->fieldNames.end();
-
-                            bool isParameter = std::find(paramNames.begin(), paramNames.end(), fieldName) != paramNames.end();
-
-                            if (isField || !isParameter)
-                            {
-                                classVars.insert(fieldName);
-                                DEBUG_LOG("Identified class field: ", fieldName);
-
-                                // If right side is a parameter reference, create mapping
-                                if (auto rightVar = dynamic_cast<VariableExpressionNode *>(assignExpr->right.get()))
-                                {
-                                    std::string paramName = rightVar->name;
-                                    if (std::find(paramNames.begin(), paramNames.end(), paramName) != paramNames.end())
-                                    {
-                                        // This is a parameter-to-field assignment
-                                        paramToClassVarMap[paramName] = fieldName;
-                                        DEBUG_LOG("Found assignment mapping parameter '", paramName,
-                                                  "' to field '", fieldName, "'");
-                                    }
-                                }
-                            }
-                        }
+                        paramToClassVarMap[rightVar->name] = fieldName;
+                        TRACE(Interpreter, Debug, "Found assignment mapping parameter '", rightVar->name,
+                                  "' to field '", fieldName, "'");
                     }
                 }
             }
         }
 
-        // Initialize all declared fields from class declaration
-        for (const auto &fieldName : klass->fieldNames)
+        // Parameters become fields as well, then any other detected class variables
+        for (const auto &paramName : paramNames)
         {
-            object->fields[fieldName] = Value(0);
-            DEBUG_LOG("Pre-initialized field '", fieldName, "' from class declaration");
+            addField(paramName);
         }
-
-        // Initialize parameter fields
-        for (const auto &paramName : paramNames)
+        for (const auto &classVar : classVars)
         {
-            object->fields[paramName] = Value(0);
-            DEBUG_LOG("Pre-initialized parameter '", paramName, "' with default value");
+            addField(classVar);
         }
 
-        // Initialize any other detected class variables
-        for (const auto &classVar : classVars)
+        // Each argument goes to its parameter's field and to the field it is assigned to
+        for (const auto &paramName : paramNames)
         {
-            if (object->fields.find(classVar) == object->fields.end())
+            std::vector<uint32_t> slots = {addField(paramName)};
+            auto it = paramToClassVarMap.find(paramName);
+            if (it != paramToClassVarMap.end())
             {
-                object->fields[classVar] = Value(0);
-                DEBUG_LOG("Pre-initialized class variable '", classVar, "' with default value");
+                slots.push_back(addField(it->second));
             }
+            klass.argumentSlots.push_back(std::move(slots));
         }
+    }
+
+    // Every field starts out as 0
+    klass.instanceShape = shape;
+    klass.fieldDefaults.assign(shape->names.size(), Value(0));
+    TRACE(Interpreter, Debug, "Class ", klass.name, " instances have ", shape->names.size(), " fields");
+}
+
+Value Interpreter::createInstance(std::shared_ptr<Class> klass, std::span<const Value> arguments)
+{
+    TRACE(Interpreter, Debug, "Detected class instantiation: ", klass->name);
 
-        // Now apply the actual argument values to parameters and mapped fields
-        for (size_t i = 0; i < declaration->parameters.size() && i < arguments.size(); i++)
+    // Create a new object instance
+    auto object = std::make_shared<Object>(klass);
+
+    // Create a Value for this object right away
+    Value objectValue(std::static_pointer_cast<void>(object), Value::Type::Object);
+
+    // Store the arguments into the slots executeClass worked out for them
+    for (size_t i = 0; i < std::min(arguments.size(), klass->argumentSlots.size()); i++)
+    {
+        for (uint32_t slot : klass->argumentSlots[i])
         {
-            std::string paramName = declaration->parameters[i]->name;
-            object->fields[paramName] = arguments[i];
-            DEBUG_LOG("Set parameter '", paramName, "' with argument ", i);
+            object->slots[slot] = arguments[i];
+        }
+    }
 
-            // If this parameter maps to a class field via constructor assignment, assign the argument value there
-            auto it = paramToClassVarMap.find(paramName);
-            if (it != paramToClassVarMap.end())
+    // Classes without constructors keep any extra arguments as generic fields
+    if (!klass->constructor)
+    {
+        for (size_t i = klass->fieldNames.size(); i < arguments.size(); i++)
+        {
+            std::string fieldName = "arg" + std::to_string(i);
+            object->setField(fieldName, arguments[i]);
+            TRACE(Interpreter, Debug, "Mapped extra argument ", i, " to generic field '", fieldName, "'");
+        }
+    }
+
+    // First, initialize with parent class constructor if available and this class doesn't
+    // have its own constructor
+    bool constructorCalled = false;
+    bool hasConstructor = klass->constructor != nullptr;
+
+    if (!hasConstructor && klass->parentClass)
+    {
+        TRACE(Interpreter, Debug, "No constructor in ", klass->name, ", attempting to call parent constructor");
+        // Call parent constructor if available
+        if (klass->parentClass->constructor)
+        {
+            auto parentConstructor = klass->parentClass->constructor;
+
+            try
             {
-                object->fields[it->second] = arguments[i];
-                DEBUG_LOG("Mapped parameter ", paramName, " (arg #", i, ") to field ", it->second);
+                // Call parent constructor
+                callFunction(parentConstructor, arguments, objectValue);
+                constructorCalled = true;
+                TRACE(Interpreter, Debug, "Parent constructor for class ", klass->parentClass->name, " executed");
+            }
+            catch (const std::exception &e)
+            {
+                TRACE(Interpreter, Debug, "Error in parent constructor: ", e.what());
             }
         }
+    }
 
-        // Create a function with this bound to the new object
-        auto boundConstructor = std::make_shared<Function>(
-            constructor->declaration,
-            std::static_pointer_cast<void>(object));
+    // For classes with constructors, initialize with default values and then apply constructor logic
+    if (klass->constructor)
+    {
+        auto constructor = klass->constructor;
 
         try
         {
-            // Call constructor
-            callFunction(boundConstructor, arguments);
+            // Call constructor with this bound to the new object
+            callFunction(constructor, arguments, objectValue);
             constructorCalled = true;
-            DEBUG_LOG("Constructor for class ", klass->name, " executed successfully");
+            TRACE(Interpreter, Debug, "Constructor for class ", klass->name, " executed successfully");
         }
         catch (const std::exception &e)
         {
-            DEBUG_LOG("Error in constructor for class ", klass->name, ": ", e.what());
+            TRACE(Interpreter, Debug, "Error in constructor for class ", klass->name, ": ", e.what());
             // Continue despite constructor error - object is still created
         }
     }
@@ -2885,36 +3396,57 @@ Value Interpreter::createInstance(std::shared_ptr<Class> klass, const std::vecto
         {
             auto constructor = klass->getMethod("constructor");
 
-            // Create a function with this bound to the new object
-            auto boundConstructor = std::make_shared<Function>(
-                constructor->declaration,
-                std::static_pointer_cast<void>(object));
-
             try
             {
-                // Call constructor
-                callFunction(boundConstructor, arguments);
+                // Call constructor with this bound to the new object
+                callFunction(constructor, arguments, objectValue);
                 constructorCalled = true;
-                DEBUG_LOG("Legacy constructor for class ", klass->name, " executed successfully");
+                TRACE(Interpreter, Debug, "Legacy constructor for class ", klass->name, " executed successfully");
             }
             catch (const std::exception &e)
             {
-                DEBUG_LOG("Error in legacy constructor for class ", klass->name, ": ", e.what());
+                TRACE(Interpreter, Debug, "Error in legacy constructor for class ", klass->name, ": ", e.what());
                 // Continue despite constructor error - object is still created
             }
         }
         else
         {
-            DEBUG_LOG("No constructor found for class ", klass->name);
+            TRACE(Interpreter, Debug, "No constructor found for class ", klass->name);
         }
     }
     return objectValue;
 }
 
 // Interpreter constructor
+std::shared_ptr<Environment> FramePool::acquire(std::shared_ptr<Environment> enclosing, int slotCount)
+{
+    if (frames.empty())
+    {
+        return std::make_shared<Environment>(std::move(enclosing), slotCount);
+    }
+
+    std::shared_ptr<Environment> frame = std::move(frames.back());
+    frames.pop_back();
+    frame->reset(std::move(enclosing), slotCount);
+    return frame;
+}
+
+void FramePool::release(std::shared_ptr<Environment> frame)
+{
+    // Frames a closure still refers to stay with the closure
+    if (!frame || frame.use_count() != 1 || frames.size() >= maxFrames)
+    {
+        return;
+    }
+
+    frame->clear();
+    frames.push_back(std::move(frame));
+}
+
 Interpreter::Interpreter(bool loadBuiltins) : environment(std::make_shared<Environment>())
 {
     globals = environment;
+    vm = std::make_shared<VM>(*this);
 
     // Only define native functions if requested
     if (loadBuiltins)
@@ -2932,39 +3464,40 @@ Interpreter::Interpreter(bool loadBuiltins) : environment(std::make_shared<Envir
 // Evaluate a function body with a specific environment
 Value Interpreter::evaluateFunctionBody(ASTNode *body, std::shared_ptr<Environment> env)
 {
-    DEBUG_LOG("evaluateFunctionBody: Start");
-    DEBUG_LOG("Body ptr: ", body);
-    DEBUG_LOG("Env ptr: ", env.get());
+    TRACE(Interpreter, Verbose, "evaluateFunctionBody: Start");
+    TRACE(Interpreter, Verbose, "Body ptr: ", body);
+    TRACE(Interpreter, Verbose, "Env ptr: ", env.get());
 
     // Save current environment
     auto previousEnv = environment;
-    DEBUG_LOG("Saved previous environment");
+    TRACE(Interpreter, Verbose, "Saved previous environment");
+
+    // Not run by callFunction, so tail call returns call right away
+    TailCallScope tailCalls(acceptsTailCall, false);
 
     try
     {
         // Set the execution environment
         environment = env;
-        DEBUG_LOG("Set new environment");
+        TRACE(Interpreter, Verbose, "Set new environment");
 
         // Execute the body
-        DEBUG_LOG("About to execute body...");
-        execute(body);
-        DEBUG_LOG("Body executed successfully");
+        TRACE(Interpreter, Verbose, "About to execute body...");
+        Completion completion = execute(body);
+        TRACE(Interpreter, Verbose, "Body executed successfully");
 
         // Restore previous environment
         environment = previousEnv;
 
+        // Return the value from the return statement
+        if (completion.type == Completion::Type::Return)
+        {
+            return completion.value;
+        }
+
         // If we get here without a return statement, return null
         return Value();
     }
-    catch (const ReturnException &e)
-    {
-        // Restore previous environment
-        environment = previousEnv;
-
-        // Return the value from the return statement
-        return e.getValue();
-    }
     catch (...)
     {
         // Restore previous environment
@@ -2979,7 +3512,9 @@ void Interpreter::defineNativeFunctions()
     auto defineNativeFunc = [this](const std::string &name, int paramCount, NativeFunction func)
     {
         auto wrapper = std::make_shared<NativeFunctionWrapper>(name, paramCount, func);
-        environment->define(name, Value(std::static_pointer_cast<void>(wrapper), Value::Type::Function));
+        // Boxed as an Object, which is how callValue tells them apart from a
+        // Function with a declaration
+        environment->define(name, Value(std::static_pointer_cast<void>(wrapper), Value::Type::Object));
     };
 
     // Math.abs
@@ -3039,5 +3574,13 @@ void Interpreter::defineNativeFunctions()
     // Random number generator
     defineNativeFunc("random", 0, [](const std::vector<Value> &args)
                      { return Value(static_cast<float>(rand()) / RAND_MAX); });
+
+    // Output functions
+
+    // flush, writes out everything printed so far
+    defineNativeFunc("flush", 0, [this](const std::vector<Value> &args)
+                     {
+        output.flush();
+        return Value(); });
 }
 // executeSwitchStatement is already defined above
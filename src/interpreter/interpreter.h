@@ -3,12 +3,18 @@
 #include <iostream>
 #include <memory>
 #include <map>
+#include <unordered_map>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <variant>
+#include <cstdint>
 #include <stdexcept>
+#include <algorithm>
 #include <functional>
+#include <span>
 #include "../debug.h"
+#include "output.h"
 #include "../parser/nodes.h" // Include full definition of FunctionNode and other AST nodes
 
 // Forward declarations of all node types needed to be handled
@@ -54,20 +60,18 @@ class ImportNode;
 class ExportNode;
 class ReExportNode;
 
-// Represents a runtime value in the interpreter
+// Represents a runtime value in the interpreter.
+//
+// A Value is one NaN-boxed 64-bit word. Floats are kept as the bits of a
+// double. Every other type sits in the payload of a negative quiet NaN with
+// the type in bits 48-50: null, booleans and integers are stored inline,
+// strings and objects (including functions and classes) point to a
+// refcounted heap cell. Copying an inline value copies the word, copying a
+// heap value bumps a plain (non-atomic) count; the interpreter never shares
+// values between threads.
 class Value
 {
 public:
-    // Use std::variant to store different possible value types
-    using ValueVariant = std::variant<
-        std::monostate,       // null
-        bool,                 // boolean
-        int,                  // integer
-        float,                // floating point
-        std::string,          // string
-        std::shared_ptr<void> // For objects, functions, etc.
-        >;
-
     enum class Type
     {
         Null,
@@ -80,30 +84,61 @@ public:
         Class
     };
 
-    Value() : type(Type::Null), value(std::monostate{}) {}
-    Value(bool val) : type(Type::Boolean), value(val) {}
-    Value(int val) : type(Type::Integer), value(val) {}
-    Value(float val) : type(Type::Float), value(val) {}
-    Value(const std::string &val) : type(Type::String), value(val) {}
-    Value(std::shared_ptr<void> val, Type t) : type(t), value(val) {}
+    Value() : bits(boxed(Type::Null, 0)) {}
+    Value(bool val) : bits(boxed(Type::Boolean, val ? 1 : 0)) {}
+    Value(int val) : bits(boxed(Type::Integer, static_cast<uint32_t>(val))) {}
+    Value(float val) : bits(floatBits(val)) {}
+    Value(const std::string &val);
+    Value(std::string &&val);
+    Value(std::shared_ptr<void> val, Type t);
+
+    Value(const Value &other) : bits(other.bits) { retain(); }
+    Value(Value &&other) noexcept : bits(other.bits) { other.bits = boxed(Type::Null, 0); }
+    Value &operator=(const Value &other)
+    {
+        other.retain();
+        release();
+        bits = other.bits;
+        return *this;
+    }
+    Value &operator=(Value &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            bits = other.bits;
+            other.bits = boxed(Type::Null, 0);
+        }
+        return *this;
+    }
+    ~Value() { release(); }
 
     // Type checking
-    bool isNull() const { return type == Type::Null; }
-    bool isBoolean() const { return type == Type::Boolean; }
-    bool isInteger() const { return type == Type::Integer; }
-    bool isFloat() const { return type == Type::Float; }
-    bool isString() const { return type == Type::String; }
-    bool isObject() const { return type == Type::Object; }
-    bool isFunction() const { return type == Type::Function; }
-    bool isClass() const { return type == Type::Class; }
+    bool isNull() const { return hasTag(Type::Null); }
+    bool isBoolean() const { return hasTag(Type::Boolean); }
+    bool isInteger() const { return hasTag(Type::Integer); }
+    bool isFloat() const { return !isBoxed(); }
+    bool isString() const { return hasTag(Type::String); }
+    bool isObject() const { return hasTag(Type::Object); }
+    bool isFunction() const { return hasTag(Type::Function); }
+    bool isClass() const { return hasTag(Type::Class); }
 
     // Value retrieval
     bool asBool() const;
     int asInt() const;
     float asFloat() const;
     std::string asString() const;
+    // The characters of a String value, without copying them
+    std::string_view stringView() const { return stringPayload(); }
     template <typename T>
-    std::shared_ptr<T> asObject() const;
+    std::shared_ptr<T> asObject() const
+    {
+        if (isHeap() && !isString())
+        {
+            return std::static_pointer_cast<T>(objectPayload());
+        }
+        throw std::runtime_error("Value is not an object");
+    }
 
     // String conversion for output
     std::string toString() const;
@@ -121,35 +156,109 @@ public:
     bool operator<=(const Value &other) const;
     bool operator>=(const Value &other) const;
 
-    Type getType() const { return type; }
-    const ValueVariant &getValue() const { return value; }
+    Type getType() const
+    {
+        return isBoxed() ? static_cast<Type>((bits >> 48) & 0x7) : Type::Float;
+    }
+
+    // The NaN-boxed word, and the word a type's boxed values start from, for
+    // native code that tests and builds Values itself (see Jit). Words below
+    // rawTag(Type::Null) are floats, words from rawTag(Type::String) up point
+    // to a heap cell
+    uint64_t raw() const { return bits; }
+    static constexpr uint64_t rawTag(Type type) { return boxed(type, 0); }
 
 private:
-    Type type;
-    ValueVariant value;
-};
+    // Boxed values have the sign, exponent and quiet bits set; the top 16 bits
+    // are 0xFFF8 | type. Float is never used as a tag, which keeps 0xFFFB free
+    // and makes every heap type (String and up) compare above heapMin.
+    static constexpr uint64_t boxPrefix = 0xFFF8000000000000ull;
+    static constexpr uint64_t heapMin = boxPrefix | (uint64_t(Type::String) << 48);
+    static constexpr uint64_t payloadMask = 0x0000FFFFFFFFFFFFull;
+    static constexpr uint64_t canonicalNaN = 0x7FF8000000000000ull;
+
+    struct HeapCell
+    {
+        uint32_t refCount = 1;
+    };
 
-// Exception class for handling return statements
-class ReturnException : public std::exception
-{
-public:
-    ReturnException(const Value &value) : returnValue(value) {}
+    struct StringCell : HeapCell
+    {
+        std::string value;
+    };
 
-    const Value &getValue() const { return returnValue; }
+    struct ObjectCell : HeapCell
+    {
+        std::shared_ptr<void> object;
+    };
 
-private:
-    Value returnValue;
+    uint64_t bits;
+
+    static constexpr uint64_t boxed(Type type, uint64_t payload)
+    {
+        return boxPrefix | (uint64_t(type) << 48) | payload;
+    }
+    static uint64_t floatBits(float val);
+    static uint64_t cellBits(Type type, HeapCell *cell)
+    {
+        return boxed(type, reinterpret_cast<uint64_t>(cell));
+    }
+
+    bool isBoxed() const { return (bits & boxPrefix) == boxPrefix; }
+    bool hasTag(Type type) const { return (bits & ~payloadMask) == boxed(type, 0); }
+    bool isHeap() const { return bits >= heapMin; }
+    HeapCell *cell() const { return reinterpret_cast<HeapCell *>(bits & payloadMask); }
+
+    void retain() const
+    {
+        if (isHeap())
+            ++cell()->refCount;
+    }
+    void release()
+    {
+        if (isHeap() && --cell()->refCount == 0)
+            destroy();
+    }
+    void destroy();
+
+    // Payload access, the type must already have been checked
+    bool boolPayload() const { return (bits & 1) != 0; }
+    int intPayload() const { return static_cast<int32_t>(static_cast<uint32_t>(bits)); }
+    float floatPayload() const;
+    const std::string &stringPayload() const { return static_cast<StringCell *>(cell())->value; }
+    const std::shared_ptr<void> &objectPayload() const { return static_cast<ObjectCell *>(cell())->object; }
 };
 
-// Exception class for handling break statements
-class BreakException : public std::exception
+static_assert(sizeof(void *) == 8, "Value keeps heap cell pointers in a 48 bit NaN payload");
+static_assert(sizeof(Value) == 8, "Value should be a single NaN-boxed word");
+
+// Result of executing a statement. Return, break and continue travel back up
+// to the loop, switch or call that handles them as a plain return value
+// instead of a C++ exception, so a function return costs no stack unwinding
+struct Completion
 {
-public:
-    BreakException() {}
+    enum class Type
+    {
+        Normal,
+        Return,
+        Break,
+        Continue
+    };
+
+    Type type = Type::Normal;
+    Value value; // Only set for Return
+
+    Completion() = default;
+    Completion(Type type, Value value = Value()) : type(type), value(std::move(value)) {}
+
+    bool isNormal() const { return type == Type::Normal; }
 };
 
 // Forward declarations
 class Environment;
+struct BytecodeFunction;
+struct ClosureBody;
+class VM;
 
 // Function and method representation
 // Forward declaration of internal function data
@@ -161,6 +270,13 @@ struct FunctionData
     std::shared_ptr<ASTNode> body;
     std::string moduleName; // For imported functions - tracks which module they came from
 
+    // Bytecode for the VM, compiled on the first call
+    std::shared_ptr<BytecodeFunction> bytecode;
+    bool bytecodeChecked = false; // True once compilation was attempted
+
+    // Closures for the body, compiled on the first call with --closures
+    std::shared_ptr<ClosureBody> closures;
+
     FunctionData() : moduleName("") {}
 
     // Create from FunctionNode (for deep copying)
@@ -270,7 +386,7 @@ struct Function
                 // Since we've updated FunctionNode to use shared_ptr for body,
                 // we can directly use it without any ownership concerns
                 data->body = std::static_pointer_cast<ASTNode>(decl->body);
-                DEBUG_LOG("Preserved body reference in function data");
+                TRACE(Interpreter, Debug, "Preserved body reference in function data");
             }
         }
     }
@@ -278,22 +394,22 @@ struct Function
     // Add a debug method to the Function class:
     void debugFunction() const
     {
-        DEBUG_LOG("Function debug info:");
-        DEBUG_LOG("- Name: ", (data ? data->name : "unknown"));
-        DEBUG_LOG("- Has declaration: ", (declaration ? "yes" : "no"));
-        DEBUG_LOG("- Parameter count: ", getParameterCount());
+        TRACE(Interpreter, Debug, "Function debug info:");
+        TRACE(Interpreter, Debug, "- Name: ", (data ? data->name : "unknown"));
+        TRACE(Interpreter, Debug, "- Has declaration: ", (declaration ? "yes" : "no"));
+        TRACE(Interpreter, Debug, "- Parameter count: ", getParameterCount());
 
         if (declaration && declaration->body)
         {
-            DEBUG_LOG("- Has body: yes, with ", declaration->body->statements.size(), " statements");
+            TRACE(Interpreter, Debug, "- Has body: yes, with ", declaration->body->statements.size(), " statements");
         }
         else if (data->body)
         {
-            DEBUG_LOG("- Has body: yes ");
+            TRACE(Interpreter, Debug, "- Has body: yes ");
         }
         else
         {
-            DEBUG_LOG("- Has body: no");
+            TRACE(Interpreter, Debug, "- Has body: no");
         }
     }
 
@@ -338,6 +454,15 @@ struct Function
     {
         return data ? data->parameters.size() : 0;
     }
+
+    // Copy bound to an object. Shares the declaration, closure and parameter
+    // data with the original, none of which change after creation
+    std::shared_ptr<Function> bind(std::shared_ptr<void> thisObj) const
+    {
+        auto bound = std::make_shared<Function>(*this);
+        bound->thisObject = std::move(thisObj);
+        return bound;
+    }
 };
 
 // Native function type (for built-in functions)
@@ -354,16 +479,60 @@ struct NativeFunctionWrapper
         : name(name), paramCount(paramCount), function(func) {}
 };
 
+// Hidden class: the layout of an object's fields. Each field name maps to a
+// slot in Object::slots. Objects with the same fields, added in the same
+// order, share one Shape; adding a field moves an object to the child shape
+// for that name, which is created once and then reused from transitions.
+// Shapes are owned by the tree rooted at their class's rootShape.
+struct Shape
+{
+    std::vector<std::string> names;                     // Slot -> field name
+    std::unordered_map<std::string, uint32_t> slots;    // Field name -> slot
+    std::unordered_map<std::string, std::unique_ptr<Shape>> transitions;
+
+    // Slot of a field, or -1 if objects of this shape don't have it
+    int slotOf(const std::string &name) const
+    {
+        auto it = slots.find(name);
+        return it != slots.end() ? static_cast<int>(it->second) : -1;
+    }
+
+    // Shape with one more field, appended as the last slot
+    Shape *withField(const std::string &name)
+    {
+        auto &next = transitions[name];
+        if (!next)
+        {
+            next = std::make_unique<Shape>();
+            next->names = names;
+            next->names.push_back(name);
+            next->slots = slots;
+            next->slots[name] = static_cast<uint32_t>(names.size());
+        }
+        return next.get();
+    }
+};
+
 // Class representation
 struct Class
 {
     std::string name;
-    std::map<std::string, std::shared_ptr<Function>> methods;
+    std::unordered_map<std::string, std::shared_ptr<Function>> methods;
     std::shared_ptr<Function> constructor; // Constructor method
     std::shared_ptr<Class> parentClass;
     std::vector<std::string> fieldNames; // Store field names from declarations
 
-    Class(const std::string &name) : name(name), constructor(nullptr), parentClass(nullptr) {}
+    // Instance template, computed once by executeClass: every new instance
+    // starts out with instanceShape and a copy of fieldDefaults, then
+    // constructor argument i is stored into each slot of argumentSlots[i]
+    std::unique_ptr<Shape> rootShape;
+    Shape *instanceShape;
+    std::vector<Value> fieldDefaults;
+    std::vector<std::vector<uint32_t>> argumentSlots;
+
+    Class(const std::string &name)
+        : name(name), constructor(nullptr), parentClass(nullptr),
+          rootShape(std::make_unique<Shape>()), instanceShape(rootShape.get()) {}
 
     bool hasMethod(const std::string &name) const
     {
@@ -408,10 +577,33 @@ class Environment;
 struct Object
 {
     std::shared_ptr<Class> klass;
-    std::map<std::string, Value> fields;
+    Shape *shape;             // Owned by klass, which the object keeps alive
+    std::vector<Value> slots; // Field values, laid out by shape
     std::shared_ptr<Environment> environment;
 
-    Object(std::shared_ptr<Class> klass) : klass(klass), environment(nullptr) {}
+    // Starts from the class's instance template
+    Object(std::shared_ptr<Class> klass)
+        : klass(klass), shape(klass->instanceShape), slots(klass->fieldDefaults), environment(nullptr) {}
+
+    // Field value, or nullptr if the object has no such field
+    Value *getField(const std::string &name)
+    {
+        int slot = shape->slotOf(name);
+        return slot >= 0 ? &slots[slot] : nullptr;
+    }
+
+    // Sets a field, adding it if the object doesn't have it yet
+    void setField(const std::string &name, Value value)
+    {
+        int slot = shape->slotOf(name);
+        if (slot >= 0)
+        {
+            slots[slot] = std::move(value);
+            return;
+        }
+        shape = shape->withField(name);
+        slots.push_back(std::move(value));
+    }
 };
 
 // Environment to store variables during execution
@@ -420,13 +612,15 @@ class Environment
 public:
     Environment() = default;
     Environment(std::shared_ptr<Environment> enclosing) : enclosing(enclosing) {}
+    Environment(std::shared_ptr<Environment> enclosing, int slotCount)
+        : slots(slotCount > 0 ? slotCount : 0), enclosing(enclosing) {}
 
     void define(const std::string &name, const Value &value)
     {
         // CRITICAL FIX: For import/export function preservation
         if (value.getType() == Value::Type::Function)
         {
-            std::cout << "MODULE FIX: Defining function " << name << " in environment" << std::endl;
+            TRACE(Module, Debug, "MODULE FIX: Defining function ", name, " in environment");
 
             // CRITICAL: Also define functions directly in the environment without ANY prefix
             // The exact original name is most important for direct access
@@ -463,6 +657,20 @@ public:
     }
 
     Value get(const std::string &name)
+    {
+        // Walk the scope chain by the exact name first, which allocates nothing
+        for (Environment *env = this; env; env = env->enclosing.get())
+        {
+            auto it = env->values.find(name);
+            if (it != env->values.end())
+            {
+                return it->second;
+            }
+        }
+        return getByAlternateName(name);
+    }
+
+    Value getByAlternateName(const std::string &name)
     {
         // Direct lookup first
         auto it = values.find(name);
@@ -485,7 +693,7 @@ public:
             auto altIt = values.find(altName);
             if (altIt != values.end())
             {
-                std::cout << "FUNCTION RESOLUTION: Found " << name << " via alternate name " << altName << std::endl;
+                TRACE(Module, Debug, "FUNCTION RESOLUTION: Found ", name, " via alternate name ", altName);
                 return altIt->second;
             }
         }
@@ -495,7 +703,7 @@ public:
         {
             try
             {
-                return enclosing->get(name);
+                return enclosing->getByAlternateName(name);
             }
             catch (const std::exception &e)
             {
@@ -514,7 +722,7 @@ public:
             auto baseIt = values.find(baseName);
             if (baseIt != values.end())
             {
-                std::cout << "LAST RESORT: Found " << name << " via base name " << baseName << std::endl;
+                TRACE(Module, Debug, "LAST RESORT: Found ", name, " via base name ", baseName);
                 return baseIt->second;
             }
         }
@@ -542,6 +750,76 @@ public:
         throw std::runtime_error("Undefined variable: " + name);
     }
 
+    // Slot access for variables the Resolver bound to a (depth, slot) pair.
+    // Falls back to a lookup by name if the scope chain doesn't have the slot,
+    // which only happens when a body runs in an environment it wasn't resolved for.
+    Value getAt(int depth, int slot, const std::string &name)
+    {
+        Environment *env = ancestor(depth);
+        if (env && slot < static_cast<int>(env->slots.size()))
+        {
+            return env->slots[slot];
+        }
+        return get(name);
+    }
+
+    void assignAt(int depth, int slot, const std::string &name, const Value &value)
+    {
+        Environment *env = ancestor(depth);
+        if (env && slot < static_cast<int>(env->slots.size()))
+        {
+            env->slots[slot] = value;
+            return;
+        }
+        assign(name, value);
+    }
+
+    void defineAt(int slot, const Value &value)
+    {
+        if (slot >= static_cast<int>(slots.size()))
+        {
+            slots.resize(slot + 1);
+        }
+        slots[slot] = value;
+    }
+
+    // Bind call arguments to parameters. Resolved bodies keep their parameters
+    // in the first slots of the function scope, anything else by name.
+    void bindParameters(const FunctionNode *declaration, const FunctionData &data,
+                        std::span<const Value> arguments)
+    {
+        size_t count = std::min(data.parameters.size(), arguments.size());
+        if (declaration && declaration->body && declaration->body->slotCount >= 0)
+        {
+            slots.resize(declaration->body->slotCount);
+            for (size_t i = 0; i < count; i++)
+            {
+                slots[i] = arguments[i];
+            }
+            return;
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            define(data.parameters[i].first, arguments[i]);
+        }
+    }
+
+    // Turn a pooled Environment into a fresh scope (see Interpreter::acquireFrame)
+    void reset(std::shared_ptr<Environment> newEnclosing, int slotCount)
+    {
+        enclosing = std::move(newEnclosing);
+        slots.resize(slotCount > 0 ? slotCount : 0);
+    }
+
+    // Drop everything the scope holds, but keep the slot capacity for reuse
+    void clear()
+    {
+        values.clear();
+        slots.clear();
+        enclosing.reset();
+    }
+
     bool contains(const std::string &name) const
     {
         if (values.find(name) != values.end())
@@ -559,7 +837,43 @@ public:
 
 private:
     std::map<std::string, Value> values;
+    std::vector<Value> slots; // Resolved variables, indexed by slot
     std::shared_ptr<Environment> enclosing;
+
+    Environment *ancestor(int depth)
+    {
+        Environment *env = this;
+        while (env && depth-- > 0)
+        {
+            env = env->enclosing.get();
+        }
+        return env;
+    }
+};
+
+// Recycles the Environments of function calls and block scopes, so the
+// steady state of a call allocates nothing. A frame goes back to the pool at
+// the end of its scope unless something else still holds on to it, e.g. a
+// closure created while it ran.
+class FramePool
+{
+public:
+    std::shared_ptr<Environment> acquire(std::shared_ptr<Environment> enclosing, int slotCount);
+    void release(std::shared_ptr<Environment> frame);
+
+    // Releases its frame when it goes out of scope, also by exception
+    struct Lease
+    {
+        FramePool &pool;
+        std::shared_ptr<Environment> frame;
+
+        explicit Lease(FramePool &pool) : pool(pool) {}
+        ~Lease() { pool.release(std::move(frame)); }
+    };
+
+private:
+    static constexpr size_t maxFrames = 256; // Deeper recursion allocates past this
+    std::vector<std::shared_ptr<Environment>> frames;
 };
 
 // Module representation
@@ -579,6 +893,8 @@ class Interpreter
 {
     // Make ModuleRegistry a friend class so it can access private members
     friend class ModuleRegistry;
+    friend class VM;
+    friend class ClosureCompiler;
 
 public:
     Interpreter(bool loadBuiltins = true);
@@ -589,6 +905,41 @@ public:
     // Set the base directory for resolving module paths
     void setBaseDirectory(const std::string &dir) { baseDirectory = dir; }
 
+    // Run functions on the bytecode VM (default) or keep everything on the AST walker
+    void setBytecodeEnabled(bool enabled) { useBytecode = enabled; }
+    bool isBytecodeEnabled() const { return useBytecode; }
+
+    // Compile hot bytecode functions to native code (see Jit). On by default
+    // where the JIT has stencils for the target
+    void setJitEnabled(bool enabled) { useJit = enabled; }
+    bool isJitEnabled() const { return useJit; }
+
+    // Compile what runs on the AST walker into closures (see ClosureCompiler)
+    // before running it: function bodies on their first call and the top
+    // level statements of the program
+    void setClosuresEnabled(bool enabled) { useClosures = enabled; }
+    bool isClosuresEnabled() const { return useClosures; }
+
+    // Run `return f(...)` in a function body as a tail call, in place of the
+    // returning function's frame (default). Without, every call keeps its
+    // frame, so a debugger sees the whole chain. Takes effect for programs
+    // interpreted after it was set, the Resolver marks the returns
+    void setTailCallsEnabled(bool enabled) { useTailCalls = enabled; }
+    bool isTailCallsEnabled() const { return useTailCalls; }
+
+    // Where print writes to. Flushed when interpret() returns
+    OutputSink &getOutput() { return output; }
+
+    // Number of edu function calls so far, on the AST walker and the VM
+    uint64_t getCallCount() const { return callCount; }
+
+    // Record the inline cache of every member access and method call site
+    // that runs, for printInlineCacheStats
+    void setInlineCacheStatsEnabled(bool enabled) { collectInlineCacheStats = enabled; }
+
+    // One line per recorded site: hits, misses, hit rate and cache state
+    void printInlineCacheStats(std::ostream &out) const;
+
     void preserveImportedFunctionBody(Value &functionValue);
 
     // Make the interpreter accessible to the module registry
@@ -607,8 +958,9 @@ public:
         environment = env;
     }
 
-    // Execute a statement directly
-    void execute(ASTNode *stmt);
+    // Execute a statement directly. Anything but a normal completion has to
+    // be handled by the caller (see Completion)
+    Completion execute(ASTNode *stmt);
 
     // Evaluate an expression directly
     Value evaluate(ExpressionNode *expr);
@@ -625,6 +977,64 @@ private:
     std::string baseDirectory;                                    // Base directory for resolving module paths
     std::map<std::string, std::shared_ptr<Module>> loadedModules; // Cache of loaded modules
     std::map<std::string, std::function<Value(const std::vector<Value> &)>> specialFunctions;
+    std::shared_ptr<VM> vm;                                       // Runs functions that compile to bytecode
+    bool useBytecode = true;                                      // False with --ast
+    bool useClosures = false;                                     // True with --closures
+    bool useJit = true;                                           // False with --no-jit
+    bool useTailCalls = true;                                     // False with --no-tail-calls
+    uint64_t callCount = 0;
+
+    // Call arguments are evaluated onto argumentStack and handed to the callee
+    // as a span, which stays valid until the callee has bound them
+    std::vector<Value> argumentStack;
+    FramePool frames;
+    OutputSink output;
+
+    // Arguments of one call, popped off argumentStack again when the frame
+    // goes out of scope, also by exception
+    struct ArgumentFrame
+    {
+        std::vector<Value> &stack;
+        size_t base;
+
+        explicit ArgumentFrame(std::vector<Value> &stack) : stack(stack), base(stack.size()) {}
+        ~ArgumentFrame() { stack.resize(base); }
+
+        std::span<const Value> arguments() const { return {stack.data() + base, stack.size() - base}; }
+    };
+
+    // A call a tail call return handed over (see returnCall). callFunction
+    // makes it once the body that returned is done, in place of that body's
+    // frame, so mutually recursive functions run in constant C++ stack
+    struct TailCall
+    {
+        std::shared_ptr<Function> function;
+        std::vector<Value> arguments;
+    };
+    TailCall tailCall;
+    bool acceptsTailCall = false; // True while the innermost body running was entered by callFunction
+
+    // Sets acceptsTailCall while it lives, also by exception. Code that runs
+    // a function body other than through callFunction refuses tail calls
+    struct TailCallScope
+    {
+        bool &accepts;
+        bool previous;
+
+        TailCallScope(bool &accepts, bool value) : accepts(accepts), previous(accepts) { accepts = value; }
+        ~TailCallScope() { accepts = previous; }
+    };
+
+    // Inline caches, see InlineCache in nodes.h
+    struct InlineCacheSite
+    {
+        int line;
+        std::string description;  // e.g. "call .sum", "get .x" or "get this.x"
+        const InlineCache *cache; // Owned by the site's node
+    };
+    bool collectInlineCacheStats = false;
+    std::vector<InlineCacheSite> inlineCacheSites;
+    std::vector<std::unique_ptr<ProgramNode>> modulePrograms; // Keeps module sites alive for the stats
 
     // Helper to register special function implementations
     void registerSpecialFunction(const std::string &name,
@@ -745,20 +1155,35 @@ private:
     // Execution methods for different node types
 
     // Statement execution
-    void executeBlockStatement(BlockStatementNode *node, std::shared_ptr<Environment> env = nullptr);
+    Completion executeBlockStatement(BlockStatementNode *node, std::shared_ptr<Environment> env = nullptr);
     void executeVariableDeclaration(VariableDeclarationNode *node);
-    void executeIfStatement(IfStatementNode *node);
-    void executeWhileStatement(WhileStatementNode *node);
-    void executeForStatement(ForStatementNode *node);
-    void executeSwitchStatement(SwitchStatementNode *node);
+    Completion executeIfStatement(IfStatementNode *node);
+    Completion executeWhileStatement(WhileStatementNode *node);
+    Completion executeForStatement(ForStatementNode *node);
+    Completion executeSwitchStatement(SwitchStatementNode *node);
+
+    // Runs a counted loop (see CountedLoop) from right after its initializer,
+    // with body running one iteration. False if it deoptimised, with the loop
+    // about to test its condition again for the generic loop to take over
+    bool runCountedLoop(ForStatementNode *node, const std::function<Completion(Interpreter &)> &body,
+                        Completion &result);
+
+    // The clause a switch table picks for a switch value, or -1 if its type
+    // needs the scan through the cases. Shared by the AST walker and the VM
+    static int findSwitchClause(const SwitchTable &table, const Value &value);
+
+    // An if or loop condition as a bool. Comparisons branch on the result of
+    // their quickened operation without evaluating it into a node value first
+    bool evaluateCondition(ExpressionNode *expr);
 
     // Specialized method for executing module functions directly
     // This avoids the recursion problem when executing imported functions
     Value executeModuleFunctionBody(std::shared_ptr<Function> function,
                                     std::shared_ptr<Environment> env,
                                     const std::vector<Value> &args);
-    void executeBreakStatement(BreakStatementNode *node);
-    void executeReturnStatement(ReturnStatementNode *node);
+    Completion executeBreakStatement(BreakStatementNode *node);
+    Completion executeContinueStatement(ContinueStatementNode *node);
+    Completion executeReturnStatement(ReturnStatementNode *node);
     void executeExpressionStatement(ExpressionStatementNode *node);
     void executeConsoleLog(ConsoleLogNode *node);
     void executeInputStatement(InputStatementNode *node);
@@ -779,15 +1204,62 @@ private:
     Value evaluateNullLiteral(NullLiteralNode *node);
 
     // Function execution
-    Value callFunction(const std::shared_ptr<Function> &function, const std::vector<Value> &arguments);
+    // A non-null self is the object a method is called on and overrides
+    // function->thisObject, so methods can be called without binding a copy
+    // of them first
+    Value callFunction(const std::shared_ptr<Function> &function, std::span<const Value> arguments,
+                       const Value &self = Value());
+    Value invokeFunction(const std::shared_ptr<Function> &function, std::span<const Value> arguments,
+                         const Value &self);
+
+    // The completion of `return callee(arguments)` marked as a tail call: a
+    // function is handed to callFunction in tailCall if it accepts one, other
+    // callees are called right away
+    Completion returnCall(const Value &callee, std::span<const Value> arguments);
     Value callNativeFunction(const std::shared_ptr<NativeFunctionWrapper> &function, const std::vector<Value> &arguments);
+    Value callValue(const Value &callee, std::span<const Value> arguments);
+
+    // Bytecode for a plain function call, or nullptr if it has to run on the AST
+    const BytecodeFunction *getBytecode(const std::shared_ptr<Function> &function);
+
+    // Closures for a function body, or nullptr if it runs on the AST walker
+    const ClosureBody *getClosures(const std::shared_ptr<Function> &function);
+    Completion executeClosureBody(const ClosureBody &body, std::shared_ptr<Environment> env);
+
+    // The method a call site calls on object, and the member a member access
+    // reads from it. Shared by the AST walker and the closures
+    std::shared_ptr<Function> findMethod(CallExpressionNode *node, const std::string &name, const Value &object);
+    Value getMember(MemberAccessExpressionNode *node, const Value &object);
+
+    // Output helper shared by console.log and the VM
+    void printValue(const Value &value);
 
     // Helper methods
     void defineNativeFunctions();
-    void lookForMainFunction(ProgramNode *program);
+    bool lookForMainFunction(ProgramNode *program);
 
     // Create object instance helper
-    Value createInstance(std::shared_ptr<Class> klass, const std::vector<Value> &arguments);
+    Value createInstance(std::shared_ptr<Class> klass, std::span<const Value> arguments);
+    void buildInstanceTemplate(Class &klass);
+
+    // Field slot and/or method a member name resolves to for an object,
+    // looked up through the site's inline cache. Method calls key the cache
+    // by class and only look for methods; other sites key it by shape and
+    // look for a field first
+    struct MemberLookup
+    {
+        int slot = -1;
+        std::shared_ptr<Function> method;
+    };
+    MemberLookup lookupMember(InlineCache &cache, const ASTNode *site, const std::string &name,
+                              const Object &object, bool withFields);
+
+    // Variables as bound by the Resolver: a slot, a field of `this` (depth and
+    // slot then locate `this`) or a name. The depth and slot are passed in as
+    // assignments keep their own
+    Value *thisField(VariableExpressionNode *node, int depth, int slot);
+    Value getVariable(VariableExpressionNode *node, int depth, int slot);
+    void setVariable(VariableExpressionNode *node, int depth, int slot, const Value &value);
 
     // Module handling
     std::shared_ptr<Module> loadModule(const std::string &modulePath);
@@ -0,0 +1,713 @@
+#include "jit.h"
+#include "../debug.h"
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+
+#if defined(__x86_64__) && defined(__linux__)
+#include <sys/mman.h>
+#define EDU_JIT_X86_64 1
+#endif
+
+// Set in the exit code of an instruction whose operands failed a guard
+static constexpr uint32_t guardFlag = 0x80000000u;
+
+bool Jit::isSupported()
+{
+#ifdef EDU_JIT_X86_64
+    return true;
+#else
+    return false;
+#endif
+}
+
+JitCode::~JitCode()
+{
+#ifdef EDU_JIT_X86_64
+    munmap(memory, size);
+#endif
+}
+
+JitExit JitCode::run(Value *registers, size_t pc) const
+{
+    // The entry stub at the start of the code sets up the fixed registers and
+    // jumps to the given address
+    using Entry = uint32_t (*)(Value *registers, const void *target);
+    auto entry = reinterpret_cast<Entry>(memory);
+    uint32_t exit = entry(registers, memory + offsets[pc]);
+    return {exit & ~guardFlag, (exit & guardFlag) != 0};
+}
+
+#ifdef EDU_JIT_X86_64
+
+// Machine code being stitched together from stencils, and the jump holes
+// still to be patched once every label is placed
+class Stitcher
+{
+public:
+    using Label = size_t;
+
+    std::vector<uint8_t> code;
+
+    void bytes(std::initializer_list<uint8_t> values) { code.insert(code.end(), values); }
+
+    void imm32(uint32_t value)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            code.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    void imm64(uint64_t value)
+    {
+        imm32(static_cast<uint32_t>(value));
+        imm32(static_cast<uint32_t>(value >> 32));
+    }
+
+    // Displacement of register r from rbx, which points to R[0]
+    void slot(uint16_t r) { imm32(static_cast<uint32_t>(r) * sizeof(Value)); }
+
+    Label label()
+    {
+        labels.push_back(unbound);
+        return labels.size() - 1;
+    }
+
+    void bind(Label label) { labels[label] = code.size(); }
+
+    // A jump or branch opcode followed by a rel32 hole for the label
+    void jump(std::initializer_list<uint8_t> opcode, Label target)
+    {
+        bytes(opcode);
+        holes.push_back({code.size(), target});
+        imm32(0);
+    }
+
+    bool patch()
+    {
+        for (const Hole &hole : holes)
+        {
+            if (labels[hole.target] == unbound)
+            {
+                return false;
+            }
+            auto rel = static_cast<int32_t>(static_cast<int64_t>(labels[hole.target]) -
+                                            static_cast<int64_t>(hole.at + 4));
+            std::memcpy(&code[hole.at], &rel, sizeof(rel));
+        }
+        return true;
+    }
+
+private:
+    static constexpr size_t unbound = std::numeric_limits<size_t>::max();
+
+    struct Hole
+    {
+        size_t at;
+        Label target;
+    };
+
+    std::vector<size_t> labels;
+    std::vector<Hole> holes;
+};
+
+// Stencil pieces. Native code keeps R[0] in rbx, the boxed Integer and
+// Boolean prefixes in r12 and r13, the lowest heap word in r14 and the
+// lowest boxed word in rbp; rax and rdx hold operands, rcx is scratch and
+// xmm0/xmm1 hold float operands.
+enum class Operand
+{
+    Rax,
+    Rdx
+};
+
+static const std::initializer_list<uint8_t> jae = {0x0F, 0x83};
+static const std::initializer_list<uint8_t> je = {0x0F, 0x84};
+static const std::initializer_list<uint8_t> jne = {0x0F, 0x85};
+static const std::initializer_list<uint8_t> jp = {0x0F, 0x8A};
+static const std::initializer_list<uint8_t> jmp = {0xE9};
+
+static uint32_t tagOf(Value::Type type)
+{
+    return static_cast<uint32_t>(Value::rawTag(type) >> 48);
+}
+
+static void load(Stitcher &s, Operand operand, uint16_t r)
+{
+    // mov rax/rdx, [rbx + r]
+    s.bytes({0x48, 0x8B, static_cast<uint8_t>(operand == Operand::Rax ? 0x83 : 0x93)});
+    s.slot(r);
+}
+
+static void store(Stitcher &s, uint16_t r)
+{
+    // mov [rbx + r], rax
+    s.bytes({0x48, 0x89, 0x83});
+    s.slot(r);
+}
+
+// R[r] is about to be overwritten, which would leak a heap value
+static void guardDestination(Stitcher &s, uint16_t r, Stitcher::Label exit)
+{
+    // cmp [rbx + r], r14; jae exit
+    s.bytes({0x4C, 0x39, 0xB3});
+    s.slot(r);
+    s.jump(jae, exit);
+}
+
+static void branchUnlessTag(Stitcher &s, Operand operand, Value::Type type, Stitcher::Label target)
+{
+    // mov rcx, rax/rdx; shr rcx, 48; cmp ecx, tag; jne target
+    s.bytes({0x48, 0x89, static_cast<uint8_t>(operand == Operand::Rax ? 0xC1 : 0xD1)});
+    s.bytes({0x48, 0xC1, 0xE9, 0x30});
+    s.bytes({0x81, 0xF9});
+    s.imm32(tagOf(type));
+    s.jump(jne, target);
+}
+
+static void branchUnlessFloat(Stitcher &s, Operand operand, Stitcher::Label target)
+{
+    // cmp rax/rdx, rbp; jae target
+    s.bytes({0x48, 0x39, static_cast<uint8_t>(operand == Operand::Rax ? 0xE8 : 0xEA)});
+    s.jump(jae, target);
+}
+
+static void boxInt(Stitcher &s)
+{
+    // or rax, r12
+    s.bytes({0x4C, 0x09, 0xE0});
+}
+
+static void boxBool(Stitcher &s)
+{
+    // movzx eax, al; or rax, r13
+    s.bytes({0x0F, 0xB6, 0xC0});
+    s.bytes({0x4C, 0x09, 0xE8});
+}
+
+static void intsToFloats(Stitcher &s)
+{
+    // cvtsi2ss xmm0, eax; cvtsi2ss xmm1, edx
+    s.bytes({0xF3, 0x0F, 0x2A, 0xC0});
+    s.bytes({0xF3, 0x0F, 0x2A, 0xCA});
+}
+
+static void narrowFloats(Stitcher &s)
+{
+    // movq xmm0, rax; movq xmm1, rdx; cvtsd2ss xmm0, xmm0; cvtsd2ss xmm1, xmm1
+    s.bytes({0x66, 0x48, 0x0F, 0x6E, 0xC0});
+    s.bytes({0x66, 0x48, 0x0F, 0x6E, 0xCA});
+    s.bytes({0xF2, 0x0F, 0x5A, 0xC0});
+    s.bytes({0xF2, 0x0F, 0x5A, 0xC9});
+}
+
+// Boxes the float in xmm0 into rax. A NaN has to be made canonical, which is
+// left to the VM
+static void widenFloat(Stitcher &s, Stitcher::Label exit)
+{
+    // cvtss2sd xmm0, xmm0; ucomisd xmm0, xmm0; jp exit; movq rax, xmm0
+    s.bytes({0xF3, 0x0F, 0x5A, 0xC0});
+    s.bytes({0x66, 0x0F, 0x2E, 0xC0});
+    s.jump(jp, exit);
+    s.bytes({0x66, 0x48, 0x0F, 0x7E, 0xC0});
+}
+
+// R[a] = R[b] op R[c] on two ints or two floats
+static void arithmetic(Stitcher &s, const Instruction &ins, std::initializer_list<uint8_t> intOp,
+                       std::initializer_list<uint8_t> floatOp, Stitcher::Label exit)
+{
+    Stitcher::Label floats = s.label();
+    Stitcher::Label done = s.label();
+
+    guardDestination(s, ins.a, exit);
+    load(s, Operand::Rax, ins.b);
+    load(s, Operand::Rdx, ins.c);
+    branchUnlessTag(s, Operand::Rax, Value::Type::Integer, floats);
+    branchUnlessTag(s, Operand::Rdx, Value::Type::Integer, exit);
+    s.bytes(intOp);
+    boxInt(s);
+    store(s, ins.a);
+    s.jump(jmp, done);
+
+    s.bind(floats);
+    branchUnlessFloat(s, Operand::Rax, exit);
+    branchUnlessFloat(s, Operand::Rdx, exit);
+    narrowFloats(s);
+    s.bytes(floatOp);
+    widenFloat(s, exit);
+    store(s, ins.a);
+    s.bind(done);
+}
+
+// R[a] = R[b] / R[c], a float even for two ints
+static void divide(Stitcher &s, const Instruction &ins, Stitcher::Label exit)
+{
+    Stitcher::Label floats = s.label();
+    Stitcher::Label quotient = s.label();
+
+    guardDestination(s, ins.a, exit);
+    load(s, Operand::Rax, ins.b);
+    load(s, Operand::Rdx, ins.c);
+    branchUnlessTag(s, Operand::Rax, Value::Type::Integer, floats);
+    branchUnlessTag(s, Operand::Rdx, Value::Type::Integer, exit);
+    intsToFloats(s);
+    s.jump(jmp, quotient);
+
+    s.bind(floats);
+    branchUnlessFloat(s, Operand::Rax, exit);
+    branchUnlessFloat(s, Operand::Rdx, exit);
+    narrowFloats(s);
+
+    // Division by zero throws from the VM: xorps xmm2, xmm2; ucomiss xmm1, xmm2; je exit
+    s.bind(quotient);
+    s.bytes({0x0F, 0x57, 0xD2});
+    s.bytes({0x0F, 0x2E, 0xCA});
+    s.jump(je, exit);
+    s.bytes({0xF3, 0x0F, 0x5E, 0xC1}); // divss xmm0, xmm1
+    widenFloat(s, exit);
+    store(s, ins.a);
+}
+
+// R[a] = R[b] % R[c] on two ints
+static void modulo(Stitcher &s, const Instruction &ins, Stitcher::Label exit)
+{
+    guardDestination(s, ins.a, exit);
+    load(s, Operand::Rax, ins.b);
+    load(s, Operand::Rdx, ins.c);
+    branchUnlessTag(s, Operand::Rax, Value::Type::Integer, exit);
+    branchUnlessTag(s, Operand::Rdx, Value::Type::Integer, exit);
+
+    // A zero divisor throws and -1 can trap, both are left to the VM:
+    // mov rcx, rdx; test ecx, ecx; je exit; cmp ecx, -1; je exit
+    s.bytes({0x48, 0x89, 0xD1});
+    s.bytes({0x85, 0xC9});
+    s.jump(je, exit);
+    s.bytes({0x83, 0xF9, 0xFF});
+    s.jump(je, exit);
+
+    // cdq; idiv ecx; mov eax, edx
+    s.bytes({0x99, 0xF7, 0xF9, 0x89, 0xD0});
+    boxInt(s);
+    store(s, ins.a);
+}
+
+// R[a] = R[b] op R[c] as a boolean. Ints compare like Value does: ordered as
+// floats, equal as ints
+static void compare(Stitcher &s, const Instruction &ins, Stitcher::Label exit)
+{
+    Stitcher::Label floats = s.label();
+    Stitcher::Label done = s.label();
+
+    guardDestination(s, ins.a, exit);
+    load(s, Operand::Rax, ins.b);
+    load(s, Operand::Rdx, ins.c);
+    branchUnlessTag(s, Operand::Rax, Value::Type::Integer, floats);
+    branchUnlessTag(s, Operand::Rdx, Value::Type::Integer, exit);
+
+    const std::initializer_list<uint8_t> intEqual = {0x39, 0xD0, 0x0F, 0x94, 0xC1}; // cmp eax, edx; sete cl
+    const std::initializer_list<uint8_t> less = {0x0F, 0x2E, 0xC8, 0x0F, 0x97, 0xC0};     // ucomiss xmm1, xmm0; seta al
+    const std::initializer_list<uint8_t> greater = {0x0F, 0x2E, 0xC1, 0x0F, 0x97, 0xC0};  // ucomiss xmm0, xmm1; seta al
+    const std::initializer_list<uint8_t> orEqual = {0x08, 0xC8};                          // or al, cl
+    switch (ins.op)
+    {
+    case OpCode::Less:
+        intsToFloats(s);
+        s.bytes(less);
+        break;
+    case OpCode::Greater:
+        intsToFloats(s);
+        s.bytes(greater);
+        break;
+    case OpCode::LessEqual:
+        s.bytes(intEqual);
+        intsToFloats(s);
+        s.bytes(less);
+        s.bytes(orEqual);
+        break;
+    case OpCode::GreaterEqual:
+        s.bytes(intEqual);
+        intsToFloats(s);
+        s.bytes(greater);
+        s.bytes(orEqual);
+        break;
+    case OpCode::Equal:
+        s.bytes({0x39, 0xD0, 0x0F, 0x94, 0xC0}); // cmp eax, edx; sete al
+        break;
+    default:
+        s.bytes({0x39, 0xD0, 0x0F, 0x95, 0xC0}); // cmp eax, edx; setne al
+        break;
+    }
+    boxBool(s);
+    store(s, ins.a);
+    s.jump(jmp, done);
+
+    // An unordered (NaN) operand makes everything but != false
+    s.bind(floats);
+    branchUnlessFloat(s, Operand::Rax, exit);
+    branchUnlessFloat(s, Operand::Rdx, exit);
+    narrowFloats(s);
+    switch (ins.op)
+    {
+    case OpCode::Less:
+        s.bytes(less);
+        break;
+    case OpCode::Greater:
+        s.bytes(greater);
+        break;
+    case OpCode::LessEqual:
+        s.bytes({0x0F, 0x2E, 0xC8, 0x0F, 0x93, 0xC0}); // ucomiss xmm1, xmm0; setae al
+        break;
+    case OpCode::GreaterEqual:
+        s.bytes({0x0F, 0x2E, 0xC1, 0x0F, 0x93, 0xC0}); // ucomiss xmm0, xmm1; setae al
+        break;
+    case OpCode::Equal:
+        // ucomiss xmm0, xmm1; sete al; setnp cl; and al, cl
+        s.bytes({0x0F, 0x2E, 0xC1, 0x0F, 0x94, 0xC0, 0x0F, 0x9B, 0xC1, 0x20, 0xC8});
+        break;
+    default:
+        // ucomiss xmm0, xmm1; setne al; setp cl; or al, cl
+        s.bytes({0x0F, 0x2E, 0xC1, 0x0F, 0x95, 0xC0, 0x0F, 0x9A, 0xC1, 0x08, 0xC8});
+        break;
+    }
+    boxBool(s);
+    store(s, ins.a);
+    s.bind(done);
+}
+
+// R[a] = op R[b] for ++, -- and unary minus on an int
+static void intUnary(Stitcher &s, const Instruction &ins, std::initializer_list<uint8_t> op, Stitcher::Label exit)
+{
+    guardDestination(s, ins.a, exit);
+    load(s, Operand::Rax, ins.b);
+    branchUnlessTag(s, Operand::Rax, Value::Type::Integer, exit);
+    s.bytes(op);
+    boxInt(s);
+    store(s, ins.a);
+}
+
+// R[a] = R[b].asBool(), negated for Not, on a boolean or an int
+static void truth(Stitcher &s, const Instruction &ins, bool negate, Stitcher::Label exit)
+{
+    Stitcher::Label notBool = s.label();
+    Stitcher::Label done = s.label();
+
+    guardDestination(s, ins.a, exit);
+    load(s, Operand::Rax, ins.b);
+    branchUnlessTag(s, Operand::Rax, Value::Type::Boolean, notBool);
+    if (negate)
+    {
+        s.bytes({0x48, 0x83, 0xF0, 0x01}); // xor rax, 1
+    }
+    store(s, ins.a);
+    s.jump(jmp, done);
+
+    s.bind(notBool);
+    branchUnlessTag(s, Operand::Rax, Value::Type::Integer, exit);
+    // test eax, eax; sete/setne al
+    s.bytes({0x85, 0xC0, 0x0F, static_cast<uint8_t>(negate ? 0x94 : 0x95), 0xC0});
+    boxBool(s);
+    store(s, ins.a);
+    s.bind(done);
+}
+
+// Jumps to target if R[a] is true (or false), for a boolean or an int
+static void conditionalJump(Stitcher &s, const Instruction &ins, bool ifTrue, Stitcher::Label target,
+                            Stitcher::Label exit)
+{
+    Stitcher::Label notBool = s.label();
+    Stitcher::Label done = s.label();
+    const std::initializer_list<uint8_t> taken = ifTrue ? jne : je;
+
+    load(s, Operand::Rax, ins.a);
+    branchUnlessTag(s, Operand::Rax, Value::Type::Boolean, notBool);
+    s.bytes({0xA8, 0x01}); // test al, 1
+    s.jump(taken, target);
+    s.jump(jmp, done);
+
+    s.bind(notBool);
+    branchUnlessTag(s, Operand::Rax, Value::Type::Integer, exit);
+    s.bytes({0x85, 0xC0}); // test eax, eax
+    s.jump(taken, target);
+    s.bind(done);
+}
+
+// Jumps to the label of the int in eax among cases[begin, end), which are
+// (value, label) sorted by value, by binary search, or to otherwise
+static void searchCases(Stitcher &s, const std::vector<std::pair<int, Stitcher::Label>> &cases, size_t begin,
+                        size_t end, Stitcher::Label otherwise)
+{
+    static const std::initializer_list<uint8_t> jl = {0x0F, 0x8C};
+
+    if (end - begin <= 3)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            s.bytes({0x3D}); // cmp eax, value
+            s.imm32(static_cast<uint32_t>(cases[i].first));
+            s.jump(je, cases[i].second);
+        }
+        s.jump(jmp, otherwise);
+        return;
+    }
+
+    size_t middle = begin + (end - begin) / 2;
+    Stitcher::Label lower = s.label();
+    s.bytes({0x3D}); // cmp eax, value
+    s.imm32(static_cast<uint32_t>(cases[middle].first));
+    s.jump(jl, lower);
+    searchCases(s, cases, middle, end, otherwise);
+    s.bind(lower);
+    searchCases(s, cases, begin, middle, otherwise);
+}
+
+// pc = the clause the table picks for the int in R[a]. Anything else goes on
+// to the compare chain after the instruction, as in the VM
+static bool switchJump(Stitcher &s, const Instruction &ins, const BytecodeFunction::SwitchJumps &jumps,
+                       const std::vector<Stitcher::Label> &instructions, Stitcher::Label next)
+{
+    const SwitchTable &table = *jumps.table;
+    auto label = [&](int clause, Stitcher::Label &result)
+    {
+        uint32_t target = jumps.targets[clause];
+        if (target >= instructions.size())
+            return false;
+        result = instructions[target];
+        return true;
+    };
+
+    std::vector<std::pair<int, Stitcher::Label>> cases;
+    for (size_t i = 0; i < table.jump.size(); i++)
+    {
+        if (table.jump[i] != table.otherwise)
+            cases.push_back({table.low + static_cast<int>(i), 0});
+    }
+    for (const auto &[value, clause] : table.sorted)
+    {
+        cases.push_back({value, 0});
+    }
+    for (auto &[value, target] : cases)
+    {
+        if (!label(table.find(value), target))
+            return false;
+    }
+    Stitcher::Label otherwise;
+    if (!label(table.otherwise, otherwise))
+        return false;
+
+    load(s, Operand::Rax, ins.a);
+    branchUnlessTag(s, Operand::Rax, Value::Type::Integer, next);
+    searchCases(s, cases, 0, cases.size(), otherwise);
+    return true;
+}
+
+static void loadWord(Stitcher &s, uint16_t r, uint64_t word, Stitcher::Label exit)
+{
+    // mov rax, word; mov [rbx + r], rax
+    guardDestination(s, r, exit);
+    s.bytes({0x48, 0xB8});
+    s.imm64(word);
+    store(s, r);
+}
+
+std::shared_ptr<JitCode> Jit::compile(const BytecodeFunction &function)
+{
+    const std::vector<Instruction> &code = function.code;
+    if (code.empty() || code.size() >= guardFlag)
+    {
+        return nullptr;
+    }
+
+    Stitcher s;
+    std::vector<Stitcher::Label> instructions;
+    std::vector<Stitcher::Label> exits;
+    for (size_t i = 0; i < code.size(); i++)
+    {
+        instructions.push_back(s.label());
+        exits.push_back(s.label());
+    }
+    Stitcher::Label epilogue = s.label();
+
+    // Entry: save the callee-saved registers we use, load the fixed ones and
+    // jump to the instruction to start at
+    s.bytes({0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x55}); // push rbx, r12, r13, r14, rbp
+    s.bytes({0x48, 0x89, 0xFB});                               // mov rbx, rdi
+    s.bytes({0x49, 0xBC});                                     // mov r12, Integer prefix
+    s.imm64(Value::rawTag(Value::Type::Integer));
+    s.bytes({0x49, 0xBD}); // mov r13, Boolean prefix
+    s.imm64(Value::rawTag(Value::Type::Boolean));
+    s.bytes({0x49, 0xBE}); // mov r14, lowest heap word
+    s.imm64(Value::rawTag(Value::Type::String));
+    s.bytes({0x48, 0xBD}); // mov rbp, lowest boxed word
+    s.imm64(Value::rawTag(Value::Type::Null));
+    s.bytes({0xFF, 0xE6}); // jmp rsi
+
+    std::vector<uint32_t> offsets(code.size());
+    std::vector<bool> guarded(code.size(), false);
+    for (size_t i = 0; i < code.size(); i++)
+    {
+        const Instruction &ins = code[i];
+        s.bind(instructions[i]);
+        offsets[i] = static_cast<uint32_t>(s.code.size());
+        guarded[i] = true;
+        bool native = true;
+
+        switch (ins.op)
+        {
+        case OpCode::Move:
+            guardDestination(s, ins.a, exits[i]);
+            load(s, Operand::Rax, ins.b);
+            s.bytes({0x4C, 0x39, 0xF0}); // cmp rax, r14
+            s.jump(jae, exits[i]);
+            store(s, ins.a);
+            break;
+        case OpCode::LoadConst:
+        {
+            uint64_t word = function.constants[ins.b].raw();
+            if (word >= Value::rawTag(Value::Type::String))
+            {
+                native = false;
+                break;
+            }
+            loadWord(s, ins.a, word, exits[i]);
+            break;
+        }
+        case OpCode::LoadNull:
+            loadWord(s, ins.a, Value().raw(), exits[i]);
+            break;
+        case OpCode::LoadBool:
+            loadWord(s, ins.a, Value(ins.b != 0).raw(), exits[i]);
+            break;
+        case OpCode::Add:
+            arithmetic(s, ins, {0x01, 0xD0}, {0xF3, 0x0F, 0x58, 0xC1}, exits[i]); // add eax, edx / addss
+            break;
+        case OpCode::Subtract:
+            arithmetic(s, ins, {0x29, 0xD0}, {0xF3, 0x0F, 0x5C, 0xC1}, exits[i]); // sub eax, edx / subss
+            break;
+        case OpCode::Multiply:
+            arithmetic(s, ins, {0x0F, 0xAF, 0xC2}, {0xF3, 0x0F, 0x59, 0xC1}, exits[i]); // imul eax, edx / mulss
+            break;
+        case OpCode::Divide:
+            divide(s, ins, exits[i]);
+            break;
+        case OpCode::Modulo:
+            modulo(s, ins, exits[i]);
+            break;
+        case OpCode::Less:
+        case OpCode::LessEqual:
+        case OpCode::Greater:
+        case OpCode::GreaterEqual:
+        case OpCode::Equal:
+        case OpCode::NotEqual:
+            compare(s, ins, exits[i]);
+            break;
+        case OpCode::Negate:
+            intUnary(s, ins, {0xF7, 0xD8}, exits[i]); // neg eax
+            break;
+        case OpCode::Increment:
+            intUnary(s, ins, {0x83, 0xC0, 0x01}, exits[i]); // add eax, 1
+            break;
+        case OpCode::Decrement:
+            intUnary(s, ins, {0x83, 0xE8, 0x01}, exits[i]); // sub eax, 1
+            break;
+        case OpCode::Not:
+            truth(s, ins, true, exits[i]);
+            break;
+        case OpCode::ToBool:
+            truth(s, ins, false, exits[i]);
+            break;
+        case OpCode::Jump:
+        case OpCode::JumpIfFalse:
+        case OpCode::JumpIfTrue:
+        {
+            int64_t target = static_cast<int64_t>(i) + 1 + ins.offset();
+            if (target < 0 || target >= static_cast<int64_t>(code.size()))
+            {
+                return nullptr;
+            }
+            if (ins.op == OpCode::Jump)
+            {
+                s.jump(jmp, instructions[target]);
+                guarded[i] = false;
+            }
+            else
+            {
+                conditionalJump(s, ins, ins.op == OpCode::JumpIfTrue, instructions[target], exits[i]);
+            }
+            break;
+        }
+        case OpCode::Switch:
+            // String tables are hashed by the VM
+            if (function.switches[ins.b].table->kind == SwitchTable::Kind::String || i + 1 >= code.size())
+            {
+                native = false;
+                break;
+            }
+            if (!switchJump(s, ins, function.switches[ins.b], instructions, instructions[i + 1]))
+            {
+                return nullptr;
+            }
+            guarded[i] = false;
+            break;
+        default:
+            // Calls, globals, printing and returns are left to the VM
+            native = false;
+            break;
+        }
+
+        if (!native)
+        {
+            // mov eax, i; jmp epilogue
+            guarded[i] = false;
+            s.bytes({0xB8});
+            s.imm32(static_cast<uint32_t>(i));
+            s.jump(jmp, epilogue);
+        }
+    }
+
+    // Guard failures leave through an exit of their own: mov eax, i | flag; jmp epilogue
+    for (size_t i = 0; i < code.size(); i++)
+    {
+        s.bind(exits[i]);
+        if (guarded[i])
+        {
+            s.bytes({0xB8});
+            s.imm32(static_cast<uint32_t>(i) | guardFlag);
+            s.jump(jmp, epilogue);
+        }
+    }
+
+    s.bind(epilogue);
+    s.bytes({0x5D, 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3}); // pop rbp, r14, r13, r12, rbx; ret
+
+    if (!s.patch())
+    {
+        return nullptr;
+    }
+
+    // Write the code, then make it executable but no longer writable
+    size_t size = s.code.size();
+    void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+    {
+        return nullptr;
+    }
+    std::memcpy(memory, s.code.data(), size);
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0)
+    {
+        munmap(memory, size);
+        return nullptr;
+    }
+
+    TRACE(Interpreter, Debug, "JIT: compiled '", function.name, "' to ", size, " bytes");
+    return std::make_shared<JitCode>(static_cast<uint8_t *>(memory), size, std::move(offsets));
+}
+
+#else
+
+std::shared_ptr<JitCode> Jit::compile(const BytecodeFunction &)
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "bytecode.h"
+
+// Where native code handed a function back to the VM: the instruction it did
+// not run, and whether that was because an operand failed a type guard
+struct JitExit
+{
+    size_t pc;
+    bool guardFailed;
+};
+
+// Native code for one BytecodeFunction, in its own executable mapping.
+//
+// It works on the VM's registers in place and can be entered at any
+// instruction. It runs until it reaches an instruction it has no code for
+// (calls, globals, printing, returns, heap values, ...) or one whose operands
+// fail a type guard, and returns that instruction's index without having run
+// any of it. The VM runs that instruction and enters the native code again
+// right after it.
+class JitCode
+{
+public:
+    JitCode(uint8_t *memory, size_t size, std::vector<uint32_t> offsets)
+        : memory(memory), size(size), offsets(std::move(offsets)) {}
+    ~JitCode();
+
+    JitCode(const JitCode &) = delete;
+    JitCode &operator=(const JitCode &) = delete;
+
+    JitExit run(Value *registers, size_t pc) const;
+
+    size_t codeSize() const { return size; }
+
+private:
+    uint8_t *memory;
+    size_t size;
+    std::vector<uint32_t> offsets; // Of each instruction's code in memory
+};
+
+// Copy-and-patch baseline JIT for bytecode functions on x86-64 Linux.
+//
+// Every instruction is lowered by copying its stencil, a fixed sequence of
+// machine code with holes for register offsets, constants and jump targets,
+// and patching the holes. Stencils take the int and float paths of
+// arithmetic, comparisons, increments and conditional jumps behind type
+// guards, and int switches binary search their case values; anything else
+// becomes an exit to the VM. The VM compiles a function
+// once it was called callThreshold times or took loopThreshold loop back
+// edges, and drops its native code again after maxDeopts failed guards.
+class Jit
+{
+public:
+    static constexpr uint32_t callThreshold = 16;
+    static constexpr uint32_t loopThreshold = 64;
+    static constexpr uint32_t maxDeopts = 64;
+
+    // False on targets without stencils, where compile() always fails
+    static bool isSupported();
+
+    // Native code for the function, or nullptr if it couldn't be compiled
+    static std::shared_ptr<JitCode> compile(const BytecodeFunction &function);
+};
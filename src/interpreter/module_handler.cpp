@@ -9,7 +9,7 @@
 // Constructor
 ModuleRegistry::ModuleRegistry() : interpreter(nullptr)
 {
-    DEBUG_LOG("Module registry initialized");
+    TRACE(Module, Debug, "Module registry initialized");
 }
 
 // Register a module's environment
@@ -17,7 +17,8 @@ void ModuleRegistry::registerModule(const std::string &moduleName,
                                     std::shared_ptr<Environment> moduleEnv)
 {
     moduleEnvironments[moduleName] = moduleEnv;
-    DEBUG_LOG("Registered module environment: ", moduleName);
+    resolvedFunctions.clear();
+    TRACE(Module, Debug, "Registered module environment: ", moduleName);
 }
 
 // Register a module's exported function
@@ -26,17 +27,19 @@ void ModuleRegistry::registerFunction(const std::string &moduleName,
                                       std::shared_ptr<Function> functionObj)
 {
     moduleFunctions[moduleName][functionName] = functionObj;
-    DEBUG_LOG("Registered function ", functionName, " from module ", moduleName);
+    resolvedFunctions.clear();
+    TRACE(Module, Debug, "Registered function ", functionName, " from module ", moduleName);
 }
 
 // Register a module function implementation
 void ModuleRegistry::registerModuleImplementation(
     const std::string &moduleName,
     const std::string &functionName,
-    std::function<Value(const std::vector<Value> &)> implementation)
+    std::function<Value(std::span<const Value>)> implementation)
 {
     moduleImplementations[moduleName][functionName] = implementation;
-    DEBUG_LOG("Registered implementation for ", moduleName, ".", functionName);
+    resolvedFunctions.clear();
+    TRACE(Module, Debug, "Registered implementation for ", moduleName, ".", functionName);
 }
 
 // Get a function from the registry
@@ -59,12 +62,18 @@ std::shared_ptr<Function> ModuleRegistry::getFunction(const std::string &moduleN
     return funcIt->second;
 }
 
-// Execute a function in its module's environment
-Value ModuleRegistry::executeFunction(const std::string &moduleName,
-                                      const std::string &functionName,
-                                      const std::vector<Value> &args)
+const ModuleRegistry::ResolvedFunction *ModuleRegistry::resolve(const std::string &moduleName,
+                                                                 const std::string &functionName)
 {
-    DEBUG_LOG("ModuleRegistry executing: ", moduleName, ".", functionName);
+    auto resolvedModuleIt = resolvedFunctions.find(moduleName);
+    if (resolvedModuleIt != resolvedFunctions.end())
+    {
+        auto resolvedIt = resolvedModuleIt->second.find(functionName);
+        if (resolvedIt != resolvedModuleIt->second.end())
+        {
+            return &resolvedIt->second;
+        }
+    }
 
     // Try different module name variations
     std::vector<std::string> possibleModuleNames = {
@@ -72,83 +81,106 @@ Value ModuleRegistry::executeFunction(const std::string &moduleName,
         moduleName + ".edu"};
 
     // Try to find the function using different module name formats
-    std::shared_ptr<Function> function = nullptr;
-    std::string actualModuleName;
-
+    ResolvedFunction resolved;
     for (const auto &modName : possibleModuleNames)
     {
-        function = getFunction(modName, functionName);
-        if (function)
+        resolved.function = getFunction(modName, functionName);
+        if (resolved.function)
         {
-            actualModuleName = modName;
-            DEBUG_LOG("Found function using module name: ", modName);
+            TRACE(Module, Debug, "Found function using module name: ", modName);
             break;
         }
     }
 
-    if (!function)
+    if (!resolved.function)
     {
-        DEBUG_LOG("Function not found: ", moduleName, ".", functionName);
-        return Value();
+        TRACE(Module, Debug, "Function not found: ", moduleName, ".", functionName);
+        return nullptr;
     }
 
     // Try to find the module environment using different name formats
-    std::shared_ptr<Environment> moduleEnv = nullptr;
-
     for (const auto &modName : possibleModuleNames)
     {
         auto moduleIt = moduleEnvironments.find(modName);
         if (moduleIt != moduleEnvironments.end())
         {
-            moduleEnv = moduleIt->second;
-            DEBUG_LOG("Found module environment using name: ", modName);
+            resolved.moduleEnv = moduleIt->second;
+            TRACE(Module, Debug, "Found module environment using name: ", modName);
             break;
         }
     }
 
-    if (!moduleEnv)
+    if (!resolved.moduleEnv)
     {
-        DEBUG_LOG("Module environment not found for: ", moduleName);
-        return Value();
+        TRACE(Module, Debug, "Module environment not found for: ", moduleName);
+        return nullptr;
     }
 
-    // Execute the imported function from the module
-
-    // First check if there's a registered implementation
+    // A registered implementation takes the place of the function
     auto moduleImplIt = moduleImplementations.find(moduleName);
     if (moduleImplIt != moduleImplementations.end())
     {
         auto funcImplIt = moduleImplIt->second.find(functionName);
         if (funcImplIt != moduleImplIt->second.end())
         {
-            DEBUG_LOG("Using registered implementation for ", moduleName, ".", functionName);
-            return funcImplIt->second(args);
+            resolved.implementation = &funcImplIt->second;
         }
     }
 
+    return &(resolvedFunctions[moduleName][functionName] = std::move(resolved));
+}
+
+// Execute a function in its module's environment
+Value ModuleRegistry::executeFunction(const std::string &moduleName,
+                                      const std::string &functionName,
+                                      std::span<const Value> args)
+{
+    TRACE(Module, Debug, "ModuleRegistry executing: ", moduleName, ".", functionName);
+
+    const ResolvedFunction *resolved = resolve(moduleName, functionName);
+    if (!resolved)
+    {
+        return Value();
+    }
+
+    // Execute the imported function from the module
+
+    // First check if there's a registered implementation
+    if (resolved->implementation)
+    {
+        TRACE(Module, Debug, "Using registered implementation for ", moduleName, ".", functionName);
+        return (*resolved->implementation)(args);
+    }
+
+    // Running the body can import and register more, which clears the resolutions
+    std::shared_ptr<Function> function = resolved->function;
+
     // This is the key part - we're not trying to execute the function ourselves
     // We're just delegating to the already-parsed function from when the module was imported
 
     // At this point, since we've registered the function during import, we just need to call it
     // with the right environment
 
-    // Create an environment for function execution with module environment as parent
-    auto execEnv = std::make_shared<Environment>(moduleEnv);
+    // Take a frame for function execution with module environment as parent
+    FramePool::Lease frame(interpreter->frames);
+    frame.frame = interpreter->frames.acquire(resolved->moduleEnv, 0);
+    const std::shared_ptr<Environment> &execEnv = frame.frame;
 
-    // Bind arguments to parameters
-    auto paramNames = function->getParameterNames();
-    for (size_t i = 0; i < paramNames.size() && i < args.size(); i++)
-    {
-        execEnv->define(paramNames[i], args[i]);
-        DEBUG_LOG("Binding param ", paramNames[i], " = ", args[i].toString());
-    }
     // Get the actual function to execute (which should have already been interpreted when imported)
     auto execFunction = function;
     if (function->importedFunction)
     {
         execFunction = function->importedFunction;
-        DEBUG_LOG("Using imported function reference");
+        TRACE(Module, Debug, "Using imported function reference");
+    }
+
+    // Bind arguments to parameters, in the slots the resolver gave the body if it has them
+    const auto &parameters = function->data->parameters;
+    for (size_t i = 0; i < parameters.size() && i < args.size(); i++)
+    {
+        TRACE(Module, Debug, "Binding param ", parameters[i].first, " = ", args[i].toString());
     }
+    execEnv->bindParameters(execFunction->declaration.get(), *function->data, args);
 
     // Debug the function structure
     // For module functions, we need to execute them differently to avoid circular calls
@@ -157,6 +189,9 @@ Value ModuleRegistry::executeFunction(const std::string &moduleName,
     // Save current environment
     auto previousEnv = interpreter->getEnvironment();
 
+    // Not run by callFunction, so tail call returns call right away
+    Interpreter::TailCallScope tailCalls(interpreter->acceptsTailCall, false);
+
     try
     {
         // Set up the execution environment with the module environment as parent
@@ -168,15 +203,20 @@ Value ModuleRegistry::executeFunction(const std::string &moduleName,
         {
 
             // Execute the function body in the current environment
-            interpreter->execute(execFunction->declaration->body.get());
+            Completion completion =
+                interpreter->executeBlockStatement(execFunction->declaration->body.get(), execEnv);
 
             // If we get here without a return, return null
             interpreter->setEnvironment(previousEnv);
+            if (completion.type == Completion::Type::Return)
+            {
+                return completion.value;
+            }
             return Value();
         }
         else
         {
-            DEBUG_LOG("ERROR: Module function missing body. Trying alternative execution.");
+            TRACE(Module, Debug, "ERROR: Module function missing body. Trying alternative execution.");
 
             // If the body is missing, try executing through the function's closure
             if (execFunction && execFunction->closure)
@@ -185,48 +225,40 @@ Value ModuleRegistry::executeFunction(const std::string &moduleName,
                 auto funcEnv = std::make_shared<Environment>(execFunction->closure);
 
                 // Bind parameters
-                auto paramNames = execFunction->getParameterNames();
-                for (size_t i = 0; i < paramNames.size() && i < args.size(); i++)
-                {
-                    funcEnv->define(paramNames[i], args[i]);
-                }
+                funcEnv->bindParameters(execFunction->declaration.get(), *execFunction->data, args);
 
                 interpreter->setEnvironment(funcEnv);
 
                 // Try to find and execute the body through the data
                 if (execFunction->data && execFunction->data->body)
                 {
-                    DEBUG_LOG("Executing via function data body");
-                    interpreter->execute(execFunction->data->body.get());
+                    TRACE(Module, Debug, "Executing via function data body");
+                    Completion completion = interpreter->execute(execFunction->data->body.get());
                     interpreter->setEnvironment(previousEnv);
+                    if (completion.type == Completion::Type::Return)
+                    {
+                        return completion.value;
+                    }
                     return Value();
                 }
             }
 
             // If all else fails, restore environment and return null
             interpreter->setEnvironment(previousEnv);
-            DEBUG_LOG("Failed to find executable body for module function");
+            TRACE(Module, Debug, "Failed to find executable body for module function");
             return Value();
         }
     }
-    catch (const ReturnException &e)
-    {
-        // Restore previous environment
-        interpreter->setEnvironment(previousEnv);
-
-        // Return the value from the return statement
-        return e.getValue();
-    }
     catch (const std::exception &e)
     {
         // Restore previous environment
         interpreter->setEnvironment(previousEnv);
-        DEBUG_LOG("Error executing module function: ", e.what());
+        TRACE(Module, Debug, "Error executing module function: ", e.what());
         throw;
     }
 
     // If we get here, something went wrong
-    DEBUG_LOG("Failed to execute module function: ", moduleName, ".", functionName);
+    TRACE(Module, Debug, "Failed to execute module function: ", moduleName, ".", functionName);
     return Value();
     return Value();
 }
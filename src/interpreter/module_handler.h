@@ -5,6 +5,7 @@
 #include <map>
 #include <memory>
 #include <functional>
+#include <span>
 
 // Forward declarations to avoid circular dependencies
 class Value;
@@ -31,12 +32,12 @@ public:
     void registerModuleImplementation(
         const std::string &moduleName,
         const std::string &functionName,
-        std::function<Value(const std::vector<Value> &)> implementation);
+        std::function<Value(std::span<const Value>)> implementation);
 
     // Execute a function in its module's environment
     Value executeFunction(const std::string &moduleName,
                           const std::string &functionName,
-                          const std::vector<Value> &args);
+                          std::span<const Value> args);
 
     // Get a registered function
     std::shared_ptr<Function> getFunction(const std::string &moduleName,
@@ -49,6 +50,18 @@ public:
     void setInterpreter(Interpreter *interp) { interpreter = interp; }
 
 private:
+    // What a module name and function name from a call site resolve to
+    struct ResolvedFunction
+    {
+        std::shared_ptr<Function> function;
+        std::shared_ptr<Environment> moduleEnv;
+        const std::function<Value(std::span<const Value>)> *implementation = nullptr;
+    };
+
+    // Looks the function up under the module name and the name with .edu once,
+    // later calls find it in resolvedFunctions. Null if it is not registered
+    const ResolvedFunction *resolve(const std::string &moduleName, const std::string &functionName);
+
     // Map of modules to their environments
     std::map<std::string, std::shared_ptr<Environment>> moduleEnvironments;
 
@@ -56,7 +69,11 @@ private:
     std::map<std::string, std::map<std::string, std::shared_ptr<Function>>> moduleFunctions;
 
     // Map of module function implementations
-    std::map<std::string, std::map<std::string, std::function<Value(const std::vector<Value> &)>>> moduleImplementations;
+    std::map<std::string, std::map<std::string, std::function<Value(std::span<const Value>)>>> moduleImplementations;
+
+    // Resolutions by the module and function name calls use, cleared when
+    // anything is registered
+    std::map<std::string, std::map<std::string, ResolvedFunction>> resolvedFunctions;
 
     // Temporary storage for pending module calls
     std::map<std::string, std::shared_ptr<Function>> pendingModuleCalls;
@@ -0,0 +1,97 @@
+#include "output.h"
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+
+OutputSink::OutputSink(int fd, size_t capacity)
+    : fd(fd), capacity(capacity > 0 ? capacity : 1), buffer(new char[this->capacity])
+{
+    setFlushPolicy(FlushPolicy::Auto);
+}
+
+OutputSink::~OutputSink()
+{
+    flush();
+}
+
+void OutputSink::setFlushPolicy(FlushPolicy policy)
+{
+    switch (policy)
+    {
+    case FlushPolicy::Auto:
+        lineBuffered = isatty(fd);
+        break;
+    case FlushPolicy::Full:
+        lineBuffered = false;
+        break;
+    case FlushPolicy::Line:
+        lineBuffered = true;
+        break;
+    }
+}
+
+void OutputSink::write(std::string_view text)
+{
+    if (text.size() > capacity - used)
+    {
+        flush();
+        // Too big to ever fit, skip the copy
+        if (text.size() >= capacity)
+        {
+            std::cout.flush();
+            writeAll(text.data(), text.size());
+            return;
+        }
+    }
+    std::memcpy(buffer.get() + used, text.data(), text.size());
+    used += text.size();
+}
+
+void OutputSink::write(char c)
+{
+    if (used == capacity)
+    {
+        flush();
+    }
+    buffer[used++] = c;
+}
+
+void OutputSink::write(int value)
+{
+    char digits[16];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    write(std::string_view(digits, result.ptr - digits));
+}
+
+void OutputSink::flush()
+{
+    if (used == 0)
+    {
+        return;
+    }
+    // Anything still sitting in std::cout (e.g. parser messages) came first
+    std::cout.flush();
+    writeAll(buffer.get(), used);
+    used = 0;
+}
+
+void OutputSink::writeAll(const char *data, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            // Nowhere left to report it, e.g. the reader of a pipe went away
+            return;
+        }
+        data += written;
+        size -= written;
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+// Buffered sink for the output of an edu program (print and friends).
+//
+// Output collects in one user-space buffer and goes out with a single write(2)
+// on the file descriptor, bypassing iostreams. When it goes out depends on the
+// flush policy; it is always written when the buffer fills up, when flush() is
+// called (also from the edu flush() builtin) and when the sink is destroyed.
+class OutputSink
+{
+public:
+    enum class FlushPolicy
+    {
+        Auto,      // Line when the descriptor is a terminal, otherwise Full
+        Full,      // Only when the buffer is full, on flush() and at exit
+        Line       // Also after every line
+    };
+
+    static constexpr size_t defaultCapacity = 64 * 1024;
+
+    explicit OutputSink(int fd = 1, size_t capacity = defaultCapacity);
+    ~OutputSink();
+
+    OutputSink(const OutputSink &) = delete;
+    OutputSink &operator=(const OutputSink &) = delete;
+
+    void setFlushPolicy(FlushPolicy policy);
+    bool isLineBuffered() const { return lineBuffered; }
+
+    void write(std::string_view text);
+    void write(char c);
+    void write(int value);
+
+    // Ends a line, flushing it if the sink is line buffered
+    void endLine()
+    {
+        write('\n');
+        if (lineBuffered)
+        {
+            flush();
+        }
+    }
+
+    // Writes out everything buffered so far
+    void flush();
+
+private:
+    int fd;
+    size_t capacity;
+    size_t used = 0;
+    std::unique_ptr<char[]> buffer;
+    bool lineBuffered;
+
+    void writeAll(const char *data, size_t size);
+};
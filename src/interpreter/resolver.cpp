@@ -0,0 +1,755 @@
+#include "resolver.h"
+#include "../debug.h"
+
+void Resolver::resolve(ProgramNode *program)
+{
+    if (!program)
+    {
+        return;
+    }
+
+    scopes.clear();
+    for (const auto &child : program->children)
+    {
+        resolveStatement(child.get());
+    }
+}
+
+// Declarations
+
+int Resolver::declare(const std::string &name)
+{
+    if (scopes.empty())
+    {
+        // Global code defines by name
+        return -1;
+    }
+
+    // Redeclaring in the same scope reuses the slot, like Environment::define overwrites
+    Scope &scope = scopes.back();
+    auto it = scope.slots.find(name);
+    if (it != scope.slots.end() && it->second >= 0)
+    {
+        return it->second;
+    }
+
+    scope.slots[name] = scope.count;
+    return scope.count++;
+}
+
+void Resolver::declareByName(const std::string &name)
+{
+    // Functions and classes are still defined by name, but they must shadow
+    // any slot with the same name further out
+    if (!scopes.empty())
+    {
+        scopes.back().slots[name] = -1;
+    }
+}
+
+bool Resolver::resolveName(const std::string &name, int &depth, int &slot) const
+{
+    depth = -1;
+    slot = -1;
+
+    int distance = 0;
+    for (auto it = scopes.rbegin(); it != scopes.rend(); ++it, ++distance)
+    {
+        auto found = it->slots.find(name);
+        if (found != it->slots.end())
+        {
+            if (found->second >= 0)
+            {
+                depth = distance;
+                slot = found->second;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void Resolver::resolveVariable(VariableExpressionNode *node, int &depth, int &slot)
+{
+    if (resolveName(node->name, depth, slot) || methodScope < 0)
+    {
+        node->fieldCache.reset();
+        return;
+    }
+
+    // Undeclared inside a method: check the fields of `this` first
+    depth = static_cast<int>(scopes.size()) - 1 - methodScope;
+    slot = scopes[methodScope].slots.at("this");
+    if (!node->fieldCache)
+    {
+        node->fieldCache = std::make_unique<InlineCache>();
+    }
+}
+
+// Statements
+
+void Resolver::resolveStatement(ASTNode *node)
+{
+    if (!node)
+    {
+        return;
+    }
+
+    switch (node->kind())
+    {
+    case NodeKind::BlockStatement:
+        resolveBlock(static_cast<BlockStatementNode *>(node));
+        break;
+    case NodeKind::VariableDeclaration:
+    {
+        auto *varDecl = static_cast<VariableDeclarationNode *>(node);
+        // The initializer can still see an outer variable with the same name
+        resolveExpression(varDecl->initializer.get());
+        varDecl->slot = declare(varDecl->name);
+        break;
+    }
+    case NodeKind::IfStatement:
+    {
+        auto *ifNode = static_cast<IfStatementNode *>(node);
+        resolveExpression(ifNode->condition.get());
+        resolveStatement(ifNode->thenBranch.get());
+        resolveStatement(ifNode->elseBranch.get());
+        break;
+    }
+    case NodeKind::WhileStatement:
+    {
+        auto *whileNode = static_cast<WhileStatementNode *>(node);
+        resolveExpression(whileNode->condition.get());
+        resolveStatement(whileNode->body.get());
+        break;
+    }
+    case NodeKind::ForStatement:
+        resolveFor(static_cast<ForStatementNode *>(node));
+        break;
+    case NodeKind::SwitchStatement:
+    {
+        auto *switchNode = static_cast<SwitchStatementNode *>(node);
+        // Case bodies run in the enclosing scope
+        resolveExpression(switchNode->condition.get());
+        for (const auto &caseClause : switchNode->cases)
+        {
+            if (!caseClause)
+                continue;
+            resolveExpression(caseClause->caseExpression.get());
+            for (const auto &statement : caseClause->statements)
+            {
+                resolveStatement(statement.get());
+            }
+        }
+        switchNode->table = buildSwitchTable(switchNode);
+        break;
+    }
+    case NodeKind::ReturnStatement:
+    {
+        auto *returnNode = static_cast<ReturnStatementNode *>(node);
+        resolveExpression(returnNode->expression.get());
+        // Try blocks aren't resolved, so a return in one keeps its call, whose
+        // exceptions the catch has to see
+        returnNode->tailCall = tailCalls && inFunction && isTailCall(returnNode->expression.get());
+        break;
+    }
+    case NodeKind::ExpressionStatement:
+        resolveExpression(static_cast<ExpressionStatementNode *>(node)->expression.get());
+        break;
+    case NodeKind::ConsoleLog:
+        resolveExpression(static_cast<ConsoleLogNode *>(node)->expression.get());
+        break;
+    case NodeKind::InputStatement:
+    {
+        auto *inputNode = static_cast<InputStatementNode *>(node);
+        if (inputNode->variable)
+        {
+            inputNode->variable->slot = declare(inputNode->variable->name);
+        }
+        break;
+    }
+    case NodeKind::Function:
+    case NodeKind::AsyncFunction:
+    {
+        auto *functionNode = static_cast<FunctionNode *>(node);
+        declareByName(functionNode->name);
+        resolveFunction(functionNode);
+        break;
+    }
+    case NodeKind::Class:
+    {
+        auto *classNode = static_cast<ClassNode *>(node);
+        declareByName(classNode->name);
+        resolveClass(classNode);
+        break;
+    }
+    case NodeKind::Import:
+    {
+        auto *importNode = static_cast<ImportNode *>(node);
+        if (importNode->hasDefaultImport)
+        {
+            declareByName(importNode->defaultImportName);
+        }
+        break;
+    }
+    case NodeKind::Export:
+    case NodeKind::ReExport:
+        resolveStatement(static_cast<ExportNode *>(node)->exportItem.get());
+        break;
+    default:
+        break;
+    }
+}
+
+void Resolver::resolveBlock(BlockStatementNode *node)
+{
+    node->needsScope = false;
+    for (const auto &statement : node->statements)
+    {
+        if (declaresInScope(statement.get()))
+        {
+            node->needsScope = true;
+            break;
+        }
+    }
+
+    if (!node->needsScope)
+    {
+        // Runs in the enclosing Environment, nothing new gets declared there
+        node->slotCount = 0;
+        for (const auto &statement : node->statements)
+        {
+            resolveStatement(statement.get());
+        }
+        return;
+    }
+
+    scopes.push_back(Scope());
+    for (const auto &statement : node->statements)
+    {
+        resolveStatement(statement.get());
+    }
+    node->slotCount = scopes.back().count;
+    scopes.pop_back();
+}
+
+void Resolver::resolveFor(ForStatementNode *node)
+{
+    node->needsScope = declaresInScope(node->initializer.get()) || declaresInScope(node->body.get());
+    if (node->needsScope)
+    {
+        scopes.push_back(Scope());
+    }
+
+    // Same order the loop runs in
+    resolveStatement(node->initializer.get());
+    resolveExpression(node->condition.get());
+    resolveStatement(node->body.get());
+    resolveExpression(node->increment.get());
+
+    if (node->needsScope)
+    {
+        node->slotCount = scopes.back().count;
+        scopes.pop_back();
+        node->counted = findCountedLoop(node);
+    }
+    else
+    {
+        node->slotCount = 0;
+    }
+}
+
+void Resolver::resolveFunction(FunctionNode *node, bool isMethod)
+{
+    if (!node->body)
+    {
+        return;
+    }
+
+    // Parameters take the first slots, in order, and share the scope with the
+    // top level of the body (see Environment::bindParameters). Methods keep
+    // `this` right after them.
+    Scope scope;
+    for (const auto &param : node->parameters)
+    {
+        scope.slots[param->name] = scope.count++;
+    }
+    node->thisSlot = -1;
+    if (isMethod)
+    {
+        node->thisSlot = scope.count;
+        scope.slots["this"] = scope.count++;
+    }
+    scopes.push_back(scope);
+
+    // Functions nested in a method still see its fields
+    int enclosingMethod = methodScope;
+    if (isMethod)
+    {
+        methodScope = static_cast<int>(scopes.size()) - 1;
+    }
+    bool enclosingFunction = inFunction;
+    inFunction = true;
+
+    for (const auto &statement : node->body->statements)
+    {
+        resolveStatement(statement.get());
+    }
+
+    inFunction = enclosingFunction;
+    methodScope = enclosingMethod;
+    node->body->slotCount = scopes.back().count;
+    scopes.pop_back();
+
+    TRACE(Interpreter, Debug, "Resolved function '", node->name, "' with ", node->body->slotCount, " slots");
+}
+
+void Resolver::resolveClass(ClassNode *node)
+{
+    // Methods close over the globals, not the scope the class is declared in
+    std::vector<Scope> enclosing;
+    enclosing.swap(scopes);
+    int enclosingMethod = methodScope;
+    methodScope = -1;
+
+    for (const auto &member : node->members)
+    {
+        if (auto method = nodeCast<FunctionNode>(member.get()))
+        {
+            resolveFunction(method, true);
+        }
+    }
+
+    methodScope = enclosingMethod;
+    scopes.swap(enclosing);
+}
+
+// Expressions
+
+void Resolver::resolveExpression(ExpressionNode *expr)
+{
+    if (!expr)
+    {
+        return;
+    }
+
+    switch (expr->kind())
+    {
+    case NodeKind::VariableExpression:
+    {
+        auto *varExpr = static_cast<VariableExpressionNode *>(expr);
+        resolveVariable(varExpr, varExpr->depth, varExpr->slot);
+        break;
+    }
+    case NodeKind::AssignmentExpression:
+    {
+        auto *assignExpr = static_cast<AssignmentExpressionNode *>(expr);
+        if (auto target = nodeCast<VariableExpressionNode>(assignExpr->left.get()))
+        {
+            resolveVariable(target, assignExpr->depth, assignExpr->slot);
+        }
+        resolveExpression(assignExpr->left.get());
+        resolveExpression(assignExpr->right.get());
+        break;
+    }
+    case NodeKind::UnaryExpression:
+        resolveExpression(static_cast<UnaryExpressionNode *>(expr)->operand.get());
+        break;
+    case NodeKind::CallExpression:
+    {
+        auto *callExpr = static_cast<CallExpressionNode *>(expr);
+        resolveExpression(callExpr->callee.get());
+        for (const auto &arg : callExpr->arguments)
+        {
+            resolveExpression(arg.get());
+        }
+        break;
+    }
+    case NodeKind::MemberAccessExpression:
+        resolveExpression(static_cast<MemberAccessExpressionNode *>(expr)->object.get());
+        break;
+    case NodeKind::BinaryExpression:
+    {
+        auto *binaryExpr = static_cast<BinaryExpressionNode *>(expr);
+        resolveExpression(binaryExpr->left.get());
+        resolveExpression(binaryExpr->right.get());
+        break;
+    }
+    case NodeKind::AdditionExpression:
+    {
+        auto *addExpr = static_cast<AdditionExpressionNode *>(expr);
+        resolveExpression(addExpr->left.get());
+        resolveExpression(addExpr->right.get());
+        break;
+    }
+    case NodeKind::SubtractionExpression:
+    {
+        auto *subExpr = static_cast<SubtractionExpressionNode *>(expr);
+        resolveExpression(subExpr->left.get());
+        resolveExpression(subExpr->right.get());
+        break;
+    }
+    case NodeKind::MultiplicationExpression:
+    {
+        auto *mulExpr = static_cast<MultiplicationExpressionNode *>(expr);
+        resolveExpression(mulExpr->left.get());
+        resolveExpression(mulExpr->right.get());
+        break;
+    }
+    case NodeKind::DivisionExpression:
+    {
+        auto *divExpr = static_cast<DivisionExpressionNode *>(expr);
+        resolveExpression(divExpr->left.get());
+        resolveExpression(divExpr->right.get());
+        break;
+    }
+    case NodeKind::ComparisonExpression:
+    {
+        auto *compExpr = static_cast<ComparisonExpressionNode *>(expr);
+        resolveExpression(compExpr->left.get());
+        resolveExpression(compExpr->right.get());
+        break;
+    }
+    case NodeKind::EqualityExpression:
+    {
+        auto *eqExpr = static_cast<EqualityExpressionNode *>(expr);
+        resolveExpression(eqExpr->left.get());
+        resolveExpression(eqExpr->right.get());
+        break;
+    }
+    case NodeKind::AndExpression:
+    {
+        auto *andExpr = static_cast<AndExpressionNode *>(expr);
+        resolveExpression(andExpr->left.get());
+        resolveExpression(andExpr->right.get());
+        break;
+    }
+    case NodeKind::OrExpression:
+    {
+        auto *orExpr = static_cast<OrExpressionNode *>(expr);
+        resolveExpression(orExpr->left.get());
+        resolveExpression(orExpr->right.get());
+        break;
+    }
+    case NodeKind::ConditionalExpression:
+    {
+        auto *condExpr = static_cast<ConditionalExpressionNode *>(expr);
+        resolveExpression(condExpr->condition.get());
+        resolveExpression(condExpr->trueExpr.get());
+        resolveExpression(condExpr->falseExpr.get());
+        break;
+    }
+    case NodeKind::ArrayLiteral:
+    {
+        auto *arrayExpr = static_cast<ArrayLiteralNode *>(expr);
+        for (const auto &element : arrayExpr->elements)
+        {
+            resolveExpression(element.get());
+        }
+        break;
+    }
+    case NodeKind::ObjectLiteral:
+    {
+        auto *objectExpr = static_cast<ObjectLiteralNode *>(expr);
+        for (const auto &property : objectExpr->properties)
+        {
+            resolveExpression(property.second.get());
+        }
+        break;
+    }
+    case NodeKind::TemplateLiteral:
+    {
+        auto *templateExpr = static_cast<TemplateLiteralNode *>(expr);
+        for (const auto &part : templateExpr->parts)
+        {
+            resolveExpression(part.get());
+        }
+        break;
+    }
+    case NodeKind::AwaitExpression:
+        resolveExpression(static_cast<AwaitExpressionNode *>(expr)->expression.get());
+        break;
+    default:
+        break;
+    }
+}
+
+bool Resolver::declaresInScope(ASTNode *node)
+{
+    if (!node)
+    {
+        return false;
+    }
+
+    if (nodeCast<VariableDeclarationNode>(node) || nodeCast<FunctionNode>(node) ||
+        nodeCast<ClassNode>(node) || nodeCast<InputStatementNode>(node) ||
+        nodeCast<ImportNode>(node) || nodeCast<ExportNode>(node))
+    {
+        return true;
+    }
+
+    // Statements without their own scope declare into ours
+    if (auto ifNode = nodeCast<IfStatementNode>(node))
+    {
+        return declaresInScope(ifNode->thenBranch.get()) || declaresInScope(ifNode->elseBranch.get());
+    }
+    if (auto whileNode = nodeCast<WhileStatementNode>(node))
+    {
+        return declaresInScope(whileNode->body.get());
+    }
+    if (auto switchNode = nodeCast<SwitchStatementNode>(node))
+    {
+        for (const auto &caseClause : switchNode->cases)
+        {
+            if (!caseClause)
+                continue;
+            for (const auto &statement : caseClause->statements)
+            {
+                if (declaresInScope(statement.get()))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Counted loops
+
+std::unique_ptr<CountedLoop> Resolver::findCountedLoop(ForStatementNode *node)
+{
+    auto declaration = nodeCast<VariableDeclarationNode>(node->initializer.get());
+    if (!declaration || declaration->slot < 0 || !declaration->initializer)
+    {
+        return nullptr;
+    }
+
+    auto loop = std::make_unique<CountedLoop>();
+    loop->slot = declaration->slot;
+
+    // i < bound, i <= bound, i > bound, i >= bound or i != bound
+    ExpressionNode *tested = nullptr;
+    if (auto comparison = nodeCast<ComparisonExpressionNode>(node->condition.get()))
+    {
+        static const std::map<std::string, CountedLoop::Test> tests = {
+            {"<", CountedLoop::Test::Less},
+            {"<=", CountedLoop::Test::LessEqual},
+            {">", CountedLoop::Test::Greater},
+            {">=", CountedLoop::Test::GreaterEqual}};
+        auto it = tests.find(comparison->op);
+        if (it == tests.end())
+        {
+            return nullptr;
+        }
+        loop->test = it->second;
+        tested = comparison->left.get();
+        loop->bound = comparison->right.get();
+    }
+    else if (auto equality = nodeCast<EqualityExpressionNode>(node->condition.get()))
+    {
+        if (equality->op != "!=")
+        {
+            return nullptr;
+        }
+        loop->test = CountedLoop::Test::NotEqual;
+        tested = equality->left.get();
+        loop->bound = equality->right.get();
+    }
+    if (!isLoopVariable(tested, loop->slot) || !isPure(loop->bound))
+    {
+        return nullptr;
+    }
+
+    // i++, ++i, i--, --i, i += k, i -= k, i = i + k or i = i - k
+    ExpressionNode *increment = node->increment.get();
+    if (auto unary = nodeCast<UnaryExpressionNode>(increment))
+    {
+        if ((unary->op != "++" && unary->op != "--") || !isLoopVariable(unary->operand.get(), loop->slot))
+        {
+            return nullptr;
+        }
+        loop->step = unary->op == "++" ? 1 : -1;
+    }
+    else if (auto assignment = nodeCast<AssignmentExpressionNode>(increment))
+    {
+        if (assignment->depth != 0 || assignment->slot != loop->slot)
+        {
+            return nullptr;
+        }
+
+        IntegerLiteralNode *amount = nullptr;
+        bool subtract = false;
+        if (assignment->op == "+=" || assignment->op == "-=")
+        {
+            amount = nodeCast<IntegerLiteralNode>(assignment->right.get());
+            subtract = assignment->op == "-=";
+        }
+        else if (assignment->op == "=")
+        {
+            if (auto addition = nodeCast<AdditionExpressionNode>(assignment->right.get()))
+            {
+                if (isLoopVariable(addition->left.get(), loop->slot))
+                {
+                    amount = nodeCast<IntegerLiteralNode>(addition->right.get());
+                }
+            }
+            else if (auto subtraction = nodeCast<SubtractionExpressionNode>(assignment->right.get()))
+            {
+                if (isLoopVariable(subtraction->left.get(), loop->slot))
+                {
+                    amount = nodeCast<IntegerLiteralNode>(subtraction->right.get());
+                    subtract = true;
+                }
+            }
+        }
+        if (!amount || amount->value == 0)
+        {
+            return nullptr;
+        }
+        loop->step = subtract ? -amount->value : amount->value;
+    }
+    else
+    {
+        return nullptr;
+    }
+
+    TRACE(Interpreter, Debug, "Counted loop over '", declaration->name, "' at line ", node->getLine(), " with step ", loop->step);
+    return loop;
+}
+
+// The variable the loop declares, read from the loop's own scope
+bool Resolver::isLoopVariable(ExpressionNode *expr, int slot)
+{
+    auto variable = nodeCast<VariableExpressionNode>(expr);
+    return variable && variable->depth == 0 && variable->slot == slot && !variable->fieldCache;
+}
+
+// Bounds are evaluated again when a counted loop deoptimises, so only
+// literals, variables and arithmetic on them qualify
+bool Resolver::isPure(ExpressionNode *expr)
+{
+    if (!expr)
+    {
+        return false;
+    }
+
+    switch (expr->kind())
+    {
+    case NodeKind::IntegerLiteral:
+    case NodeKind::VariableExpression:
+        return true;
+    case NodeKind::AdditionExpression:
+    {
+        auto *addExpr = static_cast<AdditionExpressionNode *>(expr);
+        return isPure(addExpr->left.get()) && isPure(addExpr->right.get());
+    }
+    case NodeKind::SubtractionExpression:
+    {
+        auto *subExpr = static_cast<SubtractionExpressionNode *>(expr);
+        return isPure(subExpr->left.get()) && isPure(subExpr->right.get());
+    }
+    case NodeKind::MultiplicationExpression:
+    {
+        auto *mulExpr = static_cast<MultiplicationExpressionNode *>(expr);
+        return isPure(mulExpr->left.get()) && isPure(mulExpr->right.get());
+    }
+    default:
+        return false;
+    }
+}
+
+// Switch tables
+
+// The value of an int literal case, `-` applied to one included
+static bool intCase(ExpressionNode *expr, int &value)
+{
+    if (auto literal = nodeCast<IntegerLiteralNode>(expr))
+    {
+        value = literal->value;
+        return true;
+    }
+    auto negated = nodeCast<UnaryExpressionNode>(expr);
+    if (negated && negated->op == "-" && intCase(negated->operand.get(), value))
+    {
+        value = -value;
+        return true;
+    }
+    return false;
+}
+
+std::unique_ptr<SwitchTable> Resolver::buildSwitchTable(SwitchStatementNode *node)
+{
+    auto table = std::make_unique<SwitchTable>();
+    table->otherwise = static_cast<int>(node->cases.size());
+
+    // The first case with each value, in clause order; a case after the first
+    // default is never reached by the scan
+    std::map<int, int> ints;
+    bool allInts = true;
+    bool allStrings = true;
+    int clause = 0;
+    for (const auto &caseClause : node->cases)
+    {
+        if (caseClause && caseClause->isDefault)
+        {
+            table->otherwise = clause;
+            break;
+        }
+        if (caseClause && caseClause->caseExpression)
+        {
+            int value = 0;
+            if (intCase(caseClause->caseExpression.get(), value))
+            {
+                ints.emplace(value, clause);
+                allStrings = false;
+            }
+            else if (auto literal = nodeCast<StringLiteralNode>(caseClause->caseExpression.get()))
+            {
+                table->strings.emplace(literal->value, clause);
+                allInts = false;
+            }
+            else
+            {
+                return nullptr;
+            }
+        }
+        clause++;
+    }
+
+    if (allStrings && !table->strings.empty())
+    {
+        table->kind = SwitchTable::Kind::String;
+    }
+    else if (!allInts || ints.empty())
+    {
+        return nullptr;
+    }
+    else if (static_cast<int64_t>(ints.rbegin()->first) - ints.begin()->first < 4 * static_cast<int64_t>(ints.size()))
+    {
+        // Dense enough for a jump table
+        table->kind = SwitchTable::Kind::Dense;
+        table->low = ints.begin()->first;
+        table->jump.assign(ints.rbegin()->first - table->low + 1, table->otherwise);
+        for (const auto &[value, target] : ints)
+        {
+            table->jump[value - table->low] = target;
+        }
+    }
+    else
+    {
+        table->kind = SwitchTable::Kind::Sparse;
+        table->sorted.assign(ints.begin(), ints.end());
+    }
+
+    TRACE(Interpreter, Debug, "Switch at line ", node->getLine(), " dispatches on a ",
+          table->kind == SwitchTable::Kind::Dense ? "jump table" : table->kind == SwitchTable::Kind::Sparse ? "sorted table" : "hash table");
+    return table;
+}
+
+// Tail calls
+
+bool Resolver::isTailCall(ExpressionNode *expr)
+{
+    // Method calls need their object, and the VM only calls through a name
+    auto call = nodeCast<CallExpressionNode>(expr);
+    return call && nodeCast<VariableExpressionNode>(call->callee.get());
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include "../parser/nodes.h"
+
+// Static pass run between parsing and execution.
+//
+// It binds every variable that lives in a function or block scope to a
+// (depth, slot) pair: depth is how many Environments to walk up from the one
+// that is current when the node runs, slot the index into that Environment's
+// slot array. Names it can't bind (globals, module level names, imports,
+// ...) keep depth/slot at -1 and are still looked up by name.
+//
+// Methods get a slot for `this` after their parameters. A name in a method
+// that no enclosing scope declares may be a field of `this`: it gets a
+// fieldCache, and depth/slot locate `this` instead (see
+// VariableExpressionNode). Which fields an object has is only known at run
+// time, so the interpreter falls back to the name if it has none by that name.
+//
+// The scopes tracked here have to match the Environments the interpreter
+// creates one for one: a function call creates one for its parameters and the
+// top level of its body, blocks and for loops create one only when they
+// declare something themselves (needsScope), and global code has none.
+class Resolver
+{
+public:
+    // With tailCalls, returns of a call are marked to run as tail calls (see
+    // ReturnStatementNode::tailCall)
+    explicit Resolver(bool tailCalls = true) : tailCalls(tailCalls) {}
+
+    void resolve(ProgramNode *program);
+
+private:
+    struct Scope
+    {
+        std::map<std::string, int> slots; // -1 marks a name defined by name in this scope
+        int count = 0;
+    };
+
+    std::vector<Scope> scopes; // Empty while resolving global code
+    int methodScope = -1;      // Index of the innermost method's scope, -1 outside methods
+    bool tailCalls;
+    bool inFunction = false; // Blocks of global code have scopes too
+
+    // Declarations
+    int declare(const std::string &name);
+    void declareByName(const std::string &name);
+    bool resolveName(const std::string &name, int &depth, int &slot) const;
+    void resolveVariable(VariableExpressionNode *node, int &depth, int &slot);
+
+    // Statements
+    void resolveStatement(ASTNode *node);
+    void resolveBlock(BlockStatementNode *node);
+    void resolveFor(ForStatementNode *node);
+    void resolveFunction(FunctionNode *node, bool isMethod = false);
+    void resolveClass(ClassNode *node);
+
+    // Expressions
+    void resolveExpression(ExpressionNode *expr);
+
+    // True if executing the statement defines a name in the current Environment
+    static bool declaresInScope(ASTNode *node);
+
+    // Counted loops (see CountedLoop in nodes.h), once the loop is resolved
+    static std::unique_ptr<CountedLoop> findCountedLoop(ForStatementNode *node);
+    static bool isLoopVariable(ExpressionNode *expr, int slot);
+    static bool isPure(ExpressionNode *expr);
+
+    // Switches over literals (see SwitchTable in nodes.h)
+    static std::unique_ptr<SwitchTable> buildSwitchTable(SwitchStatementNode *node);
+
+    // Returns that can hand their call over to the caller
+    static bool isTailCall(ExpressionNode *expr);
+};
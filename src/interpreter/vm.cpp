@@ -0,0 +1,319 @@
+#include "vm.h"
+#include "jit.h"
+#include <algorithm>
+#include <stdexcept>
+
+Environment *VM::closureOf(const std::shared_ptr<Function> &function)
+{
+    // Same lookup chain callFunction gives an AST function body
+    return function->closure ? function->closure.get() : interpreter.globals.get();
+}
+
+void VM::pushFrame(const std::shared_ptr<Function> &function, const BytecodeFunction *code, size_t base)
+{
+    size_t needed = base + code->registerCount;
+    if (stack.size() < needed)
+    {
+        stack.resize(std::max(needed, stack.size() * 2));
+    }
+    frames.push_back({code, closureOf(function), base, 0});
+
+    if (interpreter.useJit && !code->tier.compiled && ++code->tier.calls >= Jit::callThreshold)
+    {
+        tierUp(code);
+    }
+}
+
+void VM::tierUp(const BytecodeFunction *code)
+{
+    code->tier.compiled = true;
+    code->tier.native = Jit::compile(*code);
+}
+
+Value VM::run(const std::shared_ptr<Function> &function, const BytecodeFunction *code,
+              std::span<const Value> arguments)
+{
+    if (arguments.size() != code->parameterCount)
+    {
+        throw std::runtime_error("Error handling function parameters: Expected " +
+                                 std::to_string(code->parameterCount) + " arguments but got " +
+                                 std::to_string(arguments.size()));
+    }
+
+    // Start above the registers of whatever frame is waiting on us
+    size_t base = frames.empty() ? 0 : frames.back().base + frames.back().code->registerCount;
+    pushFrame(function, code, base);
+    std::copy(arguments.begin(), arguments.end(), stack.begin() + base);
+
+    size_t entryDepth = frames.size();
+    try
+    {
+        return execute(entryDepth);
+    }
+    catch (...)
+    {
+        // Drop the frames this run pushed so an outer run can carry on
+        frames.resize(entryDepth - 1);
+        throw;
+    }
+}
+
+Value VM::execute(size_t entryDepth)
+{
+    CallFrame *frame = nullptr;
+    const Instruction *code = nullptr;
+    const Value *constants = nullptr;
+    Value *regs = nullptr;
+    const JitCode *native = nullptr;
+    size_t pc = 0;
+
+    // Frames and the stack may both have been reallocated after a call
+    auto reload = [&]()
+    {
+        frame = &frames.back();
+        code = frame->code->code.data();
+        constants = frame->code->constants.data();
+        regs = stack.data() + frame->base;
+        native = frame->code->tier.native.get();
+        pc = frame->pc;
+    };
+    reload();
+
+    for (;;)
+    {
+        // Native code runs up to an instruction it leaves to us, which then
+        // runs below before we go back to the native code
+        if (native)
+        {
+            JitExit exit = native->run(regs, pc);
+            pc = exit.pc;
+            if (exit.guardFailed && ++frame->code->tier.deopts >= Jit::maxDeopts)
+            {
+                // The operands keep failing the type guards, stay on the VM
+                TRACE(Interpreter, Debug, "JIT: '", frame->code->name, "' deoptimised at ", pc);
+                frame->code->tier.native.reset();
+                native = nullptr;
+            }
+        }
+
+        const Instruction &ins = code[pc++];
+        switch (ins.op)
+        {
+        case OpCode::Move:
+            regs[ins.a] = regs[ins.b];
+            break;
+
+        case OpCode::LoadConst:
+            regs[ins.a] = constants[ins.b];
+            break;
+
+        case OpCode::LoadNull:
+            regs[ins.a] = Value();
+            break;
+
+        case OpCode::LoadBool:
+            regs[ins.a] = Value(ins.b != 0);
+            break;
+
+        case OpCode::GetGlobal:
+            regs[ins.a] = frame->closure->get(frame->code->names[ins.b]);
+            break;
+
+        case OpCode::SetGlobal:
+            frame->closure->assign(frame->code->names[ins.b], regs[ins.a]);
+            break;
+
+        case OpCode::Add:
+            regs[ins.a] = regs[ins.b] + regs[ins.c];
+            break;
+
+        case OpCode::Subtract:
+            regs[ins.a] = regs[ins.b] - regs[ins.c];
+            break;
+
+        case OpCode::Multiply:
+            regs[ins.a] = regs[ins.b] * regs[ins.c];
+            break;
+
+        case OpCode::Divide:
+            regs[ins.a] = regs[ins.b] / regs[ins.c];
+            break;
+
+        case OpCode::Modulo:
+            regs[ins.a] = regs[ins.b] % regs[ins.c];
+            break;
+
+        case OpCode::Less:
+            regs[ins.a] = Value(regs[ins.b] < regs[ins.c]);
+            break;
+
+        case OpCode::LessEqual:
+            regs[ins.a] = Value(regs[ins.b] <= regs[ins.c]);
+            break;
+
+        case OpCode::Greater:
+            regs[ins.a] = Value(regs[ins.b] > regs[ins.c]);
+            break;
+
+        case OpCode::GreaterEqual:
+            regs[ins.a] = Value(regs[ins.b] >= regs[ins.c]);
+            break;
+
+        case OpCode::Equal:
+            regs[ins.a] = Value(regs[ins.b] == regs[ins.c]);
+            break;
+
+        case OpCode::NotEqual:
+            regs[ins.a] = Value(regs[ins.b] != regs[ins.c]);
+            break;
+
+        case OpCode::Negate:
+        {
+            const Value &operand = regs[ins.b];
+            if (operand.isInteger())
+                regs[ins.a] = Value(-operand.asInt());
+            else if (operand.isFloat())
+                regs[ins.a] = Value(-operand.asFloat());
+            else
+                throw std::runtime_error("Cannot negate non-numeric value");
+            break;
+        }
+
+        case OpCode::Not:
+            regs[ins.a] = Value(!regs[ins.b].asBool());
+            break;
+
+        case OpCode::ToBool:
+            regs[ins.a] = Value(regs[ins.b].asBool());
+            break;
+
+        case OpCode::Increment:
+        {
+            const Value &operand = regs[ins.b];
+            if (operand.isInteger())
+                regs[ins.a] = Value(operand.asInt() + 1);
+            else if (operand.isFloat())
+                regs[ins.a] = Value(operand.asFloat() + 1.0f);
+            else
+                throw std::runtime_error("Cannot increment non-numeric value");
+            break;
+        }
+
+        case OpCode::Decrement:
+        {
+            const Value &operand = regs[ins.b];
+            if (operand.isInteger())
+                regs[ins.a] = Value(operand.asInt() - 1);
+            else if (operand.isFloat())
+                regs[ins.a] = Value(operand.asFloat() - 1.0f);
+            else
+                throw std::runtime_error("Cannot decrement non-numeric value");
+            break;
+        }
+
+        case OpCode::Jump:
+            pc += ins.offset();
+            if (ins.offset() < 0 && interpreter.useJit && !frame->code->tier.compiled &&
+                ++frame->code->tier.backedges >= Jit::loopThreshold)
+            {
+                // A hot loop: the native code takes over from its next iteration
+                tierUp(frame->code);
+                native = frame->code->tier.native.get();
+            }
+            break;
+
+        case OpCode::JumpIfFalse:
+            if (!regs[ins.a].asBool())
+                pc += ins.offset();
+            break;
+
+        case OpCode::JumpIfTrue:
+            if (regs[ins.a].asBool())
+                pc += ins.offset();
+            break;
+
+        case OpCode::Switch:
+        {
+            // Without a clause from the table the compare chain that follows
+            // scans the cases
+            const auto &jumps = frame->code->switches[ins.b];
+            int clause = Interpreter::findSwitchClause(*jumps.table, regs[ins.a]);
+            if (clause >= 0)
+                pc = jumps.targets[clause];
+            break;
+        }
+
+        case OpCode::Call:
+        case OpCode::TailCall:
+        {
+            frame->pc = pc;
+            const Value &callee = regs[ins.a];
+
+            if (callee.isFunction())
+            {
+                auto function = callee.asObject<Function>();
+                if (const BytecodeFunction *target = interpreter.getBytecode(function))
+                {
+                    if (ins.c != target->parameterCount)
+                    {
+                        throw std::runtime_error("Error handling function parameters: Expected " +
+                                                 std::to_string(target->parameterCount) + " arguments but got " +
+                                                 std::to_string(ins.c));
+                    }
+
+                    interpreter.callCount++;
+                    if (ins.op == OpCode::TailCall)
+                    {
+                        // The callee takes over this frame, its arguments
+                        // move down to where its parameters go
+                        size_t base = frame->base;
+                        std::move(regs + ins.a + 1, regs + ins.a + 1 + ins.c, regs);
+                        frames.pop_back();
+                        pushFrame(function, target, base);
+                    }
+                    else
+                    {
+                        // The arguments already sit where the callee expects its parameters
+                        pushFrame(function, target, frame->base + ins.a + 1);
+                    }
+                    reload();
+                    break;
+                }
+            }
+
+            // Copy the callee and arguments out, the stack may move while it runs
+            Value calleeValue = callee;
+            Value result;
+            {
+                Interpreter::ArgumentFrame arguments(interpreter.argumentStack);
+                interpreter.argumentStack.insert(interpreter.argumentStack.end(), regs + ins.a + 1,
+                                                 regs + ins.a + 1 + ins.c);
+                result = interpreter.callValue(calleeValue, arguments.arguments());
+            }
+            reload();
+            regs[code[pc - 1].a] = std::move(result);
+            break;
+        }
+
+        case OpCode::Print:
+            interpreter.printValue(regs[ins.a]);
+            break;
+
+        case OpCode::Return:
+        case OpCode::ReturnNull:
+        {
+            Value result = ins.op == OpCode::Return ? std::move(regs[ins.a]) : Value();
+            frames.pop_back();
+            if (frames.size() < entryDepth)
+            {
+                return result;
+            }
+
+            // Resume the caller right after its Call instruction
+            reload();
+            regs[code[pc - 1].a] = std::move(result);
+            break;
+        }
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <vector>
+#include "bytecode.h"
+
+// Register based virtual machine for functions lowered by BytecodeCompiler.
+//
+// All frames share one value stack. A call between two compiled functions
+// pushes a frame inside the same dispatch loop, with the callee's parameter
+// registers overlapping the caller's argument registers, so no arguments are
+// copied and the C++ stack does not grow with the edu call depth. Anything the
+// VM can't run itself (classes, methods, native or imported functions) is
+// handed back to the Interpreter.
+//
+// Functions that get hot are compiled to native code by the Jit, which runs
+// on the same registers; the VM steps in for the instructions it leaves out.
+class VM
+{
+public:
+    explicit VM(Interpreter &interpreter) : interpreter(interpreter) {}
+
+    // Run a compiled function. Re-entrant: the interpreter may call back into
+    // the VM while a VM frame is waiting on it.
+    Value run(const std::shared_ptr<Function> &function, const BytecodeFunction *code,
+              std::span<const Value> arguments);
+
+private:
+    struct CallFrame
+    {
+        const BytecodeFunction *code;
+        Environment *closure; // Kept alive by the called Function
+        size_t base;          // Index of R[0] in the value stack
+        size_t pc;            // Saved while a callee runs
+    };
+
+    Interpreter &interpreter;
+    std::vector<Value> stack;
+    std::vector<CallFrame> frames;
+
+    Value execute(size_t entryDepth);
+    void pushFrame(const std::shared_ptr<Function> &function, const BytecodeFunction *code, size_t base);
+    Environment *closureOf(const std::shared_ptr<Function> &function);
+    void tierUp(const BytecodeFunction *code);
+};
@@ -2,9 +2,11 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 #include <filesystem>
+#include <new>
 #include "parser/parser.h"
 #include "codegen/code_generator.h"
 #include "interpreter/interpreter.h"
@@ -12,18 +14,40 @@
 
 namespace fs = std::filesystem;
 
-std::string readFile(const std::string &filename)
+// Heap allocations made by the whole program, for --alloc-stats. Replacing
+// the global operator new is the only way to also see the allocations made
+// inside the standard library (std::map nodes, shared_ptr control blocks, ...)
+static std::atomic<uint64_t> heapAllocations{0};
+
+void *operator new(std::size_t size)
 {
-    std::ifstream file(filename);
-    if (!file.is_open())
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size ? size : 1))
     {
-        std::cerr << "Error: Could not open file " << filename << std::endl;
-        return "";
+        return memory;
     }
+    throw std::bad_alloc();
+}
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+SourceBuffer readFile(const std::string &filename)
+{
+    std::optional<SourceBuffer> source = SourceBuffer::map(filename);
+    if (!source)
+    {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return SourceBuffer();
+    }
+    return std::move(*source);
 }
 
 bool writeFile(const std::string &filename, const std::string &content)
@@ -46,6 +70,18 @@ int compileAndRun(const std::string &cppCode, const std::string &tempDir)
     std::string tempCppFile = tempDir + "/temp.cpp";
     std::string tempExeFile = tempDir + "/temp";
 
+    // Clean up temporary files however this returns
+    struct RemoveOnExit
+    {
+        const std::string &cppFile;
+        const std::string &exeFile;
+        ~RemoveOnExit()
+        {
+            std::remove(cppFile.c_str());
+            std::remove(exeFile.c_str());
+        }
+    } removeOnExit{tempCppFile, tempExeFile};
+
     // Write C++ code to temporary file
     if (!writeFile(tempCppFile, cppCode))
     {
@@ -62,13 +98,7 @@ int compileAndRun(const std::string &cppCode, const std::string &tempDir)
     }
 
     // Run the compiled program
-    int runResult = std::system(tempExeFile.c_str());
-
-    // Clean up temporary files
-    std::remove(tempCppFile.c_str());
-    std::remove(tempExeFile.c_str());
-
-    return runResult;
+    return std::system(tempExeFile.c_str());
 }
 
 void printUsage(const char *programName)
@@ -77,7 +107,21 @@ void printUsage(const char *programName)
     std::cout << "Options:" << std::endl;
     std::cout << "  --transpile    Transpile the edu code to C++ without running it" << std::endl;
     std::cout << "  --compile      Transpile, compile, and run using C++ (slower)" << std::endl;
-    std::cout << "  --debug        Enable debug output" << std::endl;
+    std::cout << "  --ast          Interpret on the AST walker only, without the bytecode VM" << std::endl;
+    std::cout << "  --closures     Compile the AST into closures and run those, without the bytecode VM" << std::endl;
+    std::cout << "  --no-jit       Keep hot bytecode functions on the VM instead of compiling them to native code" << std::endl;
+    std::cout << "  --no-tail-calls  Keep the frame of every call, also of `return f(...)`, e.g. for debugging" << std::endl;
+    std::cout << "  --ic-stats     Print the inline cache hit rate of each member access and method call site" << std::endl;
+    std::cout << "  --alloc-stats  Print the number of function calls and heap allocations per call" << std::endl;
+    std::cout << "  --flush=<when> When to write program output: auto (default, every line on a" << std::endl;
+    std::cout << "                 terminal, otherwise when the buffer is full), line or full" << std::endl;
+    std::cout << "  --tokenize-threads=<n>  Tokenize the whole source on n threads (0: one per core)" << std::endl;
+    std::cout << "                 before parsing, instead of as the parser goes; for large sources" << std::endl;
+    std::cout << "  --debug        Enable debug output for every subsystem" << std::endl;
+    std::cout << "  --trace=<list> Enable trace output for a comma separated list of subsystems" << std::endl;
+    std::cout << "                 (driver, tokenizer, parser, codegen, interpreter, module or all)" << std::endl;
+    std::cout << "  --trace-level=<level>  Level for --trace: info, debug or verbose (default)" << std::endl;
+    std::cout << "  --trace-file=<path>    Write trace output to a file instead of stderr" << std::endl;
     std::cout << "  --help         Display this help message" << std::endl;
     std::cout << std::endl;
     std::cout << "By default, edu code is directly interpreted (not transpiled)" << std::endl;
@@ -90,6 +134,17 @@ int main(int argc, char *argv[])
     bool compileMode = false;  // For transpile+compile+run
     bool interpretMode = true; // Default mode is interpret
     bool debugMode = false;
+    bool astMode = false;      // Skip the bytecode VM, e.g. to diff it against the AST walker
+    bool closureMode = false;  // Skip the bytecode VM and run the AST as compiled closures
+    bool jit = true;           // Compile hot bytecode functions to native code
+    bool tailCalls = true;     // Run `return f(...)` in place of the returning function's frame
+    bool icStats = false;      // Report inline cache hit rates after running
+    bool allocStats = false;   // Report heap allocations per call after running
+    OutputSink::FlushPolicy flushPolicy = OutputSink::FlushPolicy::Auto;
+    int tokenizeThreads = -1;  // Stream the tokens to the parser unless set
+    std::string traceCategories;
+    TraceLevel traceLevel = TraceLevel::Verbose;
+    std::ofstream traceFile;
     std::string inputFile;
     std::string outputFile;
 
@@ -111,11 +166,75 @@ int main(int argc, char *argv[])
             compileMode = true;
             interpretMode = false;
         }
+        else if (strcmp(argv[i], "--ast") == 0)
+        {
+            astMode = true;
+        }
+        else if (strcmp(argv[i], "--closures") == 0)
+        {
+            closureMode = true;
+        }
+        else if (strcmp(argv[i], "--no-jit") == 0)
+        {
+            jit = false;
+        }
+        else if (strcmp(argv[i], "--no-tail-calls") == 0)
+        {
+            tailCalls = false;
+        }
+        else if (strcmp(argv[i], "--ic-stats") == 0)
+        {
+            icStats = true;
+        }
+        else if (strcmp(argv[i], "--alloc-stats") == 0)
+        {
+            allocStats = true;
+        }
+        else if (strncmp(argv[i], "--flush=", 8) == 0)
+        {
+            std::string when = argv[i] + 8;
+            if (when == "auto")
+                flushPolicy = OutputSink::FlushPolicy::Auto;
+            else if (when == "line")
+                flushPolicy = OutputSink::FlushPolicy::Line;
+            else if (when == "full")
+                flushPolicy = OutputSink::FlushPolicy::Full;
+            else
+            {
+                std::cerr << "Error: Unknown flush policy " << when << std::endl;
+                return 1;
+            }
+        }
+        else if (strncmp(argv[i], "--tokenize-threads=", 19) == 0)
+        {
+            tokenizeThreads = std::max(0, atoi(argv[i] + 19));
+        }
         else if (strcmp(argv[i], "--debug") == 0)
         {
             debugMode = true;
             Debug::setEnabled(true);
-            std::cout << "Debug mode enabled" << std::endl;
+        }
+        else if (strncmp(argv[i], "--trace=", 8) == 0)
+        {
+            traceCategories = argv[i] + 8;
+        }
+        else if (strncmp(argv[i], "--trace-level=", 14) == 0)
+        {
+            if (!Debug::parseLevel(argv[i] + 14, traceLevel))
+            {
+                std::cerr << "Error: Unknown trace level " << (argv[i] + 14) << std::endl;
+                return 1;
+            }
+        }
+        else if (strncmp(argv[i], "--trace-file=", 13) == 0)
+        {
+            traceFile.open(argv[i] + 13);
+            if (!traceFile)
+            {
+                std::cerr << "Error: Could not open trace file " << (argv[i] + 13) << std::endl;
+                return 1;
+            }
+            Debug::setSink(traceFile);
         }
         else if (strcmp(argv[i], "--help") == 0)
         {
@@ -139,42 +258,49 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    if (debugMode)
+    if (!traceCategories.empty() && !Debug::enable(traceCategories, traceLevel))
     {
-        std::cout << "Input file: " << inputFile << std::endl;
-        if (!outputFile.empty())
-        {
-            std::cout << "Output file: " << outputFile << std::endl;
-        }
+        std::cerr << "Error: Unknown trace category in " << traceCategories << std::endl;
+        return 1;
+    }
+
+    TRACE(Driver, Info, "Input file: ", inputFile);
+    if (!outputFile.empty())
+    {
+        TRACE(Driver, Info, "Output file: ", outputFile);
     }
 
     // Read the input file
-    std::string eduCode = readFile(inputFile);
-    if (eduCode.empty())
+    SourceBuffer eduCode = readFile(inputFile);
+    if (eduCode.text().empty())
     {
         return 1;
     }
 
-    DEBUG_LOG("=== Starting main program ===");
-    DEBUG_LOG("File content length: ", eduCode.length());
-    DEBUG_LOG("First 100 characters: '", eduCode.substr(0, 100), "'");
+    TRACE(Driver, Debug, "=== Starting main program ===");
+    TRACE(Driver, Debug, "File content length: ", eduCode.text().length());
+    TRACE(Driver, Debug, "First 100 characters: '", eduCode.text().substr(0, 100), "'");
 
     try
     {
-        // Parse the edu code
-        DEBUG_LOG("=== Creating tokenizer ===");
-        Tokenizer tokenizer(eduCode);
-
-        DEBUG_LOG("=== Starting tokenization ===");
-        auto tokens = tokenizer.tokenize();
-        DEBUG_LOG("=== Tokenization completed, got ", tokens.size(), " tokens ===");
+        // Parse the edu code. The parser pulls the tokens as it goes, so the
+        // complete token vector never exists, unless they are tokenized in
+        // parallel up front
+        TRACE(Driver, Debug, "=== Creating tokenizer ===");
+        Tokenizer tokenizer(std::move(eduCode));
+        std::vector<Token> tokens;
+        if (tokenizeThreads >= 0)
+        {
+            tokens = tokenizer.tokenizeParallel(tokenizeThreads);
+            TRACE(Driver, Debug, "=== Tokenization completed, got ", tokens.size(), " tokens ===");
+        }
 
-        DEBUG_LOG("=== Creating parser ===");
-        Parser parser(tokens);
+        TRACE(Driver, Debug, "=== Creating parser ===");
+        Parser parser = tokenizeThreads >= 0 ? Parser(tokens) : Parser(tokenizer);
 
-        DEBUG_LOG("=== Starting parsing ===");
+        TRACE(Driver, Debug, "=== Starting parsing ===");
         auto program = parser.parse();
-        DEBUG_LOG("=== Parsing completed ===");
+        TRACE(Driver, Debug, "=== Parsing completed ===");
 
         if (!program)
         {
@@ -186,25 +312,47 @@ int main(int argc, char *argv[])
         {
             // Directly interpret the AST
             // std::cout << "Interpreting " << inputFile << "..." << std::endl;
-            DEBUG_LOG("Interpreting edu code directly");
+            TRACE(Driver, Debug, "Interpreting edu code directly");
 
             Interpreter interpreter;
+            interpreter.setBytecodeEnabled(!astMode && !closureMode);
+            interpreter.setClosuresEnabled(closureMode);
+            interpreter.setJitEnabled(jit);
+            interpreter.setTailCallsEnabled(tailCalls);
+            interpreter.setInlineCacheStatsEnabled(icStats);
+            interpreter.getOutput().setFlushPolicy(flushPolicy);
             // Set the global interpreter instance for module function execution
             Interpreter::setInstance(&interpreter);
 
             // Debug class declarations before interpreting
-            std::cout << "Class Declaration Debug:" << std::endl;
-            for (const auto &token : tokens)
+            if (TRACE_ENABLED(Driver, Debug))
             {
-                if (token.type == TokenType::Declaration && token.value == "class")
+                for (const auto &token : Tokenizer(std::string(tokenizer.text())).tokenize())
                 {
-                    std::cout << "Found class declaration token at line " << token.line << std::endl;
+                    if (token.type == TokenType::Declaration && token.value() == "class")
+                    {
+                        TRACE(Driver, Debug, "Found class declaration token at line ", token.line);
+                    }
                 }
             }
 
             try
             {
+                uint64_t allocationsBefore = heapAllocations.load(std::memory_order_relaxed);
                 interpreter.interpret(program.get());
+                uint64_t allocations = heapAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+
+                if (icStats)
+                {
+                    interpreter.printInlineCacheStats(std::cerr);
+                }
+                if (allocStats)
+                {
+                    uint64_t calls = interpreter.getCallCount();
+                    std::cerr << "Calls: " << calls << ", heap allocations: " << allocations
+                              << ", allocations per call: "
+                              << (calls ? static_cast<double>(allocations) / calls : 0.0) << std::endl;
+                }
             }
             catch (const std::exception &e)
             {
@@ -0,0 +1,67 @@
+#include "../parser.h"
+#include <cstdint>
+#include <gtest/gtest.h>
+
+// Fixture for AstArena tests
+class AstArenaTest : public ::testing::Test
+{
+protected:
+  std::unique_ptr<ProgramNode> parse(const std::string &source)
+  {
+    Tokenizer tokenizer(source);
+    Parser parser(tokenizer);
+    return parser.parse();
+  }
+};
+
+TEST_F(AstArenaTest, AllocatesAlignedBlocks)
+{
+  AstArena arena;
+  char *small = static_cast<char *>(arena.allocate(3, 1));
+  void *aligned = arena.allocate(24, 8);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(aligned) % 8, 0u);
+  ASSERT_GE(static_cast<char *>(aligned), small + 3) << "Blocks don't overlap";
+
+  // Lists bigger than a chunk still fit, and the chunk in use isn't given up
+  void *big = arena.allocate(1 << 20, 8);
+  void *next = arena.allocate(8, 8);
+  ASSERT_NE(big, nullptr);
+  ASSERT_LT(static_cast<char *>(next) - static_cast<char *>(aligned), 4096);
+  ASSERT_EQ(arena.used(), 3u + 24 + (1 << 20) + 8);
+  ASSERT_GE(arena.reserved(), arena.used());
+}
+
+TEST_F(AstArenaTest, ParsedNodesComeFromTheProgramArena)
+{
+  auto program = parse("int x = 1 + 2 * 3;\nint y = x;\n");
+  ASSERT_EQ(program->children.size(), 2u);
+  ASSERT_NE(program->arena, nullptr);
+  ASSERT_GT(program->arena->used(), 2 * sizeof(VariableDeclarationNode));
+  ASSERT_EQ(AstArena::current(), nullptr) << "The arena is only current while parsing";
+
+  // Nodes made after the parse are on the heap, and mix with arena nodes
+  auto declaration = dynamic_cast<VariableDeclarationNode *>(program->children[1].get());
+  ASSERT_NE(declaration, nullptr);
+  size_t used = program->arena->used();
+  declaration->initializer = std::make_unique<IntegerLiteralNode>("7", 2);
+  ASSERT_EQ(program->arena->used(), used);
+}
+
+TEST_F(AstArenaTest, SharedBodyOutlivesProgram)
+{
+  auto program = parse("int function f() {\n  int a = 1;\n  return a;\n}\n");
+  auto function = dynamic_cast<FunctionNode *>(program->children[0].get());
+  ASSERT_NE(function, nullptr);
+
+  // An imported function shares the body of the module's declaration
+  std::shared_ptr<FunctionNode> imported = function->clone();
+  std::weak_ptr<AstArena> arena = program->arena;
+  program.reset();
+
+  ASSERT_FALSE(arena.expired()) << "The body keeps its arena alive";
+  ASSERT_EQ(imported->body->statements.size(), 2u);
+  ASSERT_NE(dynamic_cast<ReturnStatementNode *>(imported->body->statements[1].get()), nullptr);
+
+  imported.reset();
+  ASSERT_TRUE(arena.expired());
+}
@@ -0,0 +1,133 @@
+#include "../flat_ast.h"
+#include "../parser.h"
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+
+// Fixture for FlatAst tests, with a scratch file
+class FlatAstTest : public ::testing::Test
+{
+protected:
+  std::string path = ::testing::TempDir() + "flat_ast_test.flat";
+
+  void TearDown() override { std::remove(path.c_str()); }
+
+  std::unique_ptr<ProgramNode> parse(const std::string &source)
+  {
+    Tokenizer tokenizer(source);
+    Parser parser(tokenizer);
+    return parser.parse();
+  }
+
+  // Something of most node kinds
+  const std::string source = R"(import { add, sub } from "./math";
+class Shape extends Base {
+  int sides = 4;
+  constructor(int n) { sides = n; }
+  int function area(float scale) {
+    if (sides > 3 && scale != 0.5) { return sides * 2; } else { return -sides; }
+  }
+}
+int function main() {
+  int total = 0;
+  for (int i = 0; i < 10; i++) { total += i; continue; }
+  while (total >= 100) { total = total - 1; break; }
+  switch (total) { case 1: print("one"); break; default: print('x'); }
+  var list = [1, 2, 3];
+  var point = { x: 1, y: true, z: null };
+  print(total / 3 + point.x);
+  return total == 45 || !(total < 1);
+}
+export int function twice(int x) { return x * 2; }
+)";
+};
+
+TEST_F(FlatAstTest, RoundTripsThroughTheTree)
+{
+  auto program = parse(source);
+  FlatAst flat = FlatAst::flatten(*program);
+  ASSERT_EQ(flat.kind(0), FlatAst::Kind::Program);
+  ASSERT_EQ(flat.children(0).size(), program->children.size());
+
+  auto rebuilt = flat.toProgram();
+  ASSERT_EQ(rebuilt->children.size(), program->children.size());
+  ASSERT_NE(rebuilt->arena, nullptr);
+  ASSERT_EQ(FlatAst::flatten(*rebuilt), flat) << "Nothing is lost on the way back";
+}
+
+TEST_F(FlatAstTest, WalksByIndex)
+{
+  FlatAst flat = FlatAst::flatten(*parse("int function f(int a) {\n  return a + 1;\n}\nint x = f(2);\n"));
+
+  // Nodes are in preorder, so every child comes after its parent
+  size_t integers = 0;
+  for (FlatAst::Index node = 0; node < flat.size(); node++)
+  {
+    integers += flat.kind(node) == FlatAst::Kind::IntegerLiteral;
+    for (FlatAst::Index child : flat.children(node))
+    {
+      ASSERT_TRUE(child == FlatAst::none || child > node);
+    }
+  }
+  ASSERT_EQ(integers, 2u);
+
+  FlatAst::Index function = flat.child(0, 0);
+  ASSERT_EQ(flat.kind(function), FlatAst::Kind::Function);
+  ASSERT_EQ(flat.text(function, 0), "f");
+  ASSERT_EQ(flat.text(function, 1), "int");
+  ASSERT_EQ(flat.children(function).size(), 2u) << "The body, then one parameter";
+  ASSERT_EQ(flat.kind(flat.child(function, 1)), FlatAst::Kind::FunctionParameter);
+
+  FlatAst::Index returned = flat.child(flat.child(function, 0), 0);
+  ASSERT_EQ(flat.kind(returned), FlatAst::Kind::ReturnStatement);
+  ASSERT_EQ(flat.line(returned), 2);
+}
+
+TEST_F(FlatAstTest, InternsStrings)
+{
+  FlatAst flat = FlatAst::flatten(*parse("int count = 1;\ncount = count + count;\n"));
+  size_t counts = 0;
+  for (size_t id = 0; id < flat.stringCount(); id++)
+  {
+    counts += flat.string(static_cast<uint32_t>(id)) == "count";
+  }
+  ASSERT_EQ(counts, 1u);
+}
+
+TEST_F(FlatAstTest, SavesAndLoads)
+{
+  FlatAst flat = FlatAst::flatten(*parse(source));
+  ASSERT_TRUE(flat.save(path));
+  auto loaded = FlatAst::load(path);
+  ASSERT_TRUE(loaded.has_value());
+  ASSERT_EQ(*loaded, flat);
+  ASSERT_EQ(FlatAst::flatten(*loaded->toProgram()), flat);
+
+  ASSERT_FALSE(FlatAst::load(path + ".missing").has_value());
+}
+
+TEST_F(FlatAstTest, RejectsDamagedFiles)
+{
+  FlatAst flat = FlatAst::flatten(*parse(source));
+  ASSERT_TRUE(flat.save(path));
+  std::string bytes;
+  {
+    std::ifstream file(path, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+  auto write = [this](const std::string &text) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << text;
+  };
+
+  write(bytes.substr(0, bytes.size() - 1));
+  ASSERT_FALSE(FlatAst::load(path).has_value()) << "Truncated";
+
+  std::string corrupt = bytes;
+  corrupt[16] = static_cast<char>(FlatAst::Kind::Count); // The first kind, after the magic and its count
+  write(corrupt);
+  ASSERT_FALSE(FlatAst::load(path).has_value()) << "Unknown kind";
+
+  write("not a flat ast");
+  ASSERT_FALSE(FlatAst::load(path).has_value());
+}
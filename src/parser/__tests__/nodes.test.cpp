@@ -0,0 +1,63 @@
+#include "../parser.h"
+#include <gtest/gtest.h>
+
+// Fixture for NodeKind, nodeCast and visitNode tests
+class NodeKindTest : public ::testing::Test
+{
+protected:
+  std::unique_ptr<ProgramNode> parse(const std::string &source)
+  {
+    Tokenizer tokenizer(source);
+    Parser parser(tokenizer);
+    return parser.parse();
+  }
+};
+
+TEST_F(NodeKindTest, NodesKnowTheirKind)
+{
+  auto program = parse("int x = 1 + 2;\nint function f() {\n  return x;\n}\n");
+  ASSERT_EQ(program->kind(), NodeKind::Program);
+  ASSERT_EQ(program->children[0]->kind(), NodeKind::VariableDeclaration);
+  ASSERT_EQ(program->children[1]->kind(), NodeKind::Function);
+
+  AsyncFunctionNode async("g", 1);
+  ASSERT_EQ(async.kind(), NodeKind::AsyncFunction);
+  ReExportNode reExport(1);
+  ASSERT_EQ(reExport.kind(), NodeKind::ReExport);
+}
+
+TEST_F(NodeKindTest, CastsLikeDynamicCast)
+{
+  AdditionExpressionNode add(nullptr, "+", nullptr, 1);
+  ExpressionNode *expr = &add;
+  ASSERT_EQ(nodeCast<AdditionExpressionNode>(expr), &add);
+  ASSERT_EQ(nodeCast<SubtractionExpressionNode>(expr), nullptr);
+  ASSERT_EQ(nodeCast<StatementNode>(static_cast<ASTNode *>(expr)), nullptr);
+  ASSERT_NE(nodeCast<ExpressionNode>(static_cast<ASTNode *>(expr)), nullptr);
+  ASSERT_EQ(nodeCast<ExpressionNode>(static_cast<ASTNode *>(nullptr)), nullptr);
+
+  // Base classes take the kinds of the classes derived from them
+  AsyncFunctionNode async("g", 1);
+  ASTNode *node = &async;
+  ASSERT_EQ(nodeCast<FunctionNode>(node), &async);
+  ASSERT_EQ(nodeCast<const AsyncFunctionNode>(static_cast<const ASTNode *>(node)), &async);
+  ReExportNode reExport(1);
+  node = &reExport;
+  ASSERT_EQ(nodeCast<ExportNode>(node), &reExport);
+  ASSERT_EQ(nodeCast<ImportNode>(node), nullptr);
+}
+
+TEST_F(NodeKindTest, VisitsTheNodesOwnClass)
+{
+  auto program = parse("int x = 1;\nwhile (x < 3) {\n  x++;\n}\nprint(x);\n");
+  auto visitor = NodeVisitor{[](VariableDeclarationNode *node) { return "declaration " + node->name; },
+                             [](WhileStatementNode *) { return std::string("loop"); },
+                             [](ASTNode *) { return std::string("other"); }};
+
+  std::vector<std::string> visited;
+  for (const auto &child : program->children)
+  {
+    visited.push_back(visitNode(child.get(), visitor));
+  }
+  ASSERT_EQ(visited, (std::vector<std::string>{"declaration x", "loop", "other"}));
+}
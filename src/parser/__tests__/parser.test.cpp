@@ -325,3 +325,66 @@ TEST_F(ParserTest, ParseClassWithMethods)
   ASSERT_NE(methodNode, nullptr) << "Method should be a MethodNode";
   ASSERT_EQ(methodNode->name, "myMethod") << "Method name should be 'myMethod'";
 }
+
+TEST_F(ParserTest, ParseBreakAndContinueInLoopBody)
+{
+  std::string source = R"(
+    while (true) {
+      continue;
+      break;
+    }
+  )";
+  Tokenizer tokenizer(source);
+  const auto &tokens = tokenizer.tokenize();
+
+  Parser parser(tokens);
+  auto program = parser.parse();
+
+  auto whileNode = dynamic_cast<WhileStatementNode *>(program->children[0].get());
+  ASSERT_NE(whileNode, nullptr) << "First child should be a WhileStatementNode";
+  auto body = dynamic_cast<BlockStatementNode *>(whileNode->body.get());
+  ASSERT_NE(body, nullptr) << "Loop body should be a block";
+  ASSERT_EQ(body->statements.size(), 2);
+  ASSERT_NE(dynamic_cast<ContinueStatementNode *>(body->statements[0].get()), nullptr)
+      << "First statement should be a ContinueStatementNode";
+  ASSERT_NE(dynamic_cast<BreakStatementNode *>(body->statements[1].get()), nullptr)
+      << "Second statement should be a BreakStatementNode";
+}
+
+TEST_F(ParserTest, StreamingParseMatchesVectorParse)
+{
+  // Longer than the stream's window, with a class member lookahead
+  std::string source = "class Point {\n  int x;\n  int y;\n  int function sum() { return x + y; }\n}\n";
+  for (int i = 0; i < 20; i++)
+  {
+    source += "int v" + std::to_string(i) + " = (1 + 2) * " + std::to_string(i) + ";\n";
+  }
+
+  Tokenizer streamed(source);
+  Parser streamingParser(streamed);
+  auto program = streamingParser.parse();
+
+  Tokenizer tokenizer(source);
+  const auto &tokens = tokenizer.tokenize();
+  ASSERT_GT(tokens.size(), 2 * TokenStream::windowSize);
+  Parser parser(tokens);
+  auto expected = parser.parse();
+
+  ASSERT_EQ(program->children.size(), expected->children.size());
+  auto classNode = dynamic_cast<ClassNode *>(program->children[0].get());
+  ASSERT_NE(classNode, nullptr) << "First child should be a ClassNode";
+  ASSERT_EQ(classNode->members.size(), 3);
+  auto last = dynamic_cast<VariableDeclarationNode *>(program->children.back().get());
+  ASSERT_NE(last, nullptr);
+  ASSERT_EQ(last->name, "v19");
+}
+
+TEST_F(ParserTest, TokenStreamRepeatsEndOfFile)
+{
+  Tokenizer tokenizer(std::string("a b"));
+  TokenStream stream(tokenizer);
+  ASSERT_EQ(stream[1].value(), "b");
+  ASSERT_EQ(stream[5].type, TokenType::EndOfFile);
+  ASSERT_EQ(stream[2].type, TokenType::EndOfFile);
+  ASSERT_EQ(stream[0].value(), "a") << "Still inside the window";
+}
@@ -0,0 +1,48 @@
+#include "../source.h"
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+
+// Fixture for SourceBuffer tests, with a scratch file
+class SourceBufferTest : public ::testing::Test
+{
+protected:
+  std::string path = ::testing::TempDir() + "source_buffer_test.edu";
+
+  void TearDown() override { std::remove(path.c_str()); }
+
+  void writeFile(const std::string &text)
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << text;
+  }
+};
+
+TEST_F(SourceBufferTest, MapsRegularFiles)
+{
+  writeFile("int x = 1;\nprint(x);\n");
+  auto source = SourceBuffer::map(path);
+  ASSERT_TRUE(source.has_value());
+  ASSERT_TRUE(source->isMapped());
+  ASSERT_EQ(source->text(), "int x = 1;\nprint(x);\n");
+
+  SourceBuffer moved = std::move(*source);
+  ASSERT_EQ(moved.text(), "int x = 1;\nprint(x);\n") << "Moving keeps the mapping";
+}
+
+TEST_F(SourceBufferTest, EmptyAndMissingFiles)
+{
+  writeFile("");
+  auto empty = SourceBuffer::map(path);
+  ASSERT_TRUE(empty.has_value());
+  ASSERT_TRUE(empty->text().empty());
+
+  ASSERT_FALSE(SourceBuffer::map(path + ".missing").has_value());
+}
+
+TEST_F(SourceBufferTest, ShortStringsSurviveAMove)
+{
+  SourceBuffer buffer(std::string("x;"));
+  SourceBuffer moved = std::move(buffer);
+  ASSERT_EQ(moved.text(), "x;");
+}
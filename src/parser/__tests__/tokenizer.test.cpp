@@ -3,7 +3,7 @@
 
 class TokenizerTest : public ::testing::Test {
 protected:
-  Tokenizer *tokenizer;
+  Tokenizer *tokenizer = nullptr;
 
   void SetUp() override {
     // This can be left empty if no general setup is needed.
@@ -31,61 +31,61 @@ protected:
 TEST_F(TokenizerTest, IdentifiesKeywords) {
   Token token = tokenizeSingleToken("for");
   EXPECT_EQ(token.type, TokenType::Keyword);
-  EXPECT_EQ(token.value, "for");
+  EXPECT_EQ(token.value(), "for");
 }
 
 TEST_F(TokenizerTest, IdentifiesDeclarations) {
   Token token = tokenizeSingleToken("class");
   EXPECT_EQ(token.type, TokenType::Declaration);
-  EXPECT_EQ(token.value, "class");
+  EXPECT_EQ(token.value(), "class");
 }
 
 TEST_F(TokenizerTest, IdentifiesIdentifiers) {
   Token token = tokenizeSingleToken("myVariable");
   EXPECT_EQ(token.type, TokenType::Identifier);
-  EXPECT_EQ(token.value, "myVariable");
+  EXPECT_EQ(token.value(), "myVariable");
 }
 
 TEST_F(TokenizerTest, IdentifiesNumbers) {
   Token token = tokenizeSingleToken("1234");
   EXPECT_EQ(token.type, TokenType::Number);
-  EXPECT_EQ(token.value, "1234");
+  EXPECT_EQ(token.value(), "1234");
 }
 
 TEST_F(TokenizerTest, IdentifiesStrings) {
   Token token = tokenizeSingleToken("\"Hello, World!\"");
   EXPECT_EQ(token.type, TokenType::String);
-  EXPECT_EQ(token.value, "Hello, World!");
+  EXPECT_EQ(token.value(), "Hello, World!");
 }
 
 TEST_F(TokenizerTest, IdentifiesOperators) {
   Token token = tokenizeSingleToken("+");
   EXPECT_EQ(token.type, TokenType::Operator);
-  EXPECT_EQ(token.value, "+");
+  EXPECT_EQ(token.value(), "+");
 }
 
 TEST_F(TokenizerTest, IdentifiesPunctuators) {
   Token token = tokenizeSingleToken(";");
   EXPECT_EQ(token.type, TokenType::Punctuator);
-  EXPECT_EQ(token.value, ";");
+  EXPECT_EQ(token.value(), ";");
 }
 
 TEST_F(TokenizerTest, IdentifiesEndOfFile) {
   Token token = tokenizeSingleToken("");
   EXPECT_EQ(token.type, TokenType::EndOfFile);
-  EXPECT_EQ(token.value, "");
+  EXPECT_EQ(token.value(), "");
 }
 
 TEST_F(TokenizerTest, HandlesUnknownCharacters) {
   Token token = tokenizeSingleToken("@");
   EXPECT_EQ(token.type, TokenType::Unknown);
-  EXPECT_EQ(token.value, "@");
+  EXPECT_EQ(token.value(), "@");
 }
 
 TEST_F(TokenizerTest, HandlesStringsWithEscapeSequences) {
   Token token = tokenizeSingleToken("\"Line\\nBreak\"");
   EXPECT_EQ(token.type, TokenType::String);
-  EXPECT_EQ(token.value, "Line\nBreak");
+  EXPECT_EQ(token.value(), "Line\nBreak");
 }
 
 TEST_F(TokenizerTest, HandlesUnterminatedStrings) {
@@ -125,7 +125,7 @@ TEST_F(TokenizerTest, TokenizesComplexSourceCode) {
   // Check for specific keywords
   auto classToken =
       std::find_if(tokens.begin(), tokens.end(),
-                   [](const Token &t) { return t.value == "class"; });
+                   [](const Token &t) { return t.value() == "class"; });
   EXPECT_NE(classToken, tokens.end());
   EXPECT_EQ(classToken->type, TokenType::Declaration);
 }
@@ -152,4 +152,103 @@ TEST_F(TokenizerTest, TokenizesCharacterVariable) {
   EXPECT_EQ(tokens[1].type, TokenType::Identifier);
   EXPECT_EQ(tokens[2].type, TokenType::Operator);
   EXPECT_EQ(tokens[3].type, TokenType::Character);
-}
\ No newline at end of file
+}
+TEST_F(TokenizerTest, KeepsEscapedLiteralsAcrossManyTokens) {
+  std::string source = "string a = \"one\\ttwo\"; char b = '\\n'; string c = \"plain\";";
+  for (int i = 0; i < 100; i++) {
+    source += " string s" + std::to_string(i) + " = \"x\\\"" + std::to_string(i) + "\";";
+  }
+
+  auto tokens = tokenizeSource(source);
+
+  // Decoded literals must stay valid while later ones are added
+  EXPECT_EQ(tokens[3].value(), "one\ttwo");
+  EXPECT_EQ(tokens[8].value(), "\n");
+  EXPECT_EQ(tokens[8].type, TokenType::Character);
+  EXPECT_EQ(tokens[13].value(), "plain");
+  EXPECT_EQ(tokens[tokens.size() - 3].value(), "x\"99");
+}
+
+TEST_F(TokenizerTest, ScansRunsLongerThanAVectorBlock) {
+  std::string identifier(70, 'a');
+  identifier += "_Z9";
+  std::string comment = "/*" + std::string(40, '*') + "\n" + std::string(50, ' ') + "\n**/";
+  std::string source = identifier + " " + comment + " \"" + std::string(45, 'x') + "\\\\" + "\" class";
+
+  auto tokens = tokenizeSource(source);
+
+  ASSERT_EQ(tokens.size(), 4u);
+  EXPECT_EQ(tokens[0].value(), identifier);
+  EXPECT_EQ(tokens[0].type, TokenType::Identifier);
+  EXPECT_EQ(tokens[1].value(), std::string(45, 'x') + "\\");
+  EXPECT_EQ(tokens[1].line, 3) << "Newlines inside the comment are counted";
+  EXPECT_EQ(tokens[2].type, TokenType::Declaration);
+}
+
+TEST_F(TokenizerTest, KeepsLexemesLongerThanTheTokenLength) {
+  // One byte short of, at and past the longest length a Token holds itself,
+  // plain and with an escape sequence
+  const size_t lengths[] = {Token::longLength - 1, Token::longLength, (1u << 24) + 5};
+  std::string source;
+  for (size_t length : lengths) {
+    source += "\"" + std::string(length, 'x') + "\" ";
+  }
+  source += "\"\\t" + std::string(1u << 24, 'y') + "\" " + std::string(1u << 24, 'z') + " end";
+
+  auto tokens = tokenizeSource(source);
+
+  ASSERT_EQ(tokens.size(), 7u);
+  for (size_t i = 0; i < 3; i++) {
+    EXPECT_EQ(tokens[i].type, TokenType::String);
+    EXPECT_EQ(tokens[i].value().size(), lengths[i]);
+  }
+  EXPECT_EQ(tokens[3].value().size(), (1u << 24) + 1);
+  EXPECT_EQ(tokens[3].value().substr(0, 2), "\ty");
+  EXPECT_EQ(tokens[4].type, TokenType::Identifier);
+  EXPECT_EQ(tokens[4].value().size(), 1u << 24);
+  EXPECT_EQ(tokens[5].value(), "end");
+}
+
+// Differential test: the parallel tokenizer has to split only where the
+// serial one is between tokens, so both must agree token for token, and
+// report the same errors at the same lines in the same order
+TEST_F(TokenizerTest, ParallelTokenizationMatchesSerial) {
+  const char *pieces[] = {
+      "class A { int x; }\n", "// a comment with \"quotes\" and 'ticks'\n",
+      "/* block\n comment with // and \" inside\n*/", "string s = \"a \\\"quoted\\\" word\";\n",
+      "string t = \"spans\nlines\";\n", "char c = '\\'';\n", "char n = '\n';\n", "char q = '\"';\n",
+      "x = a / b / c;\n", "y = a /= 2;\n", "if (a <= b && c != d) { i++; }\n",
+      "   \t  \n\n", "z = 12.5 * 3;", " ", "\"\\\\\" ", "/**/", "/*/ */"};
+  std::string source;
+  unsigned state = 12345;
+  while (source.size() < 200000) {
+    state = state * 1103515245 + 12345;
+    source += pieces[(state >> 16) % (sizeof(pieces) / sizeof(pieces[0]))];
+    if (source.size() % 50000 < 20) {
+      source += "'ab' "; // Malformed: the tokenizer reads a and b, then a new literal
+    }
+  }
+
+  Tokenizer serial(source);
+  testing::internal::CaptureStderr();
+  std::vector<Token> expected = serial.tokenize();
+  std::string expectedErrors = testing::internal::GetCapturedStderr();
+  ASSERT_GT(serial.errors().size(), 2u);
+  for (unsigned threads : {2u, 4u, 7u}) {
+    Tokenizer parallel(source);
+    testing::internal::CaptureStderr();
+    std::vector<Token> tokens = parallel.tokenizeParallel(threads, 1000);
+    EXPECT_EQ(testing::internal::GetCapturedStderr(), expectedErrors) << threads << " threads";
+    ASSERT_EQ(parallel.errors().size(), serial.errors().size());
+    for (size_t i = 0; i < parallel.errors().size(); i++) {
+      EXPECT_EQ(parallel.errors()[i].line, serial.errors()[i].line) << "error " << i;
+      EXPECT_EQ(parallel.errors()[i].message, serial.errors()[i].message) << "error " << i;
+    }
+    ASSERT_EQ(tokens.size(), expected.size()) << threads << " threads";
+    for (size_t i = 0; i < tokens.size(); i++) {
+      ASSERT_EQ(tokens[i].type, expected[i].type) << "token " << i;
+      ASSERT_EQ(tokens[i].line, expected[i].line) << "token " << i;
+      ASSERT_EQ(tokens[i].value(), expected[i].value()) << "token " << i;
+    }
+  }
+}
@@ -0,0 +1,29 @@
+#include "arena.h"
+#include <cstdint>
+
+thread_local AstArena *AstArena::active = nullptr;
+
+void *AstArena::allocate(size_t size, size_t align)
+{
+    usedBytes += size;
+    if (size > chunkSize / 4)
+    {
+        // A big list gets a chunk of its own, so the current one isn't wasted
+        chunks.emplace_back(new char[size]);
+        reservedBytes += size;
+        return chunks.back().get();
+    }
+
+    // Chunks come from new[], so they are aligned for anything a node holds
+    uintptr_t start = (reinterpret_cast<uintptr_t>(next) + align - 1) & ~(align - 1);
+    if (!next || start + size > reinterpret_cast<uintptr_t>(limit))
+    {
+        chunks.emplace_back(new char[chunkSize]);
+        reservedBytes += chunkSize;
+        next = chunks.back().get();
+        limit = next + chunkSize;
+        start = reinterpret_cast<uintptr_t>(next);
+    }
+    next = reinterpret_cast<char *>(start + size);
+    return reinterpret_cast<void *>(start);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Bump allocator for the nodes of one program. Parser::parse makes one per
+// ProgramNode and activates it while it runs; every node and node list created
+// meanwhile is carved out of its chunks instead of coming from the heap one by
+// one, and nothing is handed back until the whole arena goes at once.
+class AstArena : public std::enable_shared_from_this<AstArena>
+{
+public:
+  AstArena() = default;
+  AstArena(const AstArena &) = delete;
+  AstArena &operator=(const AstArena &) = delete;
+
+  void *allocate(size_t size, size_t align);
+
+  // Bytes handed out so far, and bytes reserved for them
+  size_t used() const { return usedBytes; }
+  size_t reserved() const { return reservedBytes; }
+
+  // The arena new nodes come from on this thread, or nullptr for the heap
+  static AstArena *current() { return active; }
+
+  // Makes an arena the current one until the scope ends
+  class Scope
+  {
+  public:
+    explicit Scope(AstArena *arena) : previous(active) { active = arena; }
+    ~Scope() { active = previous; }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    AstArena *previous;
+  };
+
+  // Shared ownership of a node. A node from the current arena also keeps the
+  // arena alive, as the node may outlive the program it was parsed into
+  template <typename T>
+  static std::shared_ptr<T> share(std::unique_ptr<T> node)
+  {
+    if (!active)
+    {
+      return std::shared_ptr<T>(std::move(node));
+    }
+    return std::shared_ptr<T>(node.release(), [arena = active->shared_from_this()](T *node) { delete node; });
+  }
+
+private:
+  static constexpr size_t chunkSize = 64 * 1024;
+
+  std::vector<std::unique_ptr<char[]>> chunks;
+  char *next = nullptr;
+  char *limit = nullptr;
+  size_t usedBytes = 0;
+  size_t reservedBytes = 0;
+
+  static thread_local AstArena *active;
+};
+
+// Allocator for the child lists of nodes: from the arena that was current when
+// the list was made, otherwise from the heap. Giving memory back to an arena
+// does nothing; the space is reclaimed with the arena
+template <typename T>
+class ArenaAllocator
+{
+public:
+  using value_type = T;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  ArenaAllocator() : arena(AstArena::current()) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+  T *allocate(size_t count)
+  {
+    if (arena)
+    {
+      return static_cast<T *>(arena->allocate(count * sizeof(T), alignof(T)));
+    }
+    return static_cast<T *>(::operator new(count * sizeof(T)));
+  }
+
+  void deallocate(T *memory, size_t)
+  {
+    if (!arena)
+    {
+      ::operator delete(memory);
+    }
+  }
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U> &other) const { return arena == other.arena; }
+
+private:
+  template <typename U>
+  friend class ArenaAllocator;
+
+  AstArena *arena;
+};
+
+template <typename T>
+using NodeList = std::vector<std::unique_ptr<T>, ArenaAllocator<std::unique_ptr<T>>>;
@@ -0,0 +1,1033 @@
+#include "flat_ast.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <typeinfo>
+#include <unordered_map>
+#include "source.h"
+
+// Appends the nodes of a tree in preorder. A node's strings and the room for
+// its children are laid down as soon as it is opened, before any of its
+// children are, which keeps every node's runs contiguous
+class FlatAst::Builder
+{
+public:
+    explicit Builder(FlatAst &ast) : ast(ast) {}
+
+    Index visit(const ASTNode *node);
+
+private:
+    FlatAst &ast;
+    // Views of the strings in the tree, which outlives the builder
+    std::unordered_map<std::string_view, uint32_t> stringIds;
+
+    Index open(Kind kind, const ASTNode &node, uint32_t operand = 0)
+    {
+        ast.kindList.push_back(kind);
+        ast.lineList.push_back(static_cast<uint32_t>(node.getLine()));
+        ast.operandList.push_back(operand);
+        return static_cast<Index>(ast.kindList.size() - 1);
+    }
+
+    void addText(std::string_view text)
+    {
+        auto [it, added] = stringIds.try_emplace(text, static_cast<uint32_t>(ast.stringCount()));
+        if (added)
+        {
+            ast.chars.append(text);
+            ast.stringStart.push_back(static_cast<uint32_t>(ast.chars.size()));
+        }
+        ast.textList.push_back(it->second);
+    }
+
+    // Ends the open node's strings and makes room for its children. Returns
+    // where they go, as childList may move while they are visited
+    size_t reserve(size_t count)
+    {
+        ast.textStart.push_back(static_cast<uint32_t>(ast.textList.size()));
+        size_t slot = ast.childList.size();
+        ast.childList.resize(slot + count, none);
+        ast.childStart.push_back(static_cast<uint32_t>(ast.childList.size()));
+        return slot;
+    }
+
+    void fill(size_t slot, const ASTNode *child)
+    {
+        Index index = visit(child);
+        ast.childList[slot] = index;
+    }
+
+    template <typename T>
+    void fill(size_t slot, const NodeList<T> &list)
+    {
+        for (const auto &child : list)
+        {
+            fill(slot++, child.get());
+        }
+    }
+
+    template <typename T>
+    Index leaf(Kind kind, const T &node, std::string_view text)
+    {
+        Index index = open(kind, node);
+        addText(text);
+        reserve(0);
+        return index;
+    }
+
+    template <typename T>
+    Index binary(Kind kind, const T &node)
+    {
+        Index index = open(kind, node);
+        addText(node.op);
+        size_t slot = reserve(2);
+        fill(slot, node.left.get());
+        fill(slot + 1, node.right.get());
+        return index;
+    }
+
+    template <typename T>
+    Index list(Kind kind, const ASTNode &node, const NodeList<T> &children)
+    {
+        Index index = open(kind, node);
+        fill(reserve(children.size()), children);
+        return index;
+    }
+
+    Index single(Kind kind, const ASTNode &node, const ASTNode *child)
+    {
+        Index index = open(kind, node);
+        fill(reserve(1), child);
+        return index;
+    }
+};
+
+FlatAst::Index FlatAst::Builder::visit(const ASTNode *node)
+{
+    if (!node)
+    {
+        return none;
+    }
+
+    switch (node->kind())
+    {
+    case NodeKind::Program:
+    {
+        auto *n = static_cast<const ProgramNode *>(node);
+        return list(Kind::Program, *n, n->children);
+    }
+    case NodeKind::Type:
+    {
+        auto *n = static_cast<const TypeNode *>(node);
+        return leaf(Kind::Type, *n, n->typeName);
+    }
+    case NodeKind::FunctionParameter:
+    {
+        auto *n = static_cast<const FunctionParameterNode *>(node);
+        Index index = open(Kind::FunctionParameter, *n);
+        addText(n->name);
+        fill(reserve(1), n->type.get());
+        return index;
+    }
+    case NodeKind::BlockStatement:
+    {
+        auto *n = static_cast<const BlockStatementNode *>(node);
+        return list(Kind::BlockStatement, *n, n->statements);
+    }
+    case NodeKind::Function:
+    case NodeKind::AsyncFunction:
+    {
+        auto *n = static_cast<const FunctionNode *>(node);
+        Kind kind = nodeCast<const AsyncFunctionNode>(n) ? Kind::AsyncFunction : Kind::Function;
+        Index index = open(kind, *n, n->isAsync);
+        addText(n->name);
+        addText(n->returnType);
+        size_t slot = reserve(1 + n->parameters.size());
+        fill(slot, n->body.get());
+        fill(slot + 1, n->parameters);
+        return index;
+    }
+    case NodeKind::Class:
+    {
+        auto *n = static_cast<const ClassNode *>(node);
+        Index index = open(Kind::Class, *n);
+        addText(n->name);
+        addText(n->baseClassName);
+        fill(reserve(n->members.size()), n->members);
+        return index;
+    }
+    case NodeKind::CaseClause:
+    {
+        auto *n = static_cast<const CaseClauseNode *>(node);
+        Index index = open(Kind::CaseClause, *n, n->isDefault);
+        size_t slot = reserve(1 + n->statements.size());
+        fill(slot, n->caseExpression.get());
+        fill(slot + 1, n->statements);
+        return index;
+    }
+    case NodeKind::Import:
+    {
+        auto *n = static_cast<const ImportNode *>(node);
+        Index index = open(Kind::Import, *n,
+                           (n->hasDefaultImport ? HasDefaultImport : 0) |
+                               (n->preserveExternalFunctions ? PreserveExternalFunctions : 0));
+        addText(n->moduleName);
+        addText(n->defaultImportName);
+        for (const auto &[original, local] : n->namedImports)
+        {
+            addText(original);
+            addText(local);
+        }
+        reserve(0);
+        return index;
+    }
+    case NodeKind::ReExport:
+    {
+        auto *n = static_cast<const ReExportNode *>(node);
+        Index index = open(Kind::ReExport, *n, (n->isDefault ? IsDefault : 0) | (n->exportAll ? ExportAll : 0));
+        addText(n->exportName);
+        addText(n->moduleName);
+        for (const auto &[original, exported] : n->namedExports)
+        {
+            addText(original);
+            addText(exported);
+        }
+        fill(reserve(1), n->exportItem.get());
+        return index;
+    }
+    case NodeKind::Export:
+    {
+        auto *n = static_cast<const ExportNode *>(node);
+        Index index = open(Kind::Export, *n, n->isDefault ? IsDefault : 0);
+        addText(n->exportName);
+        fill(reserve(1), n->exportItem.get());
+        return index;
+    }
+    case NodeKind::Interface:
+    {
+        auto *n = static_cast<const InterfaceNode *>(node);
+        Index index = open(Kind::Interface, *n);
+        addText(n->name);
+        fill(reserve(n->members.size()), n->members);
+        return index;
+    }
+    case NodeKind::ErrorType:
+    {
+        auto *n = static_cast<const ErrorTypeNode *>(node);
+        Index index = open(Kind::ErrorType, *n);
+        addText(n->varName);
+        addText(n->message);
+        addText(n->errorCode);
+        reserve(0);
+        return index;
+    }
+    case NodeKind::Constructor:
+    {
+        auto *n = static_cast<const ConstructorNode *>(node);
+        Index index = open(Kind::Constructor, *n);
+        size_t slot = reserve(1 + n->parameters.size());
+        fill(slot, n->body.get());
+        fill(slot + 1, n->parameters);
+        return index;
+    }
+    case NodeKind::VariableDeclaration:
+    {
+        auto *n = static_cast<const VariableDeclarationNode *>(node);
+        Index index = open(Kind::VariableDeclaration, *n, n->isConst);
+        addText(n->name);
+        addText(n->typeName);
+        fill(reserve(1), n->initializer.get());
+        return index;
+    }
+    case NodeKind::ReturnStatement:
+    {
+        auto *n = static_cast<const ReturnStatementNode *>(node);
+        return single(Kind::ReturnStatement, *n, n->expression.get());
+    }
+    case NodeKind::IfStatement:
+    {
+        auto *n = static_cast<const IfStatementNode *>(node);
+        Index index = open(Kind::IfStatement, *n);
+        size_t slot = reserve(3);
+        fill(slot, n->condition.get());
+        fill(slot + 1, n->thenBranch.get());
+        fill(slot + 2, n->elseBranch.get());
+        return index;
+    }
+    case NodeKind::ForStatement:
+    {
+        auto *n = static_cast<const ForStatementNode *>(node);
+        Index index = open(Kind::ForStatement, *n);
+        size_t slot = reserve(4);
+        fill(slot, n->initializer.get());
+        fill(slot + 1, n->condition.get());
+        fill(slot + 2, n->increment.get());
+        fill(slot + 3, n->body.get());
+        return index;
+    }
+    case NodeKind::WhileStatement:
+    {
+        auto *n = static_cast<const WhileStatementNode *>(node);
+        Index index = open(Kind::WhileStatement, *n);
+        size_t slot = reserve(2);
+        fill(slot, n->condition.get());
+        fill(slot + 1, n->body.get());
+        return index;
+    }
+    case NodeKind::BreakStatement:
+    {
+        auto *n = static_cast<const BreakStatementNode *>(node);
+        Index index = open(Kind::BreakStatement, *n);
+        reserve(0);
+        return index;
+    }
+    case NodeKind::ContinueStatement:
+    {
+        auto *n = static_cast<const ContinueStatementNode *>(node);
+        Index index = open(Kind::ContinueStatement, *n);
+        reserve(0);
+        return index;
+    }
+    case NodeKind::SwitchStatement:
+    {
+        auto *n = static_cast<const SwitchStatementNode *>(node);
+        Index index = open(Kind::SwitchStatement, *n);
+        size_t slot = reserve(1 + n->cases.size());
+        fill(slot, n->condition.get());
+        fill(slot + 1, n->cases);
+        return index;
+    }
+    case NodeKind::BinaryExpression:
+        return binary(Kind::BinaryExpression, *static_cast<const BinaryExpressionNode *>(node));
+    case NodeKind::Literal:
+    {
+        auto *n = static_cast<const LiteralNode *>(node);
+        return leaf(Kind::Literal, *n, n->value);
+    }
+    case NodeKind::UnaryExpression:
+    {
+        auto *n = static_cast<const UnaryExpressionNode *>(node);
+        Index index = open(Kind::UnaryExpression, *n, n->isPrefix);
+        addText(n->op);
+        fill(reserve(1), n->operand.get());
+        return index;
+    }
+    case NodeKind::CallExpression:
+    {
+        auto *n = static_cast<const CallExpressionNode *>(node);
+        Index index = open(Kind::CallExpression, *n);
+        size_t slot = reserve(1 + n->arguments.size());
+        fill(slot, n->callee.get());
+        fill(slot + 1, n->arguments);
+        return index;
+    }
+    case NodeKind::AssignmentExpression:
+        return binary(Kind::AssignmentExpression, *static_cast<const AssignmentExpressionNode *>(node));
+    case NodeKind::MemberAccessExpression:
+    {
+        auto *n = static_cast<const MemberAccessExpressionNode *>(node);
+        Index index = open(Kind::MemberAccessExpression, *n);
+        addText(n->memberName);
+        fill(reserve(1), n->object.get());
+        return index;
+    }
+    case NodeKind::ConditionalExpression:
+    {
+        auto *n = static_cast<const ConditionalExpressionNode *>(node);
+        Index index = open(Kind::ConditionalExpression, *n);
+        size_t slot = reserve(3);
+        fill(slot, n->condition.get());
+        fill(slot + 1, n->trueExpr.get());
+        fill(slot + 2, n->falseExpr.get());
+        return index;
+    }
+    case NodeKind::StringLiteral:
+    {
+        auto *n = static_cast<const StringLiteralNode *>(node);
+        return leaf(Kind::StringLiteral, *n, n->value);
+    }
+    case NodeKind::NumberLiteral:
+    {
+        auto *n = static_cast<const NumberLiteralNode *>(node);
+        return leaf(Kind::NumberLiteral, *n, n->value);
+    }
+    case NodeKind::BooleanLiteral:
+    {
+        auto *n = static_cast<const BooleanLiteralNode *>(node);
+        Index index = open(Kind::BooleanLiteral, *n, n->value);
+        reserve(0);
+        return index;
+    }
+    case NodeKind::NullLiteral:
+    {
+        auto *n = static_cast<const NullLiteralNode *>(node);
+        Index index = open(Kind::NullLiteral, *n);
+        reserve(0);
+        return index;
+    }
+    case NodeKind::ArrayLiteral:
+    {
+        auto *n = static_cast<const ArrayLiteralNode *>(node);
+        return list(Kind::ArrayLiteral, *n, n->elements);
+    }
+    case NodeKind::ObjectLiteral:
+    {
+        auto *n = static_cast<const ObjectLiteralNode *>(node);
+        Index index = open(Kind::ObjectLiteral, *n);
+        size_t slot = reserve(n->properties.size());
+        for (const auto &[key, value] : n->properties)
+        {
+            // The property takes the line of the literal
+            Index property = open(Kind::Property, *n);
+            addText(key);
+            size_t valueSlot = reserve(1);
+            ast.childList[slot++] = property;
+            fill(valueSlot, value.get());
+        }
+        return index;
+    }
+    case NodeKind::TemplateLiteral:
+    {
+        auto *n = static_cast<const TemplateLiteralNode *>(node);
+        return list(Kind::TemplateLiteral, *n, n->parts);
+    }
+    case NodeKind::TryCatch:
+    {
+        auto *n = static_cast<const TryCatchNode *>(node);
+        Index index = open(Kind::TryCatch, *n);
+        size_t slot = reserve(3);
+        fill(slot, n->tryBlock.get());
+        fill(slot + 1, n->catchVariable.get());
+        fill(slot + 2, n->catchBlock.get());
+        return index;
+    }
+    case NodeKind::EqualityExpression:
+        return binary(Kind::EqualityExpression, *static_cast<const EqualityExpressionNode *>(node));
+    case NodeKind::OrExpression:
+        return binary(Kind::OrExpression, *static_cast<const OrExpressionNode *>(node));
+    case NodeKind::AndExpression:
+        return binary(Kind::AndExpression, *static_cast<const AndExpressionNode *>(node));
+    case NodeKind::VariableExpression:
+    {
+        auto *n = static_cast<const VariableExpressionNode *>(node);
+        return leaf(Kind::VariableExpression, *n, n->name);
+    }
+    case NodeKind::AwaitExpression:
+    {
+        auto *n = static_cast<const AwaitExpressionNode *>(node);
+        return single(Kind::AwaitExpression, *n, n->expression.get());
+    }
+    case NodeKind::NullReference:
+    {
+        auto *n = static_cast<const NullReferenceNode *>(node);
+        Index index = open(Kind::NullReference, *n);
+        reserve(0);
+        return index;
+    }
+    case NodeKind::ConsoleLog:
+    {
+        auto *n = static_cast<const ConsoleLogNode *>(node);
+        return single(Kind::ConsoleLog, *n, n->expression.get());
+    }
+    case NodeKind::InputStatement:
+    {
+        auto *n = static_cast<const InputStatementNode *>(node);
+        return single(Kind::InputStatement, *n, n->variable.get());
+    }
+    case NodeKind::ComparisonExpression:
+        return binary(Kind::ComparisonExpression, *static_cast<const ComparisonExpressionNode *>(node));
+    case NodeKind::AdditionExpression:
+        return binary(Kind::AdditionExpression, *static_cast<const AdditionExpressionNode *>(node));
+    case NodeKind::SubtractionExpression:
+        return binary(Kind::SubtractionExpression, *static_cast<const SubtractionExpressionNode *>(node));
+    case NodeKind::MultiplicationExpression:
+        return binary(Kind::MultiplicationExpression, *static_cast<const MultiplicationExpressionNode *>(node));
+    case NodeKind::DivisionExpression:
+        return binary(Kind::DivisionExpression, *static_cast<const DivisionExpressionNode *>(node));
+    case NodeKind::CharLiteral:
+    {
+        auto *n = static_cast<const CharLiteralNode *>(node);
+        Index index = open(Kind::CharLiteral, *n, static_cast<unsigned char>(n->value));
+        reserve(0);
+        return index;
+    }
+    case NodeKind::PropertyDeclaration:
+    {
+        auto *n = static_cast<const PropertyDeclarationNode *>(node);
+        Index index = open(Kind::PropertyDeclaration, *n);
+        addText(n->name);
+        size_t slot = reserve(2);
+        fill(slot, n->type.get());
+        fill(slot + 1, n->initializer.get());
+        return index;
+    }
+    case NodeKind::ExpressionStatement:
+    {
+        auto *n = static_cast<const ExpressionStatementNode *>(node);
+        return single(Kind::ExpressionStatement, *n, n->expression.get());
+    }
+    case NodeKind::IntegerLiteral:
+    {
+        auto *n = static_cast<const IntegerLiteralNode *>(node);
+        Index index = open(Kind::IntegerLiteral, *n, static_cast<uint32_t>(n->value));
+        reserve(0);
+        return index;
+    }
+    case NodeKind::FloatingPointLiteral:
+    {
+        auto *n = static_cast<const FloatingPointLiteralNode *>(node);
+        uint32_t bits;
+        std::memcpy(&bits, &n->value, sizeof(bits));
+        Index index = open(Kind::FloatingPointLiteral, *n, bits);
+        reserve(0);
+        return index;
+    }
+    case NodeKind::FunctionExpression:
+    {
+        auto *n = static_cast<const FunctionExpressionNode *>(node);
+        return single(Kind::FunctionExpression, *n, n->function.get());
+    }
+    case NodeKind::Template:
+    {
+        auto *n = static_cast<const TemplateNode *>(node);
+        Index index = open(Kind::Template, *n);
+        for (const auto &parameter : n->parameters)
+        {
+            addText(parameter);
+        }
+        fill(reserve(1), n->declaration.get());
+        return index;
+    }
+    default:
+        break;
+    }
+    throw std::runtime_error("Can't flatten a node of type " + std::string(typeid(*node).name()) +
+                             " at line " + std::to_string(node->getLine()));
+}
+
+FlatAst FlatAst::flatten(const ProgramNode &program)
+{
+    FlatAst ast;
+    Builder(ast).visit(&program);
+    return ast;
+}
+
+// Rebuilds the tree of a FlatAst. Throws std::runtime_error when a child
+// isn't of the type its place in the parent needs
+class FlatAst::TreeBuilder
+{
+public:
+    explicit TreeBuilder(const FlatAst &ast) : ast(ast) {}
+
+    std::unique_ptr<ASTNode> build(FlatAst::Index index);
+
+    template <typename T>
+    std::unique_ptr<T> build(FlatAst::Index index)
+    {
+        std::unique_ptr<ASTNode> node = build(index);
+        if (node && !nodeCast<T>(node.get()))
+        {
+            throw std::runtime_error("Unexpected node kind " + std::to_string(static_cast<int>(ast.kind(index))) +
+                                     " at line " + std::to_string(node->getLine()));
+        }
+        return std::unique_ptr<T>(static_cast<T *>(node.release()));
+    }
+
+    template <typename T>
+    void buildList(FlatAst::Index index, size_t from, NodeList<T> &list)
+    {
+        auto children = ast.children(index);
+        for (size_t i = from; i < children.size(); i++)
+        {
+            list.push_back(build<T>(children[i]));
+        }
+    }
+
+private:
+    const FlatAst &ast;
+
+    std::string text(FlatAst::Index index, size_t i) const
+    {
+        return i < ast.textCount(index) ? std::string(ast.text(index, i)) : std::string();
+    }
+
+    FlatAst::Index child(FlatAst::Index index, size_t i) const
+    {
+        return i < ast.children(index).size() ? ast.child(index, i) : FlatAst::none;
+    }
+
+    template <typename T>
+    std::unique_ptr<T> binary(FlatAst::Index index, int line)
+    {
+        return std::make_unique<T>(build<ExpressionNode>(child(index, 0)), text(index, 0),
+                                   build<ExpressionNode>(child(index, 1)), line);
+    }
+};
+
+std::unique_ptr<ASTNode> FlatAst::TreeBuilder::build(FlatAst::Index index)
+{
+    using Kind = FlatAst::Kind;
+    if (index == FlatAst::none)
+    {
+        return nullptr;
+    }
+
+    int line = ast.line(index);
+    uint32_t operand = ast.operand(index);
+    switch (ast.kind(index))
+    {
+    case Kind::Program:
+    {
+        auto node = std::make_unique<ProgramNode>(line);
+        buildList(index, 0, node->children);
+        return node;
+    }
+    case Kind::Type:
+        return std::make_unique<TypeNode>(text(index, 0), line);
+    case Kind::FunctionParameter:
+    {
+        auto node = std::make_unique<FunctionParameterNode>(text(index, 0), line);
+        node->type = build<TypeNode>(child(index, 0));
+        return node;
+    }
+    case Kind::BlockStatement:
+    {
+        auto node = std::make_unique<BlockStatementNode>(line);
+        buildList(index, 0, node->statements);
+        return node;
+    }
+    case Kind::Function:
+    case Kind::AsyncFunction:
+    {
+        std::unique_ptr<FunctionNode> node;
+        if (ast.kind(index) == Kind::AsyncFunction)
+        {
+            node = std::make_unique<AsyncFunctionNode>(text(index, 0), line);
+        }
+        else
+        {
+            node = std::make_unique<FunctionNode>(text(index, 0), line);
+        }
+        node->returnType = text(index, 1);
+        node->isAsync = operand != 0;
+        node->body = AstArena::share(build<BlockStatementNode>(child(index, 0)));
+        buildList(index, 1, node->parameters);
+        return node;
+    }
+    case Kind::Class:
+    {
+        auto node = std::make_unique<ClassNode>(text(index, 0), line);
+        node->baseClassName = text(index, 1);
+        buildList(index, 0, node->members);
+        return node;
+    }
+    case Kind::CaseClause:
+    {
+        NodeList<StatementNode> statements;
+        buildList(index, 1, statements);
+        if (operand)
+        {
+            return std::make_unique<CaseClauseNode>(std::move(statements), line);
+        }
+        return std::make_unique<CaseClauseNode>(build<ExpressionNode>(child(index, 0)), std::move(statements), line);
+    }
+    case Kind::Import:
+    {
+        auto node = std::make_unique<ImportNode>(line);
+        node->moduleName = text(index, 0);
+        node->defaultImportName = text(index, 1);
+        for (size_t i = 2; i + 1 < ast.textCount(index); i += 2)
+        {
+            node->namedImports.emplace_back(text(index, i), text(index, i + 1));
+        }
+        node->hasDefaultImport = operand & FlatAst::HasDefaultImport;
+        node->preserveExternalFunctions = operand & FlatAst::PreserveExternalFunctions;
+        return node;
+    }
+    case Kind::Export:
+    case Kind::ReExport:
+    {
+        std::unique_ptr<ExportNode> node;
+        if (ast.kind(index) == Kind::ReExport)
+        {
+            auto reExport = std::make_unique<ReExportNode>(line);
+            reExport->moduleName = text(index, 1);
+            for (size_t i = 2; i + 1 < ast.textCount(index); i += 2)
+            {
+                reExport->namedExports.emplace_back(text(index, i), text(index, i + 1));
+            }
+            reExport->exportAll = operand & FlatAst::ExportAll;
+            node = std::move(reExport);
+        }
+        else
+        {
+            node = std::make_unique<ExportNode>(line);
+        }
+        node->exportName = text(index, 0);
+        node->isDefault = operand & FlatAst::IsDefault;
+        node->exportItem = build(child(index, 0));
+        return node;
+    }
+    case Kind::Interface:
+    {
+        auto node = std::make_unique<InterfaceNode>(text(index, 0), line);
+        buildList(index, 0, node->members);
+        return node;
+    }
+    case Kind::ErrorType:
+        return std::make_unique<ErrorTypeNode>(text(index, 0), text(index, 1), text(index, 2), line);
+    case Kind::Constructor:
+    {
+        NodeList<FunctionParameterNode> parameters;
+        buildList(index, 1, parameters);
+        return std::make_unique<ConstructorNode>(std::move(parameters), build<BlockStatementNode>(child(index, 0)), line);
+    }
+    case Kind::VariableDeclaration:
+    {
+        auto node = std::make_unique<VariableDeclarationNode>(text(index, 0), line);
+        node->typeName = text(index, 1);
+        node->isConst = operand != 0;
+        node->initializer = build<ExpressionNode>(child(index, 0));
+        return node;
+    }
+    case Kind::ReturnStatement:
+    {
+        auto node = std::make_unique<ReturnStatementNode>(line);
+        node->expression = build<ExpressionNode>(child(index, 0));
+        return node;
+    }
+    case Kind::IfStatement:
+    {
+        auto node = std::make_unique<IfStatementNode>(line);
+        node->condition = build<ExpressionNode>(child(index, 0));
+        node->thenBranch = build(child(index, 1));
+        node->elseBranch = build<StatementNode>(child(index, 2));
+        return node;
+    }
+    case Kind::ForStatement:
+    {
+        auto node = std::make_unique<ForStatementNode>(line);
+        node->initializer = build<StatementNode>(child(index, 0));
+        node->condition = build<ExpressionNode>(child(index, 1));
+        node->increment = build<ExpressionNode>(child(index, 2));
+        node->body = build(child(index, 3));
+        return node;
+    }
+    case Kind::WhileStatement:
+    {
+        auto node = std::make_unique<WhileStatementNode>(line);
+        node->condition = build<ExpressionNode>(child(index, 0));
+        node->body = build(child(index, 1));
+        return node;
+    }
+    case Kind::BreakStatement:
+        return std::make_unique<BreakStatementNode>(line);
+    case Kind::ContinueStatement:
+        return std::make_unique<ContinueStatementNode>(line);
+    case Kind::SwitchStatement:
+    {
+        auto node = std::make_unique<SwitchStatementNode>(line);
+        node->condition = build<ExpressionNode>(child(index, 0));
+        buildList(index, 1, node->cases);
+        return node;
+    }
+    case Kind::BinaryExpression:
+    {
+        auto node = std::make_unique<BinaryExpressionNode>(text(index, 0), line);
+        node->left = build<ExpressionNode>(child(index, 0));
+        node->right = build<ExpressionNode>(child(index, 1));
+        return node;
+    }
+    case Kind::Literal:
+        return std::make_unique<LiteralNode>(text(index, 0), line);
+    case Kind::UnaryExpression:
+    {
+        auto node = std::make_unique<UnaryExpressionNode>(text(index, 0), line);
+        node->isPrefix = operand != 0;
+        node->operand = build<ExpressionNode>(child(index, 0));
+        return node;
+    }
+    case Kind::CallExpression:
+    {
+        auto node = std::make_unique<CallExpressionNode>(line);
+        node->callee = build<ExpressionNode>(child(index, 0));
+        buildList(index, 1, node->arguments);
+        return node;
+    }
+    case Kind::AssignmentExpression:
+    {
+        auto node = std::make_unique<AssignmentExpressionNode>(text(index, 0), line);
+        node->left = build<ExpressionNode>(child(index, 0));
+        node->right = build<ExpressionNode>(child(index, 1));
+        return node;
+    }
+    case Kind::MemberAccessExpression:
+    {
+        auto node = std::make_unique<MemberAccessExpressionNode>(line);
+        node->object = build<ExpressionNode>(child(index, 0));
+        node->memberName = text(index, 0);
+        return node;
+    }
+    case Kind::ConditionalExpression:
+    {
+        auto node = std::make_unique<ConditionalExpressionNode>(line);
+        node->condition = build<ExpressionNode>(child(index, 0));
+        node->trueExpr = build<ExpressionNode>(child(index, 1));
+        node->falseExpr = build<ExpressionNode>(child(index, 2));
+        return node;
+    }
+    case Kind::StringLiteral:
+        return std::make_unique<StringLiteralNode>(text(index, 0), line);
+    case Kind::NumberLiteral:
+        return std::make_unique<NumberLiteralNode>(text(index, 0), line);
+    case Kind::BooleanLiteral:
+        return std::make_unique<BooleanLiteralNode>(operand != 0, line);
+    case Kind::NullLiteral:
+        return std::make_unique<NullLiteralNode>(line);
+    case Kind::ArrayLiteral:
+    {
+        auto node = std::make_unique<ArrayLiteralNode>(line);
+        buildList(index, 0, node->elements);
+        return node;
+    }
+    case Kind::ObjectLiteral:
+    {
+        auto node = std::make_unique<ObjectLiteralNode>(line);
+        for (FlatAst::Index property : ast.children(index))
+        {
+            if (property == FlatAst::none || ast.kind(property) != Kind::Property)
+            {
+                throw std::runtime_error("Object literal without a property at line " + std::to_string(line));
+            }
+            node->properties.emplace_back(text(property, 0), build<ExpressionNode>(child(property, 0)));
+        }
+        return node;
+    }
+    case Kind::TemplateLiteral:
+    {
+        auto node = std::make_unique<TemplateLiteralNode>(line);
+        buildList(index, 0, node->parts);
+        return node;
+    }
+    case Kind::TryCatch:
+    {
+        auto node = std::make_unique<TryCatchNode>(line);
+        node->tryBlock = build<StatementNode>(child(index, 0));
+        node->catchVariable = build<ErrorTypeNode>(child(index, 1));
+        node->catchBlock = build<BlockStatementNode>(child(index, 2));
+        return node;
+    }
+    case Kind::EqualityExpression:
+        return binary<EqualityExpressionNode>(index, line);
+    case Kind::OrExpression:
+        return binary<OrExpressionNode>(index, line);
+    case Kind::AndExpression:
+        return binary<AndExpressionNode>(index, line);
+    case Kind::VariableExpression:
+        return std::make_unique<VariableExpressionNode>(text(index, 0), line);
+    case Kind::AwaitExpression:
+    {
+        auto node = std::make_unique<AwaitExpressionNode>(line);
+        node->expression = build<ExpressionNode>(child(index, 0));
+        return node;
+    }
+    case Kind::NullReference:
+        return std::make_unique<NullReferenceNode>(line);
+    case Kind::ConsoleLog:
+    {
+        auto node = std::make_unique<ConsoleLogNode>(line);
+        node->expression = build<ExpressionNode>(child(index, 0));
+        return node;
+    }
+    case Kind::InputStatement:
+    {
+        auto node = std::make_unique<InputStatementNode>(line);
+        node->variable = build<VariableDeclarationNode>(child(index, 0));
+        return node;
+    }
+    case Kind::ComparisonExpression:
+        return binary<ComparisonExpressionNode>(index, line);
+    case Kind::AdditionExpression:
+        return binary<AdditionExpressionNode>(index, line);
+    case Kind::SubtractionExpression:
+        return binary<SubtractionExpressionNode>(index, line);
+    case Kind::MultiplicationExpression:
+        return binary<MultiplicationExpressionNode>(index, line);
+    case Kind::DivisionExpression:
+        return binary<DivisionExpressionNode>(index, line);
+    case Kind::CharLiteral:
+        return std::make_unique<CharLiteralNode>(static_cast<char>(operand), line);
+    case Kind::PropertyDeclaration:
+        return std::make_unique<PropertyDeclarationNode>(text(index, 0), build<TypeNode>(child(index, 0)),
+                                                         build<ExpressionNode>(child(index, 1)), line);
+    case Kind::ExpressionStatement:
+        return std::make_unique<ExpressionStatementNode>(build<ExpressionNode>(child(index, 0)), line);
+    case Kind::IntegerLiteral:
+    {
+        auto node = std::make_unique<IntegerLiteralNode>("0", line);
+        node->value = static_cast<int>(operand);
+        return node;
+    }
+    case Kind::FloatingPointLiteral:
+    {
+        auto node = std::make_unique<FloatingPointLiteralNode>("0", line);
+        std::memcpy(&node->value, &operand, sizeof(operand));
+        return node;
+    }
+    case Kind::FunctionExpression:
+        return std::make_unique<FunctionExpressionNode>(build<FunctionNode>(child(index, 0)), line);
+    case Kind::Template:
+    {
+        std::vector<std::string> parameters;
+        for (size_t i = 0; i < ast.textCount(index); i++)
+        {
+            parameters.push_back(text(index, i));
+        }
+        return std::make_unique<TemplateNode>(std::move(parameters), build(child(index, 0)), line);
+    }
+    case Kind::Property:
+    case Kind::Count:
+        break;
+    }
+    throw std::runtime_error("Unexpected node kind " + std::to_string(static_cast<int>(ast.kind(index))) +
+                             " at line " + std::to_string(line));
+}
+
+std::unique_ptr<ProgramNode> FlatAst::toProgram() const
+{
+    if (size() == 0 || kind(0) != Kind::Program)
+    {
+        throw std::runtime_error("A flattened program starts with its ProgramNode");
+    }
+    // Allocated like Parser::parse does
+    auto program = std::make_unique<ProgramNode>(line(0));
+    program->arena = std::make_shared<AstArena>();
+    AstArena::Scope arenaScope(program->arena.get());
+    TreeBuilder builder(*this);
+    builder.buildList(0, 0, program->children);
+    return program;
+}
+
+size_t FlatAst::bytes() const
+{
+    return kindList.size() * sizeof(Kind) +
+           (lineList.size() + operandList.size() + childStart.size() + childList.size() + textStart.size() +
+            textList.size() + stringStart.size()) *
+               sizeof(uint32_t) +
+           chars.size();
+}
+
+static constexpr char fileMagic[8] = {'E', 'D', 'U', 'F', 'L', 'A', 'T', '1'};
+
+template <typename T>
+static void writeArray(std::ofstream &file, const T &array)
+{
+    uint64_t count = array.size();
+    file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    file.write(reinterpret_cast<const char *>(array.data()), count * sizeof(array[0]));
+}
+
+// Reads an array written by writeArray from the front of data
+template <typename T>
+static bool readArray(std::string_view &data, T &array)
+{
+    uint64_t count;
+    if (data.size() < sizeof(count))
+    {
+        return false;
+    }
+    std::memcpy(&count, data.data(), sizeof(count));
+    data.remove_prefix(sizeof(count));
+    if (count > data.size() / sizeof(array[0]))
+    {
+        return false;
+    }
+    array.resize(count);
+    std::memcpy(array.data(), data.data(), count * sizeof(array[0]));
+    data.remove_prefix(count * sizeof(array[0]));
+    return true;
+}
+
+bool FlatAst::save(const std::string &path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(fileMagic, sizeof(fileMagic));
+    writeArray(file, kindList);
+    writeArray(file, lineList);
+    writeArray(file, operandList);
+    writeArray(file, childStart);
+    writeArray(file, childList);
+    writeArray(file, textStart);
+    writeArray(file, textList);
+    writeArray(file, stringStart);
+    writeArray(file, chars);
+    return static_cast<bool>(file.flush());
+}
+
+std::optional<FlatAst> FlatAst::load(const std::string &path)
+{
+    std::optional<SourceBuffer> buffer = SourceBuffer::map(path);
+    if (!buffer)
+    {
+        return std::nullopt;
+    }
+    std::string_view data = buffer->text();
+    if (data.substr(0, sizeof(fileMagic)) != std::string_view(fileMagic, sizeof(fileMagic)))
+    {
+        return std::nullopt;
+    }
+    data.remove_prefix(sizeof(fileMagic));
+
+    FlatAst ast;
+    bool read = readArray(data, ast.kindList) && readArray(data, ast.lineList) && readArray(data, ast.operandList) &&
+                readArray(data, ast.childStart) && readArray(data, ast.childList) && readArray(data, ast.textStart) &&
+                readArray(data, ast.textList) && readArray(data, ast.stringStart) && readArray(data, ast.chars);
+    if (!read || !data.empty() || !ast.isWellFormed())
+    {
+        return std::nullopt;
+    }
+    return ast;
+}
+
+// Whether the accessors can be trusted not to read out of bounds, and every
+// child comes after its parent, so a walk down the tree ends
+bool FlatAst::isWellFormed() const
+{
+    size_t count = kindList.size();
+    if (lineList.size() != count || operandList.size() != count || childStart.size() != count + 1 ||
+        textStart.size() != count + 1 || stringStart.empty())
+    {
+        return false;
+    }
+    auto isRuns = [](const std::vector<uint32_t> &starts, size_t end) {
+        return starts.front() == 0 && starts.back() == end && std::is_sorted(starts.begin(), starts.end());
+    };
+    if (!isRuns(childStart, childList.size()) || !isRuns(textStart, textList.size()) ||
+        !isRuns(stringStart, chars.size()))
+    {
+        return false;
+    }
+    for (size_t node = 0; node < count; node++)
+    {
+        if (kindList[node] >= Kind::Count)
+        {
+            return false;
+        }
+        for (Index child : children(static_cast<Index>(node)))
+        {
+            if (child != none && (child <= node || child >= count))
+            {
+                return false;
+            }
+        }
+    }
+    for (uint32_t id : textList)
+    {
+        if (id >= stringCount())
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "nodes.h"
+
+// A program's tree stored as parallel arrays instead of linked nodes. Node i
+// has a kind, a line, a 32 bit operand, a run of child indices and a run of
+// string ids; the strings are interned, each stored once. Nodes are numbered
+// in preorder with the program as node 0, so a pass that doesn't care about
+// structure is a loop over kinds(), and one that does follows children().
+// There are no pointers in it, so it is saved to disk as it is.
+//
+// Children come in a fixed order per kind, a missing one being none, with any
+// list of them last. Strings likewise, lists last, and pairs as two strings:
+//
+//   Kind                  children                          strings                     operand
+//   Program               declarations...
+//   Type                                                    typeName
+//   FunctionParameter     type                              name
+//   BlockStatement        statements...
+//   Function              body, parameters...               name, returnType            isAsync
+//   AsyncFunction         (as Function)
+//   Class                 members...                        name, baseClassName
+//   CaseClause            caseExpression, statements...                                 isDefault
+//   Import                                                  moduleName, defaultImportName,
+//                                                           (original, local)...        Import flags
+//   Export                exportItem                        exportName                  Export flags
+//   ReExport              exportItem                        exportName, moduleName,
+//                                                           (original, exported)...     Export flags
+//   Interface             members...                        name
+//   ErrorType                                               varName, message, errorCode
+//   Constructor           body, parameters...
+//   VariableDeclaration   initializer                       name, typeName              isConst
+//   ReturnStatement       expression
+//   IfStatement           condition, thenBranch, elseBranch
+//   ForStatement          initializer, condition, increment, body
+//   WhileStatement        condition, body
+//   SwitchStatement       condition, cases...
+//   UnaryExpression       operand                           op                          isPrefix
+//   CallExpression        callee, arguments...
+//   MemberAccess          object                            memberName
+//   Conditional           condition, trueExpr, falseExpr
+//   ArrayLiteral          elements...
+//   ObjectLiteral         properties...
+//   Property              value                             key
+//   TemplateLiteral       parts...
+//   TryCatch              tryBlock, catchVariable, catchBlock
+//   Binary, Assignment and the other two operand expressions:
+//                         left, right                       op
+//   Literal, StringLiteral, NumberLiteral                   value
+//   VariableExpression                                      name
+//   Await, ConsoleLog, ExpressionStatement: expression; InputStatement: variable
+//   PropertyDeclaration   type, initializer                 name
+//   FunctionExpression    function
+//   Template              declaration                       parameters...
+//   BooleanLiteral, CharLiteral, IntegerLiteral, FloatingPointLiteral: the value
+//   as the operand, a float by its bits
+//
+// Only what the parser produces is kept; the Resolver's slots and the inline
+// caches are filled in again on the tree made by toProgram().
+class FlatAst
+{
+public:
+  using Index = uint32_t;
+  static constexpr Index none = UINT32_MAX;
+
+  enum class Kind : uint8_t
+  {
+    Program,
+    Type,
+    FunctionParameter,
+    BlockStatement,
+    Function,
+    AsyncFunction,
+    Class,
+    CaseClause,
+    Import,
+    Export,
+    ReExport,
+    Interface,
+    ErrorType,
+    Constructor,
+    VariableDeclaration,
+    ReturnStatement,
+    IfStatement,
+    ForStatement,
+    WhileStatement,
+    BreakStatement,
+    ContinueStatement,
+    SwitchStatement,
+    BinaryExpression,
+    Literal,
+    UnaryExpression,
+    CallExpression,
+    AssignmentExpression,
+    MemberAccessExpression,
+    ConditionalExpression,
+    StringLiteral,
+    NumberLiteral,
+    BooleanLiteral,
+    NullLiteral,
+    ArrayLiteral,
+    ObjectLiteral,
+    Property, // One key of an ObjectLiteral, which has no node of its own in the tree
+    TemplateLiteral,
+    TryCatch,
+    EqualityExpression,
+    OrExpression,
+    AndExpression,
+    VariableExpression,
+    AwaitExpression,
+    NullReference,
+    ConsoleLog,
+    InputStatement,
+    ComparisonExpression,
+    AdditionExpression,
+    SubtractionExpression,
+    MultiplicationExpression,
+    DivisionExpression,
+    CharLiteral,
+    PropertyDeclaration,
+    ExpressionStatement,
+    IntegerLiteral,
+    FloatingPointLiteral,
+    FunctionExpression,
+    Template,
+    Count
+  };
+
+  // Operand bits of Import and of Export and ReExport nodes
+  static constexpr uint32_t HasDefaultImport = 1 << 0;
+  static constexpr uint32_t PreserveExternalFunctions = 1 << 1;
+  static constexpr uint32_t IsDefault = 1 << 0;
+  static constexpr uint32_t ExportAll = 1 << 1;
+
+  // Throws std::runtime_error for a node type it doesn't know
+  static FlatAst flatten(const ProgramNode &program);
+  // A tree equal to the flattened one, with its own arena
+  std::unique_ptr<ProgramNode> toProgram() const;
+
+  // Writes the arrays as they are, in this machine's byte order
+  bool save(const std::string &path) const;
+  // Nothing when the file can't be read or isn't a well formed FlatAst
+  static std::optional<FlatAst> load(const std::string &path);
+
+  size_t size() const { return kindList.size(); }
+  // Bytes of all the arrays together
+  size_t bytes() const;
+
+  std::span<const Kind> kinds() const { return kindList; }
+  Kind kind(Index node) const { return kindList[node]; }
+  int line(Index node) const { return static_cast<int>(lineList[node]); }
+  uint32_t operand(Index node) const { return operandList[node]; }
+
+  std::span<const Index> children(Index node) const
+  {
+    return {childList.data() + childStart[node], childStart[node + 1] - childStart[node]};
+  }
+  Index child(Index node, size_t i) const { return childList[childStart[node] + i]; }
+
+  size_t textCount(Index node) const { return textStart[node + 1] - textStart[node]; }
+  std::string_view text(Index node, size_t i) const { return string(textList[textStart[node] + i]); }
+
+  size_t stringCount() const { return stringStart.size() - 1; }
+  std::string_view string(uint32_t id) const
+  {
+    return std::string_view(chars).substr(stringStart[id], stringStart[id + 1] - stringStart[id]);
+  }
+
+  bool operator==(const FlatAst &other) const = default;
+
+private:
+  class Builder;
+  class TreeBuilder;
+
+  std::vector<Kind> kindList;
+  std::vector<uint32_t> lineList;
+  std::vector<uint32_t> operandList;
+  std::vector<uint32_t> childStart{0}; // Node i's children are childList[childStart[i], childStart[i + 1])
+  std::vector<Index> childList;
+  std::vector<uint32_t> textStart{0}; // Likewise for the ids of its strings
+  std::vector<uint32_t> textList;
+  std::vector<uint32_t> stringStart{0}; // String id's characters are chars[stringStart[id], stringStart[id + 1])
+  std::string chars;
+
+  bool isWellFormed() const;
+};
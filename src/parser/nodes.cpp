@@ -1,8 +1,30 @@
 #include "nodes.h"
 
-// Since nodes.h is primarily a header with class definitions and we're not
-// changing functionality, this file is mostly empty. Most of the class methods
-// are inline in the header. This file is created to ensure proper separation
-// of declaration and implementation.
+// A node is made right after its memory is allocated, so the arena that is
+// current in the constructor is the one the node came from. Nodes hold nothing
+// more aligned than a pointer or a double
 
-// Any additional implementations of node methods can be added here if needed.
\ No newline at end of file
+void *ASTNode::operator new(size_t size)
+{
+    AstArena *arena = AstArena::current();
+    return arena ? arena->allocate(size, alignof(void *)) : ::operator new(size);
+}
+
+void ASTNode::operator delete(ASTNode *node, std::destroying_delete_t)
+{
+    bool inArena = node->inArena;
+    // The destructor is virtual, so this destroys the whole node
+    node->~ASTNode();
+    if (!inArena)
+    {
+        ::operator delete(node);
+    }
+}
+
+void ASTNode::operator delete(void *memory)
+{
+    if (!AstArena::current())
+    {
+        ::operator delete(memory);
+    }
+}
@@ -1,40 +1,145 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
+#include "arena.h"
+
+// The class of a node, set when it is made, so code that handles the kinds
+// differently can switch on it instead of trying one dynamic_cast after
+// another. Statement and expression kinds are kept together, so "is it an
+// expression" is a range check
+enum class NodeKind : uint8_t
+{
+  Program,
+  Type,
+  FunctionParameter,
+  Function,
+  AsyncFunction,
+  Class,
+  CaseClause,
+  Import,
+  Export,
+  ReExport,
+  Interface,
+  ErrorType,
+  Constructor,
+  Template,
+
+  // StatementNode
+  BlockStatement,
+  VariableDeclaration,
+  ReturnStatement,
+  IfStatement,
+  ForStatement,
+  WhileStatement,
+  BreakStatement,
+  ContinueStatement,
+  SwitchStatement,
+  TryCatch,
+  ConsoleLog,
+  InputStatement,
+  PropertyDeclaration,
+  ExpressionStatement,
+
+  // ExpressionNode
+  BinaryExpression,
+  Literal,
+  UnaryExpression,
+  CallExpression,
+  AssignmentExpression,
+  MemberAccessExpression,
+  ConditionalExpression,
+  StringLiteral,
+  NumberLiteral,
+  BooleanLiteral,
+  NullLiteral,
+  ArrayLiteral,
+  ObjectLiteral,
+  TemplateLiteral,
+  EqualityExpression,
+  OrExpression,
+  AndExpression,
+  VariableExpression,
+  AwaitExpression,
+  NullReference,
+  ComparisonExpression,
+  AdditionExpression,
+  SubtractionExpression,
+  MultiplicationExpression,
+  DivisionExpression,
+  CharLiteral,
+  IntegerLiteral,
+  FloatingPointLiteral,
+  FunctionExpression,
+
+  FirstStatement = BlockStatement,
+  LastStatement = ExpressionStatement,
+  FirstExpression = BinaryExpression,
+  LastExpression = FunctionExpression
+};
 
 class ASTNode
 {
 public:
-  ASTNode(int line) : line(line) {}
+  ASTNode(NodeKind kind, int line) : line(line), inArena(AstArena::current() != nullptr), nodeKind(kind) { createdCount++; }
   virtual ~ASTNode() = default;
 
+  NodeKind kind() const { return nodeKind; }
+  static bool hasKind(NodeKind) { return true; }
+
+  // Nodes come from the current AstArena when there is one, and from the heap
+  // otherwise. Deleting a node from an arena only runs its destructor
+  static void *operator new(size_t size);
+  static void operator delete(ASTNode *node, std::destroying_delete_t);
+  // Frees the memory of a node whose constructor threw
+  static void operator delete(void *memory);
+
   int getLine() const { return line; }
 
+  // Number of nodes created so far, e.g. for parser throughput in nodes/s
+  static size_t created() { return createdCount; }
+
 private:
   int line; // Line number in the source code
+  bool inArena; // Allocated from an arena, so deleting it frees nothing
+  NodeKind nodeKind;
+  static inline size_t createdCount = 0;
 };
 
 class ProgramNode : public ASTNode
 {
 public:
-  ProgramNode(int line) : ASTNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::Program; }
+
+  ProgramNode(int line) : ASTNode(NodeKind::Program, line) {}
 
-  std::vector<std::unique_ptr<ASTNode>> children;
+  // Declared first, so it is released after the nodes it holds
+  std::shared_ptr<AstArena> arena;
+  NodeList<ASTNode> children;
 };
 
 class StatementNode : public ASTNode
 {
 public:
-  StatementNode(int line) : ASTNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind >= NodeKind::FirstStatement && kind <= NodeKind::LastStatement; }
+
+  StatementNode(NodeKind kind, int line) : ASTNode(kind, line) {}
 };
 class TypeNode : public ASTNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::Type; }
+
   TypeNode(const std::string &typeName, int line)
-      : ASTNode(line), typeName(typeName) {}
+      : ASTNode(NodeKind::Type, line), typeName(typeName) {}
 
   std::string typeName;
 };
@@ -42,8 +147,10 @@ public:
 class FunctionParameterNode : public ASTNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::FunctionParameter; }
+
   FunctionParameterNode(const std::string &name, int line)
-      : ASTNode(line), name(name) {}
+      : ASTNode(NodeKind::FunctionParameter, line), name(name) {}
 
   std::string name;
   std::unique_ptr<TypeNode> type; // If your language supports type annotations
@@ -52,15 +159,23 @@ public:
 class BlockStatementNode : public StatementNode
 {
 public:
-  BlockStatementNode(int line) : StatementNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::BlockStatement; }
+
+  BlockStatementNode(int line) : StatementNode(NodeKind::BlockStatement, line) {}
 
-  std::vector<std::unique_ptr<StatementNode>> statements;
+  NodeList<StatementNode> statements;
+
+  // Filled in by the Resolver
+  bool needsScope = true; // False when nothing is declared directly in the block
+  int slotCount = -1;     // Variable slots of the block's scope, -1 if unresolved
 };
 
 class FunctionNode : public ASTNode
 {
 public:
-  FunctionNode(const std::string &name, int line) : ASTNode(line), name(name), isAsync(false) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::Function || kind == NodeKind::AsyncFunction; }
+
+  FunctionNode(const std::string &name, int line) : FunctionNode(NodeKind::Function, name, line) {}
 
   // Clone this function with its full definition (for imports)
   std::shared_ptr<FunctionNode> clone() const
@@ -68,6 +183,7 @@ public:
     auto newFunc = std::make_shared<FunctionNode>(name, getLine());
     newFunc->returnType = returnType;
     newFunc->isAsync = isAsync;
+    newFunc->thisSlot = thisSlot;
 
     // Use shared_ptr for body to allow sharing between original and imported functions
     newFunc->body = body;
@@ -87,53 +203,67 @@ public:
   }
 
   std::string name;
-  std::vector<std::unique_ptr<FunctionParameterNode>> parameters;
+  NodeList<FunctionParameterNode> parameters;
   std::string returnType;
   bool isAsync;
   std::shared_ptr<BlockStatementNode> body; // Changed from unique_ptr to shared_ptr
+
+  // Slot of `this` in a method's function scope, set by the Resolver
+  int thisSlot = -1;
+
+protected:
+  FunctionNode(NodeKind kind, const std::string &name, int line) : ASTNode(kind, line), name(name), isAsync(false) {}
 };
 
 class ExpressionNode : public ASTNode
 {
 public:
-  ExpressionNode(int line) : ASTNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind >= NodeKind::FirstExpression && kind <= NodeKind::LastExpression; }
+
+  ExpressionNode(NodeKind kind, int line) : ASTNode(kind, line) {}
 };
 
 class ClassNode : public ASTNode
 {
 public:
-  ClassNode(const std::string &name, int line) : ASTNode(line), name(name), baseClassName("") {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::Class; }
+
+  ClassNode(const std::string &name, int line) : ASTNode(NodeKind::Class, line), name(name), baseClassName("") {}
 
   std::string name;
   std::string baseClassName; // Name of the parent class (if any)
-  std::vector<std::unique_ptr<ASTNode>> members;
+  NodeList<ASTNode> members;
 };
 
 class CaseClauseNode : public ASTNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::CaseClause; }
+
   // Constructor for a case clause with an expression
   CaseClauseNode(std::unique_ptr<ExpressionNode> caseExpression,
-                 std::vector<std::unique_ptr<StatementNode>> statements,
+                 NodeList<StatementNode> statements,
                  int line)
-      : ASTNode(line), caseExpression(std::move(caseExpression)),
+      : ASTNode(NodeKind::CaseClause, line), caseExpression(std::move(caseExpression)),
         statements(std::move(statements)), isDefault(false) {}
 
   // Constructor for a default case clause
-  CaseClauseNode(std::vector<std::unique_ptr<StatementNode>> statements,
+  CaseClauseNode(NodeList<StatementNode> statements,
                  int line)
-      : ASTNode(line), caseExpression(nullptr),
+      : ASTNode(NodeKind::CaseClause, line), caseExpression(nullptr),
         statements(std::move(statements)), isDefault(true) {}
 
   std::unique_ptr<ExpressionNode> caseExpression;
-  std::vector<std::unique_ptr<StatementNode>> statements;
+  NodeList<StatementNode> statements;
   bool isDefault;
 };
 
 class ImportNode : public ASTNode
 {
 public:
-  ImportNode(int line) : ASTNode(line), hasDefaultImport(false), preserveExternalFunctions(true) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::Import; }
+
+  ImportNode(int line) : ASTNode(NodeKind::Import, line), hasDefaultImport(false), preserveExternalFunctions(true) {}
 
   std::string moduleName;
   bool hasDefaultImport;
@@ -147,41 +277,52 @@ public:
 class ExportNode : public ASTNode
 {
 public:
-  ExportNode(int line) : ASTNode(line), isDefault(false) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::Export || kind == NodeKind::ReExport; }
+
+  ExportNode(int line) : ExportNode(NodeKind::Export, line) {}
 
   std::unique_ptr<ASTNode> exportItem;
   bool isDefault;
   std::string exportName; // Used for named exports
+
+protected:
+  ExportNode(NodeKind kind, int line) : ASTNode(kind, line), isDefault(false) {}
 };
 
 // For handling re-exports
 class ReExportNode : public ExportNode
 {
 public:
-  ReExportNode(int line) : ExportNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::ReExport; }
+
+  ReExportNode(int line) : ExportNode(NodeKind::ReExport, line) {}
 
   std::string moduleName;
   std::vector<std::pair<std::string, std::string>> namedExports; // Pairs of (originalName, exportName)
-  bool exportAll;                                                // For "export * from './module'"
+  bool exportAll = false; // For "export * from './module'"
 };
 
 class InterfaceNode : public ASTNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::Interface; }
+
   InterfaceNode(const std::string &name, int line)
-      : ASTNode(line), name(name) {}
+      : ASTNode(NodeKind::Interface, line), name(name) {}
 
   std::string name;
-  std::vector<std::unique_ptr<ASTNode>> members;
+  NodeList<ASTNode> members;
 };
 
 class ErrorTypeNode : public ASTNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::ErrorType; }
+
   // Constructor: takes the variable name, message, error code, and line number.
   ErrorTypeNode(const std::string &varName, const std::string &message,
                 const std::string &errorCode, int line)
-      : ASTNode(line), varName(varName), message(message),
+      : ASTNode(NodeKind::ErrorType, line), varName(varName), message(message),
         errorCode(errorCode) {}
 
   // Accept method for the visitor pattern.
@@ -194,60 +335,111 @@ public:
 class ConstructorNode : public ASTNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::Constructor; }
+
   ConstructorNode(
-      std::vector<std::unique_ptr<FunctionParameterNode>> parameters,
+      NodeList<FunctionParameterNode> parameters,
       std::unique_ptr<BlockStatementNode> body, int line)
-      : ASTNode(line), parameters(std::move(parameters)),
+      : ASTNode(NodeKind::Constructor, line), parameters(std::move(parameters)),
         body(std::move(body)) {}
 
-  std::vector<std::unique_ptr<FunctionParameterNode>> parameters;
+  NodeList<FunctionParameterNode> parameters;
   std::unique_ptr<BlockStatementNode> body;
 };
 
 class VariableDeclarationNode : public StatementNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::VariableDeclaration; }
+
   VariableDeclarationNode(const std::string &name, int line)
-      : StatementNode(line), name(name) {}
+      : StatementNode(NodeKind::VariableDeclaration, line), name(name) {}
   std::string name;
   std::unique_ptr<ExpressionNode> initializer;
   std::string typeName;
-  bool isConst;
+  bool isConst = false;
+  int slot = -1; // Slot in the current scope set by the Resolver, -1 to define by name
 };
 
 class ReturnStatementNode : public StatementNode
 {
 public:
-  ReturnStatementNode(int line) : StatementNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::ReturnStatement; }
+
+  ReturnStatementNode(int line) : StatementNode(NodeKind::ReturnStatement, line) {}
 
   std::unique_ptr<ExpressionNode> expression;
+
+  // Set by the Resolver when the expression is a call of a named function in
+  // a function body. The call then runs in place of the returning function's
+  // frame instead of on top of it
+  bool tailCall = false;
 };
 
 class IfStatementNode : public StatementNode
 {
 public:
-  IfStatementNode(int line) : StatementNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::IfStatement; }
+
+  IfStatementNode(int line) : StatementNode(NodeKind::IfStatement, line) {}
 
   std::unique_ptr<ExpressionNode> condition;
   std::unique_ptr<ASTNode> thenBranch;
   std::unique_ptr<StatementNode> elseBranch;
 };
 
+// A for loop of the canonical counted shape, found by the Resolver:
+// `for (int i = start; i < bound; i++)`. The test compares the variable the
+// loop declares against a bound without side effects, with <, <=, >, >= or
+// !=, and the step is ++, --, += k, -= k or i = i + k for an int literal k.
+// The interpreter keeps i in a native int while it and the bound are ints and
+// stores it to i's slot for the body to read. A body that assigns to i, or a
+// bound that isn't an int, deoptimises the loop to evaluating its condition
+// and increment nodes for the rest of the run; after maxDeopts it stays so.
+struct CountedLoop
+{
+  static constexpr uint8_t maxDeopts = 4;
+
+  enum class Test : uint8_t
+  {
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    NotEqual
+  };
+
+  int slot = -1;                   // Of i, in the loop's scope
+  Test test = Test::Less;
+  ExpressionNode *bound = nullptr; // The test's right operand
+  int step = 1;
+  uint8_t deopts = 0;
+};
+
 class ForStatementNode : public StatementNode
 {
 public:
-  ForStatementNode(int line) : StatementNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::ForStatement; }
+
+  ForStatementNode(int line) : StatementNode(NodeKind::ForStatement, line) {}
 
   std::unique_ptr<StatementNode> initializer;
   std::unique_ptr<ExpressionNode> condition;
   std::unique_ptr<ExpressionNode> increment;
   std::unique_ptr<ASTNode> body;
+
+  // Filled in by the Resolver
+  bool needsScope = true; // False when the loop declares nothing of its own
+  int slotCount = -1;
+  std::unique_ptr<CountedLoop> counted; // Set if the loop has the counted shape
 };
 
 class WhileStatementNode : public StatementNode
 {
 public:
-  WhileStatementNode(int line) : StatementNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::WhileStatement; }
+
+  WhileStatementNode(int line) : StatementNode(NodeKind::WhileStatement, line) {}
 
   std::unique_ptr<ExpressionNode> condition;
   std::unique_ptr<ASTNode> body;
@@ -256,39 +448,144 @@ public:
 class BreakStatementNode : public StatementNode
 {
 public:
-  BreakStatementNode(int line) : StatementNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::BreakStatement; }
+
+  BreakStatementNode(int line) : StatementNode(NodeKind::BreakStatement, line) {}
 };
 
 class ContinueStatementNode : public StatementNode
 {
 public:
-  ContinueStatementNode(int line) : StatementNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::ContinueStatement; }
+
+  ContinueStatementNode(int line) : StatementNode(NodeKind::ContinueStatement, line) {}
+};
+
+// Dispatch of a switch whose cases are all int literals or all string
+// literals, built once by the Resolver. It maps a switch value to the clause
+// the scan through the cases would start running at: the first case with that
+// value or the first default, whichever comes first. Dense int cases index a
+// jump table, sparse ones are binary searched and strings are hashed.
+struct SwitchTable
+{
+  enum class Kind : uint8_t
+  {
+    Dense,
+    Sparse,
+    String
+  };
+
+  Kind kind = Kind::Dense;
+  int otherwise = 0; // Clause for values no case has: the first default, or cases.size()
+
+  int low = 0;                                       // Dense: jump[value - low] is value's clause
+  std::vector<int> jump;
+  std::vector<std::pair<int, int>> sorted;           // Sparse: (value, clause), by value
+  std::unordered_map<std::string_view, int> strings; // String: views of the case literals
+
+  int find(int value) const
+  {
+    if (kind == Kind::Dense)
+    {
+      int64_t index = static_cast<int64_t>(value) - low;
+      return index >= 0 && index < static_cast<int64_t>(jump.size()) ? jump[index] : otherwise;
+    }
+    if (kind == Kind::Sparse)
+    {
+      auto it = std::lower_bound(sorted.begin(), sorted.end(), std::make_pair(value, 0),
+                                 [](const auto &a, const auto &b) { return a.first < b.first; });
+      return it != sorted.end() && it->first == value ? it->second : otherwise;
+    }
+    return otherwise;
+  }
+
+  int find(std::string_view value) const
+  {
+    auto it = strings.find(value);
+    return it != strings.end() ? it->second : otherwise;
+  }
 };
 
 class SwitchStatementNode : public StatementNode
 {
 public:
-  SwitchStatementNode(int line) : StatementNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::SwitchStatement; }
+
+  SwitchStatementNode(int line) : StatementNode(NodeKind::SwitchStatement, line) {}
 
   std::unique_ptr<ExpressionNode> condition;
-  std::vector<std::unique_ptr<CaseClauseNode>> cases;
+  NodeList<CaseClauseNode> cases;
+  std::unique_ptr<SwitchTable> table; // Set by the Resolver if the cases are all literals
+};
+
+// Type feedback of an operator or field access site, filled in by the
+// interpreter. Once a site has seen the same operand types, or objects of the
+// same shape, warmup times in a row it is quickened: the interpreter checks
+// for just those and runs the operation on them directly, without decoding
+// the operator or dispatching on the operands' types. A failed check
+// deoptimises the site back to the generic path, where it starts watching
+// again; after maxDeopts failures it stays generic.
+struct Quickening
+{
+  static constexpr uint8_t warmup = 2;
+  static constexpr uint8_t maxDeopts = 4;
+
+  enum class Form : uint8_t
+  {
+    Unknown, // Still watching
+    Int,     // Both operands, or the incremented variable, are ints
+    Float,   // Both operands are floats
+    Field,   // The object has shape, the field is at slot
+    Generic
+  };
+
+  enum class Op : uint8_t
+  {
+    None,
+    Add,
+    Subtract,
+    Multiply,
+    Divide,
+    Modulo,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Equal,
+    NotEqual,
+    Increment,
+    Decrement
+  };
+
+  Form form = Form::Unknown;
+  Form seen = Form::Unknown; // What the last evaluations had, while Unknown
+  Op op = Op::None;          // The operator, decoded while Unknown
+  uint8_t runs = 0;          // Evaluations in a row that had seen
+  uint8_t deopts = 0;
+  int slot = -1;
+  const void *shape = nullptr; // Kept alive by the site's InlineCache entry for it
 };
 
 class BinaryExpressionNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::BinaryExpression; }
+
   BinaryExpressionNode(const std::string &op, int line)
-      : ExpressionNode(line), op(op) {}
+      : ExpressionNode(NodeKind::BinaryExpression, line), op(op) {}
   std::unique_ptr<ExpressionNode> left;
   std::unique_ptr<ExpressionNode> right;
   std::string op; // Operator
+  Quickening quickening;
 };
 
 class LiteralNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::Literal; }
+
   LiteralNode(const std::string &value, int line)
-      : ExpressionNode(line), value(value) {}
+      : ExpressionNode(NodeKind::Literal, line), value(value) {}
 
   std::string value;
 };
@@ -296,47 +593,115 @@ public:
 class UnaryExpressionNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::UnaryExpression; }
+
   UnaryExpressionNode(const std::string &op, int line)
-      : ExpressionNode(line), op(op), isPrefix(true) {}
+      : ExpressionNode(NodeKind::UnaryExpression, line), op(op), isPrefix(true) {}
 
   std::string op; // Operator, e.g., "-", "!", "++", "--"
   std::unique_ptr<ExpressionNode> operand;
   bool isPrefix; // true for prefix operators (++x), false for postfix (x++)
+  Quickening quickening; // Of ++ and -- on a variable
+};
+
+// Inline cache of one member access or method call site, filled in by the
+// interpreter. Entries are keyed by the receiver's class or shape and hold
+// what the lookup found for it; the parser treats keys and targets as opaque.
+// After maxEntries different receivers the site is megamorphic and stops
+// caching.
+struct InlineCache
+{
+  static constexpr int maxEntries = 4;
+
+  struct Entry
+  {
+    const void *key = nullptr;
+    std::shared_ptr<void> owner;  // Keeps the key alive so its address can't be reused
+    std::shared_ptr<void> target; // Method found for the key, if any
+    int slot = -1;                // Field slot found for the key, if any
+  };
+
+  Entry entries[maxEntries];
+  int size = 0;
+  bool megamorphic = false;
+
+  // Per site counters, see Interpreter::printInlineCacheStats
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+
+  const Entry *find(const void *key) const
+  {
+    for (int i = 0; i < size; i++)
+    {
+      if (entries[i].key == key)
+        return &entries[i];
+    }
+    return nullptr;
+  }
+
+  const Entry *add(Entry entry)
+  {
+    if (size == maxEntries)
+    {
+      megamorphic = true;
+      return nullptr;
+    }
+    entries[size] = std::move(entry);
+    return &entries[size++];
+  }
 };
 
 class CallExpressionNode : public ExpressionNode
 {
 public:
-  CallExpressionNode(int line) : ExpressionNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::CallExpression; }
+
+  CallExpressionNode(int line) : ExpressionNode(NodeKind::CallExpression, line) {}
 
   std::unique_ptr<ExpressionNode> callee;
-  std::vector<std::unique_ptr<ExpressionNode>> arguments;
+  NodeList<ExpressionNode> arguments;
+
+  InlineCache cache; // Method lookup when the callee is object.method
 };
 
 class AssignmentExpressionNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::AssignmentExpression; }
+
   AssignmentExpressionNode(const std::string &op, int line)
-      : ExpressionNode(line), op(op) {}
+      : ExpressionNode(NodeKind::AssignmentExpression, line), op(op) {}
 
   std::unique_ptr<ExpressionNode> left;
   std::string op; // Operator, e.g., "=", "+=", etc.
   std::unique_ptr<ExpressionNode> right;
+
+  // Scope distance and slot of the assigned variable, -1 to assign by name.
+  // Like the target's, they locate `this` if the target has a fieldCache
+  int depth = -1;
+  int slot = -1;
 };
 
 class MemberAccessExpressionNode : public ExpressionNode
 {
 public:
-  MemberAccessExpressionNode(int line) : ExpressionNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::MemberAccessExpression; }
+
+  MemberAccessExpressionNode(int line) : ExpressionNode(NodeKind::MemberAccessExpression, line) {}
 
   std::unique_ptr<ExpressionNode> object;
   std::string memberName;
+
+  InlineCache cache; // Field or method lookup, keyed by the object's shape
+  Quickening quickening; // Of a field read
 };
 
 class ConditionalExpressionNode : public ExpressionNode
 {
 public:
-  ConditionalExpressionNode(int line) : ExpressionNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::ConditionalExpression; }
+
+  ConditionalExpressionNode(int line) : ExpressionNode(NodeKind::ConditionalExpression, line) {}
 
   std::unique_ptr<ExpressionNode> condition;
   std::unique_ptr<ExpressionNode> trueExpr;
@@ -346,8 +711,10 @@ public:
 class StringLiteralNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::StringLiteral; }
+
   StringLiteralNode(const std::string &value, int line)
-      : ExpressionNode(line), value(value) {}
+      : ExpressionNode(NodeKind::StringLiteral, line), value(value) {}
 
   std::string value;
 };
@@ -355,8 +722,10 @@ public:
 class NumberLiteralNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::NumberLiteral; }
+
   NumberLiteralNode(const std::string &value, int line)
-      : ExpressionNode(line), value(value) {}
+      : ExpressionNode(NodeKind::NumberLiteral, line), value(value) {}
 
   std::string value; // Representing the numeric value as a string
 };
@@ -364,8 +733,10 @@ public:
 class BooleanLiteralNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::BooleanLiteral; }
+
   BooleanLiteralNode(bool value, int line)
-      : ExpressionNode(line), value(value) {}
+      : ExpressionNode(NodeKind::BooleanLiteral, line), value(value) {}
 
   bool value;
 };
@@ -373,21 +744,27 @@ public:
 class NullLiteralNode : public ExpressionNode
 {
 public:
-  NullLiteralNode(int line) : ExpressionNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::NullLiteral; }
+
+  NullLiteralNode(int line) : ExpressionNode(NodeKind::NullLiteral, line) {}
 };
 
 class ArrayLiteralNode : public ExpressionNode
 {
 public:
-  ArrayLiteralNode(int line) : ExpressionNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::ArrayLiteral; }
+
+  ArrayLiteralNode(int line) : ExpressionNode(NodeKind::ArrayLiteral, line) {}
 
-  std::vector<std::unique_ptr<ExpressionNode>> elements;
+  NodeList<ExpressionNode> elements;
 };
 
 class ObjectLiteralNode : public ExpressionNode
 {
 public:
-  ObjectLiteralNode(int line) : ExpressionNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::ObjectLiteral; }
+
+  ObjectLiteralNode(int line) : ExpressionNode(NodeKind::ObjectLiteral, line) {}
 
   std::vector<std::pair<std::string, std::unique_ptr<ExpressionNode>>>
       properties;
@@ -396,16 +773,19 @@ public:
 class TemplateLiteralNode : public ExpressionNode
 {
 public:
-  TemplateLiteralNode(int line) : ExpressionNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::TemplateLiteral; }
+
+  TemplateLiteralNode(int line) : ExpressionNode(NodeKind::TemplateLiteral, line) {}
 
-  std::vector<std::unique_ptr<ExpressionNode>>
-      parts; // Could be string literals and expressions
+  NodeList<ExpressionNode> parts; // Could be string literals and expressions
 };
 
 class TryCatchNode : public StatementNode
 {
 public:
-  TryCatchNode(int line) : StatementNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::TryCatch; }
+
+  TryCatchNode(int line) : StatementNode(NodeKind::TryCatch, line) {}
 
   std::unique_ptr<StatementNode> tryBlock;
   std::unique_ptr<ErrorTypeNode> catchVariable;
@@ -415,25 +795,31 @@ public:
 class EqualityExpressionNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::EqualityExpression; }
+
   EqualityExpressionNode(std::unique_ptr<ExpressionNode> left,
                          const std::string &op,
                          std::unique_ptr<ExpressionNode> right, int line)
-      : ExpressionNode(line), left(std::move(left)), op(op),
+      : ExpressionNode(NodeKind::EqualityExpression, line), left(std::move(left)), op(op),
         right(std::move(right)) {}
 
   std::unique_ptr<ExpressionNode> left;
   std::string op; // Operator, e.g., "==" or "!="
   std::unique_ptr<ExpressionNode> right;
 
+  Quickening quickening;
+
 private:
 };
 
 class OrExpressionNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::OrExpression; }
+
   OrExpressionNode(std::unique_ptr<ExpressionNode> left, const std::string &op,
                    std::unique_ptr<ExpressionNode> right, int line)
-      : ExpressionNode(line), left(std::move(left)), op(op),
+      : ExpressionNode(NodeKind::OrExpression, line), left(std::move(left)), op(op),
         right(std::move(right)) {}
 
   std::unique_ptr<ExpressionNode> left;
@@ -444,9 +830,11 @@ public:
 class AndExpressionNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::AndExpression; }
+
   AndExpressionNode(std::unique_ptr<ExpressionNode> left, const std::string &op,
                     std::unique_ptr<ExpressionNode> right, int line)
-      : ExpressionNode(line), left(std::move(left)), op(op),
+      : ExpressionNode(NodeKind::AndExpression, line), left(std::move(left)), op(op),
         right(std::move(right)) {}
 
   std::unique_ptr<ExpressionNode> left;
@@ -459,23 +847,38 @@ private:
 class VariableExpressionNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::VariableExpression; }
+
   VariableExpressionNode(const std::string &name, int line)
-      : ExpressionNode(line), name(name) {}
+      : ExpressionNode(NodeKind::VariableExpression, line), name(name) {}
 
   std::string name; // The name of the variable
+
+  // Scope distance and slot set by the Resolver, -1 to look up by name
+  int depth = -1;
+  int slot = -1;
+
+  // Set by the Resolver for a name inside a method that isn't declared in
+  // any enclosing scope: depth and slot then locate `this`, and the name is
+  // one of its fields if the object has it, otherwise looked up by name
+  std::unique_ptr<InlineCache> fieldCache;
 };
 
 class AsyncFunctionNode : public FunctionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::AsyncFunction; }
+
   AsyncFunctionNode(const std::string &name, int line)
-      : FunctionNode(name, line) {}
+      : FunctionNode(NodeKind::AsyncFunction, name, line) {}
 };
 
 class AwaitExpressionNode : public ExpressionNode
 {
 public:
-  AwaitExpressionNode(int line) : ExpressionNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::AwaitExpression; }
+
+  AwaitExpressionNode(int line) : ExpressionNode(NodeKind::AwaitExpression, line) {}
 
   std::unique_ptr<ExpressionNode> expression;
 };
@@ -483,13 +886,17 @@ public:
 class NullReferenceNode : public ExpressionNode
 {
 public:
-  NullReferenceNode(int line) : ExpressionNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::NullReference; }
+
+  NullReferenceNode(int line) : ExpressionNode(NodeKind::NullReference, line) {}
 };
 
 class ConsoleLogNode : public StatementNode
 {
 public:
-  ConsoleLogNode(int line) : StatementNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::ConsoleLog; }
+
+  ConsoleLogNode(int line) : StatementNode(NodeKind::ConsoleLog, line) {}
 
   std::unique_ptr<ExpressionNode> expression;
 };
@@ -497,7 +904,9 @@ public:
 class InputStatementNode : public StatementNode
 {
 public:
-  InputStatementNode(int line) : StatementNode(line) {}
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::InputStatement; }
+
+  InputStatementNode(int line) : StatementNode(NodeKind::InputStatement, line) {}
 
   std::unique_ptr<VariableDeclarationNode> variable;
 };
@@ -505,77 +914,99 @@ public:
 class ComparisonExpressionNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::ComparisonExpression; }
+
   ComparisonExpressionNode(std::unique_ptr<ExpressionNode> left,
                            const std::string &op,
                            std::unique_ptr<ExpressionNode> right, int line)
-      : ExpressionNode(line), left(std::move(left)), op(op),
+      : ExpressionNode(NodeKind::ComparisonExpression, line), left(std::move(left)), op(op),
         right(std::move(right)) {}
 
   std::unique_ptr<ExpressionNode> left;
   std::string op; // Operator, e.g., "<", ">", "<=", ">="
   std::unique_ptr<ExpressionNode> right;
+
+  Quickening quickening;
 };
 
 class AdditionExpressionNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::AdditionExpression; }
+
   AdditionExpressionNode(std::unique_ptr<ExpressionNode> left,
                          const std::string &op,
                          std::unique_ptr<ExpressionNode> right, int line)
-      : ExpressionNode(line), left(std::move(left)), op(op),
+      : ExpressionNode(NodeKind::AdditionExpression, line), left(std::move(left)), op(op),
         right(std::move(right)) {}
 
   std::unique_ptr<ExpressionNode> left;
   std::string op; // Operator, expected to be "+"
   std::unique_ptr<ExpressionNode> right;
+
+  Quickening quickening;
 };
 
 class SubtractionExpressionNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::SubtractionExpression; }
+
   SubtractionExpressionNode(std::unique_ptr<ExpressionNode> left,
                             const std::string &op,
                             std::unique_ptr<ExpressionNode> right, int line)
-      : ExpressionNode(line), left(std::move(left)), op(op),
+      : ExpressionNode(NodeKind::SubtractionExpression, line), left(std::move(left)), op(op),
         right(std::move(right)) {}
 
   std::unique_ptr<ExpressionNode> left;
   std::string op; // Operator, expected to be "-"
   std::unique_ptr<ExpressionNode> right;
+
+  Quickening quickening;
 };
 
 class MultiplicationExpressionNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::MultiplicationExpression; }
+
   MultiplicationExpressionNode(std::unique_ptr<ExpressionNode> left,
                                const std::string &op,
                                std::unique_ptr<ExpressionNode> right, int line)
-      : ExpressionNode(line), left(std::move(left)), op(op),
+      : ExpressionNode(NodeKind::MultiplicationExpression, line), left(std::move(left)), op(op),
         right(std::move(right)) {}
 
   std::unique_ptr<ExpressionNode> left;
   std::string op; // Operator, expected to be "*"
   std::unique_ptr<ExpressionNode> right;
+
+  Quickening quickening;
 };
 
 class DivisionExpressionNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::DivisionExpression; }
+
   DivisionExpressionNode(std::unique_ptr<ExpressionNode> left,
                          const std::string &op,
                          std::unique_ptr<ExpressionNode> right, int line)
-      : ExpressionNode(line), left(std::move(left)), op(op),
+      : ExpressionNode(NodeKind::DivisionExpression, line), left(std::move(left)), op(op),
         right(std::move(right)) {}
 
   std::unique_ptr<ExpressionNode> left;
   std::string op; // Operator, expected to be "/"
   std::unique_ptr<ExpressionNode> right;
+
+  Quickening quickening;
 };
 class CharLiteralNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::CharLiteral; }
+
   // Constructor: takes the character value and the line number.
-  CharLiteralNode(char value, int line) : ExpressionNode(line), value(value) {}
+  CharLiteralNode(char value, int line) : ExpressionNode(NodeKind::CharLiteral, line), value(value) {}
 
   // Accept method for the visitor pattern.
   char value; // The character value of the literal.
@@ -584,10 +1015,12 @@ public:
 class PropertyDeclarationNode : public StatementNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::PropertyDeclaration; }
+
   PropertyDeclarationNode(const std::string &name,
                           std::unique_ptr<TypeNode> type,
                           std::unique_ptr<ExpressionNode> initializer, int line)
-      : StatementNode(line), name(name), type(std::move(type)),
+      : StatementNode(NodeKind::PropertyDeclaration, line), name(name), type(std::move(type)),
         initializer(std::move(initializer)) {}
 
   std::string name;
@@ -598,8 +1031,10 @@ public:
 class ExpressionStatementNode : public StatementNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::ExpressionStatement; }
+
   ExpressionStatementNode(std::unique_ptr<ExpressionNode> expression, int line)
-      : StatementNode(line), expression(std::move(expression)) {}
+      : StatementNode(NodeKind::ExpressionStatement, line), expression(std::move(expression)) {}
 
   std::unique_ptr<ExpressionNode> expression;
 };
@@ -607,8 +1042,10 @@ public:
 class IntegerLiteralNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::IntegerLiteral; }
+
   IntegerLiteralNode(const std::string &value, int line)
-      : ExpressionNode(line), value(std::stoi(value)) {}
+      : ExpressionNode(NodeKind::IntegerLiteral, line), value(std::stoi(value)) {}
 
   int value;
 };
@@ -616,8 +1053,10 @@ public:
 class FloatingPointLiteralNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::FloatingPointLiteral; }
+
   FloatingPointLiteralNode(const std::string &value, int line)
-      : ExpressionNode(line), value(std::stof(value)) {}
+      : ExpressionNode(NodeKind::FloatingPointLiteral, line), value(std::stof(value)) {}
 
   float value;
 };
@@ -625,8 +1064,10 @@ public:
 class FunctionExpressionNode : public ExpressionNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::FunctionExpression; }
+
   FunctionExpressionNode(std::unique_ptr<FunctionNode> function, int line)
-      : ExpressionNode(line), function(std::move(function)) {}
+      : ExpressionNode(NodeKind::FunctionExpression, line), function(std::move(function)) {}
 
   std::unique_ptr<FunctionNode> function;
 };
@@ -634,11 +1075,162 @@ public:
 class TemplateNode : public ASTNode
 {
 public:
+  static bool hasKind(NodeKind kind) { return kind == NodeKind::Template; }
+
   TemplateNode(std::vector<std::string> parameters,
                std::unique_ptr<ASTNode> declaration, int line)
-      : ASTNode(line), parameters(std::move(parameters)),
+      : ASTNode(NodeKind::Template, line), parameters(std::move(parameters)),
         declaration(std::move(declaration)) {}
 
   std::vector<std::string> parameters;
   std::unique_ptr<ASTNode> declaration;
 };
+
+// T, const when Node is
+template <typename T, typename Node>
+using NodeLike = std::conditional_t<std::is_const_v<Node>, const T, T>;
+
+// The node as a T, or nullptr when it is something else. Like dynamic_cast,
+// but compares the kind instead of walking the class hierarchy
+template <typename T, typename Node>
+T *nodeCast(Node *node)
+{
+  return node && std::remove_const_t<T>::hasKind(node->kind()) ? static_cast<T *>(node) : nullptr;
+}
+
+// Calls visitor with node cast to its own class, picked by one switch on the
+// kind. The visitor is typically a set of overloads, for instance a lambda
+// per class of interest and one taking an ASTNode * for the rest; whatever
+// they return has to be the same type. node must not be null
+template <typename Node, typename Visitor>
+decltype(auto) visitNode(Node *node, Visitor &&visitor)
+{
+  switch (node->kind())
+  {
+  case NodeKind::Program:
+    return visitor(static_cast<NodeLike<ProgramNode, Node> *>(node));
+  case NodeKind::Type:
+    return visitor(static_cast<NodeLike<TypeNode, Node> *>(node));
+  case NodeKind::FunctionParameter:
+    return visitor(static_cast<NodeLike<FunctionParameterNode, Node> *>(node));
+  case NodeKind::Function:
+    return visitor(static_cast<NodeLike<FunctionNode, Node> *>(node));
+  case NodeKind::AsyncFunction:
+    return visitor(static_cast<NodeLike<AsyncFunctionNode, Node> *>(node));
+  case NodeKind::Class:
+    return visitor(static_cast<NodeLike<ClassNode, Node> *>(node));
+  case NodeKind::CaseClause:
+    return visitor(static_cast<NodeLike<CaseClauseNode, Node> *>(node));
+  case NodeKind::Import:
+    return visitor(static_cast<NodeLike<ImportNode, Node> *>(node));
+  case NodeKind::Export:
+    return visitor(static_cast<NodeLike<ExportNode, Node> *>(node));
+  case NodeKind::ReExport:
+    return visitor(static_cast<NodeLike<ReExportNode, Node> *>(node));
+  case NodeKind::Interface:
+    return visitor(static_cast<NodeLike<InterfaceNode, Node> *>(node));
+  case NodeKind::ErrorType:
+    return visitor(static_cast<NodeLike<ErrorTypeNode, Node> *>(node));
+  case NodeKind::Constructor:
+    return visitor(static_cast<NodeLike<ConstructorNode, Node> *>(node));
+  case NodeKind::Template:
+    return visitor(static_cast<NodeLike<TemplateNode, Node> *>(node));
+  case NodeKind::BlockStatement:
+    return visitor(static_cast<NodeLike<BlockStatementNode, Node> *>(node));
+  case NodeKind::VariableDeclaration:
+    return visitor(static_cast<NodeLike<VariableDeclarationNode, Node> *>(node));
+  case NodeKind::ReturnStatement:
+    return visitor(static_cast<NodeLike<ReturnStatementNode, Node> *>(node));
+  case NodeKind::IfStatement:
+    return visitor(static_cast<NodeLike<IfStatementNode, Node> *>(node));
+  case NodeKind::ForStatement:
+    return visitor(static_cast<NodeLike<ForStatementNode, Node> *>(node));
+  case NodeKind::WhileStatement:
+    return visitor(static_cast<NodeLike<WhileStatementNode, Node> *>(node));
+  case NodeKind::BreakStatement:
+    return visitor(static_cast<NodeLike<BreakStatementNode, Node> *>(node));
+  case NodeKind::ContinueStatement:
+    return visitor(static_cast<NodeLike<ContinueStatementNode, Node> *>(node));
+  case NodeKind::SwitchStatement:
+    return visitor(static_cast<NodeLike<SwitchStatementNode, Node> *>(node));
+  case NodeKind::TryCatch:
+    return visitor(static_cast<NodeLike<TryCatchNode, Node> *>(node));
+  case NodeKind::ConsoleLog:
+    return visitor(static_cast<NodeLike<ConsoleLogNode, Node> *>(node));
+  case NodeKind::InputStatement:
+    return visitor(static_cast<NodeLike<InputStatementNode, Node> *>(node));
+  case NodeKind::PropertyDeclaration:
+    return visitor(static_cast<NodeLike<PropertyDeclarationNode, Node> *>(node));
+  case NodeKind::ExpressionStatement:
+    return visitor(static_cast<NodeLike<ExpressionStatementNode, Node> *>(node));
+  case NodeKind::BinaryExpression:
+    return visitor(static_cast<NodeLike<BinaryExpressionNode, Node> *>(node));
+  case NodeKind::Literal:
+    return visitor(static_cast<NodeLike<LiteralNode, Node> *>(node));
+  case NodeKind::UnaryExpression:
+    return visitor(static_cast<NodeLike<UnaryExpressionNode, Node> *>(node));
+  case NodeKind::CallExpression:
+    return visitor(static_cast<NodeLike<CallExpressionNode, Node> *>(node));
+  case NodeKind::AssignmentExpression:
+    return visitor(static_cast<NodeLike<AssignmentExpressionNode, Node> *>(node));
+  case NodeKind::MemberAccessExpression:
+    return visitor(static_cast<NodeLike<MemberAccessExpressionNode, Node> *>(node));
+  case NodeKind::ConditionalExpression:
+    return visitor(static_cast<NodeLike<ConditionalExpressionNode, Node> *>(node));
+  case NodeKind::StringLiteral:
+    return visitor(static_cast<NodeLike<StringLiteralNode, Node> *>(node));
+  case NodeKind::NumberLiteral:
+    return visitor(static_cast<NodeLike<NumberLiteralNode, Node> *>(node));
+  case NodeKind::BooleanLiteral:
+    return visitor(static_cast<NodeLike<BooleanLiteralNode, Node> *>(node));
+  case NodeKind::NullLiteral:
+    return visitor(static_cast<NodeLike<NullLiteralNode, Node> *>(node));
+  case NodeKind::ArrayLiteral:
+    return visitor(static_cast<NodeLike<ArrayLiteralNode, Node> *>(node));
+  case NodeKind::ObjectLiteral:
+    return visitor(static_cast<NodeLike<ObjectLiteralNode, Node> *>(node));
+  case NodeKind::TemplateLiteral:
+    return visitor(static_cast<NodeLike<TemplateLiteralNode, Node> *>(node));
+  case NodeKind::EqualityExpression:
+    return visitor(static_cast<NodeLike<EqualityExpressionNode, Node> *>(node));
+  case NodeKind::OrExpression:
+    return visitor(static_cast<NodeLike<OrExpressionNode, Node> *>(node));
+  case NodeKind::AndExpression:
+    return visitor(static_cast<NodeLike<AndExpressionNode, Node> *>(node));
+  case NodeKind::VariableExpression:
+    return visitor(static_cast<NodeLike<VariableExpressionNode, Node> *>(node));
+  case NodeKind::AwaitExpression:
+    return visitor(static_cast<NodeLike<AwaitExpressionNode, Node> *>(node));
+  case NodeKind::NullReference:
+    return visitor(static_cast<NodeLike<NullReferenceNode, Node> *>(node));
+  case NodeKind::ComparisonExpression:
+    return visitor(static_cast<NodeLike<ComparisonExpressionNode, Node> *>(node));
+  case NodeKind::AdditionExpression:
+    return visitor(static_cast<NodeLike<AdditionExpressionNode, Node> *>(node));
+  case NodeKind::SubtractionExpression:
+    return visitor(static_cast<NodeLike<SubtractionExpressionNode, Node> *>(node));
+  case NodeKind::MultiplicationExpression:
+    return visitor(static_cast<NodeLike<MultiplicationExpressionNode, Node> *>(node));
+  case NodeKind::DivisionExpression:
+    return visitor(static_cast<NodeLike<DivisionExpressionNode, Node> *>(node));
+  case NodeKind::CharLiteral:
+    return visitor(static_cast<NodeLike<CharLiteralNode, Node> *>(node));
+  case NodeKind::IntegerLiteral:
+    return visitor(static_cast<NodeLike<IntegerLiteralNode, Node> *>(node));
+  case NodeKind::FloatingPointLiteral:
+    return visitor(static_cast<NodeLike<FloatingPointLiteralNode, Node> *>(node));
+  case NodeKind::FunctionExpression:
+    return visitor(static_cast<NodeLike<FunctionExpressionNode, Node> *>(node));
+  }
+  throw std::logic_error("Node of unknown kind " + std::to_string(static_cast<int>(node->kind())));
+}
+
+// Builds a visitor out of lambdas, e.g.
+//   visitNode(node, NodeVisitor{[](IfStatementNode *node) {...}, [](ASTNode *) {...}})
+template <typename... Lambdas>
+struct NodeVisitor : Lambdas...
+{
+  using Lambdas::operator()...;
+};
+template <typename... Lambdas>
+NodeVisitor(Lambdas...) -> NodeVisitor<Lambdas...>;
@@ -12,32 +12,36 @@ void Parser::error(const std::string &message)
 
 std::unique_ptr<ProgramNode> Parser::parse()
 {
-    DEBUG_LOG("=== Starting Parser::parse() ===");
+    TRACE(Parser, Debug, "=== Starting Parser::parse() ===");
     auto program = std::make_unique<ProgramNode>(0); // Assuming 0 as the starting line
+    // The program itself stays on the heap; everything below it is allocated
+    // from its arena
+    program->arena = std::make_shared<AstArena>();
+    AstArena::Scope arenaScope(program->arena.get());
 
     int declarationCount = 0;
     while (!isAtEnd())
     {
-        DEBUG_LOG("=== Parsing declaration #", declarationCount++, " ===");
-        DEBUG_LOG("Current token: type=", static_cast<int>(peek().type), " value='", peek().value, "' line=", peek().line);
+        TRACE(Parser, Debug, "=== Parsing declaration #", declarationCount++, " ===");
+        TRACE(Parser, Debug, "Current token: type=", static_cast<int>(peek().type), " value='", peek().value(), "' line=", peek().line);
 
         try
         {
             auto declaration = parseDeclaration();
-            DEBUG_LOG("Successfully parsed declaration");
+            TRACE(Parser, Debug, "Successfully parsed declaration");
             program->children.push_back(std::move(declaration));
         }
         catch (const std::runtime_error &e)
         {
-            DEBUG_LOG("Error parsing declaration: ", e.what());
+            TRACE(Parser, Debug, "Error parsing declaration: ", e.what());
             std::cout << e.what() << std::endl;
             throw std::runtime_error(e.what());
         }
 
-        DEBUG_LOG("After parsing declaration, current token: type=", static_cast<int>(peek().type), " value='", peek().value, "'");
+        TRACE(Parser, Debug, "After parsing declaration, current token: type=", static_cast<int>(peek().type), " value='", peek().value(), "'");
     }
 
-    DEBUG_LOG("=== Finished Parser::parse() with ", program->children.size(), " declarations ===");
+    TRACE(Parser, Debug, "=== Finished Parser::parse() with ", program->children.size(), " declarations ===");
     return program;
 }
 
@@ -45,13 +49,13 @@ std::unique_ptr<ProgramNode> Parser::parse()
 
 std::unique_ptr<ASTNode> Parser::parseDeclaration()
 {
-    DEBUG_LOG("=== Starting parseDeclaration ===");
-    DEBUG_LOG("Current token: type=", static_cast<int>(peek().type), " value='", peek().value, "'");
-    DEBUG_LOG("Next token: type=", static_cast<int>(peekNext().type), " value='", peekNext().value, "'");
+    TRACE(Parser, Debug, "=== Starting parseDeclaration ===");
+    TRACE(Parser, Debug, "Current token: type=", static_cast<int>(peek().type), " value='", peek().value(), "'");
+    TRACE(Parser, Debug, "Next token: type=", static_cast<int>(peekNext().type), " value='", peekNext().value(), "'");
 
     if (match(TokenType::Keyword, "export"))
     {
-        DEBUG_LOG("Matched export");
+        TRACE(Parser, Debug, "Matched export");
         auto exportedItem = parseDeclaration();
         std::unique_ptr<ExportNode> node =
             std::make_unique<ExportNode>(previous().line);
@@ -60,123 +64,122 @@ std::unique_ptr<ASTNode> Parser::parseDeclaration()
     }
     else if (match(TokenType::Keyword, "template"))
     {
-        DEBUG_LOG("Matched template");
+        TRACE(Parser, Debug, "Matched template");
         return parseTemplateDeclaration();
     }
-    else if (peek().value == "class" && peek().type == TokenType::Declaration)
+    else if (peek().value() == "class" && peek().type == TokenType::Declaration)
     {
-        DEBUG_LOG("Matched class declaration");
+        TRACE(Parser, Debug, "Matched class declaration");
         return parseClassDeclaration();
     }
     else if (peek().type == TokenType::Keyword &&
              peekNext().type == TokenType::Declaration &&
-             peekNext().value == "function")
+             peekNext().value() == "function")
     {
-        DEBUG_LOG("Matched function with return type");
+        TRACE(Parser, Debug, "Matched function with return type");
         return parseFunctionDeclaration();
     }
-    else if (peek().type == TokenType::Keyword && peek().value == "async" &&
-             peekNext().type == TokenType::Declaration && peekNext().value == "function")
+    else if (peek().type == TokenType::Keyword && peek().value() == "async" &&
+             peekNext().type == TokenType::Declaration && peekNext().value() == "function")
     {
-        DEBUG_LOG("Matched async function");
+        TRACE(Parser, Debug, "Matched async function");
         return parseFunctionDeclaration();
     }
     else if (match(TokenType::Keyword, "interface"))
     {
-        DEBUG_LOG("Matched interface");
+        TRACE(Parser, Debug, "Matched interface");
         return parseInterfaceDeclaration();
     }
     else if (match(TokenType::Keyword, "if"))
     {
-        DEBUG_LOG("Matched if");
+        TRACE(Parser, Debug, "Matched if");
         return parseIfStatement();
     }
     else if (match(TokenType::Keyword, "for"))
     {
-        DEBUG_LOG("Matched for");
+        TRACE(Parser, Debug, "Matched for");
         return parseForStatement();
     }
     else if (match(TokenType::Keyword, "while"))
     {
-        DEBUG_LOG("Matched while");
+        TRACE(Parser, Debug, "Matched while");
         return parseWhileStatement();
     }
     else if (match(TokenType::Keyword, "return"))
     {
-        DEBUG_LOG("Matched return");
+        TRACE(Parser, Debug, "Matched return");
         return parseReturnStatement();
     }
-    else if (match(TokenType::Keyword, "break"))
+    else if (check(TokenType::Keyword, "break")) // parseBreakStatement consumes the keyword
     {
-        DEBUG_LOG("Matched break");
+        TRACE(Parser, Debug, "Matched break");
         return parseBreakStatement();
     }
-    else if (match(TokenType::Keyword, "continue"))
+    else if (check(TokenType::Keyword, "continue")) // parseContinueStatement consumes the keyword
     {
-        DEBUG_LOG("Matched continue");
+        TRACE(Parser, Debug, "Matched continue");
         return parseContinueStatement();
     }
     else if (check(TokenType::Keyword, "switch")) // Using check() instead of match()
     {
-        DEBUG_LOG("Matched switch");
+        TRACE(Parser, Debug, "Matched switch");
         return parseSwitchStatement();
     }
     else if (match(TokenType::Keyword, "try"))
     {
-        DEBUG_LOG("Matched try");
+        TRACE(Parser, Debug, "Matched try");
         return parseTryCatchStatement();
     }
     else if (match(TokenType::Keyword, "export"))
     {
-        DEBUG_LOG("Matched export (duplicate)");
+        TRACE(Parser, Debug, "Matched export (duplicate)");
         return parseExportStatement();
     }
     else if (match(TokenType::Keyword, "import"))
     {
-        DEBUG_LOG("Matched import");
+        TRACE(Parser, Debug, "Matched import");
         return parseImportStatement();
     }
     else if (match(TokenType::Keyword, "null"))
     {
-        DEBUG_LOG("Matched null");
+        TRACE(Parser, Debug, "Matched null");
         return parseNullReference();
     }
     else if (check(TokenType::Keyword, "print")) // Using check() instead of match()
     {
-        DEBUG_LOG("Matched print");
+        TRACE(Parser, Debug, "Matched print");
         return parseConsoleLog();
     }
     else if (match(TokenType::Keyword, "await"))
     {
-        DEBUG_LOG("Matched await");
+        TRACE(Parser, Debug, "Matched await");
         return parseAwaitExpression();
     }
     else if (match(TokenType::Keyword, "input"))
     {
-        DEBUG_LOG("Matched input");
+        TRACE(Parser, Debug, "Matched input");
         return parseInputStatement();
     }
     else if (match(TokenType::Keyword, "") ||
              match(TokenType::Keyword, "const"))
     {
-        DEBUG_LOG("Matched variable declaration");
-        return parseVariableDeclaration(previous().value);
+        TRACE(Parser, Debug, "Matched variable declaration");
+        return parseVariableDeclaration(std::string(previous().value()));
     }
 
-    DEBUG_LOG("No match found, falling back to parseStatement");
+    TRACE(Parser, Debug, "No match found, falling back to parseStatement");
     return parseStatement();
 }
 
 std::unique_ptr<FunctionParameterNode> Parser::parseFunctionParameter()
 {
     std::unique_ptr<TypeNode> paramType;
-    if (isType(peek().value))
+    if (isType(peek().value()))
     {
         // Parse parameter type if present
         paramType = parseType();
     }
-    std::string paramName =
-        consume(TokenType::Identifier, "", "Expected parameter name").value;
+    std::string paramName(consume(TokenType::Identifier, "", "Expected parameter name").value());
 
     std::unique_ptr<FunctionParameterNode> parameter =
         std::make_unique<FunctionParameterNode>(paramName, previous().line);
@@ -186,66 +189,66 @@ std::unique_ptr<FunctionParameterNode> Parser::parseFunctionParameter()
 
 std::unique_ptr<ASTNode> Parser::parseStatement()
 {
-    DEBUG_LOG("=== Starting parseStatement ===");
-    DEBUG_LOG("Current token: type=", static_cast<int>(peek().type), " value='", peek().value, "'");
+    TRACE(Parser, Debug, "=== Starting parseStatement ===");
+    TRACE(Parser, Debug, "Current token: type=", static_cast<int>(peek().type), " value='", peek().value(), "'");
 
-    if (peek().type == TokenType::Punctuator && peek().value == "{")
+    if (peek().type == TokenType::Punctuator && peek().value() == "{")
     {
-        DEBUG_LOG("Parsing block statement");
+        TRACE(Parser, Debug, "Parsing block statement");
         return parseBlockStatement();
     }
-    else if (peek().type == TokenType::Punctuator && peek().value == ";")
+    else if (peek().type == TokenType::Punctuator && peek().value() == ";")
     {
-        DEBUG_LOG("Parsing empty statement");
+        TRACE(Parser, Debug, "Parsing empty statement");
         // Handle empty statements
         advance(); // Consume the semicolon
         return std::make_unique<ExpressionStatementNode>(
             std::make_unique<NullLiteralNode>(previous().line), previous().line);
     }
     // Add handling for specific statement types
-    else if (peek().type == TokenType::Keyword && peek().value == "print")
+    else if (peek().type == TokenType::Keyword && peek().value() == "print")
     {
-        DEBUG_LOG("Parsing print statement");
+        TRACE(Parser, Debug, "Parsing print statement");
         return parseConsoleLog();
     }
-    else if (peek().type == TokenType::Keyword && peek().value == "if")
+    else if (peek().type == TokenType::Keyword && peek().value() == "if")
     {
-        DEBUG_LOG("Parsing if statement");
+        TRACE(Parser, Debug, "Parsing if statement");
         return parseIfStatement();
     }
-    else if (peek().type == TokenType::Keyword && peek().value == "for")
+    else if (peek().type == TokenType::Keyword && peek().value() == "for")
     {
-        DEBUG_LOG("Parsing for statement");
+        TRACE(Parser, Debug, "Parsing for statement");
         return parseForStatement();
     }
-    else if (peek().type == TokenType::Keyword && peek().value == "while")
+    else if (peek().type == TokenType::Keyword && peek().value() == "while")
     {
-        DEBUG_LOG("Parsing while statement");
+        TRACE(Parser, Debug, "Parsing while statement");
         return parseWhileStatement();
     }
-    else if (peek().type == TokenType::Keyword && peek().value == "return")
+    else if (peek().type == TokenType::Keyword && peek().value() == "return")
     {
-        DEBUG_LOG("Parsing return statement");
+        TRACE(Parser, Debug, "Parsing return statement");
         return parseReturnStatement();
     }
-    else if (peek().type == TokenType::Keyword && peek().value == "break")
+    else if (peek().type == TokenType::Keyword && peek().value() == "break")
     {
-        DEBUG_LOG("Parsing break statement");
+        TRACE(Parser, Debug, "Parsing break statement");
         return parseBreakStatement();
     }
-    else if (peek().type == TokenType::Keyword && peek().value == "continue")
+    else if (peek().type == TokenType::Keyword && peek().value() == "continue")
     {
-        DEBUG_LOG("Parsing continue statement");
+        TRACE(Parser, Debug, "Parsing continue statement");
         return parseContinueStatement();
     }
-    else if (peek().type == TokenType::Keyword && peek().value == "switch")
+    else if (peek().type == TokenType::Keyword && peek().value() == "switch")
     {
-        DEBUG_LOG("Parsing switch statement");
+        TRACE(Parser, Debug, "Parsing switch statement");
         return parseSwitchStatement();
     }
-    else if (peek().type == TokenType::Keyword && peek().value == "try")
+    else if (peek().type == TokenType::Keyword && peek().value() == "try")
     {
-        DEBUG_LOG("Parsing try statement");
+        TRACE(Parser, Debug, "Parsing try statement");
         return parseTryCatchStatement();
     }
     // Check for variable declaration with class instantiation or imported type
@@ -253,13 +256,13 @@ std::unique_ptr<ASTNode> Parser::parseStatement()
     else if (peek().type == TokenType::Identifier &&
              peekNext().type == TokenType::Identifier &&
              peekNextNext().type == TokenType::Operator &&
-             peekNextNext().value == "=")
+             peekNextNext().value() == "=")
     {
-        DEBUG_LOG("Parsing variable declaration with class instantiation");
-        std::string typeName = peek().value;
+        TRACE(Parser, Debug, "Parsing variable declaration with class instantiation");
+        std::string typeName(peek().value());
         advance(); // Consume the class name
 
-        std::string varName = peek().value;
+        std::string varName(peek().value());
         advance(); // Consume the variable name
 
         advance(); // Consume the equals sign
@@ -267,7 +270,7 @@ std::unique_ptr<ASTNode> Parser::parseStatement()
         auto expr = parseExpression();
 
         // Consume the semicolon
-        if (peek().type == TokenType::Punctuator && peek().value == ";")
+        if (peek().type == TokenType::Punctuator && peek().value() == ";")
         {
             advance(); // Consume the semicolon
         }
@@ -275,7 +278,7 @@ std::unique_ptr<ASTNode> Parser::parseStatement()
         {
             std::cout << "Expected ';' after variable declaration, got: "
                       << "Type: " << static_cast<int>(peek().type)
-                      << ", Value: '" << peek().value << "'" << std::endl;
+                      << ", Value: '" << peek().value() << "'" << std::endl;
         }
 
         auto varDecl = std::make_unique<VariableDeclarationNode>(varName, previous().line);
@@ -288,11 +291,11 @@ std::unique_ptr<ASTNode> Parser::parseStatement()
     // Parse an expression statement
     else
     {
-        DEBUG_LOG("Parsing expression statement (fallback)");
+        TRACE(Parser, Debug, "Parsing expression statement (fallback)");
         auto expr = parseExpression();
 
         // Consume the semicolon
-        if (peek().type == TokenType::Punctuator && peek().value == ";")
+        if (peek().type == TokenType::Punctuator && peek().value() == ";")
         {
             advance(); // Consume the semicolon
         }
@@ -300,7 +303,7 @@ std::unique_ptr<ASTNode> Parser::parseStatement()
         {
             std::cout << "Expected ';' after expression, got: "
                       << "Type: " << static_cast<int>(peek().type)
-                      << ", Value: '" << peek().value << "'" << std::endl;
+                      << ", Value: '" << peek().value() << "'" << std::endl;
         }
 
         return std::make_unique<ExpressionStatementNode>(std::move(expr), previous().line);
@@ -322,12 +325,12 @@ std::unique_ptr<ExpressionNode> Parser::parseExpression()
         auto expr = parseAssignmentExpression();
 
         // Check for member access
-        while (peek().type == TokenType::Operator && peek().value == ".")
+        while (peek().type == TokenType::Operator && peek().value() == ".")
         {
             advance(); // Consume the dot
 
             // Get the member name
-            std::string memberName = consume(TokenType::Identifier, "", "Expected member name after '.'").value;
+            std::string memberName(consume(TokenType::Identifier, "", "Expected member name after '.'").value());
 
             // Create a member access expression
             auto memberAccessNode = std::make_unique<MemberAccessExpressionNode>(previous().line);
@@ -335,12 +338,12 @@ std::unique_ptr<ExpressionNode> Parser::parseExpression()
             memberAccessNode->memberName = memberName;
 
             // Check if this is a method call
-            if (peek().type == TokenType::Punctuator && peek().value == "(")
+            if (peek().type == TokenType::Punctuator && peek().value() == "(")
             {
                 advance(); // Consume the opening parenthesis
 
                 // Parse arguments
-                std::vector<std::unique_ptr<ExpressionNode>> arguments;
+                NodeList<ExpressionNode> arguments;
                 if (!check(TokenType::Punctuator, ")"))
                 {
                     do
@@ -378,14 +381,14 @@ std::unique_ptr<ExpressionNode> Parser::parseAssignmentExpression()
         match(TokenType::Operator,
               "-=") /* ... other assignment operators ... */)
     {
-        std::string operatorValue = previous().value;
+        std::string operatorValue(previous().value());
         auto right =
             parseAssignmentExpression(); // Recursively parse the right-hand side
 
         // Ensure the left-hand side is a valid lvalue (this is language specific
         // and may involve more checks)
-        if (dynamic_cast<VariableExpressionNode *>(left.get()) ||
-            dynamic_cast<MemberAccessExpressionNode *>(left.get()))
+        if (nodeCast<VariableExpressionNode>(left.get()) ||
+            nodeCast<MemberAccessExpressionNode>(left.get()))
         {
             std::unique_ptr<AssignmentExpressionNode> node =
                 std::make_unique<AssignmentExpressionNode>(operatorValue,
@@ -411,7 +414,7 @@ std::unique_ptr<ExpressionNode> Parser::parseOrExpression()
 
     while (match(TokenType::Operator, "||"))
     {
-        std::string operatorValue = previous().value;
+        std::string operatorValue(previous().value());
         auto right = parseAndExpression(); // Recursively parse the right operand.
         left = std::make_unique<OrExpressionNode>(
             std::move(left), operatorValue, std::move(right), previous().line);
@@ -429,7 +432,7 @@ std::unique_ptr<ExpressionNode> Parser::parseAndExpression()
 
     while (match(TokenType::Operator, "&&"))
     {
-        std::string operatorValue = previous().value;
+        std::string operatorValue(previous().value());
         auto right =
             parseEqualityExpression(); // Recursively parse the right operand.
         left = std::make_unique<AndExpressionNode>(
@@ -447,7 +450,7 @@ std::unique_ptr<ExpressionNode> Parser::parseEqualityExpression()
 
     while (match(TokenType::Operator, "==") || match(TokenType::Operator, "!="))
     {
-        std::string operatorValue = previous().value;
+        std::string operatorValue(previous().value());
         auto right =
             parseComparisonExpression(); // Recursively parse the right operand.
         left = std::make_unique<EqualityExpressionNode>(
@@ -466,7 +469,7 @@ std::unique_ptr<ExpressionNode> Parser::parseComparisonExpression()
            match(TokenType::Operator, "<=") || match(TokenType::Operator, ">="))
     {
 
-        std::string operatorValue = previous().value;
+        std::string operatorValue(previous().value());
         auto right =
             parseAdditionExpression(); // Recursively parse the right operand.
         left = std::make_unique<ComparisonExpressionNode>(
@@ -490,20 +493,20 @@ std::unique_ptr<ExpressionNode> Parser::parseAdditionExpression()
             auto right = parseMultiplicationExpression(); // Parse the right operand
 
             // Check if the right operand needs member access/method call parsing
-            while (peek().type == TokenType::Operator && peek().value == ".")
+            while (peek().type == TokenType::Operator && peek().value() == ".")
             {
                 advance(); // Consume the dot
-                std::string memberName = consume(TokenType::Identifier, "", "Expected member name after '.'").value;
+                std::string memberName(consume(TokenType::Identifier, "", "Expected member name after '.'").value());
 
                 auto memberAccess = std::make_unique<MemberAccessExpressionNode>(previous().line);
                 memberAccess->object = std::move(right);
                 memberAccess->memberName = memberName;
 
                 // Check for method call
-                if (peek().type == TokenType::Punctuator && peek().value == "(")
+                if (peek().type == TokenType::Punctuator && peek().value() == "(")
                 {
                     advance(); // Consume opening parenthesis
-                    std::vector<std::unique_ptr<ExpressionNode>> arguments;
+                    NodeList<ExpressionNode> arguments;
                     if (!check(TokenType::Punctuator, ")"))
                     {
                         do
@@ -533,20 +536,20 @@ std::unique_ptr<ExpressionNode> Parser::parseAdditionExpression()
             auto right = parseMultiplicationExpression(); // Parse the right operand
 
             // Check if the right operand needs member access/method call parsing
-            while (peek().type == TokenType::Operator && peek().value == ".")
+            while (peek().type == TokenType::Operator && peek().value() == ".")
             {
                 advance(); // Consume the dot
-                std::string memberName = consume(TokenType::Identifier, "", "Expected member name after '.'").value;
+                std::string memberName(consume(TokenType::Identifier, "", "Expected member name after '.'").value());
 
                 auto memberAccess = std::make_unique<MemberAccessExpressionNode>(previous().line);
                 memberAccess->object = std::move(right);
                 memberAccess->memberName = memberName;
 
                 // Check for method call
-                if (peek().type == TokenType::Punctuator && peek().value == "(")
+                if (peek().type == TokenType::Punctuator && peek().value() == "(")
                 {
                     advance(); // Consume opening parenthesis
-                    std::vector<std::unique_ptr<ExpressionNode>> arguments;
+                    NodeList<ExpressionNode> arguments;
                     if (!check(TokenType::Punctuator, ")"))
                     {
                         do
@@ -622,7 +625,7 @@ std::unique_ptr<ExpressionNode> Parser::parseUnaryExpression()
     if (match(TokenType::Operator, "++") || match(TokenType::Operator, "--") ||
         match(TokenType::Operator, "-") || match(TokenType::Operator, "!"))
     {
-        std::string operatorValue = previous().value; // Get the unary operator
+        std::string operatorValue(previous().value()); // Get the unary operator
         auto operand = parseUnaryExpression();        // Recursively parse the operand
         std::unique_ptr<UnaryExpressionNode> node =
             std::make_unique<UnaryExpressionNode>(operatorValue, previous().line);
@@ -637,7 +640,7 @@ std::unique_ptr<ExpressionNode> Parser::parseUnaryExpression()
     // Check for postfix operators (++ and --)
     if (match(TokenType::Operator, "++") || match(TokenType::Operator, "--"))
     {
-        std::string operatorValue = previous().value;
+        std::string operatorValue(previous().value());
         std::unique_ptr<UnaryExpressionNode> node =
             std::make_unique<UnaryExpressionNode>(operatorValue, previous().line);
         node->operand = std::move(expr);
@@ -677,12 +680,12 @@ std::unique_ptr<ExpressionNode> Parser::parsePrimaryExpression()
     }
     else if (match(TokenType::Identifier, ""))
     {
-        std::string identifier = previous().value;
+        std::string identifier(previous().value());
 
         if (match(TokenType::Punctuator, "("))
         {
             // It's a function call or object creation
-            std::vector<std::unique_ptr<ExpressionNode>> arguments;
+            NodeList<ExpressionNode> arguments;
             if (!check(TokenType::Punctuator, ")"))
             {
                 do
@@ -702,7 +705,7 @@ std::unique_ptr<ExpressionNode> Parser::parsePrimaryExpression()
         {
             // It's a member access
             consume(TokenType::Identifier, "", "Expected member name after '.'");
-            std::string memberName = previous().value;
+            std::string memberName(previous().value());
             std::unique_ptr<MemberAccessExpressionNode> memberAccessNode =
                 std::make_unique<MemberAccessExpressionNode>(previous().line);
             memberAccessNode->memberName = memberName;
@@ -727,7 +730,7 @@ std::unique_ptr<ExpressionNode> Parser::parsePrimaryExpression()
     {
         return parseAnonymousFunction();
     }
-    else if (peek().value == "new")
+    else if (peek().value() == "new")
     {
         return parseAnonymousFunction();
     }
@@ -737,11 +740,11 @@ std::unique_ptr<ExpressionNode> Parser::parsePrimaryExpression()
         consume(TokenType::Punctuator, ")", "Expected ')' after expression");
         return expr;
     }
-    else if (peek().type == TokenType::Operator && peek().value == ".")
+    else if (peek().type == TokenType::Operator && peek().value() == ".")
     {
         // It's a member access expression
         advance(); // Consume the dot
-        std::string memberName = consume(TokenType::Identifier, "", "Expected member name after '.'").value;
+        std::string memberName(consume(TokenType::Identifier, "", "Expected member name after '.'").value());
 
         // Create a member access expression
         std::unique_ptr<MemberAccessExpressionNode> memberAccessNode =
@@ -757,7 +760,7 @@ std::unique_ptr<ExpressionNode> Parser::parsePrimaryExpression()
     {
         std::cout << "Unexpected token in primary expression: "
                   << "Type: " << static_cast<int>(peek().type)
-                  << ", Value: '" << peek().value << "'" << std::endl;
+                  << ", Value: '" << peek().value() << "'" << std::endl;
         throw std::runtime_error("Unexpected token in primary expression");
     }
 }
@@ -777,10 +780,10 @@ std::unique_ptr<NullReferenceNode> Parser::parseNullReference()
     return nullNode;
 }
 
-bool Parser::isType(const std::string &keyword)
+bool Parser::isType(std::string_view keyword)
 {
     // Check if the keyword is a valid type
-    static const std::set<std::string> validTypes = {
+    static const std::set<std::string, std::less<>> validTypes = {
         "bool", "char", "int", "float", "double",
         "void", "wchar_t", "string", "Error"};
     return validTypes.find(keyword) != validTypes.end();
@@ -788,35 +791,35 @@ bool Parser::isType(const std::string &keyword)
 
 std::unique_ptr<ConsoleLogNode> Parser::parseConsoleLog()
 {
-    DEBUG_LOG("=== Starting parseConsoleLog ===");
-    DEBUG_LOG("Current token: type=", static_cast<int>(peek().type), " value='", peek().value, "'");
+    TRACE(Parser, Debug, "=== Starting parseConsoleLog ===");
+    TRACE(Parser, Debug, "Current token: type=", static_cast<int>(peek().type), " value='", peek().value(), "'");
 
     // Consume the 'print' keyword first
     consume(TokenType::Keyword, "print", "Expected 'print' keyword");
-    DEBUG_LOG("Consumed 'print' keyword");
+    TRACE(Parser, Debug, "Consumed 'print' keyword");
 
     // Consume the opening parenthesis
     consume(TokenType::Punctuator, "(", "Expected '(' after 'print'");
-    DEBUG_LOG("Consumed opening parenthesis");
+    TRACE(Parser, Debug, "Consumed opening parenthesis");
 
     // Parse the expression to be logged
-    DEBUG_LOG("About to parse print expression");
+    TRACE(Parser, Debug, "About to parse print expression");
     auto expression = parseExpression();
-    DEBUG_LOG("Parsed print expression");
+    TRACE(Parser, Debug, "Parsed print expression");
 
     // Consume the closing parenthesis
     consume(TokenType::Punctuator, ")", "Expected ')' after print expression");
-    DEBUG_LOG("Consumed closing parenthesis");
+    TRACE(Parser, Debug, "Consumed closing parenthesis");
 
     // Consume the semicolon at the end of the print statement
     consume(TokenType::Punctuator, ";", "Expected ';' after print statement");
-    DEBUG_LOG("Consumed semicolon");
+    TRACE(Parser, Debug, "Consumed semicolon");
 
     // Create and return a new ConsoleLogNode
     auto console_log_node = std::make_unique<ConsoleLogNode>(previous().line);
     console_log_node->expression = std::move(expression);
 
-    DEBUG_LOG("=== Finished parseConsoleLog ===");
+    TRACE(Parser, Debug, "=== Finished parseConsoleLog ===");
     return console_log_node;
 }
 
@@ -829,7 +832,7 @@ std::unique_ptr<InputStatementNode> Parser::parseInputStatement()
     std::unique_ptr<VariableDeclarationNode> variable;
     if (match(TokenType::Identifier, "input"))
     {
-        std::string variableName = previous().value;
+        std::string variableName(previous().value());
         consume(TokenType::Operator, "=",
                 "Expected '='"); // Assuming the syntax is 'input variableName =
                                  // input();'
@@ -859,13 +862,13 @@ std::unique_ptr<ClassNode> Parser::parseClassDeclaration()
     consume(TokenType::Declaration, "class", "Expected 'class' keyword");
     auto classNameToken =
         consume(TokenType::Identifier, "", "Expected class name");
-    std::string className = classNameToken.value;
+    std::string className(classNameToken.value());
 
     std::string baseClassName;
     if (match(TokenType::Keyword, "extends"))
     {
         baseClassName =
-            consume(TokenType::Identifier, "", "Expected base class name").value;
+            consume(TokenType::Identifier, "", "Expected base class name").value();
     }
 
     // Add the class name to declaredClasses
@@ -891,16 +894,16 @@ std::unique_ptr<ClassNode> Parser::parseClassDeclaration()
 
 std::unique_ptr<ASTNode> Parser::parseClassMember()
 {
-    DEBUG_LOG(peek().value);
+    TRACE(Parser, Debug, peek().value());
 
     // Check for constructor
-    if (peek().value == "constructor")
+    if (peek().value() == "constructor")
     {
-        DEBUG_LOG("Parsing constructor declaration");
+        TRACE(Parser, Debug, "Parsing constructor declaration");
         return parseConstructorDeclaration();
     }
     // Check if the member is a method or property (both start with a type)
-    else if (peek().type == TokenType::Keyword && isType(peek().value))
+    else if (peek().type == TokenType::Keyword && isType(peek().value()))
     {
         // Look ahead to determine if it's a method or property
         // Methods: "type identifier(" or "type function identifier("
@@ -909,46 +912,45 @@ std::unique_ptr<ASTNode> Parser::parseClassMember()
         size_t savedPos = current;
         advance(); // Skip the type
 
-        if (peek().value == "function")
+        if (peek().value() == "function")
         {
             // Method with function keyword: "type function identifier("
             current = savedPos; // Reset position
-            DEBUG_LOG("Parsing function declaration with function keyword");
+            TRACE(Parser, Debug, "Parsing function declaration with function keyword");
             return parseFunctionDeclaration();
         }
-        else if (peek().type == TokenType::Identifier && peekNext().value == "(")
+        else if (peek().type == TokenType::Identifier && peekNext().value() == "(")
         {
             // Method without function keyword: "type identifier("
             current = savedPos; // Reset position
-            DEBUG_LOG("Parsing method declaration without function keyword");
+            TRACE(Parser, Debug, "Parsing method declaration without function keyword");
             return parseFunctionDeclaration();
         }
         else
         {
             // Property: "type identifier;" or "type identifier ="
             current = savedPos; // Reset position
-            DEBUG_LOG("Parsing property declaration");
+            TRACE(Parser, Debug, "Parsing property declaration");
             return parsePropertyDeclaration();
         }
     }
 
-    DEBUG_LOG("Unsupported class member type: ", peek().value);
+    TRACE(Parser, Debug, "Unsupported class member type: ", peek().value());
     throw std::runtime_error("Unsupported class member type");
 }
 
 std::unique_ptr<ASTNode> Parser::parsePropertyDeclaration()
 {
-    DEBUG_LOG("int"); // This seems to be logging the type
+    TRACE(Parser, Debug, "int"); // This seems to be logging the type
     std::unique_ptr<TypeNode> propertyType;
-    if (peek().type == TokenType::Keyword && isType(peek().value))
+    if (peek().type == TokenType::Keyword && isType(peek().value()))
     {
         // Assuming next token is type if it's an identifier
         propertyType = parseType();
     }
 
     // Assuming properties are declared like variables
-    std::string propertyName =
-        consume(TokenType::Identifier, "", "Expected property name").value;
+    std::string propertyName(consume(TokenType::Identifier, "", "Expected property name").value());
 
     // Check for '=' and parse the initializer expression if present
     std::unique_ptr<ExpressionNode> initializer;
@@ -983,7 +985,7 @@ std::unique_ptr<ASTNode> Parser::parseConstructorDeclaration()
     consume(TokenType::Punctuator, "(", "Expected '(' after 'constructor'");
 
     // Parse parameters manually
-    std::vector<std::unique_ptr<FunctionParameterNode>> parameters;
+    NodeList<FunctionParameterNode> parameters;
 
     if (!check(TokenType::Punctuator, ")"))
     {
@@ -993,8 +995,7 @@ std::unique_ptr<ASTNode> Parser::parseConstructorDeclaration()
             auto type = parseType();
 
             // Parse the name of the parameter
-            std::string paramName =
-                consume(TokenType::Identifier, "", "Expected parameter name").value;
+            std::string paramName(consume(TokenType::Identifier, "", "Expected parameter name").value());
 
             // Create a FunctionParameterNode and add it to the parameters vector
             std::unique_ptr<FunctionParameterNode> parameter =
@@ -1017,16 +1018,16 @@ std::unique_ptr<FunctionNode> Parser::parseFunctionDeclaration()
     std::string returnType;
 
     // Check for 'async' keyword
-    if (peek().type == TokenType::Keyword && peek().value == "async")
+    if (peek().type == TokenType::Keyword && peek().value() == "async")
     {
         isAsync = true;
         advance(); // Consume 'async'
     }
 
     // Check for return type
-    if (peek().type == TokenType::Keyword && isType(peek().value))
+    if (peek().type == TokenType::Keyword && isType(peek().value()))
     {
-        returnType = peek().value;
+        returnType = peek().value();
         advance(); // Consume return type
     }
 
@@ -1034,14 +1035,13 @@ std::unique_ptr<FunctionNode> Parser::parseFunctionDeclaration()
     consume(TokenType::Declaration, "function", "Expected 'function' keyword");
 
     // Get the function name
-    std::string functionName =
-        consume(TokenType::Identifier, "", "Expected function name").value;
+    std::string functionName(consume(TokenType::Identifier, "", "Expected function name").value());
 
     // Consume the opening parenthesis '(' of the parameter list
     consume(TokenType::Punctuator, "(", "Expected '(' after function name");
 
     // Parse function parameters
-    std::vector<std::unique_ptr<FunctionParameterNode>> parameters;
+    NodeList<FunctionParameterNode> parameters;
     if (!check(TokenType::Punctuator, ")"))
     {
         do
@@ -1059,7 +1059,7 @@ std::unique_ptr<FunctionNode> Parser::parseFunctionDeclaration()
     auto functionNode =
         std::make_unique<FunctionNode>(functionName, previous().line);
     functionNode->parameters = std::move(parameters);
-    functionNode->body = std::move(body);
+    functionNode->body = AstArena::share(std::move(body));
     functionNode->returnType = returnType;
     functionNode->isAsync = isAsync;
 
@@ -1072,8 +1072,8 @@ Parser::parseVariableDeclaration(std::string type)
     bool isConst = match(TokenType::Keyword, "const");
 
     // First, correctly parse the type
-    auto variableName =
-        consume(TokenType::Identifier, "", "Expected identifier").value;
+    std::string variableName(
+        consume(TokenType::Identifier, "", "Expected identifier").value());
     std::string typeName = type;
     if (!isType(typeName))
     {
@@ -1090,7 +1090,7 @@ Parser::parseVariableDeclaration(std::string type)
     }
 
     // Consume the semicolon if present
-    if (peek().type == TokenType::Punctuator && peek().value == ";")
+    if (peek().type == TokenType::Punctuator && peek().value() == ";")
     {
         advance(); // Consume the semicolon
     }
@@ -1098,7 +1098,7 @@ Parser::parseVariableDeclaration(std::string type)
     {
         std::cout << "Expected ';' after variable declaration, got: "
                   << "Type: " << static_cast<int>(peek().type)
-                  << ", Value: '" << peek().value << "'" << std::endl;
+                  << ", Value: '" << peek().value() << "'" << std::endl;
     }
 
     std::unique_ptr<VariableDeclarationNode> node =
@@ -1115,8 +1115,7 @@ std::unique_ptr<InterfaceNode> Parser::parseInterfaceDeclaration()
     consume(TokenType::Keyword, "interface", "Expected 'interface'");
 
     // Get the interface name
-    std::string interfaceName =
-        consume(TokenType::Identifier, "Expected interface name", "").value;
+    std::string interfaceName(consume(TokenType::Identifier, "Expected interface name", "").value());
 
     // Add the class name to declaredClasses
     declaredInterfaces.insert(interfaceName);
@@ -1159,8 +1158,7 @@ std::unique_ptr<ASTNode> Parser::parseInterfaceMember()
     else
     {
 
-        std::string propertyName =
-            consume(TokenType::Identifier, "Expected property name", "").value;
+        std::string propertyName(consume(TokenType::Identifier, "Expected property name", "").value());
 
         // Optional: Parse property type if it follows the property name
         std::unique_ptr<TypeNode> propertyType;
@@ -1199,7 +1197,7 @@ std::unique_ptr<BlockStatementNode> Parser::parseBlockStatement()
         try
         {
             block->statements.push_back(std::unique_ptr<StatementNode>(
-                dynamic_cast<StatementNode *>(parseDeclaration().release())));
+                nodeCast<StatementNode>(parseDeclaration().release())));
         }
         catch (const std::runtime_error &e)
         {
@@ -1235,7 +1233,7 @@ std::unique_ptr<IfStatementNode> Parser::parseIfStatement()
     {
         auto elseStatement = parseStatement();
         elseBranch = std::unique_ptr<StatementNode>(
-            dynamic_cast<StatementNode *>(elseStatement.release()));
+            nodeCast<StatementNode>(elseStatement.release()));
         if (!elseBranch)
         {
             error("Expected a statement for the 'else' branch");
@@ -1260,9 +1258,9 @@ std::unique_ptr<ForStatementNode> Parser::parseForStatement()
 
     // Parse the initializer
     std::unique_ptr<StatementNode> initializer;
-    if (isType(peek().value)) // Check for type names like "int", "string", etc.
+    if (isType(peek().value())) // Check for type names like "int", "string", etc.
     {
-        std::string typeName = peek().value;
+        std::string typeName(peek().value());
         advance(); // Consume the type
         initializer = parseVariableDeclaration(typeName);
     }
@@ -1277,7 +1275,7 @@ std::unique_ptr<ForStatementNode> Parser::parseForStatement()
     {
         auto expr = parseExpression();
         condition = std::unique_ptr<ExpressionNode>(
-            dynamic_cast<ExpressionNode *>(expr.release()));
+            nodeCast<ExpressionNode>(expr.release()));
         if (!condition)
         {
             error("Expected a valid expression for the condition");
@@ -1291,7 +1289,7 @@ std::unique_ptr<ForStatementNode> Parser::parseForStatement()
     {
         auto expr = parseExpression();
         increment = std::unique_ptr<ExpressionNode>(
-            dynamic_cast<ExpressionNode *>(expr.release()));
+            nodeCast<ExpressionNode>(expr.release()));
         if (!increment)
         {
             error("Expected a valid expression for the increment");
@@ -1318,7 +1316,7 @@ std::unique_ptr<StatementNode> Parser::parseExpressionStatement()
     auto expr = parseExpression();
 
     // Consume the semicolon if present
-    if (peek().type == TokenType::Punctuator && peek().value == ";")
+    if (peek().type == TokenType::Punctuator && peek().value() == ";")
     {
         advance(); // Consume the semicolon
     }
@@ -1326,7 +1324,7 @@ std::unique_ptr<StatementNode> Parser::parseExpressionStatement()
     {
         std::cout << "Expected ';' after expression, got: "
                   << "Type: " << static_cast<int>(peek().type)
-                  << ", Value: '" << peek().value << "'" << std::endl;
+                  << ", Value: '" << peek().value() << "'" << std::endl;
     }
 
     // Return the expression wrapped in a StatementNode
@@ -1371,7 +1369,7 @@ std::unique_ptr<ReturnStatementNode> Parser::parseReturnStatement()
 
         // Cast the ASTNode to ExpressionNode
         returnValue = std::unique_ptr<ExpressionNode>(
-            dynamic_cast<ExpressionNode *>(expr.release()));
+            nodeCast<ExpressionNode>(expr.release()));
         if (!returnValue)
         {
             error("Invalid expression in return statement");
@@ -1416,62 +1414,62 @@ std::unique_ptr<ContinueStatementNode> Parser::parseContinueStatement()
 
 std::unique_ptr<SwitchStatementNode> Parser::parseSwitchStatement()
 {
-    DEBUG_LOG("=== Starting parseSwitchStatement ===");
-    DEBUG_LOG("Current token before consume: type=", static_cast<int>(peek().type), " value='", peek().value, "'");
+    TRACE(Parser, Debug, "=== Starting parseSwitchStatement ===");
+    TRACE(Parser, Debug, "Current token before consume: type=", static_cast<int>(peek().type), " value='", peek().value(), "'");
 
     // Debug the check() method result
-    DEBUG_LOG("check(TokenType::Keyword, 'switch') = ", check(TokenType::Keyword, "switch"));
-    DEBUG_LOG("TokenType::Keyword = ", static_cast<int>(TokenType::Keyword));
+    TRACE(Parser, Debug, "check(TokenType::Keyword, 'switch') = ", check(TokenType::Keyword, "switch"));
+    TRACE(Parser, Debug, "TokenType::Keyword = ", static_cast<int>(TokenType::Keyword));
 
     // Consume the 'switch' keyword
     try
     {
         consume(TokenType::Keyword, "switch", "Expected 'switch' keyword in switch statement");
-        DEBUG_LOG("Successfully consumed 'switch' keyword");
+        TRACE(Parser, Debug, "Successfully consumed 'switch' keyword");
     }
     catch (const std::exception &e)
     {
-        DEBUG_LOG("ERROR: Failed to consume switch keyword: ", e.what());
+        TRACE(Parser, Debug, "ERROR: Failed to consume switch keyword: ", e.what());
         throw;
     }
 
     // Continue with the rest of the method...
-    DEBUG_LOG("About to consume opening parenthesis");
+    TRACE(Parser, Debug, "About to consume opening parenthesis");
     consume(TokenType::Punctuator, "(", "Expected '(' after 'switch'");
-    DEBUG_LOG("Successfully consumed opening parenthesis");
+    TRACE(Parser, Debug, "Successfully consumed opening parenthesis");
 
-    DEBUG_LOG("About to parse control expression");
+    TRACE(Parser, Debug, "About to parse control expression");
     auto controlExpression = parseExpression();
-    DEBUG_LOG("Successfully parsed control expression");
+    TRACE(Parser, Debug, "Successfully parsed control expression");
 
     consume(TokenType::Punctuator, ")", "Expected ')' after switch control expression");
-    DEBUG_LOG("Successfully consumed closing parenthesis");
+    TRACE(Parser, Debug, "Successfully consumed closing parenthesis");
 
     consume(TokenType::Punctuator, "{", "Expected '{' at the start of switch body");
-    DEBUG_LOG("Successfully consumed opening brace, about to parse cases");
+    TRACE(Parser, Debug, "Successfully consumed opening brace, about to parse cases");
 
-    std::vector<std::unique_ptr<CaseClauseNode>> cases;
+    NodeList<CaseClauseNode> cases;
     int caseCount = 0;
     while (!check(TokenType::Punctuator, "}") && !isAtEnd())
     {
-        DEBUG_LOG("Parsing case #", caseCount++);
-        DEBUG_LOG("Current token: type=", static_cast<int>(peek().type), " value='", peek().value, "'");
+        TRACE(Parser, Debug, "Parsing case #", caseCount++);
+        TRACE(Parser, Debug, "Current token: type=", static_cast<int>(peek().type), " value='", peek().value(), "'");
 
         cases.push_back(parseCaseClause());
-        DEBUG_LOG("Finished parsing case #", caseCount - 1);
+        TRACE(Parser, Debug, "Finished parsing case #", caseCount - 1);
     }
 
-    DEBUG_LOG("Finished parsing all cases, total count: ", cases.size());
+    TRACE(Parser, Debug, "Finished parsing all cases, total count: ", cases.size());
 
     consume(TokenType::Punctuator, "}", "Expected '}' at the end of switch body");
-    DEBUG_LOG("Successfully consumed closing brace, switch parsing complete");
+    TRACE(Parser, Debug, "Successfully consumed closing brace, switch parsing complete");
 
     std::unique_ptr<SwitchStatementNode> node =
         std::make_unique<SwitchStatementNode>(previous().line);
     node->condition = std::move(controlExpression);
     node->cases = std::move(cases);
 
-    DEBUG_LOG("=== Finished parseSwitchStatement ===");
+    TRACE(Parser, Debug, "=== Finished parseSwitchStatement ===");
     return node;
 }
 
@@ -1494,8 +1492,7 @@ std::unique_ptr<TryCatchNode> Parser::parseTryCatchStatement()
     // Parse the error type and variable name
     consume(TokenType::Identifier, "Error",
             "Expected 'Error' type in catch clause");
-    std::string errorVarName =
-        consume(TokenType::Identifier, "", "Expected error variable name").value;
+    std::string errorVarName(consume(TokenType::Identifier, "", "Expected error variable name").value());
 
     // Consume the closing parenthesis ')'
     consume(TokenType::Punctuator, ")", "Expected ')' after catch clause header");
@@ -1538,7 +1535,7 @@ std::unique_ptr<ExportNode> Parser::parseExportStatement()
         // Handle "export * from './module'"
         if (match(TokenType::Keyword, "from"))
         {
-            std::string moduleName = consume(TokenType::String, "", "Expected module name after 'from'").value;
+            std::string moduleName(consume(TokenType::String, "", "Expected module name after 'from'").value());
             auto reExportNode = std::make_unique<ReExportNode>(line);
             reExportNode->moduleName = moduleName;
             reExportNode->exportAll = true;
@@ -1556,13 +1553,13 @@ std::unique_ptr<ExportNode> Parser::parseExportStatement()
         std::vector<std::pair<std::string, std::string>> namedExports;
         do
         {
-            std::string originalName = consume(TokenType::Identifier, "", "Expected export name").value;
+            std::string originalName(consume(TokenType::Identifier, "", "Expected export name").value());
             std::string exportName = originalName;
 
             // Handle renamed exports: "export { a as b }"
             if (match(TokenType::Keyword, "as"))
             {
-                exportName = consume(TokenType::Identifier, "", "Expected export alias after 'as'").value;
+                exportName = consume(TokenType::Identifier, "", "Expected export alias after 'as'").value();
             }
 
             namedExports.push_back({originalName, exportName});
@@ -1573,7 +1570,7 @@ std::unique_ptr<ExportNode> Parser::parseExportStatement()
         // Check if it's a re-export with 'from'
         if (match(TokenType::Keyword, "from"))
         {
-            std::string moduleName = consume(TokenType::String, "", "Expected module name after 'from'").value;
+            std::string moduleName(consume(TokenType::String, "", "Expected module name after 'from'").value());
             auto reExportNode = std::make_unique<ReExportNode>(line);
             reExportNode->moduleName = moduleName;
             reExportNode->namedExports = std::move(namedExports);
@@ -1595,7 +1592,7 @@ std::unique_ptr<ExportNode> Parser::parseExportStatement()
 
     if (peek().type == TokenType::Keyword)
     {
-        const std::string &nextTokenValue = peek().value;
+        std::string nextTokenValue(peek().value());
         if (nextTokenValue == "class" || nextTokenValue == "function" ||
             nextTokenValue == "interface" || nextTokenValue == "template" ||
             nextTokenValue == "async")
@@ -1607,11 +1604,11 @@ std::unique_ptr<ExportNode> Parser::parseExportStatement()
             // For named exports, store the name
             if (!isDefault)
             {
-                if (auto *funcNode = dynamic_cast<FunctionNode *>(exportItem.get()))
+                if (auto *funcNode = nodeCast<FunctionNode>(exportItem.get()))
                 {
                     node->exportName = funcNode->name;
                 }
-                else if (auto *classNode = dynamic_cast<ClassNode *>(exportItem.get()))
+                else if (auto *classNode = nodeCast<ClassNode>(exportItem.get()))
                 {
                     node->exportName = classNode->name;
                 }
@@ -1619,11 +1616,11 @@ std::unique_ptr<ExportNode> Parser::parseExportStatement()
         }
         else
         {
-            exportItem = parseVariableDeclaration(peek().value);
+            exportItem = parseVariableDeclaration(std::string(peek().value()));
 
             if (!isDefault && exportItem)
             {
-                if (auto *varNode = dynamic_cast<VariableDeclarationNode *>(exportItem.get()))
+                if (auto *varNode = nodeCast<VariableDeclarationNode>(exportItem.get()))
                 {
                     node->exportName = varNode->name;
                 }
@@ -1663,7 +1660,7 @@ std::unique_ptr<ImportNode> Parser::parseImportStatement()
     {
         // This is a default import: "import defaultName from './module'"
         node->hasDefaultImport = true;
-        node->defaultImportName = consume(TokenType::Identifier, "", "Expected identifier for default import").value;
+        node->defaultImportName = consume(TokenType::Identifier, "", "Expected identifier for default import").value();
 
         // Check for named imports after default import: "import defaultName, { name1, name2 } from './module'"
         if (match(TokenType::Punctuator, ","))
@@ -1676,13 +1673,13 @@ std::unique_ptr<ImportNode> Parser::parseImportStatement()
             // Parse named imports
             do
             {
-                std::string originalName = consume(TokenType::Identifier, "", "Expected import name").value;
+                std::string originalName(consume(TokenType::Identifier, "", "Expected import name").value());
                 std::string localName = originalName;
 
                 // Handle renamed imports: "import { originalName as localName }"
                 if (match(TokenType::Keyword, "as"))
                 {
-                    localName = consume(TokenType::Identifier, "", "Expected local name after 'as'").value;
+                    localName = consume(TokenType::Identifier, "", "Expected local name after 'as'").value();
                 }
 
                 node->namedImports.push_back({originalName, localName});
@@ -1697,13 +1694,13 @@ std::unique_ptr<ImportNode> Parser::parseImportStatement()
         // This is a named import: "import { name1, name2 } from './module'"
         do
         {
-            std::string originalName = consume(TokenType::Identifier, "", "Expected import name").value;
+            std::string originalName(consume(TokenType::Identifier, "", "Expected import name").value());
             std::string localName = originalName;
 
             // Handle renamed imports: "import { originalName as localName }"
             if (match(TokenType::Keyword, "as"))
             {
-                localName = consume(TokenType::Identifier, "", "Expected local name after 'as'").value;
+                localName = consume(TokenType::Identifier, "", "Expected local name after 'as'").value();
             }
 
             node->namedImports.push_back({originalName, localName});
@@ -1716,7 +1713,7 @@ std::unique_ptr<ImportNode> Parser::parseImportStatement()
     {
         if (match(TokenType::Keyword, "as"))
         {
-            std::string namespaceName = consume(TokenType::Identifier, "", "Expected namespace name after 'as'").value;
+            std::string namespaceName(consume(TokenType::Identifier, "", "Expected namespace name after 'as'").value());
             node->hasDefaultImport = true;
             node->defaultImportName = namespaceName;
         }
@@ -1728,7 +1725,7 @@ std::unique_ptr<ImportNode> Parser::parseImportStatement()
     else
     {
         // This handles side-effect imports: "import './module';"
-        node->moduleName = consume(TokenType::String, "", "Expected module name").value;
+        node->moduleName = consume(TokenType::String, "", "Expected module name").value();
         consume(TokenType::Punctuator, ";", "Expected ';' after import statement");
         return node;
     }
@@ -1737,7 +1734,7 @@ std::unique_ptr<ImportNode> Parser::parseImportStatement()
     consume(TokenType::Keyword, "from", "Expected 'from' after import specifiers");
 
     // Parse the module name
-    node->moduleName = consume(TokenType::String, "", "Expected module name after 'from'").value;
+    node->moduleName = consume(TokenType::String, "", "Expected module name after 'from'").value();
 
     // Consume the end of statement token (semicolon)
     consume(TokenType::Punctuator, ";", "Expected ';' after import statement");
@@ -1748,7 +1745,7 @@ std::unique_ptr<ImportNode> Parser::parseImportStatement()
 std::unique_ptr<CallExpressionNode>
 Parser::parseCallExpression(std::unique_ptr<ExpressionNode> callee)
 {
-    std::vector<std::unique_ptr<ExpressionNode>> arguments;
+    NodeList<ExpressionNode> arguments;
     if (!check(TokenType::Punctuator, ")"))
     {
         do
@@ -1768,7 +1765,7 @@ Parser::parseMemberAccessExpression(std::unique_ptr<ExpressionNode> object)
 {
     auto memberNameToken =
         consume(TokenType::Identifier, "", "Expected member name after '.'");
-    std::string memberName = memberNameToken.value;
+    std::string memberName(memberNameToken.value());
 
     auto node =
         std::make_unique<MemberAccessExpressionNode>(memberNameToken.line);
@@ -1784,13 +1781,12 @@ std::unique_ptr<ExpressionNode> Parser::parseAnonymousFunction()
 
     consume(TokenType::Punctuator, "(", "Expected '(' after 'function'");
 
-    std::vector<std::unique_ptr<FunctionParameterNode>> parameters;
+    NodeList<FunctionParameterNode> parameters;
     if (!check(TokenType::Punctuator, ")"))
     {
         do
         {
-            std::string paramName =
-                consume(TokenType::Identifier, "", "Expected parameter name").value;
+            std::string paramName(consume(TokenType::Identifier, "", "Expected parameter name").value());
             // If your language supports types for parameters, parse the type here
             parameters.push_back(
                 std::make_unique<FunctionParameterNode>(paramName, previous().line));
@@ -1816,7 +1812,7 @@ std::unique_ptr<ExpressionNode> Parser::parseLiteral()
     if (previous().type == TokenType::Number)
     {
         // For numeric literals (integers, floats, doubles)
-        std::string value = previous().value;
+        std::string value(previous().value());
         if (value.find('.') != std::string::npos)
         {
             // Contains a decimal point, treat as a floating point or double
@@ -1831,27 +1827,27 @@ std::unique_ptr<ExpressionNode> Parser::parseLiteral()
     else if (previous().type == TokenType::String)
     {
         // For string literals
-        return std::make_unique<StringLiteralNode>(previous().value,
+        return std::make_unique<StringLiteralNode>(std::string(previous().value()),
                                                    previous().line);
     }
     else if ((previous().type == TokenType::Keyword &&
-              previous().value == "true") ||
+              previous().value() == "true") ||
              (previous().type == TokenType::Keyword &&
-              previous().value == "false"))
+              previous().value() == "false"))
     {
         // For boolean literals
-        bool value = previous().value == "true";
+        bool value = previous().value() == "true";
         return std::make_unique<BooleanLiteralNode>(value, previous().line);
     }
     else if ((previous().type == TokenType::Keyword &&
-              previous().value == "null"))
+              previous().value() == "null"))
     {
         // For null literals
         return std::make_unique<NullLiteralNode>(previous().line);
     }
     else if (previous().type == TokenType::Character)
     {
-        char value = previous().value[0];
+        char value = previous().value()[0];
         return std::make_unique<CharLiteralNode>(value, previous().line);
     }
     // Add more cases as needed for other types of literals
@@ -1865,14 +1861,14 @@ std::unique_ptr<ArrayLiteralNode> Parser::parseArrayLiteral()
     consume(TokenType::Punctuator, "[",
             "Expected '[' at the start of array literal");
 
-    std::vector<std::unique_ptr<ExpressionNode>> elements;
+    NodeList<ExpressionNode> elements;
     if (!check(TokenType::Punctuator, "]"))
     {
         do
         {
             auto element = parseExpression();
             elements.push_back(std::unique_ptr<ExpressionNode>(
-                dynamic_cast<ExpressionNode *>(element.release())));
+                nodeCast<ExpressionNode>(element.release())));
             if (!elements.back())
             {
                 std::cout << "Expected expression in array literal" << std::endl;
@@ -1906,7 +1902,7 @@ std::unique_ptr<ObjectLiteralNode> Parser::parseObjectLiteral()
             std::string key;
             if (match(TokenType::String, "") || match(TokenType::Identifier, ""))
             {
-                key = previous().value;
+                key = previous().value();
             }
             else
             {
@@ -1938,7 +1934,7 @@ std::unique_ptr<TypeNode> Parser::parseType()
 {
     auto typeToken = consume(TokenType::Keyword, "", "Expected a type");
 
-    std::string typeName = typeToken.value;
+    std::string typeName(typeToken.value());
     if (typeName == "bool" || typeName == "char" || typeName == "int" ||
         typeName == "float" || typeName == "double" || typeName == "void" ||
         typeName == "wchar_t" || typeName == "string" || typeName == "Error" ||
@@ -1954,19 +1950,19 @@ std::unique_ptr<TypeNode> Parser::parseType()
     }
 }
 
-bool Parser::isClassName(const std::string &name)
+bool Parser::isClassName(std::string_view name)
 {
     return declaredClasses.find(name) != declaredClasses.end();
 }
 
-bool Parser::isInterfaceName(const std::string &name)
+bool Parser::isInterfaceName(std::string_view name)
 {
     return declaredInterfaces.find(name) != declaredInterfaces.end();
 }
 
-std::vector<std::unique_ptr<FunctionParameterNode>> Parser::parseParameters()
+NodeList<FunctionParameterNode> Parser::parseParameters()
 {
-    std::vector<std::unique_ptr<FunctionParameterNode>> parameters;
+    NodeList<FunctionParameterNode> parameters;
 
     consume(TokenType::Punctuator, "(",
             "Expected '(' at the start of parameters");
@@ -1979,8 +1975,7 @@ std::vector<std::unique_ptr<FunctionParameterNode>> Parser::parseParameters()
             auto type = parseType();
 
             // Parse the name of the parameter
-            std::string paramName =
-                consume(TokenType::Identifier, "", "Expected parameter name").value;
+            std::string paramName(consume(TokenType::Identifier, "", "Expected parameter name").value());
 
             // Create a FunctionParameterNode and add it to the parameters vector
             std::unique_ptr<FunctionParameterNode> parameter =
@@ -2008,8 +2003,8 @@ std::unique_ptr<AwaitExpressionNode> Parser::parseAwaitExpression()
 
 std::unique_ptr<CaseClauseNode> Parser::parseCaseClause()
 {
-    DEBUG_LOG("=== Starting parseCaseClause ===");
-    DEBUG_LOG("Current token: type=", static_cast<int>(peek().type), " value='", peek().value, "'");
+    TRACE(Parser, Debug, "=== Starting parseCaseClause ===");
+    TRACE(Parser, Debug, "Current token: type=", static_cast<int>(peek().type), " value='", peek().value(), "'");
 
     std::unique_ptr<ExpressionNode> caseExpression;
     bool isDefault = false;
@@ -2017,33 +2012,33 @@ std::unique_ptr<CaseClauseNode> Parser::parseCaseClause()
 
     if (match(TokenType::Keyword, "case"))
     {
-        DEBUG_LOG("Matched 'case' keyword");
+        TRACE(Parser, Debug, "Matched 'case' keyword");
         auto expr = parseExpression();
         caseExpression = std::unique_ptr<ExpressionNode>(
-            dynamic_cast<ExpressionNode *>(expr.release()));
+            nodeCast<ExpressionNode>(expr.release()));
         if (!caseExpression)
         {
             std::cout << "Expected expression after 'case'" << std::endl;
             throw std::runtime_error("Expected expression after 'case'");
         }
-        DEBUG_LOG("Parsed case expression");
+        TRACE(Parser, Debug, "Parsed case expression");
     }
     else if (match(TokenType::Keyword, "default"))
     {
-        DEBUG_LOG("Matched 'default' keyword");
+        TRACE(Parser, Debug, "Matched 'default' keyword");
         isDefault = true;
     }
     else
     {
-        DEBUG_LOG("ERROR: Expected 'case' or 'default', got: type=", static_cast<int>(peek().type), " value='", peek().value, "'");
+        TRACE(Parser, Debug, "ERROR: Expected 'case' or 'default', got: type=", static_cast<int>(peek().type), " value='", peek().value(), "'");
         std::cout << "Expected 'case' or 'default' keyword" << std::endl;
         throw std::runtime_error("Expected 'case' or 'default' keyword");
     }
 
     consume(TokenType::Punctuator, ":", "Expected ':' after case value");
-    DEBUG_LOG("Consumed colon, about to parse case statements");
+    TRACE(Parser, Debug, "Consumed colon, about to parse case statements");
 
-    std::vector<std::unique_ptr<StatementNode>> statements;
+    NodeList<StatementNode> statements;
     int statementCount = 0;
 
     // Parse statements until we hit another case, default, closing brace, or EOF
@@ -2052,55 +2047,55 @@ std::unique_ptr<CaseClauseNode> Parser::parseCaseClause()
            !check(TokenType::Punctuator, "}") &&
            !isAtEnd())
     {
-        DEBUG_LOG("Parsing statement #", statementCount++, " in case");
-        DEBUG_LOG("Current token before statement: type=", static_cast<int>(peek().type), " value='", peek().value, "'");
+        TRACE(Parser, Debug, "Parsing statement #", statementCount++, " in case");
+        TRACE(Parser, Debug, "Current token before statement: type=", static_cast<int>(peek().type), " value='", peek().value(), "'");
 
         try
         {
             auto astNode = parseStatement();
-            DEBUG_LOG("parseStatement() returned successfully, checking type...");
+            TRACE(Parser, Debug, "parseStatement() returned successfully, checking type...");
 
             // Debug: Print the actual type of the returned node
-            DEBUG_LOG("Returned node type: ", typeid(*astNode).name());
+            TRACE(Parser, Debug, "Returned node type: ", typeid(*astNode).name());
 
-            StatementNode *statementNode = dynamic_cast<StatementNode *>(astNode.get());
+            StatementNode *statementNode = nodeCast<StatementNode>(astNode.get());
             if (statementNode)
             {
                 statements.push_back(std::unique_ptr<StatementNode>(statementNode));
                 astNode.release(); // Release ownership from the original unique_ptr
-                DEBUG_LOG("Successfully added statement to case");
+                TRACE(Parser, Debug, "Successfully added statement to case");
             }
             else
             {
-                DEBUG_LOG("ERROR: Dynamic cast to StatementNode failed");
-                DEBUG_LOG("Actual node type: ", typeid(*astNode).name());
+                TRACE(Parser, Debug, "ERROR: Dynamic cast to StatementNode failed");
+                TRACE(Parser, Debug, "Actual node type: ", typeid(*astNode).name());
                 std::cout << "Expected a statement node" << std::endl;
                 throw std::runtime_error("Expected a statement node");
             }
         }
         catch (const std::exception &e)
         {
-            DEBUG_LOG("ERROR in parseStatement(): ", e.what());
+            TRACE(Parser, Debug, "ERROR in parseStatement(): ", e.what());
             throw;
         }
 
-        DEBUG_LOG("Current token after statement: type=", static_cast<int>(peek().type), " value='", peek().value, "'");
+        TRACE(Parser, Debug, "Current token after statement: type=", static_cast<int>(peek().type), " value='", peek().value(), "'");
     }
 
-    DEBUG_LOG("Finished parsing case statements, count: ", statements.size());
-    DEBUG_LOG("Exit condition: case=", check(TokenType::Keyword, "case"),
+    TRACE(Parser, Debug, "Finished parsing case statements, count: ", statements.size());
+    TRACE(Parser, Debug, "Exit condition: case=", check(TokenType::Keyword, "case"),
               " default=", check(TokenType::Keyword, "default"),
               " brace=", check(TokenType::Punctuator, "}"),
               " EOF=", isAtEnd());
 
     if (isDefault)
     {
-        DEBUG_LOG("Creating default case node");
+        TRACE(Parser, Debug, "Creating default case node");
         return std::make_unique<CaseClauseNode>(std::move(statements), line);
     }
     else
     {
-        DEBUG_LOG("Creating regular case node");
+        TRACE(Parser, Debug, "Creating regular case node");
         return std::make_unique<CaseClauseNode>(std::move(caseExpression),
                                                 std::move(statements), line);
     }
@@ -2114,9 +2109,8 @@ std::unique_ptr<TemplateNode> Parser::parseTemplateDeclaration()
     std::vector<std::string> templateParams;
     do
     {
-        std::string paramName =
-            consume(TokenType::Identifier, "", "Expected template parameter name")
-                .value;
+        std::string paramName(consume(TokenType::Identifier, "", "Expected template parameter name")
+                .value());
         templateParams.push_back(paramName);
     } while (match(TokenType::Punctuator, ","));
     consume(TokenType::Punctuator, ">", "Expected '>' after template parameters");
@@ -9,18 +9,21 @@ class Parser
 {
 public:
   Parser(const std::vector<Token> &tokens) : tokens(tokens), current(0) {}
+  // Pulls the tokens from the tokenizer while parsing, so they are never all
+  // held at once
+  Parser(Tokenizer &tokenizer) : tokens(tokenizer), current(0) {}
 
   std::unique_ptr<ProgramNode> parse();
 
 private:
-  const std::vector<Token> &tokens;
-  std::set<std::string> declaredClasses;
-  std::set<std::string> declaredInterfaces;
+  mutable TokenStream tokens;
+  std::set<std::string, std::less<>> declaredClasses;
+  std::set<std::string, std::less<>> declaredInterfaces;
 
   int current;
 
   // Utility methods
-  bool match(TokenType type, const std::string &expectedValue)
+  bool match(TokenType type, std::string_view expectedValue)
   {
     if (check(type, expectedValue))
     {
@@ -30,7 +33,7 @@ private:
     return false;
   }
 
-  Token consume(TokenType type, const std::string &expectedValue,
+  const Token &consume(TokenType type, std::string_view expectedValue,
                 const std::string &errorMessage)
   {
     if (check(type, expectedValue))
@@ -44,64 +47,50 @@ private:
     }
   }
 
-  bool check(TokenType type, const std::string &expectedValue)
+  bool check(TokenType type, std::string_view expectedValue)
   {
     if (isAtEnd())
       return false;
 
-    DEBUG_LOG("check() - Checking token: type=", static_cast<int>(peek().type),
-              " value='", peek().value, "' against expected type=", static_cast<int>(type),
+    TRACE(Parser, Verbose, "check() - Checking token: type=", static_cast<int>(peek().type),
+              " value='", peek().value(), "' against expected type=", static_cast<int>(type),
               " value='", expectedValue, "'");
 
-    if (expectedValue != "")
+    if (!expectedValue.empty())
     {
       bool typeMatch = peek().type == type;
-      bool valueMatch = peek().value == expectedValue;
-      DEBUG_LOG("check() - Type match: ", typeMatch, " Value match: ", valueMatch);
+      bool valueMatch = peek().value() == expectedValue;
+      TRACE(Parser, Verbose, "check() - Type match: ", typeMatch, " Value match: ", valueMatch);
       return typeMatch && valueMatch;
     }
     else
     {
       bool typeMatch = peek().type == type;
-      DEBUG_LOG("check() - Type match only: ", typeMatch);
+      TRACE(Parser, Verbose, "check() - Type match only: ", typeMatch);
       return typeMatch;
     }
   }
 
-  Token advance()
+  const Token &advance()
   {
     if (!isAtEnd())
       current++;
     return previous();
   }
 
-  Token peek() const { return tokens[current]; }
+  const Token &peek() const { return tokens[current]; }
 
-  Token previous() { return tokens[current - 1]; }
+  const Token &previous() const { return tokens[current - 1]; }
   bool isAtEnd() const;
   void error(const std::string &message);
-  bool isType(const std::string &keyword);
-  bool isClassName(const std::string &name);
-  bool isInterfaceName(const std::string &name);
+  bool isType(std::string_view keyword);
+  bool isClassName(std::string_view name);
+  bool isInterfaceName(std::string_view name);
 
-  Token peekNext() const
-  {
-    if (current + 1 < tokens.size())
-    {
-      return tokens[current + 1];
-    }
-    return tokens
-        .back(); // Return the last token if there are no more tokens ahead
-  }
+  // Past the end these return the EndOfFile token
+  const Token &peekNext() const { return tokens[current + 1]; }
 
-  Token peekNextNext() const
-  {
-    if (current + 2 >= tokens.size())
-    {
-      return tokens.back(); // Return the last token if out of range
-    }
-    return tokens[current + 2];
-  }
+  const Token &peekNextNext() const { return tokens[current + 2]; }
 
   // Main Parsing Methods
   std::unique_ptr<ASTNode> parseDeclaration();
@@ -161,7 +150,7 @@ private:
 
   // Utility Parsing Methods
   std::unique_ptr<TypeNode> parseType();
-  std::vector<std::unique_ptr<FunctionParameterNode>> parseParameters();
+  NodeList<FunctionParameterNode> parseParameters();
   std::unique_ptr<AwaitExpressionNode> parseAwaitExpression();
   std::unique_ptr<CaseClauseNode> parseCaseClause();
   std::unique_ptr<StatementNode> parseExpressionStatement();
@@ -0,0 +1,212 @@
+#pragma once
+
+// Character classes and the run-finding primitives the Tokenizer is built on.
+// The run finders look at a whole SSE2 (or, when compiled with -mavx2, AVX2)
+// block of source per step and fall back to a byte loop for the tail and on
+// other targets.
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#define EDU_SCAN_SIMD 1
+#endif
+
+struct CharClass
+{
+  enum : uint8_t
+  {
+    Space = 1 << 0,         // What isspace() accepts in the C locale
+    Newline = 1 << 1,       // '\n', which also counts as Space
+    IdentifierStart = 1 << 2,
+    IdentifierPart = 1 << 3,
+    Digit = 1 << 4,
+    OperatorStart = 1 << 5,
+    Punctuator = 1 << 6,
+    Known = 1 << 7 // Characters the language uses at all; the rest are reported
+  };
+};
+
+constexpr std::array<uint8_t, 256> makeCharClasses()
+{
+  std::array<uint8_t, 256> classes{};
+  auto add = [&classes](const char *chars, uint8_t cls) {
+    for (; *chars; chars++)
+    {
+      classes[static_cast<unsigned char>(*chars)] |= cls;
+    }
+  };
+  add(" \t\n\v\f\r", CharClass::Space);
+  add("\n", CharClass::Newline);
+  add("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_", CharClass::IdentifierStart | CharClass::IdentifierPart);
+  add("0123456789", CharClass::Digit | CharClass::IdentifierPart);
+  add("+-*/%=&|<>!.", CharClass::OperatorStart);
+  add(";,(){}[]:", CharClass::Punctuator);
+  add("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
+      "+-*/%=&|<>!.,;()[]{}: \t\n'\"\\`",
+      CharClass::Known);
+  return classes;
+}
+
+inline constexpr std::array<uint8_t, 256> charClasses = makeCharClasses();
+
+inline bool hasClass(char ch, uint8_t classes)
+{
+  return charClasses[static_cast<unsigned char>(ch)] & classes;
+}
+
+#ifdef EDU_SCAN_SIMD
+// One block of source bytes, and a bitmask with one bit per byte of it
+#ifdef __AVX2__
+using ScanBlock = __m256i;
+using ScanMask = uint32_t;
+inline constexpr size_t scanBlockSize = 32;
+inline ScanBlock scanLoad(const char *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+inline ScanBlock scanSplat(char ch) { return _mm256_set1_epi8(ch); }
+inline ScanBlock scanEqual(ScanBlock a, ScanBlock b) { return _mm256_cmpeq_epi8(a, b); }
+inline ScanBlock scanOr(ScanBlock a, ScanBlock b) { return _mm256_or_si256(a, b); }
+inline ScanBlock scanAnd(ScanBlock a, ScanBlock b) { return _mm256_and_si256(a, b); }
+inline ScanBlock scanSub(ScanBlock a, ScanBlock b) { return _mm256_sub_epi8(a, b); }
+inline ScanBlock scanMin(ScanBlock a, ScanBlock b) { return _mm256_min_epu8(a, b); }
+inline ScanMask scanBits(ScanBlock block) { return static_cast<ScanMask>(_mm256_movemask_epi8(block)); }
+#else
+using ScanBlock = __m128i;
+using ScanMask = uint32_t;
+inline constexpr size_t scanBlockSize = 16;
+inline ScanBlock scanLoad(const char *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+inline ScanBlock scanSplat(char ch) { return _mm_set1_epi8(ch); }
+inline ScanBlock scanEqual(ScanBlock a, ScanBlock b) { return _mm_cmpeq_epi8(a, b); }
+inline ScanBlock scanOr(ScanBlock a, ScanBlock b) { return _mm_or_si128(a, b); }
+inline ScanBlock scanAnd(ScanBlock a, ScanBlock b) { return _mm_and_si128(a, b); }
+inline ScanBlock scanSub(ScanBlock a, ScanBlock b) { return _mm_sub_epi8(a, b); }
+inline ScanBlock scanMin(ScanBlock a, ScanBlock b) { return _mm_min_epu8(a, b); }
+inline ScanMask scanBits(ScanBlock block) { return static_cast<ScanMask>(_mm_movemask_epi8(block)); }
+#endif
+
+inline ScanBlock scanEqual(ScanBlock block, char ch) { return scanEqual(block, scanSplat(ch)); }
+
+// Bytes in [low, high], compared unsigned
+inline ScanBlock scanInRange(ScanBlock block, char low, char high)
+{
+  ScanBlock shifted = scanSub(block, scanSplat(low));
+  return scanEqual(scanMin(shifted, scanSplat(static_cast<char>(high - low))), shifted);
+}
+#endif
+
+// First byte in [p, end) that can't continue an identifier
+inline const char *skipIdentifier(const char *p, const char *end)
+{
+#ifdef EDU_SCAN_SIMD
+  while (p + scanBlockSize <= end)
+  {
+    ScanBlock bytes = scanLoad(p);
+    // Setting 0x20 folds upper case letters onto lower case ones
+    ScanBlock part = scanOr(scanInRange(scanOr(bytes, scanSplat(0x20)), 'a', 'z'),
+                            scanOr(scanInRange(bytes, '0', '9'), scanEqual(bytes, '_')));
+    ScanMask stops = ~scanBits(part);
+    if constexpr (scanBlockSize < 32)
+    {
+      stops &= (ScanMask(1) << scanBlockSize) - 1;
+    }
+    if (stops)
+    {
+      return p + std::countr_zero(stops);
+    }
+    p += scanBlockSize;
+  }
+#endif
+  while (p < end && hasClass(*p, CharClass::IdentifierPart))
+  {
+    p++;
+  }
+  return p;
+}
+
+// First quote or backslash in [p, end), or end
+inline const char *findQuoteOrBackslash(const char *p, const char *end, char quote)
+{
+#ifdef EDU_SCAN_SIMD
+  while (p + scanBlockSize <= end)
+  {
+    ScanBlock bytes = scanLoad(p);
+    ScanMask hits = scanBits(scanOr(scanEqual(bytes, quote), scanEqual(bytes, '\\')));
+    if (hits)
+    {
+      return p + std::countr_zero(hits);
+    }
+    p += scanBlockSize;
+  }
+#endif
+  while (p < end && *p != quote && *p != '\\')
+  {
+    p++;
+  }
+  return p;
+}
+
+// First quote, character quote or slash in [p, end), or end: in code, the
+// only characters that can start a literal or a comment
+inline const char *findLiteralOrCommentStart(const char *p, const char *end)
+{
+#ifdef EDU_SCAN_SIMD
+  while (p + scanBlockSize <= end)
+  {
+    ScanBlock bytes = scanLoad(p);
+    ScanMask hits = scanBits(scanOr(scanOr(scanEqual(bytes, '"'), scanEqual(bytes, '\'')),
+                                    scanEqual(bytes, '/')));
+    if (hits)
+    {
+      return p + std::countr_zero(hits);
+    }
+    p += scanBlockSize;
+  }
+#endif
+  while (p < end && *p != '"' && *p != '\'' && *p != '/')
+  {
+    p++;
+  }
+  return p;
+}
+
+// The "*/" closing a block comment that starts before p, or end when there is
+// none. Adds the newlines skipped on the way to newlines
+inline const char *findCommentEnd(const char *p, const char *end, int &newlines)
+{
+#ifdef EDU_SCAN_SIMD
+  // The second load reads one byte ahead
+  while (p + scanBlockSize + 1 <= end)
+  {
+    ScanBlock bytes = scanLoad(p);
+    ScanMask hits = scanBits(scanAnd(scanEqual(bytes, '*'), scanEqual(scanLoad(p + 1), '/')));
+    ScanMask lines = scanBits(scanEqual(bytes, '\n'));
+    if (hits)
+    {
+      int offset = std::countr_zero(hits);
+      newlines += std::popcount(lines & ((ScanMask(1) << offset) - 1));
+      return p + offset;
+    }
+    newlines += std::popcount(lines);
+    p += scanBlockSize;
+  }
+#endif
+  for (; p + 1 < end; p++)
+  {
+    if (p[0] == '*' && p[1] == '/')
+    {
+      return p;
+    }
+    newlines += *p == '\n';
+  }
+  return end;
+}
+
+// The next newline in [p, end), or end
+inline const char *findNewline(const char *p, const char *end)
+{
+  // libc's memchr is already vectorised
+  const void *found = std::memchr(p, '\n', end - p);
+  return found ? static_cast<const char *>(found) : end;
+}
@@ -0,0 +1,88 @@
+#include "source.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../debug.h"
+
+SourceBuffer::~SourceBuffer()
+{
+    unmap();
+}
+
+SourceBuffer &SourceBuffer::operator=(SourceBuffer &&other) noexcept
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+    unmap();
+    bool ownsText = !other.mapping && other.view.data() == other.owned.data();
+    owned = std::move(other.owned);
+    mapping = other.mapping;
+    mappedSize = other.mappedSize;
+    // A short string moves its characters, so the view has to follow them
+    view = ownsText ? std::string_view(owned) : other.view;
+    other.mapping = nullptr;
+    other.mappedSize = 0;
+    other.view = {};
+    return *this;
+}
+
+void SourceBuffer::unmap()
+{
+    if (mapping)
+    {
+        munmap(mapping, mappedSize);
+        mapping = nullptr;
+        mappedSize = 0;
+    }
+}
+
+std::optional<SourceBuffer> SourceBuffer::map(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return std::nullopt;
+    }
+
+    SourceBuffer buffer;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+    {
+        void *mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED)
+        {
+            // The tokenizer reads front to back, so the kernel can read ahead
+            madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+            buffer.mapping = mapping;
+            buffer.mappedSize = info.st_size;
+            buffer.view = std::string_view(static_cast<const char *>(mapping), info.st_size);
+            close(fd);
+            TRACE(Parser, Debug, "Mapped ", info.st_size, " bytes of ", path);
+            return buffer;
+        }
+    }
+
+    // Not a regular file, or it can't be mapped: read it instead
+    std::string text;
+    char chunk[64 * 1024];
+    ssize_t count;
+    while ((count = read(fd, chunk, sizeof(chunk))) != 0)
+    {
+        if (count < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            close(fd);
+            return std::nullopt;
+        }
+        text.append(chunk, count);
+    }
+    close(fd);
+    return SourceBuffer(std::move(text));
+}
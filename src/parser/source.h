@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// The text of a source file. A file is memory-mapped where possible, so it is
+// read straight from the page cache without being copied; anything else (a
+// pipe, a string made by a test) is held in a std::string instead. A buffer
+// can also borrow text that outlives it.
+class SourceBuffer
+{
+public:
+  SourceBuffer() = default;
+  SourceBuffer(std::string text) : owned(std::move(text)), view(owned) {}
+  ~SourceBuffer();
+
+  // The contents of the file at path, or nothing when it can't be opened
+  static std::optional<SourceBuffer> map(const std::string &path);
+
+  static SourceBuffer borrow(std::string_view text)
+  {
+    SourceBuffer buffer;
+    buffer.view = text;
+    return buffer;
+  }
+
+  SourceBuffer(SourceBuffer &&other) noexcept { *this = std::move(other); }
+  SourceBuffer &operator=(SourceBuffer &&other) noexcept;
+  SourceBuffer(const SourceBuffer &) = delete;
+  SourceBuffer &operator=(const SourceBuffer &) = delete;
+
+  std::string_view text() const { return view; }
+  bool isMapped() const { return mapping != nullptr; }
+
+private:
+  std::string owned;
+  void *mapping = nullptr;
+  size_t mappedSize = 0;
+  std::string_view view;
+
+  void unmap();
+};
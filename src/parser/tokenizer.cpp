@@ -1,25 +1,94 @@
 #include "tokenizer.h"
+#include "scan.h"
+#include <algorithm>
+#include <thread>
 #include "../debug.h"
 
+struct KeywordEntry
+{
+    std::string_view text;
+    TokenType type = TokenType::Identifier;
+};
+
+// Declaration keywords are Declaration tokens, every other keyword a Keyword
+static constexpr KeywordEntry keywordList[] = {
+    {"class", TokenType::Declaration}, {"function", TokenType::Declaration},
+    {"const", TokenType::Declaration}, {"interface", TokenType::Declaration},
+    {"async", TokenType::Declaration},
+    {"bool", TokenType::Keyword}, {"char", TokenType::Keyword}, {"int", TokenType::Keyword},
+    {"float", TokenType::Keyword}, {"double", TokenType::Keyword}, {"void", TokenType::Keyword},
+    {"wchar_t", TokenType::Keyword}, {"string", TokenType::Keyword}, {"Error", TokenType::Keyword},
+    {"export", TokenType::Keyword}, {"extends", TokenType::Keyword}, {"await", TokenType::Keyword},
+    {"null", TokenType::Keyword}, {"true", TokenType::Keyword}, {"false", TokenType::Keyword},
+    {"try", TokenType::Keyword}, {"catch", TokenType::Keyword}, {"import", TokenType::Keyword},
+    {"from", TokenType::Keyword}, {"template", TokenType::Keyword}, {"copy", TokenType::Keyword},
+    {"for", TokenType::Keyword}, {"while", TokenType::Keyword}, {"if", TokenType::Keyword},
+    {"else", TokenType::Keyword}, {"switch", TokenType::Keyword}, {"case", TokenType::Keyword},
+    {"default", TokenType::Keyword}, {"break", TokenType::Keyword}, {"continue", TokenType::Keyword},
+    {"return", TokenType::Keyword}, {"throw", TokenType::Keyword}, {"print", TokenType::Keyword}};
+
+// A perfect hash for keywordList: the static_assert below fails when a new
+// keyword collides, and the multipliers have to be searched for again
+static constexpr size_t keywordSlots = 128;
+
+static constexpr size_t keywordHash(std::string_view word)
+{
+    return (word.size() + static_cast<unsigned char>(word.front()) * 13 +
+            static_cast<unsigned char>(word.back()) * 48) &
+           (keywordSlots - 1);
+}
+
+static constexpr std::array<KeywordEntry, keywordSlots> makeKeywordTable()
+{
+    std::array<KeywordEntry, keywordSlots> table{};
+    for (const KeywordEntry &keyword : keywordList)
+    {
+        table[keywordHash(keyword.text)] = keyword;
+    }
+    return table;
+}
+
+static constexpr std::array<KeywordEntry, keywordSlots> keywordTable = makeKeywordTable();
+
+static constexpr bool keywordHashIsPerfect()
+{
+    for (const KeywordEntry &keyword : keywordList)
+    {
+        if (keywordTable[keywordHash(keyword.text)].text != keyword.text)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(keywordHashIsPerfect(), "Two keywords share a slot of keywordTable");
+
+static TokenType classifyWord(std::string_view word)
+{
+    const KeywordEntry &entry = keywordTable[keywordHash(word)];
+    return entry.text == word ? entry.type : TokenType::Identifier;
+}
+
 Token Tokenizer::nextToken()
 {
     skipWhitespaceAndComments();
 
     if (position >= source.length())
     {
-        return {TokenType::EndOfFile, "", line};
+        return makeToken(TokenType::EndOfFile, position);
     }
 
     char currentChar = source[position];
 
     // Check for identifier or keyword
-    if (isalpha(currentChar) || currentChar == '_')
+    if (hasClass(currentChar, CharClass::IdentifierStart))
     {
         return identifierOrKeyword();
     }
 
     // Check for numeric literal
-    if (isdigit(currentChar))
+    if (hasClass(currentChar, CharClass::Digit))
     {
         return numericLiteral();
     }
@@ -36,25 +105,26 @@ Token Tokenizer::nextToken()
     }
 
     // Check for operators and punctuators
-    if (isOperatorOrPunctuatorStart(currentChar))
+    if (hasClass(currentChar, CharClass::OperatorStart | CharClass::Punctuator))
     {
         return operatorOrPunctuator();
     }
 
-    if (isUnknownCharacter(currentChar))
+    if (!hasClass(currentChar, CharClass::Known))
     {
-        std::cerr << "Error: Unknown character '" << currentChar << "' at line "
-                  << line << std::endl;
-        return {TokenType::Unknown, std::string(1, currentChar), line};
+        error(std::string("Unknown character '") + currentChar + "'");
+        return Token(TokenType::Unknown, source.substr(position, 1), line);
     }
 
-    return {TokenType::Unknown, std::string(1, currentChar), line};
+    return Token(TokenType::Unknown, source.substr(position, 1), line);
 }
 
 std::vector<Token> Tokenizer::tokenize()
 {
-    DEBUG_LOG("=== Starting tokenization ===");
+    TRACE(Tokenizer, Debug, "=== Starting tokenization ===");
     std::vector<Token> tokens;
+    // Roughly one token per four characters of typical source
+    tokens.reserve(source.size() / 4 + 1);
     Token token;
 
     do
@@ -64,24 +134,22 @@ std::vector<Token> Tokenizer::tokenize()
 
     } while (token.type != TokenType::EndOfFile);
 
-    DEBUG_LOG("=== Finished tokenization with ", tokens.size(), " tokens ===");
+    TRACE(Tokenizer, Debug, "=== Finished tokenization with ", tokens.size(), " tokens ===");
     return tokens;
 }
 
-bool Tokenizer::isKeyword(const std::string &value)
+void Tokenizer::error(std::string message)
 {
-    static const std::set<std::string> keywords = {
-        "bool", "char", "int", "float", "double", "void",
-        "wchar_t", "string", "Error", "interface", "function", "const",
-        "export", "extends", "async", "await", "null", "true",
-        "false", "try", "catch", "import", "from", "template",
-        "copy", "for", "while", "if", "else", "switch",
-        "case", "default", "break", "continue", "return", "try",
-        "catch", "throw", "print"
-        // Add other keywords specific to your language
-    };
-
-    return keywords.find(value) != keywords.end();
+    errorList.push_back({line, std::move(message)});
+    if (printErrors)
+    {
+        printError(errorList.back());
+    }
+}
+
+void Tokenizer::printError(const TokenizerError &error)
+{
+    std::cerr << "Error: " << error.message << " at line " << error.line << std::endl;
 }
 
 Token Tokenizer::characterLiteral()
@@ -89,139 +157,75 @@ Token Tokenizer::characterLiteral()
     position++; // Skip opening quote
     if (position >= source.length())
     {
-        std::cerr << "Error: Unterminated character literal at line " << line
-                  << std::endl;
-        return {TokenType::Unknown, "", line};
+        error("Unterminated character literal");
+        return Token(TokenType::Unknown, "", line);
     }
 
+    size_t start = position;
     char charValue = source[position++];
+    bool escaped = false;
 
     // Handle escape sequences in char literals if needed
     if (charValue == '\\' && position < source.length())
     {
         charValue = processEscapeSequence(source[position++]);
+        escaped = true;
     }
 
     if (position >= source.length() || source[position] != '\'')
     {
-        std::cerr << "Error: Unterminated character literal at line " << line
-                  << std::endl;
-        return {TokenType::Unknown, "", line};
+        error("Unterminated character literal");
+        return Token(TokenType::Unknown, "", line);
     }
 
     position++; // Skip closing quote
 
-    // Convert charValue to a string
-    return {TokenType::Character, std::string(1, charValue), line};
-}
-
-bool Tokenizer::isOperatorOrPunctuatorStart(char ch)
-{
-    return isOperator(ch) || isPunctuator(ch);
-}
-
-bool Tokenizer::isOperator(char ch)
-{
-    static const std::string opStartChars = "+-*/%=&|<>!.";
-    return opStartChars.find(ch) != std::string::npos;
-}
-
-bool Tokenizer::isUnknownCharacter(char ch)
-{
-    static const std::string validChars =
-        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
-        "+-*/%=&|<>!.,;()[]{}: \t\n" // Include ':' for generics syntax
-        "'\"\\`";                    // Include backtick (`) if template strings are supported
-
-    return validChars.find(ch) == std::string::npos;
+    if (escaped)
+    {
+        decoded.emplace_back(1, charValue);
+        return Token(TokenType::Character, decoded.back(), line);
+    }
+    return Token(TokenType::Character, source.substr(start, 1), line);
 }
 
 void Tokenizer::skipWhitespaceAndComments()
 {
-    while (position < source.length())
+    const char *begin = source.data();
+    const char *end = begin + source.size();
+    const char *p = begin + position;
+    while (p < end)
     {
-        if (isspace(source[position]))
+        if (hasClass(*p, CharClass::Space))
         {
             // Handle new lines
-            if (source[position] == '\n')
-            {
-                line++;
-            }
-            position++;
+            line += hasClass(*p, CharClass::Newline);
+            p++;
         }
-        else if (source[position] == '/' && position + 1 < source.length())
+        else if (*p == '/' && p + 1 < end && p[1] == '/')
         {
-            if (source[position + 1] == '/')
-            {
-                // Single-line comment
-                position += 2;
-                while (position < source.length() && source[position] != '\n')
-                {
-                    position++;
-                }
-            }
-            else if (source[position + 1] == '*')
-            {
-                // Multi-line comment
-                position += 2;
-                while (position + 1 < source.length() &&
-                       !(source[position] == '*' && source[position + 1] == '/'))
-                {
-                    if (source[position] == '\n')
-                    {
-                        line++;
-                    }
-                    position++;
-                }
-                if (position < source.length())
-                {
-                    position += 2; // Skip the closing '*/'
-                }
-            }
-            else
-            {
-                break; // Not a comment, so break out of the loop
-            }
+            // Single-line comment, up to the newline
+            p = findNewline(p + 2, end);
+        }
+        else if (*p == '/' && p + 1 < end && p[1] == '*')
+        {
+            // Multi-line comment
+            p = findCommentEnd(p + 2, end, line);
+            p = p < end ? p + 2 : end; // Skip the closing '*/'
         }
         else
         {
             break; // Not whitespace or comment, so break out of the loop
         }
     }
+    position = p - begin;
 }
 
 Token Tokenizer::identifierOrKeyword()
 {
-    size_t start = position++;
-    while (position < source.length() &&
-           (isalnum(source[position]) || source[position] == '_'))
-    {
-        position++;
-    }
-
-    std::string value = source.substr(start, position - start);
-
-    if (isDeclarationKeyword(value))
-    {
-        return {TokenType::Declaration, value, line};
-    }
-
-    if (isKeyword(value))
-    {
-        return {TokenType::Keyword, value, line};
-    }
-
-    return {TokenType::Identifier, value, line};
-}
-
-bool Tokenizer::isDeclarationKeyword(const std::string &value)
-{
-    static const std::set<std::string> declarationKeywords = {
-        "class", "function", "const", "interface",
-        "async" // Add other declaration keywords
-    };
-
-    return declarationKeywords.find(value) != declarationKeywords.end();
+    size_t start = position;
+    const char *begin = source.data();
+    position = skipIdentifier(begin + position + 1, begin + source.size()) - begin;
+    return makeToken(classifyWord(source.substr(start, position - start)), start);
 }
 
 Token Tokenizer::numericLiteral()
@@ -230,7 +234,7 @@ Token Tokenizer::numericLiteral()
     bool hasDecimalPoint = false;
 
     while (position < source.length() &&
-           (isdigit(source[position]) || source[position] == '.'))
+           (hasClass(source[position], CharClass::Digit) || source[position] == '.'))
     {
         if (source[position] == '.')
         {
@@ -241,39 +245,50 @@ Token Tokenizer::numericLiteral()
         position++;
     }
 
-    return {TokenType::Number, source.substr(start, position - start), line};
+    return makeToken(TokenType::Number, start);
 }
 
 Token Tokenizer::stringLiteral()
 {
     char quoteType = source[position++];
     size_t start = position;
-    std::string value;
+    bool escaped = false;
+    const char *begin = source.data();
+    const char *end = begin + source.size();
 
+    // Jump from one quote or backslash to the next; the escaped character
+    // after a backslash is skipped
+    position = findQuoteOrBackslash(begin + position, end, quoteType) - begin;
     while (position < source.length() && source[position] != quoteType)
     {
-        if (source[position] == '\\' && position + 1 < source.length())
-        {
-            position++;
-            value += processEscapeSequence(source[position]);
-        }
-        else
-        {
-            value += source[position];
-        }
-        position++;
+        escaped = true;
+        position += position + 1 < source.length() ? 2 : 1;
+        position = findQuoteOrBackslash(begin + std::min(position, source.size()), end, quoteType) - begin;
     }
 
-    if (position == source.length())
+    if (position >= source.length())
     {
-        std::cerr << "Error: Unterminated string literal at line " << line
-                  << std::endl;
-        return {TokenType::Unknown, "",
-                line}; // Or handle this error as appropriate
+        error("Unterminated string literal");
+        return Token(TokenType::Unknown, "",
+                     line); // Or handle this error as appropriate
     }
 
+    Token token = makeToken(TokenType::String, start);
     position++; // Skip the closing quote
-    return {TokenType::String, value, line};
+    if (!escaped)
+    {
+        return token;
+    }
+
+    // Only literals with escape sequences need a decoded copy
+    std::string value;
+    value.reserve(token.value().size());
+    for (size_t i = start; i < position - 1; i++)
+    {
+        value += source[i] == '\\' ? processEscapeSequence(source[++i]) : source[i];
+    }
+    decoded.push_back(std::move(value));
+    return makeToken(TokenType::String, decoded.back(), token.line);
 }
 
 char Tokenizer::processEscapeSequence(char escapedChar)
@@ -301,10 +316,10 @@ Token Tokenizer::operatorOrPunctuator()
     char currentChar = source[position];
 
     // Handle punctuators first (single characters)
-    if (isPunctuator(currentChar))
+    if (hasClass(currentChar, CharClass::Punctuator))
     {
         position++; // Advance position BEFORE creating token
-        return {TokenType::Punctuator, std::string(1, currentChar), line};
+        return makeToken(TokenType::Punctuator, position - 1);
     }
     else
     {
@@ -314,28 +329,198 @@ Token Tokenizer::operatorOrPunctuator()
 
         if (position < source.length())
         {
-            std::string potentialOperator = source.substr(start, 2);
-            if (isMultiCharacterOperator(potentialOperator))
+            if (isMultiCharacterOperator(currentChar, source[position]))
             {
                 position++; // Advance position for second character
-                return {TokenType::Operator, potentialOperator, line};
+                return makeToken(TokenType::Operator, start);
             }
         }
 
         // Single character operator
-        return {TokenType::Operator, std::string(1, currentChar), line};
+        return makeToken(TokenType::Operator, start);
     }
 }
 
-bool Tokenizer::isPunctuator(char ch)
+// Offsets roughly every chunkSize bytes at which the tokenizer is between
+// tokens: whitespace outside of literals and comments. The scan jumps from one
+// quote or slash to the next and skips literals and comments the way the
+// tokenizer does, including its handling of malformed ones
+static std::vector<size_t> findSplitPoints(std::string_view source, size_t chunkSize)
 {
-    static const std::string punctuators = ";,(){}[]:"; // Make sure colon is included!
-    return punctuators.find(ch) != std::string::npos;
+    std::vector<size_t> splits;
+    const char *begin = source.data();
+    const char *end = begin + source.size();
+    const char *p = begin;
+    const char *target = begin + chunkSize;
+    int newlines = 0; // Not needed, the pieces count their own lines
+    while (p < end)
+    {
+        const char *special = findLiteralOrCommentStart(p, end);
+        // Everything up to special is code, so any whitespace past the target
+        // will do
+        for (const char *q = std::max(p, target); q < special; q++)
+        {
+            if (hasClass(*q, CharClass::Space))
+            {
+                splits.push_back(q - begin);
+                target = q + chunkSize;
+                break;
+            }
+        }
+        p = special;
+        if (p >= end)
+        {
+            break;
+        }
+
+        if (*p == '"')
+        {
+            // Up to the closing quote, skipping escaped characters
+            p = findQuoteOrBackslash(p + 1, end, '"');
+            while (p < end && *p != '"')
+            {
+                p = findQuoteOrBackslash(p + 1 < end ? p + 2 : end, end, '"');
+            }
+            p = p < end ? p + 1 : end;
+        }
+        else if (*p == '\'')
+        {
+            // One character, or an escape sequence, and the closing quote if
+            // it is there
+            p++;
+            if (p < end && *p++ == '\\' && p < end)
+            {
+                p++;
+            }
+            if (p < end && *p == '\'')
+            {
+                p++;
+            }
+        }
+        else if (p + 1 < end && p[1] == '/')
+        {
+            p = findNewline(p + 2, end);
+        }
+        else if (p + 1 < end && p[1] == '*')
+        {
+            p = findCommentEnd(p + 2, end, newlines);
+            p = p < end ? p + 2 : end;
+        }
+        else
+        {
+            p++; // A division
+        }
+    }
+    return splits;
+}
+
+std::vector<Token> Tokenizer::tokenizeParallel(unsigned threads, size_t minChunkSize)
+{
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t chunkSize = std::max(minChunkSize, source.size() / threads + 1);
+    std::vector<size_t> splits = source.size() >= 2 * minChunkSize && threads > 1
+                                     ? findSplitPoints(source, chunkSize)
+                                     : std::vector<size_t>();
+    if (splits.empty())
+    {
+        return tokenize();
+    }
+    TRACE(Tokenizer, Debug, "=== Tokenizing ", splits.size() + 1, " pieces in parallel ===");
+
+    // Each piece is tokenized on its own as if it started on line 1
+    splits.insert(splits.begin(), 0);
+    splits.push_back(source.size());
+    size_t count = splits.size() - 1;
+    std::vector<std::vector<Token>> tokens(count);
+    std::vector<int> lines(count);
+    pieces.clear();
+    for (size_t i = 0; i < count; i++)
+    {
+        pieces.push_back(std::make_unique<Tokenizer>(
+            SourceBuffer::borrow(source.substr(splits[i], splits[i + 1] - splits[i]))));
+        pieces.back()->printErrors = false;
+    }
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < count; i++)
+    {
+        workers.emplace_back([this, i, &tokens, &lines] {
+            Tokenizer &piece = *pieces[i];
+            std::vector<Token> &out = tokens[i];
+            out.reserve(piece.source.size() / 4 + 1);
+            do
+            {
+                out.push_back(piece.nextToken());
+            } while (out.back().type != TokenType::EndOfFile);
+            lines[i] = piece.line;
+        });
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    // Stitch the pieces together, dropping all but the last EndOfFile and
+    // moving each piece down by the lines of the pieces before it. Every
+    // piece is copied into place on its own thread again
+    std::vector<size_t> starts(count + 1, 0);
+    std::vector<int> offsets(count + 1, 0);
+    for (size_t i = 0; i < count; i++)
+    {
+        starts[i + 1] = starts[i] + tokens[i].size() - (i + 1 < count ? 1 : 0);
+        offsets[i + 1] = offsets[i] + lines[i] - 1;
+    }
+    std::vector<Token> result(starts[count]);
+    workers.clear();
+    for (size_t i = 0; i < count; i++)
+    {
+        workers.emplace_back([i, &tokens, &starts, &offsets, &result] {
+            Token *out = result.data() + starts[i];
+            for (size_t j = 0; j < starts[i + 1] - starts[i]; j++)
+            {
+                out[j] = tokens[i][j];
+                out[j].line += offsets[i];
+            }
+            std::vector<Token>().swap(tokens[i]);
+        });
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    // The errors too, only now that their lines are known
+    for (size_t i = 0; i < count; i++)
+    {
+        for (TokenizerError error : pieces[i]->errorList)
+        {
+            error.line += offsets[i];
+            printError(error);
+            errorList.push_back(std::move(error));
+        }
+    }
+    int offset = offsets[count];
+    line = offset + 1;
+    position = source.size();
+    TRACE(Tokenizer, Debug, "=== Finished tokenization with ", result.size(), " tokens ===");
+    return result;
 }
 
-bool Tokenizer::isMultiCharacterOperator(const std::string &op)
+bool Tokenizer::isMultiCharacterOperator(char first, char second)
 {
-    static const std::set<std::string> multiCharOperators = {
-        "&&", "||", "==", "!=", "<=", ">=", "+=", "-=", "*=", "/=", "++", "--"};
-    return multiCharOperators.find(op) != multiCharOperators.end();
-}
\ No newline at end of file
+    // "&&", "||", "==", "!=", "<=", ">=", "+=", "-=", "*=", "/=", "++", "--"
+    switch (second)
+    {
+    case '=':
+        return first == '=' || first == '!' || first == '<' || first == '>' ||
+               first == '+' || first == '-' || first == '*' || first == '/';
+    case '&':
+    case '|':
+    case '+':
+    case '-':
+        return first == second;
+    default:
+        return false;
+    }
+}
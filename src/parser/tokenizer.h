@@ -1,11 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
 #include <iostream>
+#include <memory>
 #include <set>
 #include <string>
+#include <stdexcept>
+#include <string_view>
 #include <vector>
+#include "source.h"
 
-enum class TokenType
+enum class TokenType : uint8_t
 {
   Identifier,
   Keyword,
@@ -19,38 +27,162 @@ enum class TokenType
   Character
 };
 
+// A token is a 16 byte view of its lexeme in the Tokenizer's source, so
+// tokenizing copies no strings. String and character literals with escape
+// sequences point at their decoded text in a side table of the Tokenizer
+// instead. Either way a token is only valid while its Tokenizer is alive.
 struct Token
 {
-  TokenType type;
-  std::string value;
-  int line; // Line number for error reporting
+  // Lexemes from 16 MiB - 1 bytes on (a huge string literal) don't fit the
+  // 24-bit length. The Tokenizer keeps their view and text points at it
+  static constexpr uint32_t longLength = (1u << 24) - 1;
+
+  Token() : length(0) {}
+  Token(TokenType type, std::string_view text, int line)
+      : text(text.data()), length(shortLength(text.size())), type(type), line(line) {}
+  Token(TokenType type, const std::string_view *longText, int line)
+      : text(reinterpret_cast<const char *>(longText)), length(longLength), type(type), line(line) {}
+
+  const char *text = "";
+  uint32_t length : 24;
+  TokenType type = TokenType::Unknown;
+  int line = 0; // Line number for error reporting
+
+  std::string_view value() const
+  {
+    return length != longLength ? std::string_view(text, length)
+                                : *reinterpret_cast<const std::string_view *>(text);
+  }
+
+private:
+  static uint32_t shortLength(size_t size)
+  {
+    if (size >= longLength)
+    {
+      throw std::length_error("A lexeme of " + std::to_string(size) +
+                              " bytes needs the Tokenizer to keep its view");
+    }
+    return static_cast<uint32_t>(size);
+  }
+};
+
+static_assert(sizeof(Token) == 16, "Tokens should stay two words");
+
+// A problem with the source, reported as the tokenizer comes across it
+struct TokenizerError
+{
+  int line;
+  std::string message;
 };
 
 class Tokenizer
 {
 public:
-  Tokenizer(const std::string &source) : source(source), position(0), line(1) {}
+  Tokenizer(std::string source) : Tokenizer(SourceBuffer(std::move(source))) {}
+  explicit Tokenizer(SourceBuffer buffer)
+      : buffer(std::move(buffer)), source(this->buffer.text()), position(0), line(1) {}
+
+  // Tokens point into the tokenizer, which therefore can't be copied or moved
+  Tokenizer(const Tokenizer &) = delete;
+  Tokenizer &operator=(const Tokenizer &) = delete;
 
   std::vector<Token> tokenize();
   Token nextToken();
 
+  // Splits the source where the tokenizer is between tokens, outside of any
+  // literal or comment, and tokenizes the pieces on up to threads threads (0
+  // for one per core). The tokens are the same as tokenize()'s. Sources too
+  // short for two pieces of minChunkSize bytes are tokenized serially.
+  std::vector<Token> tokenizeParallel(unsigned threads = 0, size_t minChunkSize = 1 << 20);
+
+  std::string_view text() const { return source; }
+
+  // The errors found so far in source order. Each is printed to std::cerr as
+  // well when it is found
+  const std::vector<TokenizerError> &errors() const { return errorList; }
+
 private:
-  std::string source;
+  SourceBuffer buffer;
+  std::string_view source;
+  std::deque<std::string> decoded; // Escaped literals; a deque never moves them
+  std::deque<std::string_view> longLexemes; // Views of the lexemes too long for a Token
+  std::vector<std::unique_ptr<Tokenizer>> pieces; // Own the literals decoded by tokenizeParallel
   size_t position;
   int line;
+  std::vector<TokenizerError> errorList;
+  bool printErrors = true; // The pieces of tokenizeParallel leave it to print theirs in order
+
+  Token makeToken(TokenType type, size_t start)
+  {
+    return makeToken(type, source.substr(start, position - start), line);
+  }
+
+  Token makeToken(TokenType type, std::string_view text, int tokenLine)
+  {
+    if (text.size() < Token::longLength)
+    {
+      return Token(type, text, tokenLine);
+    }
+    longLexemes.push_back(text);
+    return Token(type, &longLexemes.back(), tokenLine);
+  }
 
-  bool isKeyword(const std::string &value);
-  bool isOperatorOrPunctuatorStart(char ch);
-  bool isOperator(char ch);
-  bool isUnknownCharacter(char ch);
+  void error(std::string message);
+  static void printError(const TokenizerError &error);
   void skipWhitespaceAndComments();
   Token identifierOrKeyword();
-  bool isDeclarationKeyword(const std::string &value);
   Token numericLiteral();
   Token stringLiteral();
   char processEscapeSequence(char escapedChar);
   Token characterLiteral();
   Token operatorOrPunctuator();
-  bool isPunctuator(char ch);
-  bool isMultiCharacterOperator(const std::string &op);
+  bool isMultiCharacterOperator(char first, char second);
+};
+
+// The tokens of a Tokenizer as the parser sees them. Tokens are either pulled
+// from the Tokenizer as they are asked for, keeping only the last windowSize
+// of them in a ring, or read from a vector tokenized in advance. Past the end
+// the stream keeps returning the EndOfFile token.
+class TokenStream
+{
+public:
+  static constexpr size_t windowSize = 32;
+
+  explicit TokenStream(Tokenizer &tokenizer) : tokenizer(&tokenizer) {}
+  explicit TokenStream(const std::vector<Token> &tokens) : tokens(&tokens) {}
+
+  const Token &operator[](size_t index)
+  {
+    if (tokens)
+    {
+      return (*tokens)[std::min(index, tokens->size() - 1)];
+    }
+    if (index >= pulled)
+    {
+      return pull(index);
+    }
+    if (index + windowSize < pulled)
+    {
+      throw std::logic_error("Token " + std::to_string(index) + " has already left the window");
+    }
+    return window[index % windowSize];
+  }
+
+private:
+  Tokenizer *tokenizer = nullptr;
+  const std::vector<Token> *tokens = nullptr;
+  std::array<Token, windowSize> window;
+  size_t pulled = 0; // Tokens taken from the tokenizer so far
+  bool ended = false;
+
+  const Token &pull(size_t index)
+  {
+    while (pulled <= index && !ended)
+    {
+      Token &token = window[pulled++ % windowSize];
+      token = tokenizer->nextToken();
+      ended = token.type == TokenType::EndOfFile;
+    }
+    return window[std::min(index, pulled - 1) % windowSize];
+  }
 };